@@ -108,14 +108,9 @@ from intensity.server.admin_listener import *
 
 print "Preparing timing and running first slice"
 
-NETWORK_RATE = float(get_config("Network", "rate", 33))/1000.0
-MIN_DELAY    = 0.01 # If this is too big - 0.1 is too big - then we get jerky motion with many NPCs. Probably
-                    # because 0.1 is a long wait between updates (10Hz instead of 30Hz)
-                    # But if this is too small - 0.0 is too small - then the interactive console is not responsive
-
 CModule.slice()  # Do a single time slice
 
-print "Network rate:", NETWORK_RATE, "MIN_DELAY:", MIN_DELAY
+print "Network rate:", get_config("Network", "rate", 33)
 
 print "Running main server with parallel interactive console"
 
@@ -131,48 +126,22 @@ if PROFILE:
 
 MASTER_UPDATE_INTERVAL = float(get_config("Network", "master_update_rate", 300))
 
-last_master_update = 0
-
-# Main loop
-
-def main_loop():
-    try:
-        last_time = time.time()
-        while not should_quit():
-
-            # Sleep just long enough for the network rate to be ok, with a minimum so that the interactive console is responsive.
-            while time.time() - last_time < NETWORK_RATE: # For some reason Python 'stutters' in timekeeping, so need a loop, not a single oprt n.
-                delay = max( NETWORK_RATE - (time.time() - last_time) , MIN_DELAY )
-    #            print "Sleeping:", delay
-                time.sleep(delay)
-            assert(time.time() - last_time >= NETWORK_RATE - 0.0001) # 0.0001 for potential rounding errors
-
-            # TODO: In the future, might just run CModule.slice() in a separate thread in order to get responsiveness for interactive console
-            # Would need to be a *real* thread, not a CPython one
-            last_time = time.time()
+def run_periodic():
+    def do_update_master():
+        auth.update_master()
 
-            if not should_quit(): # If during the sleep a quit was requested, do this immediately, do not slice any more
+    # Update master in the side thread, but with it's results - set_map, etc. - in the main queue
+    side_actionqueue.add_action(do_update_master)
 
-                # We do this safely, so as to never work in parallel with the interactive console; see comments in SafeConsole (ser ver_init.py)
-                with slicing_console_lock:
-                    CModule.slice()  # Do a single time slice
+# Main loop. This is native, see ServerSystem::mainLoop: it runs the slices at the network rate, and calls
+# us only to run queued actions and periodic tasks
 
-            # Update master, if necessary TODO: If we add more such things, create a modular plugin system
+main_actionqueue.on_action_added = CModule.notify_main_actions
 
-            global last_master_update
-
-            if time.time() - last_master_update >= MASTER_UPDATE_INTERVAL:
-                last_master_update = time.time()
-
-                def do_update_master():
-                    auth.update_master()
-
-                # Update master in the side thread, but with it's results - set_map, etc. - in the main queue
-                side_actionqueue.add_action(do_update_master)
-
-            # Run queued actions
-
-            main_actionqueue.execute_all()
+def main_loop():
+    try:
+        if not should_quit():
+            CModule.main_loop(slicing_console_lock, main_actionqueue.execute_all, run_periodic, MASTER_UPDATE_INTERVAL)
     except KeyboardInterrupt:
         pass # Just exit gracefully
 
@@ -33,6 +33,18 @@ struct BIHStack
     float tmin, tmax;
 };
 
+// Traversal stack, on the program stack for all but unusually deep trees. It is not static, as lightmaps are traced
+// from several threads
+struct BIHStackBuffer
+{
+    enum { LOCALSIZE = 64 };
+
+    BIHStack local[LOCALSIZE], *buf;
+
+    BIHStackBuffer(int size) : buf(size <= LOCALSIZE ? local : new BIHStack[size]) {}
+    ~BIHStackBuffer() { if(buf != local) delete[] buf; }
+};
+
 bool BIH::traverse(const vec &o, const vec &ray, float maxdist, float &dist, int mode)
 {
     if(!numnodes) return false;
@@ -51,8 +63,9 @@ bool BIH::traverse(const vec &o, const vec &ray, float maxdist, float &dist, int
     if(tmin >= maxdist || tmin>=tmax) return false;
     tmax = min(tmax, maxdist);
 
-    static vector<BIHStack> stack;
-    stack.setsizenodelete(0);
+    BIHStackBuffer stackbuf(maxdepth);
+    BIHStack *stack = stackbuf.buf;
+    int stacksize = 0;
 
     ivec order(ray.x>0 ? 0 : 1, ray.y>0 ? 0 : 1, ray.z>0 ? 0 : 1);
     BIHNode *curnode = &nodes[0];
@@ -96,7 +109,7 @@ bool BIH::traverse(const vec &o, const vec &ray, float maxdist, float &dist, int
             {
                 if(!curnode->isleaf(faridx))
                 {
-                    BIHStack &save = stack.add();
+                    BIHStack &save = stack[stacksize++];
                     save.node = &nodes[curnode->childindex(faridx)];
                     save.tmin = max(tmin, farsplit);
                     save.tmax = tmax;
@@ -107,8 +120,8 @@ bool BIH::traverse(const vec &o, const vec &ray, float maxdist, float &dist, int
             tmax = min(tmax, nearsplit);
             continue;
         }
-        if(stack.empty()) return false;
-        BIHStack &restore = stack.pop();
+        if(stacksize <= 0) return false;
+        BIHStack &restore = stack[--stacksize];
         curnode = restore.node;
         tmin = restore.tmin;
         tmax = restore.tmax;
@@ -273,10 +286,21 @@ static inline void yawray(vec &o, vec &ray, float angle)
     ray.normalize();
 }
 
-bool mmintersect(const extentity &e, const vec &o, const vec &ray, float maxdist, int mode, float &dist)
+// The models of the mapmodels, resolved on the main thread before lighting the map and indexed like entities::getents().
+// While they are in use, mmintersect() only reads them, so worker threads tracing shadows never load models.
+// A NULL entry marks an entity that is not a mapmodel, or whose model or BIH failed to load
+static vector<model *> mmintersectmodels;
+static bool usemmintersectmodels = false;
+
+bool mmintersect(const extentity &e, int id, const vec &o, const vec &ray, float maxdist, int mode, float &dist)
 {
-    LogicEntityPtr entity = LogicSystem::getLogicEntity(e); // INTENSITY
-    model *m = entity.get() ? entity->getModel() : NULL; // INTENSITY
+    model *m;
+    if(usemmintersectmodels) m = mmintersectmodels.inrange(id) ? mmintersectmodels[id] : NULL;
+    else
+    {
+        LogicEntityPtr entity = LogicSystem::getLogicEntity(e); // INTENSITY
+        m = entity.get() ? entity->getModel() : NULL; // INTENSITY
+    }
     if(!m) return false;
     if(mode&RAY_SHADOW)
     {
@@ -284,7 +308,7 @@ bool mmintersect(const extentity &e, const vec &o, const vec &ray, float maxdist
     }
     else if((mode&RAY_ENTS)!=RAY_ENTS && !m->collide) return false;
 //    if((mode&RAY_ENTS)!=RAY_ENTS && m->collisionsonlyfortriggering) return false; // INTENSITY: Might need this
-    if(!m->bih && !m->setBIH()) return false;
+    if(!m->bih && (usemmintersectmodels || !m->setBIH())) return false;
     if(!maxdist) maxdist = 1e16f;
     vec yo(o);
     yo.sub(e.o);
@@ -294,3 +318,28 @@ bool mmintersect(const extentity &e, const vec &o, const vec &ray, float maxdist
     return m->bih->traverse(yo, yray, maxdist, dist, mode);
 }
 
+// Resolves the models, BIHs and alpha masks of all mapmodels, which mmintersect() would otherwise load on first use,
+// so that it can then be called from other threads until cleanupmmintersect()
+void preloadmmintersect()
+{
+    const vector<extentity *> &ents = entities::getents();
+    mmintersectmodels.setsize(0);
+    loopv(ents)
+    {
+        model *&m = mmintersectmodels.add(NULL);
+        if(ents[i]->type!=ET_MAPMODEL) continue;
+        LogicEntityPtr entity = LogicSystem::getLogicEntity(*ents[i]); // INTENSITY
+        model *mm = entity.get() ? entity->getModel() : NULL; // INTENSITY
+        if(!mm || (!mm->bih && !mm->setBIH())) continue;
+        loopj(mm->bih->numtris) if(mm->bih->tris[j].tex) loadalphamask(mm->bih->tris[j].tex);
+        m = mm;
+    }
+    usemmintersectmodels = true;
+}
+
+void cleanupmmintersect()
+{
+    usemmintersectmodels = false;
+    mmintersectmodels.setsize(0);
+}
+
@@ -39,5 +39,7 @@ struct BIH
     bool traverse(const vec &o, const vec &ray, float maxdist, float &dist, int mode);
 };
 
-extern bool mmintersect(const extentity &e, const vec &o, const vec &ray, float maxdist, int mode, float &dist);
+extern bool mmintersect(const extentity &e, int id, const vec &o, const vec &ray, float maxdist, int mode, float &dist);
+extern void preloadmmintersect();
+extern void cleanupmmintersect();
 
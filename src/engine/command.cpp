@@ -11,6 +11,14 @@ identtable *idents = NULL;        // contains ALL vars/commands/aliases
 
 bool overrideidents = false, persistidents = true;
 
+static void releasecode(cscode *code); // INTENSITY
+static void clearcscache();
+
+static inline void invalidatecode(ident &id)
+{
+    if(id.code) { releasecode(id.code); id.code = NULL; }
+}
+
 void clearstack(ident &id)
 {
     identstack *stack = id.stack;
@@ -26,8 +34,9 @@ void clearstack(ident &id)
 
 void clear_command()
 {
-    enumerate(*idents, ident, i, if(i.type==ID_ALIAS) { DELETEA(i.name); DELETEA(i.action); if(i.stack) clearstack(i); });
+    enumerate(*idents, ident, i, if(i.type==ID_ALIAS) { invalidatecode(i); DELETEA(i.name); DELETEA(i.action); if(i.stack) clearstack(i); });
     if(idents) idents->clear();
+    clearcscache(); // INTENSITY
 }
 
 void clearoverride(ident &i)
@@ -40,6 +49,7 @@ void clearoverride(ident &i)
             {
                 if(i.action != i.isexecuting) delete[] i.action;
                 i.action = newstring("");
+                invalidatecode(i); // INTENSITY
             }
             break;
         case ID_VAR:
@@ -72,6 +82,7 @@ void pushident(ident &id, char *val)
     stack->next = id.stack;
     id.stack = stack;
     id.action = val;
+    invalidatecode(id); // INTENSITY
 }
 
 void popident(ident &id)
@@ -82,6 +93,7 @@ void popident(ident &id)
     id.action = stack->action;
     id.stack = stack->next;
     delete stack;
+    invalidatecode(id); // INTENSITY
 }
 
 ident *newident(const char *name)
@@ -141,6 +153,7 @@ void aliasa(const char *name, char *action)
     {
         if(b->action != b->isexecuting) delete[] b->action;
         b->action = action;
+        invalidatecode(*b); // INTENSITY
         if(overrideidents) b->override = OVERRIDDEN;
         else 
         {
@@ -485,209 +498,612 @@ static inline bool isinteger(char *c)
 
 char *commandret = NULL;
 
-char *executeret(const char *p)               // all evaluation happens here, recursively
+static const int MAXWORDS = 25;                 // limit, remove
+
+// INTENSITY: Bytecode. Source text is compiled once into statements of words, each word being a literal
+// (with its numeric values pre-converted), a $lookup, a () expression (itself compiled), or a [] block whose
+// @macros must be expanded when it runs. Compiling mirrors the parser above exactly, but evaluates nothing, so
+// running compiled code has the same effects, in the same order, as parsing and running the source - just
+// without re-tokenizing it, and with idents looked up once. Source that does not parse (e.g. a missing bracket)
+// is not compiled, and is interpreted as before, so it reports its errors as before.
+//
+// Aliases keep the compiled form of their action, dropped whenever the action changes. Other source - binds,
+// menus, loop bodies, sleeps - is compiled into a cache keyed by the text.
+
+enum { CSW_LITERAL = 0, CSW_LOOKUP, CSW_EXP, CSW_MACRO };
+
+struct csword
 {
-    const int MAXWORDS = 25;                    // limit, remove
-    char *w[MAXWORDS];
-    char *retval = NULL;
-    #define setretval(v) { char *rv = v; if(rv) retval = rv; }
-    for(bool cont = true; cont;)                // for each ; seperated statement
+    int type;
+    char *str;          // CSW_LITERAL: the word, CSW_LOOKUP: "$name", CSW_MACRO: the [] block as written
+    int ival;           // CSW_LITERAL: numeric values
+    float fval;
+    ident *id;          // CSW_LOOKUP, or a literal command name: the ident, once it exists (idents never move)
+    cscode *code;       // CSW_EXP
+};
+
+struct csstatement
+{
+    int firstword, numargs, infix;
+};
+
+struct cscode
+{
+    int refs;
+    bool valid;         // if false, the source failed to parse, and is interpreted
+    char *source;
+    vector<csword> words;
+    vector<csstatement> statements;
+
+    cscode(const char *source) : refs(1), valid(true), source(newstring(source)) {}
+    ~cscode()
     {
-        int numargs = MAXWORDS, infix = 0;
-        loopi(MAXWORDS)                         // collect all argument values
+        loopv(words)
+        {
+            DELETEA(words[i].str);
+            if(words[i].code) releasecode(words[i].code);
+        }
+        delete[] source;
+    }
+};
+
+static void releasecode(cscode *code)
+{
+    if(--code->refs <= 0) delete code;
+}
+
+static bool scanexp(const char *&p, int right, vector<char> &buf, bool &hasmacro);
+
+static bool scanmacro(const char *&p, int level, vector<char> &buf, bool &hasmacro) // see parsemacro
+{
+    int escape = 1;
+    while(*p=='@') p++, escape++;
+    if(level > escape)
+    {
+        while(escape--) buf.add('@');
+        return true;
+    }
+    hasmacro = true;
+    if(*p=='(')
+    {
+        vector<char> exp;
+        return scanexp(p, ')', exp, hasmacro);
+    }
+    while(isalnum(*p) || *p=='_') p++;
+    return true;
+}
+
+static bool scanexp(const char *&p, int right, vector<char> &buf, bool &hasmacro) // see parseexp
+{
+    int left = *p++;
+    for(int brak = 1; brak; )
+    {
+        int c = *p++;
+        switch(c)
+        {
+            case '\r': continue;
+            case '@':
+                if(left == '[') 
+                {
+                    if(!scanmacro(p, brak, buf, hasmacro)) return false;
+                    continue; 
+                }
+                break;
+            case '\"':
+            {
+                buf.add(c);
+                const char *end = parsestring(p);
+                buf.put(p, end - p);
+                p = end;
+                if(*p=='\"') buf.add(*p++);
+                continue;
+            }
+            case '/':
+                if(*p=='/')
+                {
+                    p += strcspn(p, "\n\0");
+                    continue;
+                }
+                break;
+            case '\0':
+                p--;
+                return false;
+        }
+        if(c==left) brak++;
+        else if(c==right) brak--;
+        buf.add(c);
+    }
+    buf.pop();
+    return true;
+}
+
+static cscode *compilecode(const char *p);
+
+// returns 1 for a word, 0 at the end of the statement, and -1 if the source does not parse
+static int compileword(const char *&p, int arg, int &infix, csword &w) // see parseword
+{
+    for(;;)
+    {
+        p += strspn(p, " \t\r");
+        if(p[0]!='/' || p[1]!='/') break;
+        p += strcspn(p, "\n\0");  
+    }
+    w.type = CSW_LITERAL;
+    w.str = NULL;
+    w.ival = 0;
+    w.fval = 0;
+    w.id = NULL;
+    w.code = NULL;
+    if(*p=='\"')
+    {
+        p++;
+        const char *end = parsestring(p);
+        w.str = newstring(end - p);
+        w.str[escapestring(w.str, p, end)] = '\0';
+        p = end;
+        if(*p=='\"') p++;
+    }
+    else if(*p=='(' || *p=='[')
+    {
+        const char *start = p;
+        vector<char> buf;
+        bool hasmacro = false;
+        if(!scanexp(p, *p=='(' ? ')' : ']', buf, hasmacro)) return -1;
+        if(*start=='(')
+        {
+            buf.add(0);
+            w.type = CSW_EXP;
+            w.code = compilecode(buf.getbuf());
+        }
+        else if(hasmacro)
+        {
+            w.type = CSW_MACRO;
+            w.str = newstring(start, p-start);
+        }
+        else w.str = newstring(buf.getbuf(), buf.length());
+    }
+    else
+    {
+        const char *word = p;
+        for(;;)
+        {
+            p += strcspn(p, "/; \t\r\n\0");
+            if(p[0]!='/' || p[1]=='/') break;
+            else if(p[1]=='\0') { p++; break; }
+            p += 2;
+        }
+        if(p-word==0) return 0;
+        if(arg==1 && p-word==1) switch(*word)
+        {
+            case '=': infix = *word; break;
+        }
+        w.str = newstring(word, p-word);
+        if(*w.str=='$') w.type = CSW_LOOKUP;
+    }
+    if(w.type==CSW_LITERAL)
+    {
+        w.ival = parseint(w.str);
+        w.fval = atof(w.str);
+    }
+    return 1;
+}
+
+static cscode *compilecode(const char *p) // see interpretret
+{
+    cscode *code = new cscode(p);
+    for(bool cont = true; cont;)
+    {
+        csstatement st;
+        st.firstword = code->words.length();
+        st.infix = 0;
+        int numargs = MAXWORDS;
+        loopi(MAXWORDS)
         {
-            w[i] = (char *)"";
             if(i>numargs) continue;
-            char *s = parseword(p, i, infix);   // parse and evaluate exps
-            if(s) w[i] = s;
+            csword w;
+            int parsed = compileword(p, i, st.infix, w);
+            if(parsed < 0) { code->valid = false; return code; }
+            if(parsed) code->words.add(w);
             else numargs = i;
         }
-        
         p += strcspn(p, ";\n\0");
-        cont = *p++!=0;                         // more statements if this isn't the end of the string
-        char *c = w[0];
-        if(!*c) continue;                       // empty statement
-        
-        DELETEA(retval);
+        cont = *p++!=0;
+        st.numargs = numargs;
+        if(numargs) code->statements.add(st);   // empty statements do nothing
+    }
+    return code;
+}
+
+VAR(cscompile, 0, 1, 1); // INTENSITY: 0 interprets all source text, as before bytecode
+
+#define CSCACHESIZE 1024                        // entries, before the cache is flushed
+#define CSMAXCACHED 4096                        // longer source (e.g., whole config files) is interpreted
+#define CSSEENSIZE 4096                         // hashes of source run once, which is only compiled if run again
+
+static hashtable<const char *, cscode *> cscache;
+static uint csseen[CSSEENSIZE];
+
+static void clearcscache()
+{
+    enumerate(cscache, cscode *, code, releasecode(code));
+    cscache.clear();
+}
+
+static cscode *getcachedcode(const char *p)
+{
+    if(strlen(p) > CSMAXCACHED) return NULL;
+    cscode **cached = cscache.access(p);
+    if(cached) return *cached;
+    // one-off text (e.g., formatted by a script for a single execute) is interpreted, so that it neither pays
+    // for compiling nor fills the cache and flushes the binds and menus that do run repeatedly
+    uint hash = hthash(p);
+    uint &seen = csseen[hash&(CSSEENSIZE-1)];
+    if(seen != hash) { seen = hash; return NULL; }
+    if(cscache.numelems >= CSCACHESIZE) clearcscache();
+    cscode *code = compilecode(p);
+    cscache.access(code->source, code);
+    return code;
+}
+
+// Runs a statement whose words have been evaluated. Words are owned by the statement (and given away, or freed
+// here), except for the literals of compiled code ('lits'), which are only copied where something keeps them.
+
+#define ISLITERAL(j) (lits && (j) < numargs && lits[j].type==CSW_LITERAL)
+#define ARGINT(j) (ISLITERAL(j) ? lits[j].ival : parseint(w[j]))
+#define ARGFLOAT(j) (ISLITERAL(j) ? lits[j].fval : atof(w[j]))
+#define GIVEARG(j) (ISLITERAL(j) ? newstring(w[j]) : w[j])
+
+static char *interpretret(const char *p);
+static char *executecode(cscode *code);
 
-        if(infix)
+static char *executealias(ident &id)
+{
+    if(cscompile)
+    {
+        if(!id.code) id.code = compilecode(id.action);
+        return executecode(id.code);
+    }
+    return interpretret(id.action);
+}
+
+static char *callstatement(ident *id, char *c, char **w, int numargs, int infix, csword *lits)
+{
+    char *retval = NULL;
+    #define setretval(v) { char *rv = v; if(rv) retval = rv; }
+    if(infix)
+    {
+        switch(infix)
         {
-            switch(infix)
-            {
-                case '=':    
-                    aliasa(c, numargs>2 ? w[2] : newstring(""));
-                    w[2] = NULL;
-                    break;
-            }
+            case '=':    
+                aliasa(c, numargs>2 ? GIVEARG(2) : newstring(""));
+                w[2] = NULL;
+                break;
         }
-        else
-        {     
-            ident *id = idents->access(c);
-            if(!id)
-            {
-                if(!isinteger(c))
-                    conoutf(CON_ERROR, "unknown command: %s", c);
-                setretval(newstring(c));
-            }
-            else switch(id->type)
-            {
-                case ID_CCOMMAND:
-                case ID_COMMAND:                     // game defined commands
-                {   
-                    void *v[MAXWORDS];
-                    union
-                    {
-                        int i;
-                        float f;
-                    } nstor[MAXWORDS];
-                    int n = 0, wn = 0;
-                    char *cargs = NULL;
-                    if(id->type==ID_CCOMMAND) v[n++] = id->self;
-                    for(const char *a = id->narg; *a; a++) switch(*a)
-                    {
-                        case 's':                                 v[n] = w[++wn];     n++; break;
-                        case 'i': nstor[n].i = parseint(w[++wn]); v[n] = &nstor[n].i; n++; break;
-                        case 'f': nstor[n].f = atof(w[++wn]);     v[n] = &nstor[n].f; n++; break;
+    }
+    else
+    {     
+        if(!id)
+        {
+            if(!isinteger(c))
+                conoutf(CON_ERROR, "unknown command: %s", c);
+            setretval(newstring(c));
+        }
+        else switch(id->type)
+        {
+            case ID_CCOMMAND:
+            case ID_COMMAND:                     // game defined commands
+            {   
+                void *v[MAXWORDS];
+                union
+                {
+                    int i;
+                    float f;
+                } nstor[MAXWORDS];
+                int n = 0, wn = 0;
+                char *cargs = NULL;
+                char *copies[2*MAXWORDS];        // of literals, for commands that take strings
+                int numcopies = 0;
+                if(id->type==ID_CCOMMAND) v[n++] = id->self;
+                for(const char *a = id->narg; *a; a++) switch(*a)
+                {
+                    case 's': ++wn; v[n] = ISLITERAL(wn) ? (copies[numcopies++] = newstring(w[wn])) : w[wn]; n++; break;
+                    case 'i': ++wn; nstor[n].i = ARGINT(wn);   v[n] = &nstor[n].i; n++; break;
+                    case 'f': ++wn; nstor[n].f = ARGFLOAT(wn); v[n] = &nstor[n].f; n++; break;
 #ifndef STANDALONE
-                        case 'D': nstor[n].i = addreleaseaction(id->name) ? 1 : 0; v[n] = &nstor[n].i; n++; break;
+                    case 'D': nstor[n].i = addreleaseaction(id->name) ? 1 : 0; v[n] = &nstor[n].i; n++; break;
 #endif
-                        case 'V': v[n++] = w+1; nstor[n].i = numargs-1; v[n] = &nstor[n].i; n++; break;
-                        case 'C': if(!cargs) cargs = conc(w+1, numargs-1, true); v[n++] = cargs; break;
-                        default: fatal("builtin declared with illegal type");
-                    }
-                    switch(n)
-                    {
-                        case 0: ((void (__cdecl *)()                                      )id->fun)();                             break;
-                        case 1: ((void (__cdecl *)(void *)                                )id->fun)(v[0]);                         break;
-                        case 2: ((void (__cdecl *)(void *, void *)                        )id->fun)(v[0], v[1]);                   break;
-                        case 3: ((void (__cdecl *)(void *, void *, void *)                )id->fun)(v[0], v[1], v[2]);             break;
-                        case 4: ((void (__cdecl *)(void *, void *, void *, void *)        )id->fun)(v[0], v[1], v[2], v[3]);       break;
-                        case 5: ((void (__cdecl *)(void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4]); break;
-                        case 6: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5]); break;
-                        case 7: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5], v[6]); break;
-                        case 8: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]); break;
-                        default: fatal("builtin declared with too many args (use V?)");
-                    }
-                    if(cargs) delete[] cargs;
-                    setretval(commandret);
-                    commandret = NULL;
-                    break;
+                    case 'V': 
+                        for(int j = 1; j < numargs; j++) if(ISLITERAL(j)) w[j] = copies[numcopies++] = newstring(w[j]);
+                        v[n++] = w+1; nstor[n].i = numargs-1; v[n] = &nstor[n].i; n++; 
+                        break;
+                    case 'C': if(!cargs) cargs = conc(w+1, numargs-1, true); v[n++] = cargs; break;
+                    default: fatal("builtin declared with illegal type");
+                }
+                switch(n)
+                {
+                    case 0: ((void (__cdecl *)()                                      )id->fun)();                             break;
+                    case 1: ((void (__cdecl *)(void *)                                )id->fun)(v[0]);                         break;
+                    case 2: ((void (__cdecl *)(void *, void *)                        )id->fun)(v[0], v[1]);                   break;
+                    case 3: ((void (__cdecl *)(void *, void *, void *)                )id->fun)(v[0], v[1], v[2]);             break;
+                    case 4: ((void (__cdecl *)(void *, void *, void *, void *)        )id->fun)(v[0], v[1], v[2], v[3]);       break;
+                    case 5: ((void (__cdecl *)(void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4]); break;
+                    case 6: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5]); break;
+                    case 7: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5], v[6]); break;
+                    case 8: ((void (__cdecl *)(void *, void *, void *, void *, void *, void *, void *, void *))id->fun)(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7]); break;
+                    default: fatal("builtin declared with too many args (use V?)");
                 }
+                if(cargs) delete[] cargs;
+                loopi(numcopies) delete[] copies[i];
+                if(numcopies) loopj(numargs) if(ISLITERAL(j)) w[j] = lits[j].str; // do not free copies twice
+                setretval(commandret);
+                commandret = NULL;
+                break;
+            }
 
-                case ID_VAR:                        // game defined variables 
-                    if(numargs <= 1) 
-                    {
-                        if(id->flags&IDF_HEX && id->maxval==0xFFFFFF) 
-                            conoutf("%s = 0x%.6X (%d, %d, %d)", c, *id->storage.i, (*id->storage.i>>16)&0xFF, (*id->storage.i>>8)&0xFF, *id->storage.i&0xFF);
-                        else
-                            conoutf(id->flags&IDF_HEX ? "%s = 0x%X" : "%s = %d", c, *id->storage.i);      // var with no value just prints its current value
-                    }
-                    else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
+            case ID_VAR:                        // game defined variables 
+                if(numargs <= 1) 
+                {
+                    if(id->flags&IDF_HEX && id->maxval==0xFFFFFF) 
+                        conoutf("%s = 0x%.6X (%d, %d, %d)", c, *id->storage.i, (*id->storage.i>>16)&0xFF, (*id->storage.i>>8)&0xFF, *id->storage.i&0xFF);
+                    else
+                        conoutf(id->flags&IDF_HEX ? "%s = 0x%X" : "%s = %d", c, *id->storage.i);      // var with no value just prints its current value
+                }
+                else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
 #ifndef STANDALONE
-                    else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
+                else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
 #else
-                    else
+                else
 #endif
+                {
+                    OVERRIDEVAR(break, id->overrideval.i = *id->storage.i, , )
+                    int i1 = ARGINT(1);
+                    if(id->flags&IDF_HEX && numargs > 2)
+                    {
+                        i1 <<= 16;
+                        i1 |= ARGINT(2)<<8;    
+                        i1 |= ARGINT(3);
+                    }
+                    if(i1<id->minval || i1>id->maxval)
                     {
-                        OVERRIDEVAR(break, id->overrideval.i = *id->storage.i, , )
-                        int i1 = parseint(w[1]);
-                        if(id->flags&IDF_HEX && numargs > 2)
-                        {
-                            i1 <<= 16;
-                            i1 |= parseint(w[2])<<8;    
-                            i1 |= parseint(w[3]);
-                        }
-                        if(i1<id->minval || i1>id->maxval)
-                        {
-                            i1 = i1<id->minval ? id->minval : id->maxval;                // clamp to valid range
-                            conoutf(CON_ERROR,
-                                id->flags&IDF_HEX ?
-                                    (id->minval <= 255 ? "valid range for %s is %d..0x%X" : "valid range for %s is 0x%X..0x%X") :
-                                    "valid range for %s is %d..%d", 
-                                id->name, id->minval, id->maxval);
-                        }
-                        *id->storage.i = i1;
-                        id->changed();                                             // call trigger function if available
+                        i1 = i1<id->minval ? id->minval : id->maxval;                // clamp to valid range
+                        conoutf(CON_ERROR,
+                            id->flags&IDF_HEX ?
+                                (id->minval <= 255 ? "valid range for %s is %d..0x%X" : "valid range for %s is 0x%X..0x%X") :
+                                "valid range for %s is %d..%d", 
+                            id->name, id->minval, id->maxval);
+                    }
+                    *id->storage.i = i1;
+                    id->changed();                                             // call trigger function if available
 #ifndef STANDALONE
-                        if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
+                    if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
 #endif
-                    }
-                    break;
-                  
-                case ID_FVAR:
-                    if(numargs <= 1) conoutf("%s = %s", c, floatstr(*id->storage.f));
-                    else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
+                }
+                break;
+              
+            case ID_FVAR:
+                if(numargs <= 1) conoutf("%s = %s", c, floatstr(*id->storage.f));
+                else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
 #ifndef STANDALONE
-                    else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
+                else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
 #else
-                    else
+                else
 #endif
+                {
+                    OVERRIDEVAR(break, id->overrideval.f = *id->storage.f, , );
+                    float f1 = ARGFLOAT(1);
+                    if(f1<id->minvalf || f1>id->maxvalf)
                     {
-                        OVERRIDEVAR(break, id->overrideval.f = *id->storage.f, , );
-                        float f1 = atof(w[1]);
-                        if(f1<id->minvalf || f1>id->maxvalf)
-                        {
-                            f1 = f1<id->minvalf ? id->minvalf : id->maxvalf;                // clamp to valid range
-                            conoutf(CON_ERROR, "valid range for %s is %s..%s", id->name, floatstr(id->minvalf), floatstr(id->maxvalf));
-                        }
-                        *id->storage.f = f1;
-                        id->changed();
+                        f1 = f1<id->minvalf ? id->minvalf : id->maxvalf;                // clamp to valid range
+                        conoutf(CON_ERROR, "valid range for %s is %s..%s", id->name, floatstr(id->minvalf), floatstr(id->maxvalf));
+                    }
+                    *id->storage.f = f1;
+                    id->changed();
 #ifndef STANDALONE
-                        if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
+                    if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
 #endif
-                    }
-                    break;
+                }
+                break;
  
-                case ID_SVAR:
-                    if(numargs <= 1) conoutf(strchr(*id->storage.s, '"') ? "%s = [%s]" : "%s = \"%s\"", c, *id->storage.s);
-                    else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
+            case ID_SVAR:
+                if(numargs <= 1) conoutf(strchr(*id->storage.s, '"') ? "%s = [%s]" : "%s = \"%s\"", c, *id->storage.s);
+                else if(id->flags&IDF_READONLY) conoutf(CON_ERROR, "variable %s is read-only", id->name);
 #ifndef STANDALONE
-                    else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
+                else if(!(id->flags&IDF_OVERRIDE) || overrideidents || game::allowedittoggle())
 #else
-                    else
+                else
 #endif
-                    {
-                        OVERRIDEVAR(break, id->overrideval.s = *id->storage.s, delete[] id->overrideval.s, delete[] *id->storage.s);
-                        *id->storage.s = newstring(w[1]);
-                        id->changed();
+                {
+                    OVERRIDEVAR(break, id->overrideval.s = *id->storage.s, delete[] id->overrideval.s, delete[] *id->storage.s);
+                    *id->storage.s = newstring(w[1]);
+                    id->changed();
 #ifndef STANDALONE
-                        if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
+                    if(id->flags&IDF_OVERRIDE && !overrideidents) game::vartrigger(id);
 #endif
-                    }
-                    break;
-                        
-                case ID_ALIAS:                              // alias, also used as functions and (global) variables
+                }
+                break;
+                    
+            case ID_ALIAS:                              // alias, also used as functions and (global) variables
+            {
+                if(!ISLITERAL(0)) delete[] w[0]; // INTENSITY: Port from sauer svn rev. 1813, 'leak fix'
+                static vector<ident *> argids;
+                for(int i = 1; i<numargs; i++)
                 {
-                    delete[] w[0]; // INTENSITY: Port from sauer svn rev. 1813, 'leak fix'
-                    static vector<ident *> argids;
-                    for(int i = 1; i<numargs; i++)
+                    if(i > argids.length())
                     {
-                        if(i > argids.length())
-                        {
-                            defformatstring(argname)("arg%d", i);
-                            argids.add(newident(argname));
-                        }
-                        pushident(*argids[i-1], w[i]); // set any arguments as (global) arg values so functions can access them
+                        defformatstring(argname)("arg%d", i);
+                        argids.add(newident(argname));
                     }
-                    _numargs = numargs-1;
-                    bool wasoverriding = overrideidents;
-                    if(id->override!=NO_OVERRIDE) overrideidents = true;
-                    char *wasexecuting = id->isexecuting;
-                    id->isexecuting = id->action;
-                    setretval(executeret(id->action));
-                    if(id->isexecuting != id->action && id->isexecuting != wasexecuting) delete[] id->isexecuting;
-                    id->isexecuting = wasexecuting;
-                    overrideidents = wasoverriding;
-                    for(int i = 1; i<numargs; i++) popident(*argids[i-1]);
-                    continue;
+                    pushident(*argids[i-1], GIVEARG(i)); // set any arguments as (global) arg values so functions can access them
                 }
+                _numargs = numargs-1;
+                bool wasoverriding = overrideidents;
+                if(id->override!=NO_OVERRIDE) overrideidents = true;
+                char *wasexecuting = id->isexecuting;
+                id->isexecuting = id->action;
+                setretval(executealias(*id));
+                if(id->isexecuting != id->action && id->isexecuting != wasexecuting) delete[] id->isexecuting;
+                id->isexecuting = wasexecuting;
+                overrideidents = wasoverriding;
+                for(int i = 1; i<numargs; i++) popident(*argids[i-1]);
+                return retval;
+            }
+        }
+    }
+    loopj(numargs) if(w[j] && !ISLITERAL(j)) delete[] w[j];
+    return retval;
+    #undef setretval
+}
+
+static char *interpretret(const char *p)       // all evaluation happens here, recursively
+{
+    char *w[MAXWORDS];
+    char *retval = NULL;
+    for(bool cont = true; cont;)                // for each ; seperated statement
+    {
+        int numargs = MAXWORDS, infix = 0;
+        loopi(MAXWORDS)                         // collect all argument values
+        {
+            w[i] = (char *)"";
+            if(i>numargs) continue;
+            char *s = parseword(p, i, infix);   // parse and evaluate exps
+            if(s) w[i] = s;
+            else numargs = i;
+        }
+        
+        p += strcspn(p, ";\n\0");
+        cont = *p++!=0;                         // more statements if this isn't the end of the string
+        char *c = w[0];
+        if(!*c) continue;                       // empty statement
+        
+        DELETEA(retval);
+        retval = callstatement(infix ? NULL : idents->access(c), c, w, numargs, infix, NULL);
+    }
+    return retval;
+}
+
+static char *lookupword(csword &word)           // see lookup
+{
+    ident *id = word.id ? word.id : (word.id = idents->access(word.str+1));
+    if(id) switch(id->type)
+    {
+        case ID_VAR: { defformatstring(t)("%d", *id->storage.i); return newstring(t); }
+        case ID_FVAR: return newstring(floatstr(*id->storage.f));
+        case ID_SVAR: return newstring(*id->storage.s);
+        case ID_ALIAS: return newstring(id->action);
+    }
+    conoutf(CON_ERROR, "unknown alias lookup: %s", word.str+1);
+    return newstring(word.str);
+}
+
+static char *runcode(cscode &code)
+{
+    char *w[MAXWORDS];
+    char *retval = NULL;
+    loopv(code.statements)
+    {
+        csstatement &st = code.statements[i];
+        csword *lits = &code.words[st.firstword];
+        int numargs = st.numargs;
+        loopj(MAXWORDS) w[j] = (char *)"";
+        loopj(numargs)                          // evaluate in order, as parsing would
+        {
+            csword &word = lits[j];
+            switch(word.type)
+            {
+                case CSW_LITERAL: w[j] = word.str; break;
+                case CSW_LOOKUP: w[j] = lookupword(word); break;
+                case CSW_EXP: { char *ret = executecode(word.code); w[j] = ret ? ret : newstring(""); break; }
+                case CSW_MACRO: { const char *p = word.str; char *ret = parseexp(p, ']'); w[j] = ret ? ret : newstring(""); break; }
             }
         }
-        loopj(numargs) if(w[j]) delete[] w[j];
+        char *c = w[0];
+        if(!*c)                                 // empty statement
+        {
+            loopj(numargs) if(!ISLITERAL(j)) delete[] w[j];
+            continue;
+        }
+
+        DELETEA(retval);
+        ident *id = NULL;
+        if(!st.infix)
+        {
+            if(ISLITERAL(0)) id = lits[0].id ? lits[0].id : (lits[0].id = idents->access(c));
+            else id = idents->access(c);
+        }
+        retval = callstatement(id, c, w, numargs, st.infix, lits);
     }
     return retval;
 }
 
+static char *executecode(cscode *code)
+{
+    code->refs++;                               // in case it is redefined or flushed while running
+    char *ret = code->valid ? runcode(*code) : interpretret(code->source);
+    releasecode(code);
+    return ret;
+}
+
+char *executeret(const char *p)
+{
+    if(cscompile)
+    {
+        cscode *code = getcachedcode(p);
+        if(code) return executecode(code);
+    }
+    return interpretret(p);
+}
+
+#ifndef STANDALONE
+// Compares bytecode to interpreting: runs a file (e.g., a map config - whose commands really run, each time),
+// if given, and then a looping alias, 'iterations' times each way, and reports the times in milliseconds
+
+static int benchcubescript(const char *source, int iterations, bool compiled)
+{
+    int wascompile = cscompile;
+    bool waspersist = persistidents;
+    cscompile = compiled ? 1 : 0;
+    persistidents = false;
+    int start = SDL_GetTicks();
+    cscode *code = compiled ? compilecode(source) : NULL;
+    loopi(iterations)
+    {
+        char *ret = code ? executecode(code) : interpretret(source);
+        DELETEA(ret);
+    }
+    if(code) releasecode(code);
+    int elapsed = SDL_GetTicks() - start;
+    cscompile = wascompile;
+    persistidents = waspersist;
+    return elapsed;
+}
+
+void csbench(char *file, int *iterations)
+{
+    int n = max(*iterations, 1);
+    if(file[0])
+    {
+        string s;
+        copystring(s, file);
+        char *buf = loadfile(path(s), NULL);
+        if(!buf) { conoutf(CON_ERROR, "could not read \"%s\"", file); return; }
+        int interpreted = benchcubescript(buf, n, false), compiled = benchcubescript(buf, n, true);
+        conoutf("%s x%d: %d ms interpreted, %d ms compiled", file, n, interpreted, compiled);
+        delete[] buf;
+    }
+    const char *loop =
+        "alias __csbenchstep [ __csbenchsum = (+ $__csbenchsum (* $arg1 2)); if (> $__csbenchsum 1000000) [ __csbenchsum = 0 ] ]; "
+        "__csbenchsum = 0; loop __csbenchi 1000 [ __csbenchstep $__csbenchi ]";
+    int interpreted = benchcubescript(loop, n, false), compiled = benchcubescript(loop, n, true);
+    conoutf("looping alias x%d: %d ms interpreted, %d ms compiled", n, interpreted, compiled);
+}
+COMMAND(csbench, "si");
+#endif
+
+#undef ISLITERAL
+#undef ARGINT
+#undef ARGFLOAT
+#undef GIVEARG
+
 int execute(const char *p)
 {
     char *ret = executeret(p);
@@ -219,6 +219,11 @@ extern void render3dbox(vec &o, float tofloor, float toceil, float xradius, floa
 // octa
 extern cube *newcubes(uint face = F_EMPTY);
 extern cubeext *newcubeext(cube &c);
+extern void *newoctapayload(int size); // INTENSITY: Pooled arrays for cubeexts
+extern void freeoctapayload(void *p);
+template<class T> static inline T *newoctaarray(int n) { return (T *)newoctapayload(n*sizeof(T)); }
+#define DELETEOCTAARRAY(p) if(p) { freeoctapayload(p); p = NULL; }
+extern void trimoctapools();
 extern void getcubevector(cube &c, int d, int x, int y, int z, ivec &p);
 extern void setcubevector(cube &c, int d, int x, int y, int z, ivec &p);
 extern int familysize(cube &c);
@@ -229,6 +234,8 @@ extern void validatec(cube *c, int size);
 extern bool isvalidcube(cube &c);
 extern cube &lookupcube(int tx, int ty, int tz, int tsize = 0);
 extern cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient);
+extern cube &lookupcube(int tx, int ty, int tz, int tsize, ivec &ro, int &rsize);
+extern cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient, ivec &ro, int &rosize);
 extern void newclipplanes(cube &c);
 extern void freeclipplanes(cube &c);
 extern void forcemip(cube &c);
@@ -476,7 +483,10 @@ extern void mousemove(int dx, int dy);
 extern bool pointincube(const clipplanes &p, const vec &v);
 extern bool overlapsdynent(const vec &o, float radius);
 extern void rotatebb(vec &center, vec &radius, int yaw);
-extern float shadowray(const vec &o, const vec &ray, float radius, int mode, extentity *t = NULL);
+struct ShadowRayCache;
+extern ShadowRayCache *newshadowraycache();
+extern void freeshadowraycache(ShadowRayCache *&cache);
+extern float shadowray(ShadowRayCache *cache, const vec &o, const vec &ray, float radius, int mode, extentity *t = NULL);
 
 // world
 enum
@@ -579,6 +589,12 @@ extern void rendergrass();
 // blendmap
 extern int blendpaintmode;
 
+struct BlendMapCache;
+extern BlendMapCache *newblendmapcache();
+extern void freeblendmapcache(BlendMapCache *&cache);
+extern bool setblendmaporigin(BlendMapCache *cache, const ivec &o, int size);
+extern bool hasblendmap(BlendMapCache *cache);
+extern uchar lookupblendmap(BlendMapCache *cache, const vec &pos);
 extern bool setblendmaporigin(const ivec &o, int size);
 extern bool hasblendmap();
 extern uchar lookupblendmap(const vec &pos);
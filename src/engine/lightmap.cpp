@@ -33,17 +33,64 @@ VARN(lmshadows, lmshadows_, 0, 2, 2);
 VARN(lmaa, lmaa_, 0, 3, 3);
 static int lmshadows = 2, lmaa = 3;
 
-static Slot *lmslot = NULL;
-static int lmtype, lmbpp, lmorient, lmrotate;
-static uchar lm[4*LM_MAXW*LM_MAXH];
-static vec lm_ray[LM_MAXW*LM_MAXH];
-static int lm_w, lm_h;
-static vector<const extentity *> lights1, lights2;
+// The state of lighting a surface. Each thread lighting the map has its own
+struct lightmapworker
+{
+    uchar lm[4*LM_MAXW*LM_MAXH];
+    vec lm_ray[LM_MAXW*LM_MAXH];
+    vec samples[4*(LM_MAXW+1)*(LM_MAXH+1)];
+    uchar blur[4*LM_MAXW*LM_MAXH];
+    uchar mincolor[4], maxcolor[4];
+    int lm_w, lm_h;
+    Slot *slot;
+    int type, bpp, orient, rotate;
+    const vector<const extentity *> *lights1, *lights2;
+    BlendMapCache *blendmapcache;
+    ShadowRayCache *shadowraycache;
+    SDL_Thread *thread;
+
+    lightmapworker()
+     : lm_w(0), lm_h(0), slot(NULL), type(LM_DIFFUSE), bpp(3), orient(0), rotate(0),
+       lights1(NULL), lights2(NULL), blendmapcache(newblendmapcache()), shadowraycache(NULL), thread(NULL)
+    {
+    }
+
+    ~lightmapworker()
+    {
+        freeblendmapcache(blendmapcache);
+        freeshadowraycache(shadowraycache);
+    }
+};
+
+// A lit surface's lightmap, kept until it is packed into the atlases
+struct lightmapinfo
+{
+    int type, bpp, w, h;
+    uchar texcoords[8];
+    vector<uchar> colors;
+    vector<bvec> rays;
+
+    lightmapinfo() : type(LM_DIFFUSE), bpp(3), w(0), h(0) {}
+
+    void save(const lightmapworker &lw, const uchar *tc)
+    {
+        type = lw.type;
+        bpp = lw.bpp;
+        w = lw.lm_w;
+        h = lw.lm_h;
+        memcpy(texcoords, tc, 8);
+        colors.setsizenodelete(0);
+        colors.put(lw.lm, bpp*w*h);
+        rays.setsizenodelete(0);
+        if((type&LM_TYPE) == LM_BUMPMAP0) rays.put((const bvec *)lw.lm_ray, w*h);
+    }
+};
+
 static uint progress = 0;
 static GLuint progresstex = 0;
 static int progresstexticks = 0;
 
-bool calclight_canceled = false;
+volatile bool calclight_canceled = false;
 volatile bool check_calclight_progress = false;
 
 void check_calclight_canceled()
@@ -165,50 +212,52 @@ void insert_unlit(int i)
     }
 }
 
-void insert_lightmap(ushort &x, ushort &y, uchar &lmid)
+void insert_lightmap(lightmapinfo &info, ushort &x, ushort &y, uchar &lmid)
 {
     loopv(lightmaps)
     {
-        if(lightmaps[i].type == lmtype && lightmaps[i].insert(x, y, lm, lm_w, lm_h))
+        if(lightmaps[i].type == info.type && lightmaps[i].insert(x, y, info.colors.getbuf(), info.w, info.h))
         {
             lmid = i + LMID_RESERVED;
-            if((lmtype&LM_TYPE) == LM_BUMPMAP0) ASSERT(lightmaps[i+1].insert(x, y, (uchar *)lm_ray, lm_w, lm_h));
+            if((info.type&LM_TYPE) == LM_BUMPMAP0) ASSERT(lightmaps[i+1].insert(x, y, (uchar *)info.rays.getbuf(), info.w, info.h));
             return;
         }
     }
 
     lmid = lightmaps.length() + LMID_RESERVED;
     LightMap &l = lightmaps.add();
-    l.type = lmtype;
-    l.bpp = lmbpp;
-    l.data = new uchar[lmbpp*LM_PACKW*LM_PACKH];
-    memset(l.data, 0, lmbpp*LM_PACKW*LM_PACKH);
-    ASSERT(l.insert(x, y, lm, lm_w, lm_h));
-    if((lmtype&LM_TYPE) == LM_BUMPMAP0)
+    l.type = info.type;
+    l.bpp = info.bpp;
+    l.data = new uchar[info.bpp*LM_PACKW*LM_PACKH];
+    memset(l.data, 0, info.bpp*LM_PACKW*LM_PACKH);
+    ASSERT(l.insert(x, y, info.colors.getbuf(), info.w, info.h));
+    if((info.type&LM_TYPE) == LM_BUMPMAP0)
     {
         LightMap &r = lightmaps.add();
-        r.type = LM_BUMPMAP1 | (lmtype&~LM_TYPE);
+        r.type = LM_BUMPMAP1 | (info.type&~LM_TYPE);
         r.bpp = 3;
         r.data = new uchar[3*LM_PACKW*LM_PACKH];
         memset(r.data, 0, 3*LM_PACKW*LM_PACKH);
-        ASSERT(r.insert(x, y, (uchar *)lm_ray, lm_w, lm_h));
+        ASSERT(r.insert(x, y, (uchar *)info.rays.getbuf(), info.w, info.h));
     }
 }
 
-void copy_lightmap(surfaceinfo &surface)
+void copy_lightmap(lightmapinfo &info, surfaceinfo &surface)
 {
-    lightmaps[surface.lmid-LMID_RESERVED].copy(surface.x, surface.y, lm, lm_w, lm_h);
-    if((lmtype&LM_TYPE)==LM_BUMPMAP0 && lightmaps.inrange(surface.lmid+1-LMID_RESERVED))
-        lightmaps[surface.lmid+1-LMID_RESERVED].copy(surface.x, surface.y, (uchar *)lm_ray, lm_w, lm_h);
+    lightmaps[surface.lmid-LMID_RESERVED].copy(surface.x, surface.y, info.colors.getbuf(), info.w, info.h);
+    if((info.type&LM_TYPE)==LM_BUMPMAP0 && lightmaps.inrange(surface.lmid+1-LMID_RESERVED))
+        lightmaps[surface.lmid+1-LMID_RESERVED].copy(surface.x, surface.y, (uchar *)info.rays.getbuf(), info.w, info.h);
 }
 
 struct compresskey 
 { 
     ushort x, y, lmid;
     uchar w, h;
+    const lightmapinfo *info; // the lightmap being looked up; only read from the key passed to the hashtable
 
     compresskey() {}
-    compresskey(const surfaceinfo &s) : x(s.x), y(s.y), lmid(s.lmid), w(s.w), h(s.h) {}
+    compresskey(const lightmapinfo &info) : info(&info) {}
+    compresskey(const surfaceinfo &s, const lightmapinfo &info) : x(s.x), y(s.y), lmid(s.lmid), w(s.w), h(s.h), info(&info) {}
 };
 
 struct compressval 
@@ -221,22 +270,23 @@ struct compressval
 
 static inline bool htcmp(const compresskey &x, const compresskey &y)
 {
-    if(lm_w != y.w || lm_h != y.h) return false;
+    const lightmapinfo &info = *x.info;
+    if(info.w != y.w || info.h != y.h) return false;
     LightMap &ylm = lightmaps[y.lmid - LMID_RESERVED];
-    if(lmtype != ylm.type) return false;
-    const uchar *xcolor = lm, *ycolor = ylm.data + lmbpp*(y.x + y.y*LM_PACKW);
-    loopi(lm_h)
+    if(info.type != ylm.type) return false;
+    const uchar *xcolor = info.colors.getbuf(), *ycolor = ylm.data + info.bpp*(y.x + y.y*LM_PACKW);
+    loopi(info.h)
     {
-        if(memcmp(xcolor, ycolor, lmbpp*lm_w)) return false;
-        xcolor += lmbpp*lm_w;
-        ycolor += lmbpp*LM_PACKW;
+        if(memcmp(xcolor, ycolor, info.bpp*info.w)) return false;
+        xcolor += info.bpp*info.w;
+        ycolor += info.bpp*LM_PACKW;
     }
-    if((lmtype&LM_TYPE) != LM_BUMPMAP0) return true;
-    const bvec *xdir = (bvec *)lm_ray, *ydir = (bvec *)lightmaps[y.lmid+1 - LMID_RESERVED].data;
-    loopi(lm_h)
+    if((info.type&LM_TYPE) != LM_BUMPMAP0) return true;
+    const bvec *xdir = info.rays.getbuf(), *ydir = (bvec *)lightmaps[y.lmid+1 - LMID_RESERVED].data;
+    loopi(info.h)
     {
-        if(memcmp(xdir, ydir, lm_w*sizeof(bvec))) return false;
-        xdir += lm_w;
+        if(memcmp(xdir, ydir, info.w*sizeof(bvec))) return false;
+        xdir += info.w;
         ydir += LM_PACKW;
     }
     return true;
@@ -244,12 +294,13 @@ static inline bool htcmp(const compresskey &x, const compresskey &y)
     
 static inline uint hthash(const compresskey &k)
 {
-    uint hash = lm_w + (lm_h<<8);
-    const uchar *color = lm;
-    loopi(lm_w*lm_h)
+    const lightmapinfo &info = *k.info;
+    uint hash = info.w + (info.h<<8);
+    const uchar *color = info.colors.getbuf();
+    loopi(info.w*info.h)
     {
        hash ^= (color[0] + (color[1] << 8) + (color[2] << 16));
-       color += lmbpp;
+       color += info.bpp;
     }
     return hash;  
 }
@@ -258,15 +309,15 @@ static hashtable<compresskey, compressval> compressed;
 
 VAR(lightcompress, 0, 3, 6);
 
-bool pack_lightmap(surfaceinfo &surface) 
+bool pack_lightmap(lightmapinfo &info, surfaceinfo &surface) 
 {
-    if((int)lm_w <= lightcompress && (int)lm_h <= lightcompress)
+    if(info.w <= lightcompress && info.h <= lightcompress)
     {
-        compressval *val = compressed.access(compresskey());
+        compressval *val = compressed.access(compresskey(info));
         if(!val)
         {
-            insert_lightmap(surface.x, surface.y, surface.lmid);
-            compressed[surface] = surface;
+            insert_lightmap(info, surface.x, surface.y, surface.lmid);
+            compressed[compresskey(surface, info)] = surface;
         }
         else
         {
@@ -276,7 +327,7 @@ bool pack_lightmap(surfaceinfo &surface)
             return false;
         }
     }
-    else insert_lightmap(surface.x, surface.y, surface.lmid);
+    else insert_lightmap(info, surface.x, surface.y, surface.lmid);
     return true;
 }
 
@@ -329,7 +380,7 @@ void update_lightmap(const surfaceinfo &surface)
 }
  
         
-void generate_lumel(const float tolerance, const vector<const extentity *> &lights, const vec &target, const vec &normal, vec &sample, int x, int y)
+void generate_lumel(lightmapworker *w, const float tolerance, const vector<const extentity *> &lights, const vec &target, const vec &normal, vec &sample, int x, int y)
 {
     vec avgray(0, 0, 0);
     float r = 0, g = 0, b = 0;
@@ -359,11 +410,11 @@ void generate_lumel(const float tolerance, const vector<const extentity *> &ligh
         }
         if(lmshadows && mag)
         {
-            float dist = shadowray(light.o, ray, mag - tolerance, RAY_SHADOW | (lmshadows > 1 ? RAY_ALPHAPOLY : 0));
+            float dist = shadowray(w->shadowraycache, light.o, ray, mag - tolerance, RAY_SHADOW | (lmshadows > 1 ? RAY_ALPHAPOLY : 0));
             if(dist < mag - tolerance) continue;
         }
         float intensity;
-        switch(lmtype&LM_TYPE)
+        switch(w->type&LM_TYPE)
         {
             case LM_BUMPMAP0: 
                 intensity = attenuation; 
@@ -377,18 +428,18 @@ void generate_lumel(const float tolerance, const vector<const extentity *> &ligh
         g += intensity * float(light.attr3);
         b += intensity * float(light.attr4);
     }
-    switch(lmtype&LM_TYPE)
+    switch(w->type&LM_TYPE)
     {
         case LM_BUMPMAP0:
             if(avgray.iszero()) break;
             // transform to tangent space
             extern float orientation_tangent[6][3][4];
             extern float orientation_binormal[6][3][4];            
-            vec S(orientation_tangent[lmrotate][dimension(lmorient)]),
-                T(orientation_binormal[lmrotate][dimension(lmorient)]);
+            vec S(orientation_tangent[w->rotate][dimension(w->orient)]),
+                T(orientation_binormal[w->rotate][dimension(w->orient)]);
             normal.orthonormalize(S, T);
             avgray.normalize();
-            lm_ray[y*lm_w+x].add(vec(S.dot(avgray), T.dot(avgray), normal.dot(avgray)));
+            w->lm_ray[y*w->lm_w+x].add(vec(S.dot(avgray), T.dot(avgray), normal.dot(avgray)));
             break;
     }
     sample.x = min(255.0f, max(r, float(ambientcolor[0])));
@@ -411,37 +462,39 @@ bool lumel_sample(const vec &sample, int aasample, int stride)
     return false;
 }
 
-void calcskylight(const vec &o, const vec &normal, float tolerance, uchar *skylight, int flags = RAY_ALPHAPOLY, extentity *t = NULL)
+// At file scope, so that its initialization does not race between threads
+static const vec skylightrays[17] =
 {
-    static const vec rays[17] =
-    {
-        vec(cosf(21*RAD)*cosf(50*RAD), sinf(21*RAD)*cosf(50*RAD), sinf(50*RAD)),
-        vec(cosf(111*RAD)*cosf(50*RAD), sinf(111*RAD)*cosf(50*RAD), sinf(50*RAD)),
-        vec(cosf(201*RAD)*cosf(50*RAD), sinf(201*RAD)*cosf(50*RAD), sinf(50*RAD)),
-        vec(cosf(291*RAD)*cosf(50*RAD), sinf(291*RAD)*cosf(50*RAD), sinf(50*RAD)),
-
-        vec(cosf(66*RAD)*cosf(70*RAD), sinf(66*RAD)*cosf(70*RAD), sinf(70*RAD)),
-        vec(cosf(156*RAD)*cosf(70*RAD), sinf(156*RAD)*cosf(70*RAD), sinf(70*RAD)),
-        vec(cosf(246*RAD)*cosf(70*RAD), sinf(246*RAD)*cosf(70*RAD), sinf(70*RAD)),
-        vec(cosf(336*RAD)*cosf(70*RAD), sinf(336*RAD)*cosf(70*RAD), sinf(70*RAD)),
-       
-        vec(0, 0, 1),
+    vec(cosf(21*RAD)*cosf(50*RAD), sinf(21*RAD)*cosf(50*RAD), sinf(50*RAD)),
+    vec(cosf(111*RAD)*cosf(50*RAD), sinf(111*RAD)*cosf(50*RAD), sinf(50*RAD)),
+    vec(cosf(201*RAD)*cosf(50*RAD), sinf(201*RAD)*cosf(50*RAD), sinf(50*RAD)),
+    vec(cosf(291*RAD)*cosf(50*RAD), sinf(291*RAD)*cosf(50*RAD), sinf(50*RAD)),
+
+    vec(cosf(66*RAD)*cosf(70*RAD), sinf(66*RAD)*cosf(70*RAD), sinf(70*RAD)),
+    vec(cosf(156*RAD)*cosf(70*RAD), sinf(156*RAD)*cosf(70*RAD), sinf(70*RAD)),
+    vec(cosf(246*RAD)*cosf(70*RAD), sinf(246*RAD)*cosf(70*RAD), sinf(70*RAD)),
+    vec(cosf(336*RAD)*cosf(70*RAD), sinf(336*RAD)*cosf(70*RAD), sinf(70*RAD)),
+   
+    vec(0, 0, 1),
+
+    vec(cosf(43*RAD)*cosf(60*RAD), sinf(43*RAD)*cosf(60*RAD), sinf(60*RAD)),
+    vec(cosf(133*RAD)*cosf(60*RAD), sinf(133*RAD)*cosf(60*RAD), sinf(60*RAD)),
+    vec(cosf(223*RAD)*cosf(60*RAD), sinf(223*RAD)*cosf(60*RAD), sinf(60*RAD)),
+    vec(cosf(313*RAD)*cosf(60*RAD), sinf(313*RAD)*cosf(60*RAD), sinf(60*RAD)),
+
+    vec(cosf(88*RAD)*cosf(80*RAD), sinf(88*RAD)*cosf(80*RAD), sinf(80*RAD)),
+    vec(cosf(178*RAD)*cosf(80*RAD), sinf(178*RAD)*cosf(80*RAD), sinf(80*RAD)),
+    vec(cosf(268*RAD)*cosf(80*RAD), sinf(268*RAD)*cosf(80*RAD), sinf(80*RAD)),
+    vec(cosf(358*RAD)*cosf(80*RAD), sinf(358*RAD)*cosf(80*RAD), sinf(80*RAD)),
 
-        vec(cosf(43*RAD)*cosf(60*RAD), sinf(43*RAD)*cosf(60*RAD), sinf(60*RAD)),
-        vec(cosf(133*RAD)*cosf(60*RAD), sinf(133*RAD)*cosf(60*RAD), sinf(60*RAD)),
-        vec(cosf(223*RAD)*cosf(60*RAD), sinf(223*RAD)*cosf(60*RAD), sinf(60*RAD)),
-        vec(cosf(313*RAD)*cosf(60*RAD), sinf(313*RAD)*cosf(60*RAD), sinf(60*RAD)),
-
-        vec(cosf(88*RAD)*cosf(80*RAD), sinf(88*RAD)*cosf(80*RAD), sinf(80*RAD)),
-        vec(cosf(178*RAD)*cosf(80*RAD), sinf(178*RAD)*cosf(80*RAD), sinf(80*RAD)),
-        vec(cosf(268*RAD)*cosf(80*RAD), sinf(268*RAD)*cosf(80*RAD), sinf(80*RAD)),
-        vec(cosf(358*RAD)*cosf(80*RAD), sinf(358*RAD)*cosf(80*RAD), sinf(80*RAD)),
+};
 
-    };
+void calcskylight(ShadowRayCache *cache, const vec &o, const vec &normal, float tolerance, uchar *skylight, int flags = RAY_ALPHAPOLY, extentity *t = NULL)
+{
     int hit = 0;
-    loopi(17) if(normal.dot(rays[i])>=0)
+    loopi(17) if(normal.dot(skylightrays[i])>=0)
     {
-        if(shadowray(vec(rays[i]).mul(tolerance).add(o), rays[i], 1e16f, RAY_SHADOW | flags, t)>1e15f) hit++;
+        if(shadowray(cache, vec(skylightrays[i]).mul(tolerance).add(o), skylightrays[i], 1e16f, RAY_SHADOW | flags, t)>1e15f) hit++;
     }
 
     loopk(3) skylight[k] = uchar(ambientcolor[k] + (max(skylightcolor[k], ambientcolor[k]) - ambientcolor[k])*hit/17.0f);
@@ -455,9 +508,8 @@ static inline bool hasskylight()
 VARR(blurlms, 0, 0, 2);
 VARR(blurskylight, 0, 0, 2);
 
-void blurlightmap(int n)
+void blurlightmap(lightmapworker *w, int n)
 {
-    static uchar blur[4*LM_MAXW*LM_MAXH];
     static const int matrix3x3[9] =
     {
         1, 2, 1,
@@ -474,9 +526,9 @@ void blurlightmap(int n)
         1, 1, 2, 1, 1
     };
     static const int matrix5x5sum = 52;
-    uchar *src = lm, *dst = blur;
-    int stride = lmbpp*lm_w;
-    loop(y, lm_h) loop(x, lm_w) 
+    uchar *src = w->lm, *dst = w->blur;
+    int stride = w->bpp*w->lm_w;
+    loop(y, w->lm_h) loop(x, w->lm_w) 
     {
         loopk(3)
         {
@@ -484,35 +536,35 @@ void blurlightmap(int n)
             const int *m = n>1 ? matrix5x5 : matrix3x3;
             for(int t = -n; t<=n; t++) for(int s = -n; s<=n; s++, m++)
             {
-                val += *m * (x+s>=0 && x+s<lm_w && y+t>=0 && y+t<lm_h ? src[t*stride+lmbpp*s] : c);
+                val += *m * (x+s>=0 && x+s<w->lm_w && y+t>=0 && y+t<w->lm_h ? src[t*stride+w->bpp*s] : c);
             }
             *dst++ = val/(n>1 ? matrix5x5sum : matrix3x3sum);
             src++;
         }
-        if(lmtype&LM_ALPHA) *dst++ = *src++;
+        if(w->type&LM_ALPHA) *dst++ = *src++;
     }
-    memcpy(lm, blur, lmbpp*lm_w*lm_h);
+    memcpy(w->lm, w->blur, w->bpp*w->lm_w*w->lm_h);
 }
 
-static inline void generate_alpha(float tolerance, const vec &pos, uchar &alpha)
+static inline void generate_alpha(lightmapworker *w, float tolerance, const vec &pos, uchar &alpha)
 {
-    alpha = lookupblendmap(pos);
-    if(lmslot->layermask)
+    alpha = lookupblendmap(w->blendmapcache, pos);
+    if(w->slot->layermask)
     {
         static const int sdim[] = { 1, 0, 0 }, tdim[] = { 2, 2, 1 };
-        int dim = dimension(lmorient);
-        float k = 8.0f/lmslot->scale,
-              s = (pos[sdim[dim]] * k - lmslot->xoffset) / lmslot->layermaskscale,
-              t = (pos[tdim[dim]] * (dim <= 1 ? -k : k) - lmslot->yoffset) / lmslot->layermaskscale;
-        if((lmrotate&5)==1) swap(s, t);
-        if(lmrotate>=2 && lmrotate<=4) s = -s;
-        if((lmrotate>=1 && lmrotate<=2) || lmrotate==5) t = -t;
-        const ImageData &mask = *lmslot->layermask;
+        int dim = dimension(w->orient);
+        float k = 8.0f/w->slot->scale,
+              s = (pos[sdim[dim]] * k - w->slot->xoffset) / w->slot->layermaskscale,
+              t = (pos[tdim[dim]] * (dim <= 1 ? -k : k) - w->slot->yoffset) / w->slot->layermaskscale;
+        if((w->rotate&5)==1) swap(s, t);
+        if(w->rotate>=2 && w->rotate<=4) s = -s;
+        if((w->rotate>=1 && w->rotate<=2) || w->rotate==5) t = -t;
+        const ImageData &mask = *w->slot->layermask;
         int mx = int(floor(s))%mask.w, my = int(floor(t))%mask.h;
         if(mx < 0) mx += mask.w;
         if(my < 0) my += mask.h;
         uchar maskval = mask.data[mask.bpp*(mx + 1) - 1 + mask.pitch*my];
-        switch(lmslot->layermaskmode)
+        switch(w->slot->layermaskmode)
         {
             case 2: alpha = min(alpha, maskval); break;
             case 3: alpha = max(alpha, maskval); break;
@@ -539,10 +591,18 @@ enum
 #define SURFACE_AMBIENT SURFACE_AMBIENT_BOTTOM
 #define SURFACE_LIGHTMAP SURFACE_LIGHTMAP_BOTTOM
 
-int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpvert *lv, int numv, const vec &ustep, const vec &vstep)
+// Worker threads only check whether to stop. The main thread shows the progress while it waits for them
+#define CHECK_WORKER_PROGRESS(exit) \
+    if(w->thread) \
+    { \
+        if(calclight_canceled) exit; \
+    } \
+    else CHECK_PROGRESS(exit)
+
+int generate_lightmap(lightmapworker *w, float lpu, int y1, int y2, const vec &origin, const lerpvert *lv, int numv, const vec &ustep, const vec &vstep)
 {
-    static uchar mincolor[4], maxcolor[4];
-    static float aacoords[8][2] =
+    uchar *mincolor = w->mincolor, *maxcolor = w->maxcolor;
+    static const float aacoords[8][2] =
     {
         {0.0f, 0.0f},
         {-0.5f, -0.5f},
@@ -555,24 +615,23 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
         {-0.6f, -0.3f},
     };
     float tolerance = 0.5 / lpu;
-    vector<const extentity *> &lights = (y1 == 0 ? lights1 : lights2);
+    const vector<const extentity *> &lights = *(y1 == 0 ? w->lights1 : w->lights2);
     vec v = origin;
     vec offsets[8];
     loopi(8) loopj(3) offsets[i][j] = aacoords[i][0]*ustep[j] + aacoords[i][1]*vstep[j];
 
     if(y1 == 0)
     {
-        memset(mincolor, 255, sizeof(mincolor));
-        memset(maxcolor, 0, sizeof(maxcolor));
-        if((lmtype&LM_TYPE) == LM_BUMPMAP0) memset(lm_ray, 0, sizeof(lm_ray));
+        memset(mincolor, 255, sizeof(w->mincolor));
+        memset(maxcolor, 0, sizeof(w->maxcolor));
+        if((w->type&LM_TYPE) == LM_BUMPMAP0) memset(w->lm_ray, 0, sizeof(w->lm_ray));
     }
 
-    static vec samples[4*(LM_MAXW+1)*(LM_MAXH+1)];
-
+    vec *samples = w->samples;
     int aasample = min(1 << lmaa, 4);
-    int stride = aasample*(lm_w+1);
+    int stride = aasample*(w->lm_w+1);
     vec *sample = &samples[stride*y1];
-    uchar *skylight = &lm[lmbpp*lm_w*y1];
+    uchar *skylight = &w->lm[w->bpp*w->lm_w*y1];
     lerpbounds start, end;
     initlerpbounds(lv, numv, start, end);
     for(int y = y1; y < y2; ++y, v.add(vstep)) 
@@ -581,18 +640,18 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
         lerpnormal(y, lv, numv, start, end, normal, nstep);
         
         vec u(v);
-        for(int x = 0; x < lm_w; ++x, u.add(ustep), normal.add(nstep), skylight += lmbpp) 
+        for(int x = 0; x < w->lm_w; ++x, u.add(ustep), normal.add(nstep), skylight += w->bpp) 
         {
-            CHECK_PROGRESS(return NO_SURFACE);
-            generate_lumel(tolerance, lights, u, vec(normal).normalize(), *sample, x, y);
+            CHECK_WORKER_PROGRESS(return NO_SURFACE);
+            generate_lumel(w, tolerance, lights, u, vec(normal).normalize(), *sample, x, y);
             if(hasskylight())
             {
-                if((lmtype&LM_TYPE)==LM_BUMPMAP0 || !adaptivesample || sample->x<skylightcolor[0] || sample->y<skylightcolor[1] || sample->z<skylightcolor[2])
-                    calcskylight(u, normal, tolerance, skylight, lmshadows > 1 ? RAY_ALPHAPOLY : 0);
+                if((w->type&LM_TYPE)==LM_BUMPMAP0 || !adaptivesample || sample->x<skylightcolor[0] || sample->y<skylightcolor[1] || sample->z<skylightcolor[2])
+                    calcskylight(w->shadowraycache, u, normal, tolerance, skylight, lmshadows > 1 ? RAY_ALPHAPOLY : 0);
                 else loopk(3) skylight[k] = max(skylightcolor[k], ambientcolor[k]);
             }
             else loopk(3) skylight[k] = ambientcolor[k];
-            if(lmtype&LM_ALPHA) generate_alpha(tolerance, u, skylight[3]);
+            if(w->type&LM_ALPHA) generate_alpha(w, tolerance, u, skylight[3]);
             sample += aasample;
         }
         sample += aasample;
@@ -606,29 +665,29 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
         lerpnormal(y, lv, numv, start, end, normal, nstep);
 
         vec u(v);
-        for(int x = 0; x < lm_w; ++x, u.add(ustep), normal.add(nstep)) 
+        for(int x = 0; x < w->lm_w; ++x, u.add(ustep), normal.add(nstep)) 
         {
             vec &center = *sample++;
-            if(adaptivesample && x > 0 && x+1 < lm_w && y > y1 && y+1 < y2 && !lumel_sample(center, aasample, stride))
+            if(adaptivesample && x > 0 && x+1 < w->lm_w && y > y1 && y+1 < y2 && !lumel_sample(center, aasample, stride))
                 loopi(aasample-1) *sample++ = center;
             else
             {
 #define EDGE_TOLERANCE(i) \
     ((!x && aacoords[i][0] < 0) \
-     || (x+1==lm_w && aacoords[i][0] > 0) \
+     || (x+1==w->lm_w && aacoords[i][0] > 0) \
      || (!y && aacoords[i][1] < 0) \
-     || (y+1==lm_h && aacoords[i][1] > 0) \
+     || (y+1==w->lm_h && aacoords[i][1] > 0) \
      ? edgetolerance : 1)
                 vec n(normal);
                 n.normalize();
                 loopi(aasample-1)
-                    generate_lumel(EDGE_TOLERANCE(i+1) * tolerance, lights, vec(u).add(offsets[i+1]), n, *sample++, x, y);
+                    generate_lumel(w, EDGE_TOLERANCE(i+1) * tolerance, lights, vec(u).add(offsets[i+1]), n, *sample++, x, y);
                 if(lmaa == 3) 
                 {
                     loopi(4)
                     {
                         vec s;
-                        generate_lumel(EDGE_TOLERANCE(i+4) * tolerance, lights, vec(u).add(offsets[i+4]), n, s, x, y);
+                        generate_lumel(w, EDGE_TOLERANCE(i+4) * tolerance, lights, vec(u).add(offsets[i+4]), n, s, x, y);
                         center.add(s);
                     }
                     center.div(5);
@@ -638,45 +697,45 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
         if(aasample > 1)
         {
             normal.normalize();
-            generate_lumel(tolerance, lights, vec(u).add(offsets[1]), normal, sample[1], lm_w-1, y);
+            generate_lumel(w, tolerance, lights, vec(u).add(offsets[1]), normal, sample[1], w->lm_w-1, y);
             if(aasample > 2)
-                generate_lumel(edgetolerance * tolerance, lights, vec(u).add(offsets[3]), normal, sample[3], lm_w-1, y);
+                generate_lumel(w, edgetolerance * tolerance, lights, vec(u).add(offsets[3]), normal, sample[3], w->lm_w-1, y);
         }
         sample += aasample;
     }
 
-    if(y2 == lm_h)
+    if(y2 == w->lm_h)
     {
         if(aasample > 1)
         {
             vec normal, nstep;
-            lerpnormal(lm_h, lv, numv, start, end, normal, nstep);
+            lerpnormal(w->lm_h, lv, numv, start, end, normal, nstep);
 
-            for(int x = 0; x <= lm_w; ++x, v.add(ustep), normal.add(nstep))
+            for(int x = 0; x <= w->lm_w; ++x, v.add(ustep), normal.add(nstep))
             {
-                CHECK_PROGRESS(return NO_SURFACE);
+                CHECK_WORKER_PROGRESS(return NO_SURFACE);
                 vec n(normal);
                 n.normalize();
-                generate_lumel(edgetolerance * tolerance, lights, vec(v).add(offsets[1]), n, sample[1], min(x, lm_w-1), lm_h-1);
+                generate_lumel(w, edgetolerance * tolerance, lights, vec(v).add(offsets[1]), n, sample[1], min(x, w->lm_w-1), w->lm_h-1);
                 if(aasample > 2)
-                    generate_lumel(edgetolerance * tolerance, lights, vec(v).add(offsets[2]), n, sample[2], min(x, lm_w-1), lm_h-1);
+                    generate_lumel(w, edgetolerance * tolerance, lights, vec(v).add(offsets[2]), n, sample[2], min(x, w->lm_w-1), w->lm_h-1);
                 sample += aasample;
             } 
         }
 
         if(hasskylight())
         {
-            if(blurskylight && (lm_w>1 || lm_h>1)) blurlightmap(blurskylight);
+            if(blurskylight && (w->lm_w>1 || w->lm_h>1)) blurlightmap(w, blurskylight);
         }
         sample = samples;
         float weight = 1.0f / (1.0f + 4.0f*lmaa),
               cweight = weight * (lmaa == 3 ? 5.0f : 1.0f);
-        uchar *lumel = lm;
-        vec *ray = lm_ray;
+        uchar *lumel = w->lm;
+        vec *ray = w->lm_ray;
         bvec minray(255, 255, 255), maxray(0, 0, 0);
-        loop(y, lm_h)
+        loop(y, w->lm_h)
         {
-            loop(x, lm_w)
+            loop(x, w->lm_w)
             {
                 vec l(0, 0, 0);
                 const vec &center = *sample++;
@@ -706,14 +765,14 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
                     mincolor[k] = min(mincolor[k], lumel[k]);
                     maxcolor[k] = max(maxcolor[k], lumel[k]);
                 }
-                if(lmtype&LM_ALPHA)
+                if(w->type&LM_ALPHA)
                 {
                     mincolor[3] = min(mincolor[3], lumel[3]);
                     maxcolor[3] = max(maxcolor[3], lumel[3]);
                 }
-                if((lmtype&LM_TYPE) == LM_BUMPMAP0)
+                if((w->type&LM_TYPE) == LM_BUMPMAP0)
                 {
-                    bvec &n = ((bvec *)lm_ray)[ray-lm_ray];
+                    bvec &n = ((bvec *)w->lm_ray)[ray-w->lm_ray];
                     if(ray->iszero()) n = bvec(128, 128, 255);
                     else
                     {
@@ -732,7 +791,7 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
                     }
                     ray++;
                 }
-                lumel += lmbpp;
+                lumel += w->bpp;
             }
             sample += aasample;
         }
@@ -748,53 +807,53 @@ int generate_lightmap(float lpu, int y1, int y2, const vec &origin, const lerpve
                color[2] <= int(ambientcolor[2]) + lighterror &&
                (maxcolor[3]==0 || mincolor[3]==255))
                 return mincolor[3]==255 ? SURFACE_AMBIENT_TOP : SURFACE_AMBIENT_BOTTOM;
-            if((lmtype&LM_TYPE) != LM_BUMPMAP0 || 
+            if((w->type&LM_TYPE) != LM_BUMPMAP0 || 
                 (int(maxray.x) - int(minray.x) <= bumperror &&
                  int(maxray.y) - int(minray.z) <= bumperror &&
                  int(maxray.z) - int(minray.z) <= bumperror))
 
             {
-                memcpy(lm, color, 3);
-                if(lmtype&LM_ALPHA) lm[3] = mincolor[3];
-                if((lmtype&LM_TYPE) == LM_BUMPMAP0) 
+                memcpy(w->lm, color, 3);
+                if(w->type&LM_ALPHA) w->lm[3] = mincolor[3];
+                if((w->type&LM_TYPE) == LM_BUMPMAP0) 
                 {
-                    loopk(3) ((bvec *)lm_ray)[0][k] = uchar((int(maxray[k])+int(minray[k]))/2);
+                    loopk(3) ((bvec *)w->lm_ray)[0][k] = uchar((int(maxray[k])+int(minray[k]))/2);
                 }
-                lm_w = 1;
-                lm_h = 1;
+                w->lm_w = 1;
+                w->lm_h = 1;
             }
         }
-        if(blurlms && (lm_w>1 || lm_h>1)) blurlightmap(blurlms);
+        if(blurlms && (w->lm_w>1 || w->lm_h>1)) blurlightmap(w, blurlms);
     }
     if(mincolor[3]==255) return SURFACE_LIGHTMAP_TOP;
     else if(maxcolor[3]==0) return SURFACE_LIGHTMAP_BOTTOM;
     else return SURFACE_LIGHTMAP_BLEND;
 }
 
-int preview_lightmap_alpha(float lpu, int y1, int y2, const vec &origin, const vec &ustep, const vec &vstep)
+int preview_lightmap_alpha(lightmapworker *w, float lpu, int y1, int y2, const vec &origin, const vec &ustep, const vec &vstep)
 {
     extern int fullbrightlevel;
     float tolerance = 0.5 / lpu;
-    uchar *dst = &lm[4*lm_w*y1];
+    uchar *dst = &w->lm[4*w->lm_w*y1];
     vec v = origin;
     uchar minalpha = 255, maxalpha = 0;
     for(int y = y1; y < y2; ++y, v.add(vstep))
     {
         vec u(v);
-        for(int x = 0; x < lm_w; ++x, u.add(ustep), dst += 4)
+        for(int x = 0; x < w->lm_w; ++x, u.add(ustep), dst += 4)
         {
             loopk(3) dst[k] = fullbrightlevel;        
-            generate_alpha(tolerance, u, dst[3]);
+            generate_alpha(w, tolerance, u, dst[3]);
             minalpha = min(minalpha, dst[3]);
             maxalpha = max(maxalpha, dst[3]);
         }
     }
-    if(y2 == lm_h)
+    if(y2 == w->lm_h)
     {
         if(minalpha==255) return SURFACE_AMBIENT_TOP;
         if(maxalpha==0) return SURFACE_AMBIENT_BOTTOM;
-        if(minalpha==maxalpha) lm_w = lm_h = 1;    
-        loopi(lm_w*lm_h) ((bvec *)lm_ray)[i] = bvec(128, 128, 255);
+        if(minalpha==maxalpha) w->lm_w = w->lm_h = 1;    
+        loopi(w->lm_w*w->lm_h) ((bvec *)w->lm_ray)[i] = bvec(128, 128, 255);
     }
     return SURFACE_LIGHTMAP_BLEND;
 }        
@@ -885,7 +944,7 @@ const vector<int> &checklightcache(int x, int y)
     return lce.lights;
 }
 
-static inline void addlight(const extentity &light, int cx, int cy, int cz, int size, const vec *v, const vec *n, const vec *n2)
+static inline void addlight(vector<const extentity *> &lights1, vector<const extentity *> &lights2, const extentity &light, int cx, int cy, int cz, int size, const vec *v, const vec *n, const vec *n2)
 {
     int radius = light.attr1;
     if(radius > 0)
@@ -941,7 +1000,7 @@ static inline void addlight(const extentity &light, int cx, int cy, int cz, int
     if(plane2) lights2.add(&light);
 } 
 
-bool find_lights(int cx, int cy, int cz, int size, const vec *v, const vec *n, const vec *n2, const Slot &slot)
+bool find_lights(vector<const extentity *> &lights1, vector<const extentity *> &lights2, int cx, int cy, int cz, int size, const vec *v, const vec *n, const vec *n2, const Slot &slot)
 {
     lights1.setsize(0);
     lights2.setsize(0);
@@ -954,7 +1013,7 @@ bool find_lights(int cx, int cy, int cz, int size, const vec *v, const vec *n, c
             const extentity &light = *ents[lights[i]];
             switch(light.type)
             {
-                case ET_LIGHT: addlight(light, cx, cy, cz, size, v, n, n2); break;
+                case ET_LIGHT: addlight(lights1, lights2, light, cx, cy, cz, size, v, n, n2); break;
             }
         }
     }
@@ -963,14 +1022,14 @@ bool find_lights(int cx, int cy, int cz, int size, const vec *v, const vec *n, c
         const extentity &light = *ents[i];
         switch(light.type)
         {
-            case ET_LIGHT: addlight(light, cx, cy, cz, size, v, n, n2); break;
+            case ET_LIGHT: addlight(lights1, lights2, light, cx, cy, cz, size, v, n, n2); break;
         }
     }
     if(slot.layer && (setblendmaporigin(ivec(cx, cy, cz), size) || slot.layermask)) return true;
     return lights1.length() || lights2.length() || hasskylight();
 }
 
-int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uchar texcoords[8], bool preview = false)
+int setup_surface(lightmapworker *w, plane planes[2], const vec *p, const vec *n, const vec *n2, uchar texcoords[8], bool preview = false)
 {
     vec u, v, s, t;
     float umin(0.0f), umax(0.0f),
@@ -1026,8 +1085,8 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
         tl = (uint)ceil((tmax + 1) * lpu);
         tl = max(LM_MINW, tl);
     }
-    lm_w = max(LM_MINW, min(LM_MAXW, ul));
-    lm_h = min(LM_MAXH, vl + tl);
+    w->lm_w = max(LM_MINW, min(LM_MAXW, ul));
+    w->lm_h = min(LM_MAXH, vl + tl);
 
     vec origin1(p[0]), origin2, uo(u), vo(v);
     uo.mul(umin);
@@ -1044,23 +1103,23 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
     origin1.add(vo);
     
     vec ustep(u), vstep(v);
-    ustep.mul((umax - umin) / (lm_w - 1));
-    uint split = vl * lm_h / (vl + tl);
+    ustep.mul((umax - umin) / (w->lm_w - 1));
+    uint split = vl * w->lm_h / (vl + tl);
     vstep.mul((vmax - vmin) / (split - 1));
     int surftype = NO_SURFACE;
     if(preview)
     {
-        if(!n2) surftype = preview_lightmap_alpha(lpu, 0, lm_h, origin1, ustep, vstep);
+        if(!n2) surftype = preview_lightmap_alpha(w, lpu, 0, w->lm_h, origin1, ustep, vstep);
         else
         {
             origin2 = p[0];
             origin2.add(uo);
             vec tstep(t);
-            tstep.mul(tmax / (lm_h - split - 1));
+            tstep.mul(tmax / (w->lm_h - split - 1));
 
-            surftype = preview_lightmap_alpha(lpu, 0, split, origin1, ustep, vstep);
+            surftype = preview_lightmap_alpha(w, lpu, 0, split, origin1, ustep, vstep);
             if(surftype<SURFACE_LIGHTMAP) return surftype;
-            surftype = preview_lightmap_alpha(lpu, split, lm_h, origin2, ustep, tstep);
+            surftype = preview_lightmap_alpha(w, lpu, split, w->lm_h, origin2, ustep, tstep);
         }
     }
     else if(!n2)
@@ -1069,14 +1128,14 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
         int numv = 4;
         calclerpverts(origin1, p, n, ustep, vstep, lv, numv);
 
-        surftype = generate_lightmap(lpu, 0, lm_h, origin1, lv, numv, ustep, vstep);
+        surftype = generate_lightmap(w, lpu, 0, w->lm_h, origin1, lv, numv, ustep, vstep);
     }
     else
     {
         origin2 = p[0];
         origin2.add(uo);
         vec tstep(t);
-        tstep.mul(tmax / (lm_h - split - 1));
+        tstep.mul(tmax / (w->lm_h - split - 1));
 
         vec p1[3] = {p[0], p[1], p[2]},
             p2[3] = {p[0], p[2], p[3]};
@@ -1085,9 +1144,9 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
         calclerpverts(origin1, p1, n, ustep, vstep, lv1, numv1);
         calclerpverts(origin2, p2, n2, ustep, tstep, lv2, numv2);
 
-        surftype = generate_lightmap(lpu, 0, split, origin1, lv1, numv1, ustep, vstep);
+        surftype = generate_lightmap(w, lpu, 0, split, origin1, lv1, numv1, ustep, vstep);
         if(surftype<SURFACE_LIGHTMAP) return surftype;
-        surftype = generate_lightmap(lpu, split, lm_h, origin2, lv2, numv2, ustep, tstep);
+        surftype = generate_lightmap(w, lpu, split, w->lm_h, origin2, lv2, numv2, ustep, tstep);
     }
     if(surftype<SURFACE_LIGHTMAP) return surftype;
 
@@ -1102,7 +1161,7 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
     }
 
     float uscale = 255.0f / float(umax - umin),
-          vscale = 255.0f / float(vmax - vmin) * float(split) / float(lm_h);
+          vscale = 255.0f / float(vmax - vmin) * float(split) / float(w->lm_h);
     CALCVERT(origin1, u, v, 0, 0)
     CALCVERT(origin1, u, v, 0, 1)
     CALCVERT(origin1, u, v, 0, 2)
@@ -1112,17 +1171,17 @@ int setup_surface(plane planes[2], const vec *p, const vec *n, const vec *n2, uc
     }
     else
     {
-        uchar toffset = uchar(255.0 * float(split) / float(lm_h));
-        float tscale = 255.0f / float(tmax - tmin) * float(lm_h - split) / float(lm_h);
+        uchar toffset = uchar(255.0 * float(split) / float(w->lm_h));
+        float tscale = 255.0f / float(tmax - tmin) * float(w->lm_h - split) / float(w->lm_h);
         CALCVERT(origin2, u, t, toffset, 3)
     }
     return surftype;
 }
 
-void removelmalpha()
+void removelmalpha(lightmapworker *w)
 {
-    if(!(lmtype&LM_ALPHA)) return;
-    for(uchar *dst = lm, *src = lm, *end = &src[lm_w*lm_h*4];
+    if(!(w->type&LM_ALPHA)) return;
+    for(uchar *dst = w->lm, *src = w->lm, *end = &src[w->lm_w*w->lm_h*4];
         src < end;
         dst += 3, src += 4)
     {
@@ -1130,8 +1189,280 @@ void removelmalpha()
         dst[1] = src[1];
         dst[2] = src[2];
     }
-    lmtype &= ~LM_ALPHA;
-    lmbpp = 3;
+    w->type &= ~LM_ALPHA;
+    w->bpp = 3;
+}
+
+// Lighting the map is split in three. The main thread walks the octree and gathers, for each cube, the faces to light
+// and the lights that reach them (setup_surfaces). Worker threads then light those faces (light_task), and the main
+// thread finally packs the results into the atlases (pack_task). Packing happens in the order the cubes were
+// gathered, so the atlases come out the same no matter how many threads are used.
+// Gathering and packing create cube extensions, normals and surfaces, so they run in batches while the workers are
+// idle; the octree never changes while the workers trace rays through it.
+
+// A face of a cube, gathered on the main thread and lit by a worker
+struct lightmapface
+{
+    int orient, numplanes;
+    plane planes[2];
+    vec v[4], n[4], n2[3];
+    Slot *slot, *layer;
+    ivec blendorigin;
+    int blendsize;
+    vector<const extentity *> lights1, lights2;
+
+    int surftype, layersurftype;
+    lightmapinfo lm, layerlm;
+};
+
+struct lightmaptask
+{
+    cube *c;
+    int numfaces;
+    lightmapface faces[6];
+};
+
+// Whether a layer needs its own lightmap, rather than sharing the one lit for the slot beneath it
+static inline bool separatelayer(const Slot &slot, const Slot &layer)
+{
+    return (slot.shader->type^layer.shader->type)&SHADER_NORMALSLMS ||
+           (slot.shader->type&SHADER_NORMALSLMS && slot.rotation!=layer.rotation);
+}
+
+static void light_face(lightmapworker *w, lightmapface &f)
+{
+    Slot &slot = *f.slot, *layer = f.layer;
+    uchar texcoords[8];
+
+    w->lights1 = &f.lights1;
+    w->lights2 = &f.lights2;
+    if(layer) setblendmaporigin(w->blendmapcache, f.blendorigin, f.blendsize);
+
+    w->slot = &slot;
+    w->type = slot.shader->type&SHADER_NORMALSLMS ? LM_BUMPMAP0 : LM_DIFFUSE;
+    if(layer) w->type |= LM_ALPHA;
+    w->bpp = w->type&LM_ALPHA ? 4 : 3;
+    w->orient = f.orient;
+    w->rotate = slot.rotation;
+    f.surftype = setup_surface(w, f.planes, f.v, f.n, f.numplanes >= 2 ? f.n2 : NULL, texcoords);
+    f.layersurftype = NO_SURFACE;
+    switch(f.surftype)
+    {
+        case SURFACE_LIGHTMAP_BOTTOM:
+            if(separatelayer(slot, *layer)) break;
+            // fall through
+        case SURFACE_LIGHTMAP_BLEND:
+        case SURFACE_LIGHTMAP_TOP:
+            if(f.surftype!=SURFACE_LIGHTMAP_BLEND) removelmalpha(w);
+            f.lm.save(*w, texcoords);
+            if(f.surftype==SURFACE_LIGHTMAP_BLEND && separatelayer(slot, *layer)) break;
+            return;
+
+        default: return;
+    }
+
+    w->slot = layer;
+    w->type = layer->shader->type&SHADER_NORMALSLMS ? LM_BUMPMAP0 : LM_DIFFUSE;
+    w->bpp = 3;
+    w->rotate = layer->rotation;
+    f.layersurftype = setup_surface(w, f.planes, f.v, f.n, f.numplanes >= 2 ? f.n2 : NULL, texcoords);
+    if(f.layersurftype==SURFACE_LIGHTMAP_TOP) f.layerlm.save(*w, texcoords);
+}
+
+static void light_task(lightmapworker *w, lightmaptask &t)
+{
+    loopi(t.numfaces)
+    {
+        if(calclight_canceled) return;
+        light_face(w, t.faces[i]);
+    }
+}
+
+static void pack_task(lightmaptask &t)
+{
+    surfaceinfo surfaces[12];
+    int numsurfs = 0;
+    loopj(t.numfaces)
+    {
+        lightmapface &f = t.faces[j];
+        int i = f.orient;
+        Slot &slot = *f.slot, *layer = f.layer;
+        switch(f.surftype)
+        {
+            case SURFACE_LIGHTMAP_BOTTOM:
+                if(separatelayer(slot, *layer)) break;
+                // fall through
+            case SURFACE_LIGHTMAP_BLEND:
+            case SURFACE_LIGHTMAP_TOP:
+            {
+                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
+                surfaceinfo &surface = surfaces[i];
+                surface.w = f.lm.w;
+                surface.h = f.lm.h;
+                if(f.surftype==SURFACE_LIGHTMAP_BLEND) surface.layer = LAYER_TOP|LAYER_BLEND;
+                else if(f.surftype==SURFACE_LIGHTMAP_BOTTOM) surface.layer = LAYER_BOTTOM;
+                memcpy(surface.texcoords, f.lm.texcoords, 8);
+                pack_lightmap(f.lm, surface);
+                if(f.surftype!=SURFACE_LIGHTMAP_BLEND) continue;
+                if(separatelayer(slot, *layer)) break;
+                surfaces[numsurfs] = surface;
+                surfaces[numsurfs++].layer = LAYER_BOTTOM;
+                continue;
+            }
+
+            case SURFACE_AMBIENT_BOTTOM:
+                if(layer)
+                {
+                    if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
+                    surfaces[i].layer = LAYER_BOTTOM;
+                }
+                continue;
+
+            default: continue;
+        }
+
+        switch(f.layersurftype)
+        {
+            case SURFACE_LIGHTMAP_TOP:
+            {
+                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
+                surfaceinfo &surface = surfaces[f.surftype==SURFACE_LIGHTMAP_BLEND ? numsurfs++ : i];
+                surface.w = f.layerlm.w;
+                surface.h = f.layerlm.h;
+                surface.layer = LAYER_BOTTOM;
+                memcpy(surface.texcoords, f.layerlm.texcoords, 8);
+                pack_lightmap(f.layerlm, surface);
+                break;
+            }
+
+            case SURFACE_AMBIENT_TOP:
+            {
+                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
+                surfaceinfo &surface = surfaces[f.surftype==SURFACE_LIGHTMAP_BLEND ? numsurfs++ : i];
+                memset(&surface, 0, sizeof(surface));
+                surface.layer = LAYER_BOTTOM;
+                break;
+            }
+        }
+    }
+    if(numsurfs) newsurfaces(*t.c, surfaces, numsurfs);
+}
+
+#define MAXLIGHTMAPTASKS 256
+
+VARP(lightthreads, 1, 1, 16);
+
+static vector<lightmapworker *> lightworkers;
+static lightmapworker *mainworker = NULL; // for lighting on the main thread, when not using worker threads
+static lightmaptask *lightmaptasks = NULL; // a ring of tasks, indexed modulo MAXLIGHTMAPTASKS
+static int taskhead = 0, taskready = 0, tasknext = 0, tasklit = 0, tasktail = 0; // tasks gathered, given to the workers, taken by them, lit, and packed
+static bool tasksfinished = false;
+static SDL_mutex *tasklock = NULL;
+static SDL_cond *taskcond = NULL, *donecond = NULL;
+
+static int lightmapworkerthread(void *data)
+{
+    lightmapworker *w = (lightmapworker *)data;
+    SDL_LockMutex(tasklock);
+    for(;;)
+    {
+        while(tasknext == taskready && !tasksfinished) SDL_CondWait(taskcond, tasklock);
+        if(tasknext == taskready) break;
+        lightmaptask &t = lightmaptasks[tasknext++ % MAXLIGHTMAPTASKS];
+        SDL_UnlockMutex(tasklock);
+        light_task(w, t);
+        SDL_LockMutex(tasklock);
+        if(++tasklit == taskready) SDL_CondSignal(donecond);
+    }
+    SDL_UnlockMutex(tasklock);
+    return 0;
+}
+
+// Gives the gathered tasks to the workers and waits for all of them to be lit, showing the progress meanwhile,
+// then packs them
+static void light_tasks()
+{
+    if(tasktail == taskhead) return;
+    SDL_LockMutex(tasklock);
+    taskready = taskhead;
+    SDL_CondBroadcast(taskcond);
+    while(tasklit != taskready)
+    {
+        SDL_CondWaitTimeout(donecond, tasklock, 250);
+        if(check_calclight_progress && !calclight_canceled)
+        {
+            SDL_UnlockMutex(tasklock);
+            show_calclight_progress();
+            check_calclight_canceled();
+            SDL_LockMutex(tasklock);
+        }
+    }
+    SDL_UnlockMutex(tasklock);
+    for(; tasktail < taskhead; tasktail++)
+    {
+        if(!calclight_canceled) pack_task(lightmaptasks[tasktail % MAXLIGHTMAPTASKS]);
+    }
+}
+
+static lightmaptask &new_task(cube &c)
+{
+    if(taskhead - tasktail >= MAXLIGHTMAPTASKS) light_tasks();
+    lightmaptask &t = lightmaptasks[taskhead % MAXLIGHTMAPTASKS];
+    t.c = &c;
+    t.numfaces = 0;
+    return t;
+}
+
+static void submit_task(lightmaptask &t)
+{
+    if(lightworkers.empty())
+    {
+        light_task(mainworker, t);
+        if(!calclight_canceled) pack_task(t);
+        return;
+    }
+    taskhead++;
+}
+
+static void setuplightmapworkers()
+{
+    // Resolve what tracing shadows through mapmodels would otherwise load lazily, which workers cannot do
+    preloadmmintersect();
+
+    if(!lightmaptasks) lightmaptasks = new lightmaptask[MAXLIGHTMAPTASKS];
+    taskhead = taskready = tasknext = tasklit = tasktail = 0;
+    tasksfinished = false;
+
+    if(!mainworker) mainworker = new lightmapworker;
+    freeshadowraycache(mainworker->shadowraycache);
+    mainworker->shadowraycache = newshadowraycache();
+
+    if(lightthreads <= 1) return;
+    if(!tasklock) tasklock = SDL_CreateMutex();
+    if(!taskcond) taskcond = SDL_CreateCond();
+    if(!donecond) donecond = SDL_CreateCond();
+    loopi(lightthreads)
+    {
+        lightmapworker *w = lightworkers.add(new lightmapworker);
+        w->shadowraycache = newshadowraycache();
+        w->thread = SDL_CreateThread(lightmapworkerthread, w);
+    }
+}
+
+static void cleanuplightmapworkers()
+{
+    if(lightworkers.length())
+    {
+        light_tasks();
+        SDL_LockMutex(tasklock);
+        tasksfinished = true;
+        SDL_CondBroadcast(taskcond);
+        SDL_UnlockMutex(tasklock);
+        loopv(lightworkers) SDL_WaitThread(lightworkers[i]->thread, NULL);
+        lightworkers.deletecontentsp();
+    }
+    freeshadowraycache(mainworker->shadowraycache);
+    cleanupmmintersect();
 }
 
 void setup_surfaces(cube &c, int cx, int cy, int cz, int size)
@@ -1156,15 +1487,15 @@ void setup_surfaces(cube &c, int cx, int cy, int cz, int size)
     }
 
     int mergeindex = 0;
-    surfaceinfo surfaces[12];
-    int numsurfs = 0;
+    lightmaptask &t = new_task(c);
     loopi(6) if(usefaces[i])
     {
         CHECK_PROGRESS(return);
         if(c.texture[i] == DEFAULT_SKY) continue;
 
-        plane planes[2];
-        vec v[4], n[4], n2[3];
+        lightmapface &f = t.faces[t.numfaces];
+        plane *planes = f.planes;
+        vec *v = f.v, *n = f.n, *n2 = f.n2;
         int numplanes;
 
         Slot &slot = lookuptexture(c.texture[i], false),
@@ -1190,7 +1521,9 @@ void setup_surfaces(cube &c, int cx, int cy, int cz, int size)
                 findnormal(mo, mv[j], planes[0], n[j]);
             }
 
-            if(!find_lights(mo.x, mo.y, mo.z, 1<<msz, v, n, NULL, slot))
+            f.blendorigin = mo;
+            f.blendsize = 1<<msz;
+            if(!find_lights(f.lights1, f.lights2, mo.x, mo.y, mo.z, 1<<msz, v, n, NULL, slot))
             {
                 if(!(shadertype&(SHADER_NORMALSLMS | SHADER_ENVMAP))) continue;
             }
@@ -1232,7 +1565,9 @@ void setup_surfaces(cube &c, int cx, int cy, int cz, int size)
             if(!(usefaces[i]&1)) { v[1] = v[0]; n[1] = n[0]; }
             if(!(usefaces[i]&2)) { v[3] = v[0]; n[3] = n[0]; }
 
-            if(!find_lights(cx, cy, cz, size, v, n, numplanes > 1 ? n2 : NULL, slot))
+            f.blendorigin = ivec(cx, cy, cz);
+            f.blendsize = size;
+            if(!find_lights(f.lights1, f.lights2, cx, cy, cz, size, v, n, numplanes > 1 ? n2 : NULL, slot))
             {
                 if(!(shadertype&(SHADER_NORMALSLMS | SHADER_ENVMAP))) continue;
             }
@@ -1246,90 +1581,15 @@ void setup_surfaces(cube &c, int cx, int cy, int cz, int size)
             cn[i].normals[2] = bvec(n[2]);
             cn[i].normals[3] = bvec(numplanes < 2 ? n[3] : n2[2]);
         }
-        if(lights1.empty() && lights2.empty() && (!layer || (!hasblendmap() && !slot.layermask)) && !hasskylight()) continue;
-
-        uchar texcoords[8];
+        if(f.lights1.empty() && f.lights2.empty() && (!layer || (!hasblendmap() && !slot.layermask)) && !hasskylight()) continue;
 
-        lmslot = &slot;
-        lmtype = shader->type&SHADER_NORMALSLMS ? LM_BUMPMAP0 : LM_DIFFUSE;
-        if(layer) lmtype |= LM_ALPHA;
-        lmbpp = lmtype&LM_ALPHA ? 4 : 3;
-        lmorient = i;
-        lmrotate = slot.rotation;
-        int surftype = setup_surface(planes, v, n, numplanes >= 2 ? n2 : NULL, texcoords);
-        switch(surftype)
-        {
-            case SURFACE_LIGHTMAP_BOTTOM:
-                if((shader->type^layer->shader->type)&SHADER_NORMALSLMS ||
-                   (shader->type&SHADER_NORMALSLMS && slot.rotation!=layer->rotation))
-                    break;
-                // fall through
-            case SURFACE_LIGHTMAP_BLEND:
-            case SURFACE_LIGHTMAP_TOP:
-            {
-                CHECK_PROGRESS(return);
-                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
-                surfaceinfo &surface = surfaces[i];
-                surface.w = lm_w;
-                surface.h = lm_h;
-                if(surftype==SURFACE_LIGHTMAP_BLEND) surface.layer = LAYER_TOP|LAYER_BLEND;
-                else
-                {
-                    if(surftype==SURFACE_LIGHTMAP_BOTTOM) surface.layer = LAYER_BOTTOM;
-                    if(lmtype&LM_ALPHA) removelmalpha();
-                } 
-                memcpy(surface.texcoords, texcoords, 8);
-                pack_lightmap(surface);
-                if(surftype!=SURFACE_LIGHTMAP_BLEND) continue;
-                if((shader->type^layer->shader->type)&SHADER_NORMALSLMS ||
-                   (shader->type&SHADER_NORMALSLMS && slot.rotation!=layer->rotation)) 
-                    break;
-                surfaces[numsurfs] = surface;
-                surfaces[numsurfs++].layer = LAYER_BOTTOM;
-                continue;
-            }
-
-            case SURFACE_AMBIENT_BOTTOM:
-                if(layer)
-                {
-                    if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
-                    surfaces[i].layer = LAYER_BOTTOM;
-                }
-                continue;
-
-            default: continue;
-        }
-
-        lmslot = layer;
-        lmtype = layer->shader->type&SHADER_NORMALSLMS ? LM_BUMPMAP0 : LM_DIFFUSE;
-        lmbpp = 3;
-        lmrotate = layer->rotation;
-        switch(setup_surface(planes, v, n, numplanes >= 2 ? n2 : NULL, texcoords))
-        {
-            case SURFACE_LIGHTMAP_TOP:
-            {
-                CHECK_PROGRESS(return);
-                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
-                surfaceinfo &surface = surfaces[surftype==SURFACE_LIGHTMAP_BLEND ? numsurfs++ : i];
-                surface.w = lm_w;
-                surface.h = lm_h;
-                surface.layer = LAYER_BOTTOM;
-                memcpy(surface.texcoords, texcoords, 8);
-                pack_lightmap(surface);
-                break;
-            }
-
-            case SURFACE_AMBIENT_TOP:
-            {
-                if(!numsurfs) { numsurfs = 6; memset(surfaces, 0, sizeof(surfaces)); }
-                surfaceinfo &surface = surfaces[surftype==SURFACE_LIGHTMAP_BLEND ? numsurfs++ : i];
-                memset(&surface, 0, sizeof(surface));
-                surface.layer = LAYER_BOTTOM;
-                break;
-            }
-        }
+        f.orient = i;
+        f.numplanes = numplanes;
+        f.slot = &slot;
+        f.layer = layer;
+        t.numfaces++;
     }
-    if(numsurfs) newsurfaces(c, surfaces, numsurfs);
+    if(t.numfaces) submit_task(t);
 }
 
 void generate_lightmaps(cube *c, int cx, int cy, int cz, int size)
@@ -1373,6 +1633,10 @@ bool previewblends(cube &c, const ivec &co, int size)
         return blends;
     }
 
+    if(!mainworker) mainworker = new lightmapworker;
+    lightmapworker *w = mainworker;
+    setblendmaporigin(w->blendmapcache, co, size);
+
     vec verts[8];
     loopi(8) if(vertused&(1<<i)) 
     {
@@ -1420,12 +1684,12 @@ bool previewblends(cube &c, const ivec &co, int size)
         static const vec n[4] = { vec(0, 0, 1), vec(0, 0, 1), vec(0, 0, 1), vec(0, 0, 1) };
         uchar texcoords[8];
 
-        lmslot = &slot;
-        lmtype = shadertype&SHADER_NORMALSLMS ? LM_BUMPMAP0|LM_ALPHA : LM_DIFFUSE|LM_ALPHA;
-        lmbpp = 4;
-        lmorient = i;
-        lmrotate = slot.rotation;
-        int surftype = setup_surface(planes, v, n, numplanes >= 2 ? n : NULL, texcoords, true);
+        w->slot = &slot;
+        w->type = shadertype&SHADER_NORMALSLMS ? LM_BUMPMAP0|LM_ALPHA : LM_DIFFUSE|LM_ALPHA;
+        w->bpp = 4;
+        w->orient = i;
+        w->rotate = slot.rotation;
+        int surftype = setup_surface(w, planes, v, n, numplanes >= 2 ? n : NULL, texcoords, true);
         switch(surftype)
         {
             case SURFACE_AMBIENT_TOP:
@@ -1450,23 +1714,25 @@ bool previewblends(cube &c, const ivec &co, int size)
             {
                 if(!numsurfs) numsurfs = 6;
                 surfaceinfo &surface = surfaces[i];
-                if(surface.w==lm_w && surface.h==lm_h && 
+                static lightmapinfo info;
+                info.save(*w, texcoords);
+                if(surface.w==info.w && surface.h==info.h && 
                    surface.layer==(LAYER_TOP|LAYER_BLEND) && 
                    !memcmp(surface.texcoords, texcoords, 8) &&
                    lightmaps.inrange(surface.lmid-LMID_RESERVED) &&
-                   lightmaps[surface.lmid-LMID_RESERVED].type==lmtype)           
+                   lightmaps[surface.lmid-LMID_RESERVED].type==info.type)           
                 {
-                    copy_lightmap(surface);
+                    copy_lightmap(info, surface);
                     update_lightmap(surface);
                     surfaces[numsurfs] = surface;
                     surfaces[numsurfs++].layer = LAYER_BOTTOM;
                     continue;
                 }
-                surface.w = lm_w;
-                surface.h = lm_h;
+                surface.w = info.w;
+                surface.h = info.h;
                 surface.layer = LAYER_TOP|LAYER_BLEND;
                 memcpy(surface.texcoords, texcoords, 8);
-                if(pack_lightmap(surface)) update_lightmap(surface);
+                if(pack_lightmap(info, surface)) update_lightmap(surface);
                 surfaces[numsurfs] = surface;
                 surfaces[numsurfs++].layer = LAYER_BOTTOM;
                 continue;
@@ -1585,7 +1851,9 @@ void calclight(int *quality)
     Uint32 start = SDL_GetTicks();
     calcnormals();
     show_calclight_progress();
+    setuplightmapworkers();
     generate_lightmaps(worldroot, 0, 0, 0, worldsize >> 1);
+    cleanuplightmapworkers();
     clearnormals();
     Uint32 end = SDL_GetTicks();
     if(timer) SDL_RemoveTimer(timer);
@@ -1642,7 +1910,9 @@ void patchlight(int *quality)
     Uint32 start = SDL_GetTicks();
     if(patchnormals) calcnormals();
     show_calclight_progress();
+    setuplightmapworkers();
     generate_lightmaps(worldroot, 0, 0, 0, worldsize >> 1);
+    cleanuplightmapworkers();
     if(patchnormals) clearnormals();
     Uint32 end = SDL_GetTicks();
     if(timer) SDL_RemoveTimer(timer);
@@ -1996,7 +2266,7 @@ void lightreaching(const vec &target, vec &color, vec &dir, extentity *t, float
             continue;
     
         ray.div(mag);
-        if(shadowray(e.o, ray, mag, RAY_SHADOW | RAY_POLY, t) < mag)
+        if(shadowray(NULL, e.o, ray, mag, RAY_SHADOW | RAY_POLY, t) < mag)
             continue;
         float intensity = 1;
         if(e.attr1)
@@ -2026,7 +2296,7 @@ void lightreaching(const vec &target, vec &color, vec &dir, extentity *t, float
     if(t && hasskylight())
     {
         uchar skylight[3];
-        calcskylight(target, vec(0, 0, 0), 0.5f, skylight, RAY_POLY, t);
+        calcskylight(NULL, target, vec(0, 0, 0), 0.5f, skylight, RAY_POLY, t);
         loopk(3) color[k] = min(1.5f, max(max(skylight[k]/255.0f, ambient), color[k]));
     }
     else loopk(3)
@@ -2057,7 +2327,7 @@ entity *brightestlight(const vec &target, const vec &dir)
              continue;
 
         ray.div(mag);
-        if(shadowray(e.o, ray, mag, RAY_SHADOW | RAY_POLY) < mag)
+        if(shadowray(NULL, e.o, ray, mag, RAY_SHADOW | RAY_POLY) < mag)
             continue;
         float intensity = 1;
         if(e.attr1)
@@ -2095,7 +2365,7 @@ void newsurfaces(cube &c, const surfaceinfo *surfs, int numsurfs)
     if(!c.ext) newcubeext(c);
     if(!c.ext->surfaces || c.ext->surfaces==brightsurfaces)
     {
-        c.ext->surfaces = new surfaceinfo[numsurfs];
+        c.ext->surfaces = newoctaarray<surfaceinfo>(numsurfs); // INTENSITY
         memcpy(c.ext->surfaces, surfs, numsurfs*sizeof(surfaceinfo));
     }
 }
@@ -2105,7 +2375,7 @@ void freesurfaces(cube &c)
     if(c.ext)
     {
         if(c.ext->surfaces==brightsurfaces) c.ext->surfaces = NULL;
-        else DELETEA(c.ext->surfaces);
+        else DELETEOCTAARRAY(c.ext->surfaces); // INTENSITY
     }
 }
 
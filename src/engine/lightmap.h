@@ -135,7 +135,7 @@ extern void freenormals(cube &c);
         if(calclight_canceled) exit; \
     }
 
-extern bool calclight_canceled;
+extern volatile bool calclight_canceled;
 extern volatile bool check_calclight_progress;
 
 extern void check_calclight_canceled();
@@ -1217,7 +1217,7 @@ int sauer_main(int argc, char **argv) // INTENSITY: Renamed so we can access it
         lastmillis += curtime;
         totalmillis = millis;
 
-        Logging::log(Logging::INFO, "New frame: lastmillis: %d   curtime: %d\r\n", lastmillis, curtime); // INTENSITY
+        LOG(INFO, "New frame: lastmillis: %d   curtime: %d\r\n", lastmillis, curtime); // INTENSITY
 
         checkinput();
         menuprocess();
@@ -1244,13 +1244,9 @@ int sauer_main(int argc, char **argv) // INTENSITY: Renamed so we can access it
             // INTENSITY: If we have all the data we need from the server to run the game, then we can actually draw
             if (ClientSystem::scenarioStarted())
             {
-                static Benchmarker renderingBenchmarker;
-                renderingBenchmarker.start();
+                PROFILE("rendering");
 
                 gl_drawframe(screen->w, screen->h);
-
-                renderingBenchmarker.stop();
-                SystemManager::showBenchmark("                                        Rendering", renderingBenchmarker);
             }
         }
         swapbuffers();
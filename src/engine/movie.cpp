@@ -14,7 +14,165 @@
 #include "engine.h"
 #include "SDL_mixer.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOVIESSE2
+#include <emmintrin.h>
+#endif
+
 VAR(dbgmovie, 0, 0, 1);
+VAR(moviesimd, 0, 1, 1);
+VARP(moviethreads, 1, 4, 16); // threads converting each frame to yuv, including the encoder thread itself
+
+// splits the rows of a frame into bands, and converts them on a small pool of threads
+namespace movieworkers
+{
+    typedef void (*bandfunc)(void *data, uint row, uint rowend);
+
+    static vector<SDL_Thread *> threads;
+    static SDL_mutex *lock = NULL;
+    static SDL_cond *wakeup = NULL, *finished = NULL;
+    static bool quit = false;
+
+    static bandfunc func = NULL;
+    static void *data = NULL;
+    static uint rows = 0, bandrows = 0, nextrow = 0, busy = 0;
+
+    // called with the lock held, takes bands until there are none left
+    static void dobands()
+    {
+        while(nextrow < rows)
+        {
+            uint row = nextrow, rowend = min(row + bandrows, rows);
+            nextrow = rowend;
+            busy++;
+            SDL_UnlockMutex(lock);
+            func(data, row, rowend);
+            SDL_LockMutex(lock);
+            if(!--busy && nextrow >= rows) SDL_CondSignal(finished);
+        }
+    }
+
+    static int worker(void *)
+    {
+        SDL_LockMutex(lock);
+        while(!quit)
+        {
+            if(nextrow < rows) dobands();
+            else SDL_CondWait(wakeup, lock);
+        }
+        SDL_UnlockMutex(lock);
+        return 0;
+    }
+
+    void stop()
+    {
+        if(!lock) return;
+        SDL_LockMutex(lock);
+        quit = true;
+        SDL_CondBroadcast(wakeup);
+        SDL_UnlockMutex(lock);
+        loopv(threads) SDL_WaitThread(threads[i], NULL);
+        threads.setsize(0);
+
+        SDL_DestroyMutex(lock);
+        SDL_DestroyCond(wakeup);
+        SDL_DestroyCond(finished);
+        lock = NULL;
+        wakeup = finished = NULL;
+        quit = false;
+    }
+
+    static void start(int numthreads)
+    {
+        lock = SDL_CreateMutex();
+        wakeup = SDL_CreateCond();
+        finished = SDL_CreateCond();
+        loopi(numthreads)
+        {
+            SDL_Thread *thread = SDL_CreateThread(worker, NULL);
+            if(!thread) break;
+            threads.add(thread);
+        }
+    }
+
+    // runs f over rows [0, numrows) and returns when all of them are done
+    void run(bandfunc f, void *d, uint numrows)
+    {
+        if(moviethreads <= 1 || numrows < 2)
+        {
+            stop();
+            f(d, 0, numrows);
+            return;
+        }
+        if(!lock || threads.length() != moviethreads-1)
+        {
+            stop();
+            start(moviethreads-1);
+        }
+
+        SDL_LockMutex(lock);
+        func = f;
+        data = d;
+        rows = numrows;
+        bandrows = max(numrows/(4*(threads.length()+1)), 1U); // several bands per thread to even out the load
+        nextrow = 0;
+        SDL_CondBroadcast(wakeup);
+        dobands(); // the calling thread helps too
+        while(busy) SDL_CondWait(finished, lock);
+        rows = nextrow = 0;
+        SDL_UnlockMutex(lock);
+    }
+}
+
+#ifdef MOVIESSE2
+// weighted sum of b,g,r for 4 pixels, held as 16 bit lanes 2 pixels at a time: madd leaves b*wb+g*wg and r*wr
+// for each pixel, which are then added together
+static inline __m128i sse2weigh(__m128i lo, __m128i hi, __m128i weights)
+{
+    __m128 m1 = _mm_castsi128_ps(_mm_madd_epi16(lo, weights)), m2 = _mm_castsi128_ps(_mm_madd_epi16(hi, weights));
+    return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(m1, m2, _MM_SHUFFLE(2, 0, 2, 0))),
+                         _mm_castps_si128(_mm_shuffle_ps(m1, m2, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+// same as the scalar loop in aviwriter::encodeyuv, 8 pixels of 2 rows at a time, w must be a multiple of 8
+// everything is done in 32 bit integers with the same weights, so the output is identical
+static void sse2encodeyuv(const uchar *src, const uchar *src2, uchar *ydst, uchar *ydst2, uchar *udst, uchar *vdst, uint w)
+{
+    const __m128i zero = _mm_setzero_si128(),
+                  yweights = _mm_setr_epi16(467, 2404, 1225, 0, 467, 2404, 1225, 0),
+                  uweights = _mm_setr_epi16(512, -339, -173, 0, 512, -339, -173, 0),
+                  vweights = _mm_setr_epi16(-83, -429, 512, 0, -83, -429, 512, 0),
+                  uvbias = _mm_set1_epi32(128<<12);
+    for(const uchar *end = &src[w<<2]; src < end; src += 32, src2 += 32, ydst += 8, ydst2 += 8, udst += 4, vdst += 4)
+    {
+        const __m128i a = _mm_loadu_si128((const __m128i *)src), b = _mm_loadu_si128((const __m128i *)&src[16]),
+                      c = _mm_loadu_si128((const __m128i *)src2), d = _mm_loadu_si128((const __m128i *)&src2[16]),
+                      alo = _mm_unpacklo_epi8(a, zero), ahi = _mm_unpackhi_epi8(a, zero),
+                      blo = _mm_unpacklo_epi8(b, zero), bhi = _mm_unpackhi_epi8(b, zero),
+                      clo = _mm_unpacklo_epi8(c, zero), chi = _mm_unpackhi_epi8(c, zero),
+                      dlo = _mm_unpacklo_epi8(d, zero), dhi = _mm_unpackhi_epi8(d, zero);
+
+        // 0.299*R + 0.587*G + 0.114*B
+        const __m128i y1 = _mm_packs_epi32(_mm_srli_epi32(sse2weigh(alo, ahi, yweights), 12), _mm_srli_epi32(sse2weigh(blo, bhi, yweights), 12)),
+                      y2 = _mm_packs_epi32(_mm_srli_epi32(sse2weigh(clo, chi, yweights), 12), _mm_srli_epi32(sse2weigh(dlo, dhi, yweights), 12));
+        _mm_storel_epi64((__m128i *)ydst, _mm_packus_epi16(y1, y1));
+        _mm_storel_epi64((__m128i *)ydst2, _mm_packus_epi16(y2, y2));
+
+        // sums of each 2x2 block
+        const __m128i s1 = _mm_add_epi16(alo, clo), s2 = _mm_add_epi16(ahi, chi),
+                      s3 = _mm_add_epi16(blo, dlo), s4 = _mm_add_epi16(bhi, dhi),
+                      q1 = _mm_add_epi16(_mm_unpacklo_epi64(s1, s2), _mm_unpackhi_epi64(s1, s2)),
+                      q2 = _mm_add_epi16(_mm_unpacklo_epi64(s3, s4), _mm_unpackhi_epi64(s3, s4));
+
+        const __m128i u = _mm_srai_epi32(_mm_add_epi32(sse2weigh(q1, q2, uweights), uvbias), 12),
+                      v = _mm_srai_epi32(_mm_add_epi32(sse2weigh(q1, q2, vweights), uvbias), 12),
+                      uv = _mm_packus_epi16(_mm_packs_epi32(u, v), zero);
+        const int ubits = _mm_cvtsi128_si32(uv), vbits = _mm_cvtsi128_si32(_mm_srli_si128(uv, 4));
+        memcpy(udst, &ubits, 4); // chroma rows are only 2 byte aligned
+        memcpy(vdst, &vbits, 4);
+    }
+}
+#endif
 
 struct aviindexentry
 {
@@ -357,23 +515,35 @@ struct aviwriter
         rdst = (rt*area)>>24;
     }
  
-    void scaleyuv(const uchar *pixels, uint srcw, uint srch)
+    // finds where a pair of output rows goes in the (flipped) yuv planes
+    void yuvrow(uint row, uchar *&yplane, uchar *&uplane, uchar *&vplane, int &ystride, int &uvstride)
     {
         const int flip = -1;
         const uint planesize = videow * videoh;
-        if(!yuv) yuv = new uchar[(planesize*3)/2];
-        uchar *yplane = yuv, *uplane = yuv + planesize, *vplane = yuv + planesize + planesize/4;
-        const int ystride = flip*int(videow), uvstride = flip*int(videow)/2;
+        yplane = yuv; uplane = yuv + planesize; vplane = yuv + planesize + planesize/4;
+        ystride = flip*int(videow); uvstride = flip*int(videow)/2;
         if(flip < 0) { yplane -= int(videoh-1)*ystride; uplane -= int(videoh/2-1)*uvstride; vplane -= int(videoh/2-1)*uvstride; }
+        yplane += int(row)*2*ystride;
+        uplane += int(row)*uvstride;
+        vplane += int(row)*uvstride;
+    }
+
+    // converts output row pairs [row, rowend), so a frame can be split between threads
+    void scaleyuv(const uchar *pixels, uint srcw, uint srch, uint row, uint rowend)
+    {
+        const uint planesize = videow * videoh;
+        uchar *yplane, *uplane, *vplane;
+        int ystride, uvstride;
+        yuvrow(row, yplane, uplane, vplane, ystride, uvstride);
 
         const uint stride = srcw<<2;
         srcw &= ~1;
         srch &= ~1;
         const uint wfrac = (srcw<<12)/videow, hfrac = (srch<<12)/videoh, 
                    area = ((unsigned long long int)planesize<<12)/(srcw*srch + 1),
-                   dw = videow*wfrac, dh = videoh*hfrac;
+                   dw = videow*wfrac, dh = rowend*2*hfrac;
   
-        for(uint y = 0; y < dh;)
+        for(uint y = row*2*hfrac; y < dh;)
         {
             uint yn = y + hfrac - 1, yi = y>>12, h = (yn>>12) - yi, ylow = ((yn|(-int(h)>>24))&0xFFFU) + 1 - (y&0xFFFU), yhigh = (yn&0xFFFU) + 1;
             y += hfrac;
@@ -417,21 +587,31 @@ struct aviwriter
         }
     }
 
-    void encodeyuv(const uchar *pixels)
+    void encodeyuv(const uchar *pixels, uint row, uint rowend)
     {
-        const int flip = -1;
-        const uint planesize = videow * videoh;
-        if(!yuv) yuv = new uchar[(planesize*3)/2];
-        uchar *yplane = yuv, *uplane = yuv + planesize, *vplane = yuv + planesize + planesize/4;
-        const int ystride = flip*int(videow), uvstride = flip*int(videow)/2;
-        if(flip < 0) { yplane -= int(videoh-1)*ystride; uplane -= int(videoh/2-1)*uvstride; vplane -= int(videoh/2-1)*uvstride; }
+        uchar *yplane, *uplane, *vplane;
+        int ystride, uvstride;
+        yuvrow(row, yplane, uplane, vplane, ystride, uvstride);
 
         const uint stride = videow<<2;
-        const uchar *src = pixels, *yend = src + videoh*stride;
+        const uchar *src = pixels + row*2*stride, *yend = pixels + rowend*2*stride;
         while(src < yend)    
         {
             const uchar *src2 = src + stride, *xend = src2;
             uchar *ydst = yplane, *ydst2 = yplane + ystride, *udst = uplane, *vdst = vplane;
+#ifdef MOVIESSE2
+            if(moviesimd)
+            {
+                const uint w = videow&~7U;
+                sse2encodeyuv(src, src2, ydst, ydst2, udst, vdst, w);
+                src += w<<2;
+                src2 += w<<2;
+                ydst += w;
+                ydst2 += w;
+                udst += w/2;
+                vdst += w/2;
+            }
+#endif
             while(src < xend)
             {
                 const uint b1 = src[0], g1 = src[1], r1 = src[2],
@@ -464,6 +644,27 @@ struct aviwriter
         }
     }
 
+    struct yuvjob
+    {
+        aviwriter *file;
+        const uchar *pixels;
+        uint srcw, srch;
+    };
+
+    static void yuvband(void *data, uint row, uint rowend)
+    {
+        yuvjob &job = *(yuvjob *)data;
+        if(job.srcw != job.file->videow || job.srch != job.file->videoh) job.file->scaleyuv(job.pixels, job.srcw, job.srch, row, rowend);
+        else job.file->encodeyuv(job.pixels, row, rowend);
+    }
+
+    void convertyuv(const uchar *pixels, uint srcw, uint srch)
+    {
+        if(!yuv) yuv = new uchar[(videow*videoh*3)/2];
+        yuvjob job = { this, pixels, srcw, srch };
+        movieworkers::run(yuvband, &job, videoh/2);
+    }
+
     void compressyuv(const uchar *pixels)
     {
         const int flip = -1;
@@ -550,8 +751,7 @@ struct aviwriter
         switch(format)
         {
             case VID_RGB: 
-                if(srcw != videow || srch != videoh) scaleyuv(pixels, srcw, srch);
-                else encodeyuv(pixels);
+                convertyuv(pixels, srcw, srch);
                 break;
             case VID_YUV:
                 compressyuv(pixels);
@@ -793,6 +993,7 @@ namespace recorder
         SDL_UnlockMutex(videolock);
         
         SDL_WaitThread(thread, NULL); // block until thread is finished
+        movieworkers::stop();
 
         if(scalefb) { glDeleteFramebuffers_(1, &scalefb); scalefb = 0; }
         if(scaletex[0] || scaletex[1]) { glDeleteTextures(2, scaletex); memset(scaletex, 0, sizeof(scaletex)); }
@@ -1021,3 +1222,52 @@ void movie(char *name)
 
 COMMAND(movie, "s");
 
+
+// times the rgb to yuv conversion on synthetic frames, without recording or rendering anything
+static float benchyuv(aviwriter &file, const uchar *pixels, uint srcw, uint srch, int frames)
+{
+    file.convertyuv(pixels, srcw, srch); // allocates the yuv buffer and starts the workers
+    uint start = SDL_GetTicks();
+    loopi(frames) file.convertyuv(pixels, srcw, srch);
+    uint elapsed = max(SDL_GetTicks() - start, 1U);
+    return frames*1000.0f/elapsed;
+}
+
+void moviebench(int *numframes)
+{
+    if(recorder::isrecording()) { conoutf(CON_ERROR, "cannot benchmark while recording a movie"); return; }
+    int frames = *numframes > 0 ? *numframes : 60, oldsimd = moviesimd, oldthreads = moviethreads,
+        threads = moviethreads > 1 ? moviethreads : 4;
+    static const uint sizes[][2] = { { 640, 480 }, { 1280, 720 }, { 1920, 1080 } };
+    loopi(sizeof(sizes)/sizeof(sizes[0]))
+    {
+        uint w = sizes[i][0], h = sizes[i][1], sw = w*3/2, sh = h*3/2, seed = i+1;
+        uchar *pixels = new uchar[sw*sh*4];
+        loopj(sw*sh*4) { seed = seed*1103515245 + 12345; pixels[j] = seed>>24; }
+
+        aviwriter reference("moviebench", w, h, 30, false), file("moviebench", w, h, 30, false);
+        const uint framesize = (w*h*3)/2;
+        bool same = true;
+        float fps[2][3];
+        loopk(2) // full size, then scaled down from 1.5x
+        {
+            uint srcw = k ? sw : w, srch = k ? sh : h;
+            moviesimd = 0; moviethreads = 1;
+            fps[k][0] = benchyuv(reference, pixels, srcw, srch, frames);
+            moviesimd = 1;
+            fps[k][1] = benchyuv(file, pixels, srcw, srch, frames);
+            if(memcmp(reference.yuv, file.yuv, framesize)) same = false;
+            moviethreads = threads;
+            fps[k][2] = benchyuv(file, pixels, srcw, srch, frames);
+            if(memcmp(reference.yuv, file.yuv, framesize)) same = false;
+        }
+        moviesimd = oldsimd; moviethreads = oldthreads;
+        movieworkers::stop();
+        delete[] pixels;
+
+        conoutf("moviebench %dx%d: scalar %.1f fps, simd %.1f fps, %d threads %.1f fps; from %dx%d: %.1f fps, %d threads %.1f fps (%s)",
+            w, h, fps[0][0], fps[0][1], threads, fps[0][2], sw, sh, fps[1][0], threads, fps[1][2], same ? "identical" : "MISMATCH");
+    }
+}
+
+COMMAND(moviebench, "i");
@@ -339,13 +339,13 @@ void newnormals(cube &c)
     if(!c.ext) newcubeext(c);
     if(!c.ext->normals)
     {
-        c.ext->normals = new surfacenormals[6];
+        c.ext->normals = newoctaarray<surfacenormals>(6); // INTENSITY
         memset(c.ext->normals, 128, 6*sizeof(surfacenormals));
     }
 }
 
 void freenormals(cube &c)
 {
-    if(c.ext) DELETEA(c.ext->normals);
+    if(c.ext) DELETEOCTAARRAY(c.ext->normals); // INTENSITY
 }
 
@@ -2,13 +2,170 @@
 
 #include "engine.h"
 
+// INTENSITY: Pooled allocation of the octree. Cube families, cubeexts and the arrays hanging off cubeexts
+// (surfaces, normals, merges) come from pools of fixed-size slots carved out of large chunks, instead of
+// each being its own heap allocation. Free slots are reused, and are put back in address order when a map is
+// loaded (see trimoctapools), so a freshly loaded octree - which is allocated depth-first - lies in memory in
+// the order it is traversed.
+
+VAR(octafamilies, 1, 0, 0);  // live cube families (read-only stats)
+VAR(octapoolkb, 1, 0, 0);    // memory held by the pools
+VAR(octapoolusedkb, 1, 0, 0); // memory in live slots
+VAR(octapoolfrag, 1, 0, 0);  // percentage of pool memory in free slots
+
+static int octapoolbytes = 0, octapoolusedbytes = 0;
+
+static void updateoctapoolstats()
+{
+    octapoolkb = octapoolbytes>>10;
+    octapoolusedkb = octapoolusedbytes>>10;
+    octapoolfrag = octapoolbytes ? int(100*(long long)(octapoolbytes - octapoolusedbytes)/octapoolbytes) : 0;
+}
+
+struct octapool
+{
+    const char *name;
+    int slotsize, slotsperchunk, used;
+    vector<uchar *> chunks;
+    void *freeslots;
+
+    octapool(const char *name, int size) : name(name), used(0), freeslots(NULL)
+    {
+        slotsize = (max(size, int(sizeof(void *))) + sizeof(void *)-1) & ~(sizeof(void *)-1);
+        slotsperchunk = max(64*1024/slotsize, 1);
+    }
+
+    void link(uchar *slot, void *next) { *(void **)slot = next; }
+
+    void grow()
+    {
+        uchar *chunk = new uchar[slotsize*slotsperchunk];
+        chunks.add(chunk);
+        for(int i = slotsperchunk-1; i >= 0; i--)
+        {
+            link(&chunk[i*slotsize], freeslots);
+            freeslots = &chunk[i*slotsize];
+        }
+        octapoolbytes += slotsize*slotsperchunk;
+    }
+
+    void *alloc()
+    {
+        if(!freeslots) grow();
+        void *slot = freeslots;
+        freeslots = *(void **)slot;
+        used++;
+        octapoolusedbytes += slotsize;
+        return slot;
+    }
+
+    void free(void *slot)
+    {
+        link((uchar *)slot, freeslots);
+        freeslots = slot;
+        used--;
+        octapoolusedbytes -= slotsize;
+    }
+
+    static int compareslots(void **a, void **b) { return *a < *b ? -1 : (*a > *b ? 1 : 0); }
+
+    // Releases the chunks if nothing is in use, and otherwise sorts the free slots, so that what is allocated
+    // next is contiguous where possible
+    void trim()
+    {
+        if(!used)
+        {
+            octapoolbytes -= slotsize*slotsperchunk*chunks.length();
+            chunks.deletecontentsa();
+            freeslots = NULL;
+            return;
+        }
+        vector<void *> slots;
+        for(void *slot = freeslots; slot; slot = *(void **)slot) slots.add(slot);
+        slots.sort(compareslots);
+        freeslots = NULL;
+        loopvrev(slots)
+        {
+            link((uchar *)slots[i], freeslots);
+            freeslots = slots[i];
+        }
+    }
+};
+
+static octapool familypool("families", 8*sizeof(cube)), extpool("cubeexts", sizeof(cubeext));
+
+// Size classes for the arrays hanging off cubeexts. Each slot starts with the index of its pool, as the
+// callers do not always know the size of what they free (e.g., surfaces shrink in place)
+union octapayloadheader { int pool; void *align; };
+
+static octapool payloadpools[] =
+{
+    octapool("payloads16", sizeof(octapayloadheader)+16),
+    octapool("payloads32", sizeof(octapayloadheader)+32),
+    octapool("payloads64", sizeof(octapayloadheader)+64),
+    octapool("payloads128", sizeof(octapayloadheader)+128),
+    octapool("payloads256", sizeof(octapayloadheader)+256)
+};
+
+#define NUMPAYLOADPOOLS int(sizeof(payloadpools)/sizeof(payloadpools[0]))
+
+void *newoctapayload(int size)
+{
+    int pool = 0;
+    while(pool < NUMPAYLOADPOOLS && payloadpools[pool].slotsize < int(sizeof(octapayloadheader))+size) pool++;
+    octapayloadheader *header;
+    if(pool < NUMPAYLOADPOOLS) header = (octapayloadheader *)payloadpools[pool].alloc();
+    else
+    {
+        header = (octapayloadheader *)new uchar[sizeof(octapayloadheader)+size];
+        pool = -1;
+    }
+    header->pool = pool;
+    updateoctapoolstats();
+    return header+1;
+}
+
+void freeoctapayload(void *p)
+{
+    if(!p) return;
+    octapayloadheader *header = (octapayloadheader *)p - 1;
+    if(header->pool >= 0) payloadpools[header->pool].free(header);
+    else delete[] (uchar *)header;
+    updateoctapoolstats();
+}
+
+void trimoctapools()
+{
+    familypool.trim();
+    extpool.trim();
+    loopi(NUMPAYLOADPOOLS) payloadpools[i].trim();
+    updateoctapoolstats();
+}
+
+static void printoctapool(octapool &pool)
+{
+    int bytes = pool.slotsize*pool.slotsperchunk*pool.chunks.length();
+    conoutf("%s: %d live (%d bytes each), %d chunks, %d KB, %d%% free",
+        pool.name, pool.used, pool.slotsize, pool.chunks.length(), bytes>>10,
+        bytes ? int(100*(long long)(bytes - pool.used*pool.slotsize)/bytes) : 0);
+}
+
+void octapoolstats()
+{
+    printoctapool(familypool);
+    printoctapool(extpool);
+    loopi(NUMPAYLOADPOOLS) printoctapool(payloadpools[i]);
+}
+COMMAND(octapoolstats, "");
+
 cube *worldroot = newcubes(F_SOLID);
 int allocnodes = 0;
 
 cubeext *newcubeext(cube &c)
 {
     if(c.ext) return c.ext;
-    c.ext = new cubeext;
+    c.ext = (cubeext *)extpool.alloc();
+    updateoctapoolstats();
     c.ext->material = MAT_AIR;
     c.ext->visible = 0;
     c.ext->merged = 0;
@@ -25,7 +182,7 @@ cubeext *newcubeext(cube &c)
 
 cube *newcubes(uint face)
 {
-    cube *c = new cube[8];
+    cube *c = (cube *)familypool.alloc(); // INTENSITY
     loopi(8)
     {
         c->children = NULL;
@@ -38,6 +195,8 @@ cube *newcubes(uint face)
         c++;
     }
     allocnodes++;
+    octafamilies = allocnodes; // INTENSITY
+    updateoctapoolstats();
     return c-8;
 }
 
@@ -52,13 +211,18 @@ void freeocta(cube *c)
 {
     if(!c) return;
     loopi(8) discardchildren(c[i]);
-    delete[] c;
+    familypool.free(c); // INTENSITY
     allocnodes--;
+    octafamilies = allocnodes;
+    updateoctapoolstats();
 }
 
 void freecubeext(cube &c)
 {
-    DELETEP(c.ext);
+    if(!c.ext) return;
+    extpool.free(c.ext); // INTENSITY
+    c.ext = NULL;
+    updateoctapoolstats();
 }
 
 void discardchildren(cube &c)
@@ -156,7 +320,7 @@ void validatec(cube *c, int size)
 
 ivec lu;
 int lusize;
-cube &lookupcube(int tx, int ty, int tz, int tsize)
+cube &lookupcube(int tx, int ty, int tz, int tsize, ivec &ro, int &rsize)
 {
     int size = worldsize;
     int x = 0, y = 0, z = 0;
@@ -178,14 +342,19 @@ cube &lookupcube(int tx, int ty, int tz, int tsize)
         }
         c = c->children;
     }
-    lu.x = x;
-    lu.y = y;
-    lu.z = z;
-    lusize = size;
+    ro.x = x;
+    ro.y = y;
+    ro.z = z;
+    rsize = size;
     return *c;
 }
 
-cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient)
+cube &lookupcube(int tx, int ty, int tz, int tsize)
+{
+    return lookupcube(tx, ty, tz, tsize, lu, lusize);
+}
+
+cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient, ivec &ro, int &rosize)
 {
     switch(orient)
     {
@@ -196,7 +365,12 @@ cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient)
         case O_LEFT:   x -= size; break;
         case O_RIGHT:  x += size; break;
     }
-    return lookupcube(x, y, z, rsize);
+    return lookupcube(x, y, z, rsize, ro, rosize);
+}
+
+cube &neighbourcube(int x, int y, int z, int size, int rsize, int orient)
+{
+    return neighbourcube(x, y, z, size, rsize, orient, lu, lusize);
 }
 
 int lookupmaterial(const vec &v)
@@ -918,10 +1092,12 @@ bool visibleface(cube &c, int orient, int x, int y, int z, int size, uchar mat,
         if(collapsedface(cfe)) return false;
     }
 
-    cube &o = neighbourcube(x, y, z, size, -size, orient);
+    ivec no;
+    int nsize;
+    cube &o = neighbourcube(x, y, z, size, -size, orient, no, nsize);
     if(&o==&c) return false;
 
-    if(lusize > size || (lusize == size && !o.children))
+    if(nsize > size || (nsize == size && !o.children))
     {
         if(nmat != MAT_AIR && o.ext && (o.ext->material&matmask) == nmat) return true;
         if(isentirelysolid(o)) return false;
@@ -931,19 +1107,19 @@ bool visibleface(cube &c, int orient, int x, int y, int z, int size, uchar mat,
 
         ivec vo(x, y, z);
         vo.mask(VVEC_INT_MASK);
-        lu.mask(VVEC_INT_MASK);
+        no.mask(VVEC_INT_MASK);
         facevec cf[4], of[4];
         genfacevecs(c, orient, vo, size, mat != MAT_AIR, cf);
-        int numo = genoppositefacevecs(o, opposite(orient), lu, lusize, of);
+        int numo = genoppositefacevecs(o, opposite(orient), no, nsize, of);
         return numo < 3 || !insideface(cf, 4, of, numo);
     }
 
     ivec vo(x, y, z);
     vo.mask(VVEC_INT_MASK);
-    lu.mask(VVEC_INT_MASK);
+    no.mask(VVEC_INT_MASK);
     facevec cf[4];
     genfacevecs(c, orient, vo, size, mat != MAT_AIR, cf);
-    return !occludesface(o, opposite(orient), lu, lusize, vo, size, mat, nmat, matmask, cf);
+    return !occludesface(o, opposite(orient), no, nsize, vo, size, mat, nmat, matmask, cf);
 }
 
 // more expensive version that checks both triangles of a face independently
@@ -963,28 +1139,30 @@ int visibletris(cube &c, int orient, int x, int y, int z, int size)
 
     if(collapsedface(faceedges(c, orient))) return 0;
 
-    cube &o = neighbourcube(x, y, z, size, -size, orient);
+    ivec no;
+    int nsize;
+    cube &o = neighbourcube(x, y, z, size, -size, orient, no, nsize);
     if(&o==&c) return 0;
 
     ivec vo(x, y, z);
     vo.mask(VVEC_INT_MASK);
-    lu.mask(VVEC_INT_MASK);
+    no.mask(VVEC_INT_MASK);
     facevec cf[4], of[4];
     int opp = opposite(orient), numo = 0;
-    if(lusize > size || (lusize == size && !o.children))
+    if(nsize > size || (nsize == size && !o.children))
     {
         if(isempty(o)) return 3;
         if(!notouch && (isentirelysolid(o) || (touchingface(o, opp) && faceedges(o, opp) == F_SOLID))) return 0;
 
         genfacevecs(c, orient, vo, size, false, cf);
-        numo = genoppositefacevecs(o, opp, lu, lusize, of);
+        numo = genoppositefacevecs(o, opp, no, nsize, of);
         if(numo < 3) return 3;
         if(!notouch && insideface(cf, 4, of, numo)) return 0; 
     }
     else
     {
         genfacevecs(c, orient, vo, size, false, cf);
-        if(!notouch && occludesface(o, opp, lu, lusize, vo, size, MAT_AIR, MAT_AIR, MATF_VOLUME, cf)) return 0;
+        if(!notouch && occludesface(o, opp, no, nsize, vo, size, MAT_AIR, MAT_AIR, MATF_VOLUME, cf)) return 0;
     }
 
     static const int trimasks[2][2] = { { 0x7, 0xD }, { 0xE, 0xB } };
@@ -1022,7 +1200,7 @@ int visibletris(cube &c, int orient, int x, int y, int z, int size)
             if(!numo)
             {
                 tf[3] = cf[v3];
-                if(!occludesface(o, opp, lu, lusize, vo, size, MAT_AIR, MAT_AIR, MATF_VOLUME, tf)) continue;
+                if(!occludesface(o, opp, no, nsize, vo, size, MAT_AIR, MAT_AIR, MATF_VOLUME, tf)) continue;
             }
             else if(!insideface(tf, 3, of, numo)) continue;
             return vis & ~(1<<i);
@@ -1354,10 +1532,10 @@ void addmergeinfo(cube &c, int orient, cubeface &cf)
     loopi(orient) if(c.ext->mergeorigin&(1<<i)) index++;
     int total = index;
     loopi(6-orient-1) if(c.ext->mergeorigin&(1<<(i+orient+1))) total++;
-    mergeinfo *m = new mergeinfo[total+1];
+    mergeinfo *m = newoctaarray<mergeinfo>(total+1); // INTENSITY
     if(index) memcpy(m, c.ext->merges, index*sizeof(mergeinfo));
     if(total>index) memcpy(&m[index+1], &c.ext->merges[index], (total-index)*sizeof(mergeinfo));
-    if(c.ext->merges) delete[] c.ext->merges;
+    if(c.ext->merges) freeoctapayload(c.ext->merges);
     c.ext->merges = m;
     m += index;
     c.ext->mergeorigin |= 1<<orient;
@@ -1371,7 +1549,7 @@ void freemergeinfo(cube &c)
 {
     if(!c.ext) return;
     c.ext->mergeorigin = 0;
-    DELETEA(c.ext->merges);
+    DELETEOCTAARRAY(c.ext->merges); // INTENSITY
 }
 
 VAR(maxmerge, 0, 6, VVEC_INT-1);
@@ -64,7 +64,6 @@ bool pointincube(const clipplanes &p, const vec &v)
 }
 
 #define INTERSECTPLANES(setentry) \
-    clipplanes &p = *c.ext->clip; \
     float enterdist = -1e16f, exitdist = 1e16f; \
     loopi(p.size) \
     { \
@@ -92,7 +91,7 @@ bool pointincube(const clipplanes &p, const vec &v)
     }
 
 // optimized shadow version
-bool shadowcubeintersect(const cube &c, const vec &o, const vec &ray, float &dist)
+static bool shadowcubeintersect(const clipplanes &p, const vec &o, const vec &ray, float &dist)
 {
     INTERSECTPLANES({});
     if(exitdist < 0) return false;
@@ -108,6 +107,7 @@ vec hitsurface;
 bool raycubeintersect(const cube &c, const vec &o, const vec &ray, float &dist)
 {
     int entry = -1, bbentry = -1;
+    clipplanes &p = *c.ext->clip;
     INTERSECTPLANES(entry = i);
     loop(i, 3)
     {
@@ -171,7 +171,7 @@ static float disttoent(octaentities *oc, octaentities *last, const vec &o, const
     entintersect(RAY_POLY, mapmodels,
         if(e.attr3 && (e.triggerstate == TRIGGER_DISAPPEARED || !checktriggertype(e.attr3, TRIG_COLLIDE) || e.triggerstate == TRIGGERED) && (mode&RAY_ENTS)!=RAY_ENTS) continue;
         orient = 0; // FIXME, not set
-        if(!mmintersect(e, o, ray, radius, mode, f)) continue;
+        if(!mmintersect(e, oc->mapmodels[i], o, ray, radius, mode, f)) continue;
     );
 
     entintersect(RAY_ENTS, other,
@@ -220,7 +220,7 @@ static float shadowent(octaentities *oc, octaentities *last, const vec &o, const
         extentity &e = *ents[oc->mapmodels[i]];
         if(!e.inoctanode || &e==t) continue;
         if(e.attr3 && (e.triggerstate == TRIGGER_DISAPPEARED || !checktriggertype(e.attr3, TRIG_COLLIDE) || e.triggerstate == TRIGGERED)) continue;
-        if(!mmintersect(e, o, ray, radius, mode, f)) continue;
+        if(!mmintersect(e, oc->mapmodels[i], o, ray, radius, mode, f)) continue;
         if(f>0 && f<dist) dist = f;
     } 
     return dist;
@@ -230,7 +230,7 @@ static float shadowent(octaentities *oc, octaentities *last, const vec &o, const
     octaentities *oclast = NULL; \
     float dist = 0, dent = mode&RAY_BB ? 1e16f : 1e14f; \
     vec v(o), invray(ray.x ? 1/ray.x : 1e16f, ray.y ? 1/ray.y : 1e16f, ray.z ? 1/ray.z : 1e16f); \
-    static cube *levels[32]; \
+    cube *levels[32]; \
     levels[worldscale] = worldroot; \
     int lshift = worldscale; \
     ivec lsizemask(invray.x>0 ? 1 : 0, invray.y>0 ? 1 : 0, invray.z>0 ? 1 : 0); \
@@ -343,8 +343,21 @@ float raycube(const vec &o, const vec &ray, float radius, int mode, int size, ex
     }
 }
 
+// A small direct-mapped cache of clip planes, so that threads lighting the map do not share the global one.
+// genclipplanes only reads the octree (neighbour lookups return their position locally, not through lu/lusize).
+struct ShadowRayCache
+{
+    clipplanes clipcache[MAXCLIPPLANES];
+
+    ShadowRayCache() { loopi(MAXCLIPPLANES) clipcache[i].owner = NULL; }
+};
+
+ShadowRayCache *newshadowraycache() { return new ShadowRayCache; }
+
+void freeshadowraycache(ShadowRayCache *&cache) { DELETEP(cache); }
+
 // optimized version for lightmap shadowing... every cycle here counts!!!
-float shadowray(const vec &o, const vec &ray, float radius, int mode, extentity *t)
+float shadowray(ShadowRayCache *cache, const vec &o, const vec &ray, float radius, int mode, extentity *t)
 {
     INITRAYCUBE;
     CHECKINSIDEWORLD;
@@ -362,8 +375,23 @@ float shadowray(const vec &o, const vec &ray, float radius, int mode, extentity
         if(!isempty(c))
         {
             float f = 0;
-            setcubeclip(c, lo.x, lo.y, lo.z, 1<<lshift);
-            if(shadowcubeintersect(c, v, ray, f)) return dist+f;
+            const clipplanes *p;
+            if(cache)
+            {
+                clipplanes &cp = cache->clipcache[(size_t(&c)/sizeof(cube))&(MAXCLIPPLANES-1)];
+                if(cp.owner != &c)
+                {
+                    cp.owner = &c;
+                    genclipplanes(c, lo.x, lo.y, lo.z, 1<<lshift, cp);
+                }
+                p = &cp;
+            }
+            else
+            {
+                setcubeclip(c, lo.x, lo.y, lo.z, 1<<lshift);
+                p = c.ext->clip;
+            }
+            if(shadowcubeintersect(*p, v, ray, f)) return dist+f;
         }
 
         FINDCLOSEST( , , );
@@ -1554,14 +1582,14 @@ bool moveplayer(physent *pl, int moveres, bool local, int curtime)
     {
         ScriptValuePtr scriptEntity = LogicSystem::getLogicEntity((dynent*)pl).get()->scriptEntity;
 
-        ScriptEngineManager::getGlobal()->getProperty("ApplicationManager")->getProperty("instance")->call(
+        static ScriptFunction* onEntityOffMap = ScriptEngineManager::getFunction(
 #ifdef CLIENT // INTENSITY
-                "clientOnEntityOffMap",
+                "ApplicationManager.instance.clientOnEntityOffMap"
 #else // SERVER
-                "onEntityOffMap",
+                "ApplicationManager.instance.onEntityOffMap"
 #endif
-            scriptEntity
         );
+        onEntityOffMap->call(ScriptArgs().append(scriptEntity));
     }
 #endif
 
@@ -779,9 +779,9 @@ void mousemove(int dx, int dy)
     // INTENSITY: Let scripts customize mousemoving
     if (ScriptEngineManager::hasEngine())
     {
-        ScriptValuePtr scriptMovement = ScriptEngineManager::getGlobal()->getProperty("ApplicationManager")->getProperty("instance")->call(
-            "performMousemove",
-            ScriptValueArgs().append(dx*cursens).append(-dy*cursens*(invmouse ? -1 : 1))
+        static ScriptFunction* performMousemove = ScriptEngineManager::getFunction("ApplicationManager.instance.performMousemove");
+        ScriptValuePtr scriptMovement = performMousemove->call(
+            ScriptArgs().append(dx*cursens).append(-dy*cursens*(invmouse ? -1 : 1))
         );
 
         if (scriptMovement->hasProperty("yaw"))
@@ -1843,8 +1843,9 @@ void drawcrosshair(int w, int h)
     else
     { 
         std::string crosshairName = ""; // INTENSITY: Start script-controlled crosshairs
+        static ScriptFunction* getCrosshair = ScriptEngineManager::getFunction("ApplicationManager.instance.getCrosshair");
         if (ScriptEngineManager::hasEngine())
-            crosshairName = ScriptEngineManager::getGlobal()->getProperty("ApplicationManager")->getProperty("instance")->call("getCrosshair")->getString();
+            crosshairName = getCrosshair->call()->getString();
         crosshair = textureload(crosshairName.c_str(), 3, true, false);
         if (crosshair == notexture) return;
         #if 0
@@ -402,8 +402,8 @@ void rendermapmodel(extentity &e)
     LogicEntityPtr entity = LogicSystem::getLogicEntity(e);
     if (!entity.get() || entity->isNone())
     {
-        Logging::log(Logging::ERROR, "Trying to show a missing mapmodel\r\n");
-        Logging::log(Logging::ERROR, "                                  %d\r\n", LogicSystem::getUniqueId(&e));
+        LOG(ERROR, "Trying to show a missing mapmodel\r\n");
+        LOG(ERROR, "                                  %d\r\n", LogicSystem::getUniqueId(&e));
         assert(0);
     }
     int anim     = entity.get()->getAnimation(); // ANIM_MAPMODEL|ANIM_LOOP
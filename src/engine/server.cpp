@@ -7,6 +7,7 @@
  // INTENSITY
 #include "network_system.h"
 #include "server_system.h"
+#include "message_system.h"
 #include "fpsclient_interface.h"
 #include "utility.h"
 #include "system_manager.h"
@@ -623,11 +624,17 @@ void show_server_stats()
     else
         printf("No activity to report\r\n");
 
+#ifdef SERVER
+    ServerSystem::showTickStats(); // INTENSITY
+#endif
+
     // Initialise
     laststatus = totalmillis;
     bsend = brec = 0;
 }
 
+void servicenetwork(uint timeout); // INTENSITY
+
 void serverslice(bool dedicated, uint timeout)   // main server update, called from main loop in sp, or from below in dedicated server
 {
     localclients = nonlocalclients = 0;
@@ -672,6 +679,13 @@ void serverslice(bool dedicated, uint timeout)   // main server update, called f
     }
 #endif
 
+    servicenetwork(timeout); // INTENSITY: Moved the event loop there, so the native server main loop can use it between ticks
+    if(server::sendpackets()) enet_host_flush(serverhost);
+}
+
+// INTENSITY: Handles network events, waiting up to 'timeout' ms for the first. Split out of serverslice
+void servicenetwork(uint timeout)
+{
     ENetEvent event;
     bool serviced = false;
     while(!serviced)
@@ -722,7 +736,6 @@ void serverslice(bool dedicated, uint timeout)   // main server update, called f
                 break;
         }
     }
-    if(server::sendpackets()) enet_host_flush(serverhost);
 }
 
 // INTENSITY: Added this, so we can flush out messages at will, e.g., login failure messages,
@@ -732,7 +745,7 @@ void force_network_flush()
 {
     if (!serverhost)
     {
-        Logging::log(Logging::ERROR, "Trying to force_flush, but no serverhost yet\r\n");
+        LOG(ERROR, "Trying to force_flush, but no serverhost yet\r\n");
         return;
     }
 
@@ -814,7 +827,7 @@ bool setuplistenserver(bool dedicated)
         // of the sort that standby mode is meant to prevent, but standby does not protect from this.
         // So, just wait to be manually restarted.
         //return servererror(dedicated, "could not create server host");
-        Logging::log(Logging::ERROR, "***!!! could not create server host (awaiting manual restart) !!!***");
+        LOG(ERROR, "***!!! could not create server host (awaiting manual restart) !!!***");
         return false;
     }
     loopi(maxclients) serverhost->peers[i].data = NULL;
@@ -947,6 +960,7 @@ void server_init()//int argc, char* argv[])
 
     fpsEntity->uniqueId = DUMMY_SINGLETON_CLIENT_UNIQUE_ID;
     FPSServerInterface::getUniqueId(0) = DUMMY_SINGLETON_CLIENT_UNIQUE_ID;
+    MessageSystem::Recipients::invalidate();
 }
 #endif // SERVER
 #endif // 0
@@ -955,17 +969,22 @@ void server_init()//int argc, char* argv[])
 // INTENSITY: Added this, the main slicing routine
 void server_runslice()
 {
-    serverslice(true, 5);
+    PROFILE("server_runslice");
 
-    // Kripken: Simulate the curtime parameter in Sauer.
-    double now = GET_PYTHON<double>("time.time()");
-    static double total_time = 0;
-    if (!total_time) // This prevents garbage on the very first call, since if total_time=0, then 1000*now overflows
-        total_time = now;
-    curtime = (long)(1000* (now - total_time) );
-    total_time = now;
+    serverslice(true, 0); // The main loop waits on the network between slices, see ServerSystem::mainLoop
+
+    // Kripken: Simulate the curtime parameter in Sauer. Time is from a monotonic clock, and the part of
+    // a millisecond that is left over is kept for the next slice, so that game time does not drift
+    static Profiler::Nanoseconds lastTime = 0;
+    Profiler::Nanoseconds now = Profiler::now();
+    if (!lastTime)
+        lastTime = now;
+    curtime = int((now - lastTime) / 1000000ULL);
+    lastTime += Profiler::Nanoseconds(curtime) * 1000000ULL;
 
     if(lastmillis) game::updateworld();
+
+    SystemManager::frameTrigger(curtime);
 }
 #endif
 
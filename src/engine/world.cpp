@@ -1213,6 +1213,7 @@ bool emptymap(int scale, bool force, const char *mname, bool usecfg)    // main
     
     texmru.setsize(0);
     freeocta(worldroot);
+    trimoctapools(); // INTENSITY
     worldroot = newcubes(F_EMPTY);
     loopi(4) solidfaces(worldroot[i]);
 
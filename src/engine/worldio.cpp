@@ -11,6 +11,10 @@
     #include "client_system.h"
 #endif
 #include "intensity_physics.h"
+#include "navigation.h"
+#ifdef SERVER
+    #include "map_cache.h"
+#endif
 
 
 void backup(char *name, char *backupname)
@@ -259,7 +263,7 @@ void loadc(stream *f, cube &c)
                     loopi(6) if(c.ext->mergeorigin&(1<<i)) nummerges++;
                     if(nummerges)
                     {
-                        c.ext->merges = new mergeinfo[nummerges];
+                        c.ext->merges = newoctaarray<mergeinfo>(nummerges); // INTENSITY
                         loopi(nummerges)
                         {
                             mergeinfo *m = &c.ext->merges[i];
@@ -575,6 +579,7 @@ bool load_world(const char *mname, const char *cname)        // still supports a
 
     freeocta(worldroot);
     worldroot = NULL;
+    trimoctapools(); // INTENSITY: Lay out the new octree contiguously
 
     setvar("mapsize", hdr.worldsize, true, false);
     int worldscale = 0;
@@ -666,6 +671,17 @@ bool load_world(const char *mname, const char *cname)        // still supports a
     }
 
     renderprogress(0, "loading octree...");
+#ifdef SERVER // INTENSITY: Load the decoded octree from our cache, if we can (the client needs the rest of the .ogz)
+    Profiler::Nanoseconds octreeStart = Profiler::now();
+    unsigned int mapCacheKey = 0;
+    bool useMapCache = MapCache::enabled() && MapCache::getKey(mapCacheKey);
+    if(useMapCache && MapCache::load(mapCacheKey, hdr.worldsize))
+    {
+        LOG(INFO, "World: Octree loaded from cache in %.2f ms\r\n", (Profiler::now() - octreeStart) / 1000000.0f);
+    }
+    else
+    {
+#endif
     worldroot = loadchildren(f);
 
 	if(hdr.version <= 11)
@@ -679,6 +695,11 @@ bool load_world(const char *mname, const char *cname)        // still supports a
 
     renderprogress(0, "validating...");
     validatec(worldroot, hdr.worldsize>>1);
+#ifdef SERVER // INTENSITY
+        LOG(INFO, "World: Octree loaded from %s in %.2f ms\r\n", ogzname, (Profiler::now() - octreeStart) / 1000000.0f);
+        if(useMapCache) MapCache::save(mapCacheKey, hdr.worldsize);
+    }
+#endif
 
 #ifdef CLIENT // INTENSITY: Server doesn't need lightmaps, pvs and blendmap (and current code for server wouldn't clean
               //            them up if we did read them, so would have a leak)
@@ -726,10 +747,10 @@ bool load_world(const char *mname, const char *cname)        // still supports a
    
 #ifdef CLIENT // INTENSITY: Stop, finish loading later when we have all the entities
     renderprogress(0, "requesting entities...");
-    Logging::log(Logging::DEBUG, "Requesting active entities...\r\n");
+    LOG(DEBUG, "Requesting active entities...\r\n");
     MessageSystem::send_ActiveEntitiesRequest(ClientSystem::currScenarioCode); // Ask for the NPCs and other players, which are not part of the map proper
 #else // SERVER
-    Logging::log(Logging::DEBUG, "Finishing loading of the world...\r\n");
+    LOG(DEBUG, "Finishing loading of the world...\r\n");
     finish_load_world();
 #endif
 
@@ -782,7 +803,9 @@ bool finish_load_world() // INTENSITY: Second half, after all entities received
 
     startmap(cname ? cname : mname);
     
-    Logging::log(Logging::DEBUG, "load_world complete.\r\n"); // INTENSITY
+    NavigationSystem::load(); // INTENSITY
+
+    LOG(DEBUG, "load_world complete.\r\n"); // INTENSITY
     WorldSystem::loadingWorld = false; // INTENSITY
 
     delete saved_hdr; // INTENSITY
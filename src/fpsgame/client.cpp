@@ -55,7 +55,7 @@ namespace game
 
     void gamedisconnect(bool cleanup)
     {
-        Logging::log(Logging::DEBUG, "client.h: gamedisconnect()\r\n");
+        LOG(DEBUG, "client.h: gamedisconnect()\r\n");
 //        if(remote) stopfollowing(); Kripken
         connected = false;
         player1->clientnum = -1;
@@ -63,7 +63,7 @@ namespace game
         player1->privilege = PRIV_NONE;
         spectator = false;
 //        loopv(players) if(players[i]) clientdisconnected(i, false); Kripken: When we disconnect, we should shut down anyhow...
-        Logging::log(Logging::WARNING, "Not doing normal Sauer disconnecting of other clients\r\n");
+        LOG(WARNING, "Not doing normal Sauer disconnecting of other clients\r\n");
 
         #ifdef CLIENT
             ClientSystem::onDisconnect();
@@ -171,7 +171,7 @@ namespace game
 
     void addmsg(int type, const char *fmt, ...)
     {
-        Logging::log(Logging::INFO, "Client: ADDMSG: adding a message of type %d\r\n", type);
+        LOG(INFO, "Client: ADDMSG: adding a message of type %d\r\n", type);
 
         if(!connected) return;
         static uchar buf[MAXTRANS];
@@ -286,7 +286,7 @@ namespace game
 
     void sendposition(fpsent *d)
     {
-        Logging::log(Logging::INFO, "sendposition?, %d)\r\n", curtime);
+        LOG(INFO, "sendposition?, %d)\r\n", curtime);
 
 //        if(d->state==CS_ALIVE || d->state==CS_EDITING) // Kripken: We handle death differently.
 //        {
@@ -296,7 +296,7 @@ namespace game
         if (d->uniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID)
 #endif
         {
-            Logging::log(Logging::INFO, "sendpacketclient: Sending for client %d: %f,%f,%f\r\n",
+            LOG(INFO, "sendpacketclient: Sending for client %d: %f,%f,%f\r\n",
                                          d->clientnum, d->o.x, d->o.y, d->o.z);
 
             // send position updates separately so as to not stall out aiming
@@ -341,9 +341,10 @@ namespace game
     {
         static int lastupdate = -1000;
 
-        Logging::log(Logging::INFO, "c2sinfo: %d,%d\r\n", totalmillis, lastupdate);
+        LOG(INFO, "c2sinfo: %d,%d\r\n", totalmillis, lastupdate);
 
-        int rate = Utility::Config::getInt("Network", "rate", 33);
+        static Utility::Config::Int rateConfig("Network", "rate", 33);
+        int rate = rateConfig.get();
         if(totalmillis - lastupdate < rate) return;    // don't update faster than the rate
         lastupdate = totalmillis;
 
@@ -412,6 +413,18 @@ namespace game
                 break;
             }
 
+            case SV_POSKEYFRAME:                // delta-compressed position of another client
+            case SV_POSDELTA:
+            {
+                NetworkSystem::PositionUpdater::QuantizedInfo info;
+                if (NetworkSystem::PositionUpdater::DeltaCompression::decode(type, p, info))
+                    info.applyToEntity();
+                else
+                    LOG(INFO, "Ignoring delta position update for client %d, no baseline\r\n", info.clientNumber);
+
+                break;
+            }
+
             default:
                 neterr("positions-type");
                 return;
@@ -420,7 +433,9 @@ namespace game
 
     void parsepacketclient(int chan, packetbuf &p)   // processes any updates from the server
     {
-        Logging::log(Logging::INFO, "Client: Receiving packet, channel: %d\r\n", chan);
+        PROFILE("parsepacketclient");
+
+        LOG(INFO, "Client: Receiving packet, channel: %d\r\n", chan);
 
         switch(chan)
         {   // Kripken: channel 0 is just positions, for as-fast-as-possible position updates. We do not want to change this.
@@ -454,7 +469,7 @@ namespace game
         while(p.remaining())
         {
           type = getint(p);
-          Logging::log(Logging::INFO, "Client: Parsing a message of type %d\r\n", type);
+          LOG(INFO, "Client: Parsing a message of type %d\r\n", type);
           switch(type)
           { // Kripken: Mangling sauer indentation as little as possible
 
@@ -497,7 +512,7 @@ namespace game
             {
 //                if(!d) return; Kripken: We can get edit commands from the server, which has no 'd' to speak of XXX FIXME - might be buggy
 
-                Logging::log(Logging::DEBUG, "Edit command intercepted in client.h\r\n");
+                LOG(DEBUG, "Edit command intercepted in client.h\r\n");
 
                 selinfo sel;
                 sel.o.x = getint(p); sel.o.y = getint(p); sel.o.z = getint(p);
@@ -517,7 +532,7 @@ namespace game
                         #ifdef CLIENT
                             tex = getint(p); allfaces = getint(p); mpedittex(tex, allfaces, sel, false); break;
                         #else // SERVER
-                            getint(p); getint(p); Logging::log(Logging::DEBUG, "Server ignoring texture change (a)\r\n"); break;
+                            getint(p); getint(p); LOG(DEBUG, "Server ignoring texture change (a)\r\n"); break;
                         #endif
                     case SV_EDITM: mat = getint(p); filter = getint(p); mpeditmat(mat, filter, sel, false); break;
                     case SV_FLIP: mpflip(sel, false); break;
@@ -528,7 +543,7 @@ namespace game
                         #ifdef CLIENT
                             tex = getint(p); newtex = getint(p); mpreplacetex(tex, newtex, sel, false); break;
                         #else // SERVER
-                            getint(p); getint(p); Logging::log(Logging::DEBUG, "Server ignoring texture change (b)\r\n"); break;
+                            getint(p); getint(p); LOG(DEBUG, "Server ignoring texture change (b)\r\n"); break;
                         #endif
                     case SV_DELCUBE: mpdelcube(sel, false); break;
                 }
@@ -571,7 +586,7 @@ assert(0); // Kripken: Do not let clients know other clients' pings
 
             default:
             {
-                Logging::log(Logging::INFO, "Client: Handling a non-typical message: %d\r\n", type);
+                LOG(INFO, "Client: Handling a non-typical message: %d\r\n", type);
 #ifdef CLIENT
                 if (!MessageSystem::MessageManager::receive(type, ClientSystem::playerNumber, cn, p))
 #else
@@ -591,7 +606,7 @@ assert(0); // Kripken: Do not let clients know other clients' pings
 
     void changemap(const char *name, int mode)        // forced map change from the server // Kripken : TODO: Deprecated, Remove
     {
-        Logging::log(Logging::INFO, "Client: Changing map: %s\r\n", name);
+        LOG(INFO, "Client: Changing map: %s\r\n", name);
 
         mode = 0;
         gamemode = mode;
@@ -606,7 +621,7 @@ assert(0); // Kripken: Do not let clients know other clients' pings
 
     void changemap(const char *name) // request map change, server may ignore
     {
-        Logging::log(Logging::INFO, "Client: Requesting map: %s\r\n", name);
+        LOG(INFO, "Client: Requesting map: %s\r\n", name);
 
         if(spectator && !player1->privilege) return;
 //        int nextmode = nextmode; // in case stopdemo clobbers nextmode
@@ -634,7 +649,7 @@ assert(0); // Kripken: Do not let clients know other clients' pings
 
     void connectattempt(const char *name, const char *password, const ENetAddress &address)
     {
-        Logging::log(Logging::DEBUG, "Connect attempt\r\n");
+        LOG(DEBUG, "Connect attempt\r\n");
     }
 
     void connectfail()
@@ -654,7 +669,7 @@ assert(0); // Kripken: Do not let clients know other clients' pings
 #ifdef CLIENT
         if(!ClientSystem::isAdmin())
         {
-            Logging::log(Logging::WARNING, "vartrigger invalid\r\n");
+            LOG(WARNING, "vartrigger invalid\r\n");
             return;
         }
 #endif
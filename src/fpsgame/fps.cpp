@@ -206,7 +206,7 @@ namespace game
                     continue; // On the server, 'other players' are only PCs
             #endif
 
-            Logging::log(Logging::INFO, "otherplayers: moving %d from %f,%f,%f\r\n", d->uniqueId, d->o.x, d->o.y, d->o.z);
+            LOG(INFO, "otherplayers: moving %d from %f,%f,%f\r\n", d->uniqueId, d->o.x, d->o.y, d->o.z);
 
             if(d->state==CS_ALIVE)
             {
@@ -249,7 +249,7 @@ namespace game
             }
             else if(d->state==CS_DEAD && lastmillis-d->lastpain<2000) moveplayer(d, 1, true);
 
-            Logging::log(Logging::INFO, "                                      to %f,%f,%f\r\n", d->o.x, d->o.y, d->o.z);
+            LOG(INFO, "                                      to %f,%f,%f\r\n", d->o.x, d->o.y, d->o.z);
 
 #if (SERVER_DRIVEN_PLAYERS == 1)
             // Enable this to let server drive client movement
@@ -272,7 +272,7 @@ namespace game
 
             if ( ClientSystem::playerLogicEntity.get()->scriptEntity->getPropertyBool("initialized") )
             {
-                Logging::log(Logging::INFO, "Player %d (%lu) is initialized, run moveplayer(): %f,%f,%f.\r\n",
+                LOG(INFO, "Player %d (%lu) is initialized, run moveplayer(): %f,%f,%f.\r\n",
                     player1->uniqueId, (unsigned long)player1,
                     player1->o.x,
                     player1->o.y,
@@ -290,7 +290,7 @@ namespace game
                 moveplayer(player1, 10, true); // Disable this to stop play from moving by client command
 #endif
 
-                Logging::log(Logging::INFO, "                              moveplayer(): %f,%f,%f.\r\n",
+                LOG(INFO, "                              moveplayer(): %f,%f,%f.\r\n",
                     player1->o.x,
                     player1->o.y,
                     player1->o.z
@@ -299,10 +299,10 @@ namespace game
                 swayhudgun(curtime);
                 entities::checkitems(player1);
             } else
-                Logging::log(Logging::INFO, "Player is not yet initialized, do not run moveplayer() etc.\r\n");
+                LOG(INFO, "Player is not yet initialized, do not run moveplayer() etc.\r\n");
         }
         else
-            Logging::log(Logging::INFO, "Player does not yet exist, or scenario not started, do not run moveplayer() etc.\r\n");
+            LOG(INFO, "Player does not yet exist, or scenario not started, do not run moveplayer() etc.\r\n");
         
 #else // SERVER
     #if 1
@@ -323,7 +323,7 @@ namespace game
             // Apply physics to actually move the player
             moveplayer(npc, 10, false); // FIXME: Use Config param for resolution and local. 1, false does seem ok though
 
-            Logging::log(Logging::INFO, "updateworld, server-controlled client %d: moved to %f,%f,%f\r\n", i,
+            LOG(INFO, "updateworld, server-controlled client %d: moved to %f,%f,%f\r\n", i,
                                             npc->o.x, npc->o.y, npc->o.z);
 
             //?? Dummy singleton still needs to send the messages vector. XXX - do we need this even without NPCs? XXX - works without it
@@ -337,7 +337,7 @@ namespace game
 
     void updateworld()        // main game update loop
     {
-        Logging::log(Logging::INFO, "updateworld(?, %d)\r\n", curtime);
+        LOG(INFO, "updateworld(?, %d)\r\n", curtime);
         INDENT_LOG(Logging::INFO);
 
         // SERVER used to initialize turn_move, move, look_updown_move and strafe to 0 for NPCs here
@@ -357,13 +357,14 @@ namespace game
 #else
         bool runWorld = ScriptEngineManager::hasEngine();
 #endif
-        static Benchmarker physicsBenchmarker;
+        PROFILE("updateworld");
 
         //===================
         // Run physics
         //===================
 
-        physicsBenchmarker.start();
+        {
+            PROFILE("physics");
 
             if (runWorld)
             {
@@ -374,8 +375,9 @@ namespace game
                 //============================================
 
                 // If triggering collisions can be done by the scripting library code, use that
+                static ScriptFunction* manageTriggeringCollisions = ScriptEngineManager::getFunction("manageTriggeringCollisions");
                 if (ScriptEngineManager::getGlobal()->hasProperty("manageTriggeringCollisions"))
-                    ScriptEngineManager::getGlobal()->call("manageTriggeringCollisions");
+                    manageTriggeringCollisions->call();
                 else
                 {
                     loopv(players)
@@ -391,23 +393,24 @@ namespace game
                     }
                 }
             }
-
-        physicsBenchmarker.stop();
+        }
 
         //==============================================
         // Manage actions
         // Done after physics, so can override physics
         //==============================================
 
-        static Benchmarker actionsBenchmarker;
-        actionsBenchmarker.start();
+        {
+            PROFILE("actions");
+
             if (runWorld)
             {
-                ScriptEngineManager::getGlobal()->call("startFrame");
+                static ScriptFunction* startFrame = ScriptEngineManager::getFunction("startFrame");
+                startFrame->call();
 
                 LogicSystem::manageActions(curtime);
             }
-        actionsBenchmarker.stop();
+        }
 
 #ifdef CLIENT
         //================================================================
@@ -428,9 +431,6 @@ namespace game
 #else // SERVER
         c2sinfo(); // Send all the info for all the NPCs
 #endif
-
-        SystemManager::showBenchmark("Physics", physicsBenchmarker);
-        SystemManager::showBenchmark("                    Actions", actionsBenchmarker);
     }
 
     void spawnplayer(fpsent *d)   // place at random spawn. also used by monsters!
@@ -470,7 +470,7 @@ namespace game
 
     fpsent *newclient(int cn)   // ensure valid entity
     {
-        Logging::log(Logging::DEBUG, "fps::newclient: %d\r\n", cn);
+        LOG(DEBUG, "fps::newclient: %d\r\n", cn);
 
         if(cn < 0 || cn > max(0xFF, MAXCLIENTS)) // + MAXBOTS))
         {
@@ -507,7 +507,7 @@ namespace game
 
     void clientdisconnected(int cn, bool notify)
     {
-        Logging::log(Logging::DEBUG, "fps::clientdisconnected: %d\r\n", cn);
+        LOG(DEBUG, "fps::clientdisconnected: %d\r\n", cn);
 
         if(!clients.inrange(cn)) return;
         if(following==cn)
@@ -649,12 +649,12 @@ namespace game
    
     void drawhudmodel(fpsent *d, int anim, float speed = 0, int base = 0)
     {
-        Logging::log(Logging::WARNING, "Rendering hudmodel is deprecated for now\r\n");
+        LOG(WARNING, "Rendering hudmodel is deprecated for now\r\n");
     }
 
     void drawhudgun()
     {
-        Logging::log(Logging::WARNING, "Rendering hudgun is deprecated for now\r\n");
+        LOG(WARNING, "Rendering hudgun is deprecated for now\r\n");
     }
 
     void drawicon(float tx, float ty, int x, int y)
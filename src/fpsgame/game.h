@@ -98,12 +98,13 @@ enum
     SV_ADDBOT, SV_DELBOT, SV_INITAI, SV_FROMAI, SV_BOTLIMIT, SV_BOTBALANCE,
     SV_MAPCRC, SV_CHECKMAPS,
     SV_SWITCHNAME, SV_SWITCHMODEL, SV_SWITCHTEAM,
+    SV_POSKEYFRAME, SV_POSDELTA, // INTENSITY: Delta-compressed position updates, see NetworkSystem::PositionUpdater::DeltaCompression
     NUMSV
 };
 
 #define SAUERBRATEN_SERVER_PORT 28787
 #define SAUERBRATEN_SERVINFO_PORT 28789
-#define PROTOCOL_VERSION 1000           // bump when protocol changes
+#define PROTOCOL_VERSION 1003           // bump when protocol changes
 #define DEMO_VERSION 1                  // bump when demo format changes
 #define DEMO_MAGIC "SAUERBRATEN_DEMO"
 
@@ -19,7 +19,7 @@ namespace game
         if (!ClientSystem::loggedIn) // If not logged in remotely, do not render, because entities lack all the fields like model_name
                                      // in the future, perhaps add these, if we want local rendering
         {
-            Logging::log(Logging::INFO, "Not logged in remotely, so not rendering\r\n");
+            LOG(INFO, "Not logged in remotely, so not rendering\r\n");
             return;
         }
 
@@ -35,7 +35,7 @@ namespace game
         }
         if(isthirdperson() && !followingplayer())
         {
-            Logging::log(Logging::INFO, "Rendering self\r\n");
+            LOG(INFO, "Rendering self\r\n");
             CharacterRendering::render(player1); // INTENSITY
         }
 
@@ -52,7 +52,8 @@ namespace game
 //        fpsent *exclude = isthirdperson() ? NULL : followingplayer(), *d; // XXX: Apply this!
 //        if(isthirdperson() && !followingplayer()) // XXX Apply this!
 
-        ScriptEngineManager::getGlobal()->call("renderDynamic", isthirdperson());
+        static ScriptFunction* renderDynamic = ScriptEngineManager::getFunction("renderDynamic");
+        renderDynamic->call(ScriptArgs().append(isthirdperson()));
 #endif
 
 //        ExtraRendering::renderShadowingMapmodels(); // Kripken: Mapmodels with dynamic shadows, we draw them now
@@ -80,7 +81,8 @@ namespace game
 
     void renderavatar()
     {
-        ScriptEngineManager::getGlobal()->call("renderHUDModels");
+        static ScriptFunction* renderHUDModels = ScriptEngineManager::getFunction("renderHUDModels");
+        renderHUDModels->call();
     }
 }
 
@@ -283,7 +283,7 @@ namespace server
         static int servtypes[] = { SV_SERVINFO, SV_INITCLIENT, SV_WELCOME, SV_MAPRELOAD, SV_SERVMSG, SV_DAMAGE, SV_HITPUSH, SV_SHOTFX, SV_DIED, SV_SPAWNSTATE, SV_FORCEDEATH, SV_ITEMACC, SV_ITEMSPAWN, SV_TIMEUP, SV_CDIS, SV_CURRENTMASTER, SV_PONG, SV_RESUME, SV_BASESCORE, SV_BASEINFO, SV_BASEREGEN, SV_ANNOUNCE, SV_SENDDEMOLIST, SV_SENDDEMO, SV_DEMOPLAYBACK, SV_SENDMAP, SV_DROPFLAG, SV_SCOREFLAG, SV_RETURNFLAG, SV_RESETFLAG, SV_INVISFLAG, SV_CLIENT, SV_AUTHCHAL, SV_INITAI };
         if(ci) loopi(sizeof(servtypes)/sizeof(int)) if(type == servtypes[i])
         {
-            Logging::log(Logging::ERROR, "checktype has decided to return -1 for %d\r\n", type);
+            LOG(ERROR, "checktype has decided to return -1 for %d\r\n", type);
             return -1;
         }
         return type;
@@ -307,6 +307,8 @@ namespace server
 
     bool buildworldstate()
     {
+        PROFILE("buildworldstate");
+
         static struct { int posoff, msgoff, msglen; } pkt[MAXCLIENTS];
         worldstate &ws = *new worldstate;
 
@@ -317,7 +319,7 @@ namespace server
             if(ci.position.empty()) pkt[i].posoff = -1;
             else
             {
-                Logging::log(Logging::INFO, "SERVER: prepping relayed SV_POS data for sending %d, size: %d\r\n", ci.clientnum,
+                LOG(INFO, "SERVER: prepping relayed SV_POS data for sending %d, size: %d\r\n", ci.clientnum,
                              ci.position.length());
 
                 pkt[i].posoff = ws.positions.length();
@@ -339,7 +341,7 @@ namespace server
             }
         }
 
-        Logging::log(Logging::INFO, "SERVER: prepping sum of relayed data for sending, size: %d,%d\r\n", ws.positions.length(), ws.messages.length());
+        LOG(INFO, "SERVER: prepping sum of relayed data for sending, size: %d,%d\r\n", ws.positions.length(), ws.messages.length());
 
         int psize = ws.positions.length(), msize = ws.messages.length();
 //        if(psize) recordpacket(0, ws.positions.getbuf(), psize);
@@ -348,11 +350,24 @@ namespace server
         loopi(msize) { uchar c = ws.messages[i]; ws.messages.add(c); }
         ws.uses = 0;
 
+        // Kripken: With interest management, each client gets its own subset of the positions, built below
+        bool interestManaged = psize && NetworkSystem::PositionUpdater::InterestManager::enabled();
+        if (interestManaged)
+        {
+            NetworkSystem::PositionUpdater::InterestManager::startRound();
+            loopv(clients)
+            {
+                clientinfo &ci = *clients[i];
+                if (!ci.position.empty())
+                    NetworkSystem::PositionUpdater::InterestManager::addSource(ci.clientnum, ci.position);
+            }
+        }
+
         loopv(clients)
         {
             clientinfo &ci = *clients[i];
 
-            Logging::log(Logging::INFO, "Processing update relaying for %d:%d\r\n", ci.clientnum, ci.uniqueId);
+            LOG(INFO, "Processing update relaying for %d:%d\r\n", ci.clientnum, ci.uniqueId);
 
 #ifdef SERVER
             // Kripken: FIXME: Send position updates only to real clients, not local ones. For multiple local
@@ -366,14 +381,31 @@ namespace server
             {
 
                 ENetPacket *packet;
-                if(psize && (pkt[i].posoff<0 || psize-ci.position.length()>0))
+                if(interestManaged)
+                {
+                    static vector<uchar> relevant;
+                    relevant.setsizenodelete(0);
+                    NetworkSystem::PositionUpdater::InterestManager::appendRelevantPositions(ci.clientnum, relevant);
+                    if(relevant.length())
+                    {
+                        // Kripken: Unique to this client, so ENet copies it, and the worldstate need not track it
+                        packet = enet_packet_create(relevant.getbuf(), relevant.length(), 0);
+
+                        LOG(INFO, "Sending interest-managed positions packet to %d, size: %d\r\n",
+                                     ci.clientnum, relevant.length());
+
+                        sendpacket(ci.clientnum, 0, packet);
+                        if(!packet->referenceCount) enet_packet_destroy(packet);
+                    }
+                }
+                else if(psize && (pkt[i].posoff<0 || psize-ci.position.length()>0))
                 {
                     // Kripken: Trickery with offsets here prevents relaying back to the same client. Ditto below
                     packet = enet_packet_create(&ws.positions[pkt[i].posoff<0 ? 0 : pkt[i].posoff+ci.position.length()], 
                                                 pkt[i].posoff<0 ? psize : psize-ci.position.length(), 
                                                 ENET_PACKET_FLAG_NO_ALLOCATE);
 
-                    Logging::log(Logging::INFO, "Sending positions packet to %d\r\n", ci.clientnum);
+                    LOG(INFO, "Sending positions packet to %d\r\n", ci.clientnum);
 
                     sendpacket(ci.clientnum, 0, packet); // Kripken: Sending queue of position changes, in channel 0?
 
@@ -387,7 +419,7 @@ namespace server
                                                 pkt[i].msgoff<0 ? msize : msize-pkt[i].msglen, 
                                                 (reliablemessages ? ENET_PACKET_FLAG_RELIABLE : 0) | ENET_PACKET_FLAG_NO_ALLOCATE);
 
-                    Logging::log(Logging::INFO, "Sending messages packet to %d\r\n", ci.clientnum);
+                    LOG(INFO, "Sending messages packet to %d\r\n", ci.clientnum);
 
                     sendpacket(ci.clientnum, 1, packet);
                     if(!packet->referenceCount) enet_packet_destroy(packet);
@@ -422,13 +454,16 @@ namespace server
         enet_uint32 curtime = enet_time_get()-lastsend;
         if(curtime<33) return false; // kripken: Server sends packets at most every 33ms? FIXME: fast rate, we might slow or dynamic this
         bool flush = buildworldstate();
+        if (MessageSystem::StateDataBatching::flush()) flush = true;
         lastsend += curtime - (curtime%33);
         return flush;
     }
 
     void parsepacket(int sender, int chan, packetbuf &p)     // has to parse exactly each byte of the packet
     {
-        Logging::log(Logging::INFO, "Server: Parsing packet, %d-%d\r\n", sender, chan);
+        PROFILE("parsepacket");
+
+        LOG(INFO, "Server: Parsing packet, %d-%d\r\n", sender, chan);
 
         if(sender<0) return;
         if(chan==2) // Kripken: Channel 2 is, just like with the client, for file transfers
@@ -440,7 +475,7 @@ namespace server
         int cn = -1, type;
         clientinfo *ci = sender>=0 ? (clientinfo *)getinfo(sender) : NULL;
 
-        if (ci == NULL) Logging::log(Logging::ERROR, "ci is null. Sender: %ld\r\n", (long) sender); // Kripken
+        if (ci == NULL) LOG(ERROR, "ci is null. Sender: %ld\r\n", (long) sender); // Kripken
 
         // Kripken: QUEUE_MSG puts the incoming message into the out queue. So after the server parses it,
         // it sends it to all *other* clients. This is in tune with the server-as-a-relay-server approach in Sauer.
@@ -463,7 +498,7 @@ namespace server
         while((curmsg = p.length()) < p.maxlen)
         {
           type = checktype(getint(p), ci);  // kripken: checks type is valid for situation
-          Logging::log(Logging::INFO, "Server: Parsing a message of type %d\r\n", type);
+          LOG(INFO, "Server: Parsing a message of type %d\r\n", type);
           switch(type)
           { // Kripken: Mangling sauer indentation as little as possible
             case SV_POS: // Kripken: position update for a client
@@ -487,19 +522,15 @@ namespace server
                 //if(!ci->local) // Kripken: We relay even our local clients, PCs need to hear about NPC positions
                 // && (ci->state.state==CS_ALIVE || ci->state.state==CS_EDITING)) // Kripken: We handle death differently
                 {
-                    Logging::log(Logging::INFO, "SERVER: relaying SV_POS data for client %d\r\n", cn);
+                    LOG(INFO, "SERVER: relaying SV_POS data for client %d\r\n", cn);
 
                     // Modify the info depending on various server parameters
                     NetworkSystem::PositionUpdater::processServerPositionReception(info);
 
-                    // Queue the info to be sent to the clients
-                    int maxLength = p.length()*2 + 100; // Kripken: The server almost always DECREASES the size, but be careful
-                    unsigned char* data = new unsigned char[maxLength];
-                    ucharbuf temp(data, maxLength);
-                    info.applyToBuffer(temp);
+                    // Queue the info to be sent to the clients. Encoded directly into the client's
+                    // buffer, whose storage is reused between updates
                     ci->position.setsizenodelete(0);
-                    loopk(temp.length()) ci->position.add(temp.buf[k]);
-                    delete[] data;
+                    info.applyToBuffer(ci->position);
                 }
 //                if(smode && ci->state.state==CS_ALIVE) smode->moved(ci, oldpos, ci->state.o); // Kripken:Gametype(ctf etc.)-specific stuff
                 break;
@@ -513,10 +544,10 @@ namespace server
                 REFLECT_PYTHON( signal_text_message );
                 signal_text_message(sender, text);
 
+                static ScriptFunction* handleTextMessage = ScriptEngineManager::getFunction("ApplicationManager.instance.handleTextMessage");
                 if (!ScriptEngineManager::hasEngine() ||
-                    !ScriptEngineManager::getGlobal()->getProperty("ApplicationManager")->getProperty("instance")->call(
-                        "handleTextMessage",
-                        ScriptValueArgs().append(ci->uniqueId).append(std::string(text))
+                    !handleTextMessage->call(
+                        ScriptArgs().append(ci->uniqueId).append(std::string(text))
                     )->getBool())
                 {
                     // No engine, or script did not completely handle this message, so relay it the normal way
@@ -537,10 +568,10 @@ namespace server
 
             default:
             {
-                Logging::log(Logging::DEBUG, "Server: Handling a non-typical message: %d\r\n", type);
+                LOG(DEBUG, "Server: Handling a non-typical message: %d\r\n", type);
                 if (!MessageSystem::MessageManager::receive(type, -1, sender, p))
                 {
-                    Logging::log(Logging::DEBUG, "Relaying Sauer protocol message: %d\r\n", type);
+                    LOG(DEBUG, "Relaying Sauer protocol message: %d\r\n", type);
 
                     int size = msgsizelookup(type);
                     if(size==-1) { disconnect_client(sender, DISC_TAGT); return; }
@@ -550,7 +581,7 @@ namespace server
 
                     if(ci && ci->state.state!=CS_SPECTATOR) QUEUE_MSG;
 
-                    Logging::log(Logging::DEBUG, "Relaying complete\r\n");
+                    LOG(DEBUG, "Relaying complete\r\n");
                 }
                 break;
             }
@@ -597,11 +628,15 @@ namespace server
         clientinfo *ci = (clientinfo *)getinfo(n);
         if(smode) smode->leavegame(ci, true);
         clients.removeobj(ci);
+        MessageSystem::Recipients::invalidate();
+
+        NetworkSystem::PositionUpdater::InterestManager::clientDisconnected(n);
+        MessageSystem::StateDataBatching::clientDisconnected(n);
     }
 
     void setAdmin(int clientNumber, bool isAdmin)
     {
-        Logging::log(Logging::DEBUG, "setAdmin for client %d\r\n", clientNumber);
+        LOG(DEBUG, "setAdmin for client %d\r\n", clientNumber);
 
         clientinfo *ci = (clientinfo *)getinfo(clientNumber);
         if (!ci) return; // May have been kicked just before now
@@ -642,7 +677,7 @@ namespace server
 //                                         // pending login. Also, they will create their own entities when
 //                                         // the login finishes, so it would be a bug to do it here as well.
 
-                Logging::log(Logging::DEBUG, "scriptingEntities creation: Adding %d\r\n", i);
+                LOG(DEBUG, "scriptingEntities creation: Adding %d\r\n", i);
 
                 createScriptingEntity(i);
             }
@@ -653,7 +688,7 @@ namespace server
         clientinfo *ci = (clientinfo *)getinfo(cn);
         if (!ci)
         {
-            Logging::log(Logging::WARNING, "Asked to create a player entity for %d, but no clientinfo (perhaps disconnected meanwhile)\r\n", cn);
+            LOG(WARNING, "Asked to create a player entity for %d, but no clientinfo (perhaps disconnected meanwhile)\r\n", cn);
             return ScriptEngineManager::getNull();
         }
 
@@ -661,7 +696,7 @@ namespace server
         if (fpsEntity)
         {
             // Already created an entity
-            Logging::log(Logging::WARNING, "createScriptingEntity(%d): already have fpsEntity, and hence scripting entity. Kicking.\r\n", cn);
+            LOG(WARNING, "createScriptingEntity(%d): already have fpsEntity, and hence scripting entity. Kicking.\r\n", cn);
             disconnect_client(cn, DISC_KICK);
             return ScriptEngineManager::getNull();
         }
@@ -670,7 +705,7 @@ namespace server
         if (_class == "")
              _class = ScriptEngineManager::runScript("ApplicationManager.instance.getPcClass()")->getString();
 
-        Logging::log(Logging::DEBUG, "Creating player entity: %s, %d", _class.c_str(), cn);
+        LOG(DEBUG, "Creating player entity: %s, %d", _class.c_str(), cn);
 
         int uniqueId = ScriptEngineManager::runScript("getNewUniqueId()")->getInt();
 
@@ -704,6 +739,7 @@ namespace server
             assert(fpsEntity);
 
             fpsEntity->serverControlled = true; // Mark this as an NPC the server should control
+            MessageSystem::Recipients::invalidate();
 
             FPSClientInterface::spawnPlayer(fpsEntity);
         }
@@ -714,7 +750,7 @@ namespace server
 
     int clientconnect(int n, uint ip)
     {
-        Logging::log(Logging::DEBUG, "server::clientconnect: %d\r\n", n);
+        LOG(DEBUG, "server::clientconnect: %d\r\n", n);
 
 /*
 // XXX This is a useful thing to test crashes on logins at odd times. See 'already have fpsEntity, and hence scripting entity'
@@ -729,6 +765,7 @@ if (i == 0) {
         clientinfo *ci = (clientinfo *)getinfo(n);
         ci->clientnum = n;
         clients.add(ci);
+        MessageSystem::Recipients::invalidate();
 
 //        FPSClientInterface::newClient(n); // INTENSITY: Also connect to the server's internal client - XXX NO - do in parallel to client
 
@@ -740,13 +777,15 @@ if (i == 0) {
 
     void clientdisconnect(int n) 
     { 
-        Logging::log(Logging::DEBUG, "server::clientdisconnect: %d\r\n", n);
+        LOG(DEBUG, "server::clientdisconnect: %d\r\n", n);
         INDENT_LOG(Logging::DEBUG);
 
         clientinfo *ci = (clientinfo *)getinfo(n);
         if(smode) smode->leavegame(ci, true);
         clients.removeobj(ci);
 
+        NetworkSystem::PositionUpdater::InterestManager::clientDisconnected(n);
+
         REFLECT_PYTHON( on_logout );
         on_logout(n);
     }
@@ -829,6 +868,8 @@ if (i == 0) {
     void serverupdate()
     {
         gamemillis += curtime;
+
+        MessageSystem::Recipients::invalidate();
     }
 
     void recordpacket(int chan, void *data, int len)
@@ -113,10 +113,20 @@ namespace MessageSystem
             # Generate param string (for sendf, and full - for parameters to send())
             param_string      = ''
             param_string_full = ''
+            has_buffer = False
             for param_type, param_name in params:
-                param_string_full = param_string_full + param_type + " " + param_name + ", "
+                if param_type == 'vector<uchar>':
+                    param_string_full = param_string_full + param_type + " &" + param_name + ", "
+                else:
+                    param_string_full = param_string_full + param_type + " " + param_name + ", "
                 if param_type == 'std::string':
                     param_string = param_string + 's'
+                elif param_type == 'vector<uchar>':
+                    if direction == "client->server":
+                        print "Error, buffers can only be sent from the server:", param_name
+                        1/0.
+                    param_string = param_string + 'im' # Length, then the raw bytes
+                    has_buffer = True
                 elif param_type in [ 'bool', 'int', 'float' ]:
                     if param_type != 'int' or param_name != 'clientNumber': # int clientNumber is implicit
                         param_string = param_string + 'i'
@@ -182,7 +192,7 @@ void send_%s(%s);
 
             if direction == "client->server":
                 send = send + """
-        Logging::log(Logging::DEBUG, "Sending a message of type %s (%s)\\r\\n");
+        LOG(DEBUG, "Sending a message of type %s (%s)\\r\\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(%s, "%s%s", """ % (name, type_code, type_code, 'r' if reliable else '', param_string)
@@ -200,66 +210,77 @@ void send_%s(%s);
                     print "Bad direction:", direction
                     1/0.
                 
+                recipient_kinds = "MessageSystem::Recipients::REMOTE"
+                if dummy_server_string == "true":
+                    recipient_kinds = recipient_kinds + " | MessageSystem::Recipients::DUMMY"
+                if all_npcs_string == "true":
+                    recipient_kinds = recipient_kinds + " | MessageSystem::Recipients::NPC"
+
+                # Arguments for sendf, and the equivalent direct encoding into a buffer, for broadcasts
+                sendf_args = ""
+                encode_params = ""
+                for param_type, param_name in params:
+                    if param_type == 'int' and param_name == 'clientNumber': # Implicit, not sent
+                        continue
+
+                    if param_type == "std::string":
+                        sendf_args = sendf_args + "%s.c_str(), " % param_name
+                        encode_params = encode_params + "            sendstring(%s.c_str(), buf);\n" % param_name
+                    elif param_type == "float":
+                        sendf_args = sendf_args + "int(%s*DMF), " % param_name
+                        encode_params = encode_params + "            putint(buf, int(%s*DMF));\n" % param_name
+                    elif param_type == "vector<uchar>":
+                        sendf_args = sendf_args + "%s.length(), %s.length(), %s.getbuf(), " % (param_name, param_name, param_name)
+                        encode_params = encode_params + "            putint(buf, %s.length());\n            buf.put(%s.getbuf(), %s.length());\n" % (param_name, param_name, param_name)
+                    else:
+                        sendf_args = sendf_args + "%s, " % param_name
+                        encode_params = encode_params + "            putint(buf, %s);\n" % param_name
+                sendf_args = sendf_args[:-2]
+
+                # Queued state data updates must not arrive after later reliable messages (e.g., an entity's
+                # state after its removal), so flush them first
+                flush_batched = ""
+                if reliable:
+                    flush_batched = "        StateDataBatching::flushReliable();\n\n"
+
                 send = """
-        Logging::log(Logging::DEBUG, "Sending a message of type %s (%s)\\r\\n");
+        int exclude = -1; // Set this to clientNumber to not send to
+
+        LOG(DEBUG, "Sending a message of type %s (%s)\\r\\n");
         INDENT_LOG(Logging::DEBUG);
 
          %s
 
-        int start, finish;
-        if (clientNumber == -1)
+%s        if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, %s);
+            putint(buf, %s);
+%s            broadcast(buf.finalize(), MAIN_CHANNEL, %s, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (%s)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (%s && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (%s && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %%d (%%d) ((%%d))\\r\\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "%si%s", %s, """ % (name, type_code, send, dummy_server_string, all_npcs_string, 'r' if reliable else '', param_string, type_code)
+            sendf(clientNumber, MAIN_CHANNEL, "%si%s", %s%s);
+        }
+""" % (name, type_code, send, flush_batched, 'ENET_PACKET_FLAG_RELIABLE' if reliable else '0', type_code, encode_params,
+       recipient_kinds, recipient_kinds, 'r' if reliable else '', param_string, type_code,
+       (', ' + sendf_args) if sendf_args else '')
 
-            for param_type, param_name in params:
-                if implicit_client_number and param_type == 'int' and param_name == 'clientNumber':
-                    continue
+            if direction == "client->server":
+                for param_type, param_name in params:
+                    if implicit_client_number and param_type == 'int' and param_name == 'clientNumber':
+                        continue
 
-                pre_modifier = ""
-                post_modifier = ""
+                    pre_modifier = ""
+                    post_modifier = ""
 
-                if param_type == "std::string":
-                    post_modifier = ".c_str()"
-                elif param_type == "float":
-                    pre_modifier = "int("
-                    post_modifier = "*DMF)"
-                send = send + "%s%s%s, " % (pre_modifier, param_name, post_modifier)
-            send = send[:-2] + ");\n"
-
-            if direction != "client->server":
-                send = """
-        int exclude = -1; // Set this to clientNumber to not send to
-""" + send + """
-            }
-        }
-"""
+                    if param_type == "std::string":
+                        post_modifier = ".c_str()"
+                    elif param_type == "float":
+                        pre_modifier = "int("
+                        post_modifier = "*DMF)"
+                    send = send + "%s%s%s, " % (pre_modifier, param_name, post_modifier)
+                send = send[:-2] + ");\n"
 
             # Generate receive
 
@@ -278,8 +299,12 @@ void send_%s(%s);
         getstring(tmp_%s, p);
         std::string %s = tmp_%s;
 """ % (param_name, param_name, param_name, param_name)
+                elif param_type == "vector<uchar>":
+                    temp_receive = temp_receive + """        int length_%s = getint(p);
+        ucharbuf %s = p.subbuf(max(length_%s, 0));
+""" % (param_name, param_name, param_name)
 
-            receive = '        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type %s (%s)\\r\\n");\n\n' % (name, type_code) + temp_receive + '\n' + receive;
+            receive = '        LOG(DEBUG, "MessageSystem: Receiving a message of type %s (%s)\\r\\n");\n\n' % (name, type_code) + temp_receive + '\n' + receive;
 
             # Write out send and receive
 
@@ -340,7 +365,9 @@ void send_%s(%s);
 
             # Write out the boost::python file so Python can also use these messages
             # TODO: Separate files for client and server, they don't need to have all of them... but a minor issue.
-            if direction == "server->client":
+            if has_buffer:
+                pass # Raw buffers are for C++ only
+            elif direction == "server->client":
                 generated_boost_file.write("""
     // %s
     exposeToPython("%s", &MessageSystem::send_%s);
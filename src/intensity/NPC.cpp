@@ -21,7 +21,7 @@ ScriptValuePtr add(std::string _class)
 
     FPSServerInterface::getUsername(clientNumber) = "Bot." + Utility::toString(clientNumber); // Also sets as valid ('logged in')
 
-    Logging::log(Logging::DEBUG, "New NPC with client number: %d\r\n", clientNumber);
+    LOG(DEBUG, "New NPC with client number: %d\r\n", clientNumber);
 
     // Create scripting entity (players do this when they log in, NPCs do it here
     return server::createScriptingEntity(clientNumber, _class);
@@ -32,7 +32,7 @@ const AssetInfo AssetManager::getAssetInfo(const AssetId& id)
     if (iter == registeredAssets.end())
     {
         // We are missing the info
-        Logging::log(Logging::ERROR, "Request for the info of a non-registered asset: %s\r\n", id.c_str());
+        LOG(ERROR, "Request for the info of a non-registered asset: %s\r\n", id.c_str());
         assert(0);
     }
 
@@ -41,7 +41,7 @@ const AssetInfo AssetManager::getAssetInfo(const AssetId& id)
 
 void AssetManager::registerAssetInfo(const AssetId& id, const AssetInfo& info)
 {
-    Logging::log(Logging::DEBUG, "AssetManager::registerAssetInfo: %s\r\n", id.c_str());
+    LOG(DEBUG, "AssetManager::registerAssetInfo: %s\r\n", id.c_str());
     INDENT_LOG(Logging::DEBUG);
 
     if (registeredAssets.find(id) == registeredAssets.end())
@@ -56,7 +56,7 @@ void AssetManager::registerAssetInfo(const AssetId& id, const AssetInfo& info)
 
     if (assetIter != pendingActions.end())
     {
-        Logging::log(Logging::DEBUG, "Actions are pending for this asset, ensure that it will arrive or act immediately\r\n");
+        LOG(DEBUG, "Actions are pending for this asset, ensure that it will arrive or act immediately\r\n");
 
         if (checkLocalAssetPresence(id, true)) // Will send a request if necessary
         {
@@ -107,7 +107,7 @@ void AssetManager::removeAction(const AssetId& id, AssetActionPtr action)
 
 bool AssetManager::checkLocalAssetPresence(const AssetId& id, bool takeAction)
 {
-    Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : %s\r\n", id.c_str());
+    LOG(DEBUG, "AssetManager::checkLocalAssetPresence : %s\r\n", id.c_str());
 
     AssetInfoMap::iterator iter = registeredAssets.find(id);
 
@@ -115,11 +115,11 @@ bool AssetManager::checkLocalAssetPresence(const AssetId& id, bool takeAction)
     {
         // We are missing the info
 
-        Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : missing Info\r\n", id.c_str());
+        LOG(DEBUG, "AssetManager::checkLocalAssetPresence : missing Info\r\n", id.c_str());
 
         if (takeAction)
         {
-            Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : requesting Info\r\n");
+            LOG(DEBUG, "AssetManager::checkLocalAssetPresence : requesting Info\r\n");
 
             requestAssetInfo(id);
         }
@@ -137,13 +137,13 @@ bool AssetManager::checkLocalAssetPresence(const AssetId& id, bool takeAction)
     {
         // We have an outdated version of this asset
 
-        Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : incorrect hash: %s vs. %s\r\n",
+        LOG(DEBUG, "AssetManager::checkLocalAssetPresence : incorrect hash: %s vs. %s\r\n",
             info.hash.c_str(), localHash.c_str()
         );
 
         if (takeAction)
         {
-            Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : requesting asset\r\n");
+            LOG(DEBUG, "AssetManager::checkLocalAssetPresence : requesting asset\r\n");
 
             requestAsset(id);
         }
@@ -151,7 +151,7 @@ bool AssetManager::checkLocalAssetPresence(const AssetId& id, bool takeAction)
         return false;
     }
 
-    Logging::log(Logging::DEBUG, "AssetManager::checkLocalAssetPresence : %s : YES\r\n", id.c_str());
+    LOG(DEBUG, "AssetManager::checkLocalAssetPresence : %s : YES\r\n", id.c_str());
 
     return true;
 }
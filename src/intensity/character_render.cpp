@@ -14,13 +14,13 @@
 
 void CharacterRendering::render(fpsent* entity)
 {
-    Logging::log(Logging::INFO, "CharacterRendering::rendering %d\r\n", LogicSystem::getUniqueId(entity));
+    LOG(INFO, "CharacterRendering::rendering %d\r\n", LogicSystem::getUniqueId(entity));
     INDENT_LOG(Logging::INFO);
 
     if (!ClientSystem::loggedIn) // If not logged in remotely, do not render, because entities lack all the fields like model_name
                                  // in the future, perhaps add these, if we want local rendering
     {
-        Logging::log(Logging::INFO, "Not logged in remotely, so not rendering\r\n");
+        LOG(INFO, "Not logged in remotely, so not rendering\r\n");
         return;
     }
 
@@ -28,7 +28,7 @@ void CharacterRendering::render(fpsent* entity)
 
     if ( !logicEntity.get() )
     {
-        Logging::log(Logging::INFO, "fpsent exists, but no logic entity yet for it, so not rendering\r\n");
+        LOG(INFO, "fpsent exists, but no logic entity yet for it, so not rendering\r\n");
         return;
     }
 
@@ -36,13 +36,13 @@ void CharacterRendering::render(fpsent* entity)
 
     if ( !scriptEntity->getPropertyBool("initialized") )
     {
-        Logging::log(Logging::INFO, "Not initialized, so not rendering\r\n");
+        LOG(INFO, "Not initialized, so not rendering\r\n");
         return;
     }
 
     // Render client using model name, attachments, and animation information
 
-    Logging::log(Logging::INFO, "Rendering %d, with o=(%f,%f,%f)\r\n", logicEntity.get()->getUniqueId(),
+    LOG(INFO, "Rendering %d, with o=(%f,%f,%f)\r\n", logicEntity.get()->getUniqueId(),
                                                                        logicEntity.get()->getOrigin().x,
                                                                        logicEntity.get()->getOrigin().y,
                                                                        logicEntity.get()->getOrigin().z);
@@ -59,7 +59,7 @@ void CharacterRendering::render(fpsent* entity)
                      entity->lastaction,
                      entity->lastpain);
     } else {
-        Logging::log(Logging::INFO, "No model, so no render.\r\n");
+        LOG(INFO, "No model, so no render.\r\n");
     }
 
     // INTENSITY: Class above head in edit mode
@@ -69,7 +69,7 @@ void CharacterRendering::render(fpsent* entity)
         particle_text(entity->abovehead(), _class.c_str(), 16, 1);
     }
 
-    Logging::log(Logging::INFO, "CharacterRendering::render complete.\r\n");
+    LOG(INFO, "CharacterRendering::render complete.\r\n");
 }
 
 
@@ -91,7 +91,7 @@ void CharacterInfo::addAttachment(Attachment attachment)
 {
     if (attachments.size() >= MAX_ATTACHMENTS)
     {
-        Logging::log(Logging::WARNING,
+        LOG(WARNING,
                      "Attempt to add an attachment beyond the limit of the number of attachment ('%s','%s')\r\n",
                      attachment.name.c_str(), attachment.tag.c_str());
         return;
@@ -99,7 +99,7 @@ void CharacterInfo::addAttachment(Attachment attachment)
  
     if (findAttachment(attachment.tag) != -1)
     {
-        Logging::log(Logging::WARNING, "Attempt to add an attachment with an existing tag! ('%s')\r\n", attachment.tag.c_str());
+        LOG(WARNING, "Attempt to add an attachment with an existing tag! ('%s')\r\n", attachment.tag.c_str());
         return;
     }
 
@@ -112,7 +112,7 @@ void CharacterInfo::removeAttachment(std::string tag)
 
     if (index == -1)
     {
-        Logging::log(Logging::WARNING, "Attempt to remove a non-existing tag! ('%s')\r\n", tag.c_str());
+        LOG(WARNING, "Attempt to remove a non-existing tag! ('%s')\r\n", tag.c_str());
         return;
     }
 
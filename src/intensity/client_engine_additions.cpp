@@ -26,7 +26,7 @@ VAR(cam_dist, 0, 50, 200);
 
 void CameraControl::incrementCameraDist(int inc_dir)
 {
-    Logging::log(Logging::DEBUG, "changing camera increment: %d\r\n", inc_dir);
+    LOG(DEBUG, "changing camera increment: %d\r\n", inc_dir);
 
     cam_dist += (inc_dir * CameraControl::cameraMoveDist);
 
@@ -95,7 +95,7 @@ physent* CameraControl::getCamera()
 
 void CameraControl::positionCamera(physent* camera1)
 {
-    Logging::log(Logging::INFO, "CameraControl::positionCamera\r\n");
+    LOG(INFO, "CameraControl::positionCamera\r\n");
     INDENT_LOG(Logging::INFO);
 
     if (useForcedCamera)
@@ -289,7 +289,7 @@ void prepare_entity_gui()
     GuiControl::EditedEntity::currEntity = TargetingControl::targetLogicEntity;
     if (GuiControl::EditedEntity::currEntity->isNone())
     {
-        Logging::log(Logging::DEBUG, "No entity to show the GUI for\r\n");
+        LOG(DEBUG, "No entity to show the GUI for\r\n");
         return;
     }
 
@@ -364,7 +364,7 @@ void prepare_entity_gui()
 
         if (value.size() > 50)
         {
-            Logging::log(Logging::WARNING, "Not showing field '%s' as it is overly large for the GUI\r\n", key.c_str());
+            LOG(WARNING, "Not showing field '%s' as it is overly large for the GUI\r\n", key.c_str());
             continue; // Do not even try to show overly-large items
         }
 
@@ -585,7 +585,7 @@ bool PlayerControl::handleClick(int button, bool up)
         {
             if (!TargetingControl::targetLogicEntity.get()->isNone())
             {
-                Logging::log(Logging::DEBUG, "Clicked on entity: %d, %ld\r\n",
+                LOG(DEBUG, "Clicked on entity: %d, %ld\r\n",
                                              TargetingControl::targetLogicEntity.get()->getUniqueId(),
                                              (long)TargetingControl::targetLogicEntity.get());
 
@@ -648,7 +648,7 @@ void addHoverLight()
 
     if (!TargetingControl::targetLogicEntity.get())
     {
-        Logging::log(Logging::WARNING, "targetLogicEntity is NULL\r\n");
+        LOG(WARNING, "targetLogicEntity is NULL\r\n");
         return;
     }
 
@@ -771,7 +771,7 @@ void ExtraRendering::renderShadowingMapmodels()
 
 void mouseclick(int button, bool down)
 {
-    Logging::log(Logging::INFO, "mouse click: %d (down: %d)\r\n", button, down);
+    LOG(INFO, "mouse click: %d (down: %d)\r\n", button, down);
 
     if (! (ScriptEngineManager::hasEngine() && ClientSystem::scenarioStarted()) )
         return;
@@ -83,7 +83,7 @@ void ClientSystem::connect(std::string host, int port)
 
 void ClientSystem::login(int clientNumber)
 {
-    Logging::log(Logging::DEBUG, "ClientSystem::login()\r\n");
+    LOG(DEBUG, "ClientSystem::login()\r\n");
 
     playerNumber = clientNumber;
 
@@ -101,7 +101,7 @@ void ClientSystem::finishLogin(bool local)
     // There is no Python LE for the player yet, we await its arrival from the server just like any other LE. When
     // it does arrive, we will point playerLogicEntity to it. See messages.template.
  
-    Logging::log(Logging::DEBUG, "Now logged in, with unique_ID: %d\r\n", uniqueId);
+    LOG(DEBUG, "Now logged in, with unique_ID: %d\r\n", uniqueId);
 }
 
 void ClientSystem::doDisconnect()
@@ -122,7 +122,7 @@ void ClientSystem::onDisconnect()
 
 void ClientSystem::clearPlayerEntity()
 {
-    Logging::log(Logging::DEBUG, "ClientSystem::clearPlayerEntity\r\n");
+    LOG(DEBUG, "ClientSystem::clearPlayerEntity\r\n");
     playerLogicEntity.reset();
 }
 
@@ -141,7 +141,7 @@ bool ClientSystem::mapCompletelyReceived()
 bool ClientSystem::scenarioStarted()
 {
     if (!_mapCompletelyReceived)
-        Logging::log(Logging::INFO, "Map not completely received, so scenario not started\r\n");
+        LOG(INFO, "Map not completely received, so scenario not started\r\n");
 
     // If not already started, test if indeed started
     if (_mapCompletelyReceived && !_scenarioStarted)
@@ -176,7 +176,7 @@ void ClientSystem::gotoLoginScreen()
 {
     assert(0);
 #if 0
-    Logging::log(Logging::DEBUG, "Going to login screen\r\n");
+    LOG(DEBUG, "Going to login screen\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     LogicSystem::init(); // This is also done later, but as the mainloop assumes there is always a ScriptEngine, we do it here as well
@@ -190,7 +190,7 @@ void ClientSystem::gotoLoginScreen()
 
     game::changemap("login");
 
-    Logging::log(Logging::DEBUG, "Going to login screen complete\r\n");
+    LOG(DEBUG, "Going to login screen complete\r\n");
 #endif
 }
 
@@ -205,7 +205,7 @@ extern int sauer_main(int argc, char **argv); // from main.cpp
 
 void client_main()
 {
-    Logging::log(Logging::DEBUG, "client_main");
+    LOG(DEBUG, "client_main");
 
     sauer_main(saved_argc, saved_argv);
 }
@@ -601,7 +601,7 @@ void show_instances()
     command += "]\n";
     command += "showgui instances\n";
 
-    Logging::log(Logging::DEBUG, "Instances GUI: %s\r\n", command.c_str());
+    LOG(DEBUG, "Instances GUI: %s\r\n", command.c_str());
 
     execute(command.c_str());
 }
@@ -65,7 +65,7 @@ namespace EditingSystem
     {
         savedMousePosTime = Utility::SystemInfo::currTime();
         savedMousePos = TargetingControl::worldPosition;
-        Logging::log(Logging::DEBUG, "Saved mouse pos: %f,%f,%f (%d)\r\n", savedMousePos.x, savedMousePos.y, savedMousePos.z,
+        LOG(DEBUG, "Saved mouse pos: %f,%f,%f (%d)\r\n", savedMousePos.x, savedMousePos.y, savedMousePos.z,
                                                                            savedMousePosTime);
     }
 
@@ -104,7 +104,7 @@ void newEntity(std::string _class, std::string stateData)
     #ifdef CLIENT
         vec farPosition;
 
-        Logging::log(Logging::DEBUG, "Considering saved mouse pos: %f,%f,%f (%d, %d)\r\n", savedMousePos.x, savedMousePos.y, savedMousePos.z,
+        LOG(DEBUG, "Considering saved mouse pos: %f,%f,%f (%d, %d)\r\n", savedMousePos.x, savedMousePos.y, savedMousePos.z,
                                                                            savedMousePosTime, Utility::SystemInfo::currTime());
 
         // Use saved position, if exists and saved recently
@@ -184,11 +184,11 @@ bool checkCubeCoords(int x, int y, int z, int gridsize)
 
 void createCube(int x, int y, int z, int gridsize)
 {
-    Logging::log(Logging::DEBUG, "createCube: %d,%d,%d  --  %d\r\n", x, y, z, gridsize);
+    LOG(DEBUG, "createCube: %d,%d,%d  --  %d\r\n", x, y, z, gridsize);
 
     if (!checkCubeCoords(x, y, z, gridsize))
     {
-        Logging::log(Logging::ERROR, "Bad cube coordinates to createCube: %d,%d,%d : %d\r\n", x, y, z, gridsize);
+        LOG(ERROR, "Bad cube coordinates to createCube: %d,%d,%d : %d\r\n", x, y, z, gridsize);
         return;
     }
 
@@ -222,7 +222,7 @@ void deleteCube(int x, int y, int z, int gridsize)
 {
     if (!checkCubeCoords(x, y, z, gridsize))
     {
-        Logging::log(Logging::ERROR, "Bad cube coordinates to createCube: %d,%d,%d : %d\r\n", x, y, z, gridsize);
+        LOG(ERROR, "Bad cube coordinates to createCube: %d,%d,%d : %d\r\n", x, y, z, gridsize);
         return;
     }
 
@@ -246,7 +246,7 @@ void setCubeTexture(int x, int y, int z, int gridsize, int face, int texture)
 {
     if (!checkCubeCoords(x, y, z, gridsize))
     {
-        Logging::log(Logging::ERROR, "Bad cube coordinates to setCubeTexture: %d,%d,%d : %d\r\n", x, y, z, gridsize);
+        LOG(ERROR, "Bad cube coordinates to setCubeTexture: %d,%d,%d : %d\r\n", x, y, z, gridsize);
         return;
     }
 
@@ -272,7 +272,7 @@ void setCubeMaterial(int x, int y, int z, int gridsize, int material)
 {
     if (!checkCubeCoords(x, y, z, gridsize))
     {
-        Logging::log(Logging::ERROR, "Bad cube coordinates to setCubeMaterial: %d,%d,%d : %d\r\n", x, y, z, gridsize);
+        LOG(ERROR, "Bad cube coordinates to setCubeMaterial: %d,%d,%d : %d\r\n", x, y, z, gridsize);
         return;
     }
 
@@ -307,7 +307,7 @@ void pushCubeCorner(int x, int y, int z, int gridsize, int face, int corner, int
 {
     if (!checkCubeCoords(x, y, z, gridsize))
     {
-        Logging::log(Logging::ERROR, "Bad cube coordinates to pushCubeCorner: %d,%d,%d : %d\r\n", x, y, z, gridsize);
+        LOG(ERROR, "Bad cube coordinates to pushCubeCorner: %d,%d,%d : %d\r\n", x, y, z, gridsize);
         return;
     }
 
@@ -331,7 +331,7 @@ void pushCubeCorner(int x, int y, int z, int gridsize, int face, int corner, int
 
 void considerForSmoothing(int x, int y, int z, int resolution, unsigned char* data)
 {
-    Logging::log(Logging::DEBUG, "considerForSmoothing: %d,%d,%d     %d\r\n", x, y, z, resolution);
+    LOG(DEBUG, "considerForSmoothing: %d,%d,%d     %d\r\n", x, y, z, resolution);
 
     const int worldSize = getworldsize();
     const int resolutionFactor = worldSize/resolution;
@@ -354,7 +354,7 @@ void considerForSmoothing(int x, int y, int z, int resolution, unsigned char* da
     int down_y = data[base - resolution];
     int down_z = data[base - 1];
 
-    Logging::log(Logging::DEBUG, "trying to apply smoothing: %d,%d,%d,%d,%d,%d\r\n", up_x, down_x, up_y, down_y, up_z, down_z);
+    LOG(DEBUG, "trying to apply smoothing: %d,%d,%d,%d,%d,%d\r\n", up_x, down_x, up_y, down_y, up_z, down_z);
 
     // Look for the case where we are a corner, i.e., 3 neighbors are empty and 3 are full, in the appropriate alignment
 
@@ -363,7 +363,7 @@ void considerForSmoothing(int x, int y, int z, int resolution, unsigned char* da
             up_x + down_x + up_y + down_y + up_z + down_z == 3 )
             // And to have three full directions and three empty
     {
-        Logging::log(Logging::DEBUG, "smoothing is appropriate\r\n");
+        LOG(DEBUG, "smoothing is appropriate\r\n");
 
 //        deleteCube(x, y, z, resolutionFactor);
 //        createCube(x, y, z, resolutionFactor);
@@ -393,7 +393,7 @@ void considerForSmoothing(int x, int y, int z, int resolution, unsigned char* da
 // Internal function for createMapFromRaw
 void createCubeFromRaw(int x, int y, int z, int gridsize, int resolution, unsigned char* data, int smoothing)
 {
-    Logging::log(Logging::DEBUG, "createCubeFromRaw: %d,%d,%d    %d,%d\r\n", x, y, z, gridsize, resolution);
+    LOG(DEBUG, "createCubeFromRaw: %d,%d,%d    %d,%d\r\n", x, y, z, gridsize, resolution);
     INDENT_LOG(Logging::DEBUG);
 
     const int worldSize = getworldsize();
@@ -435,16 +435,16 @@ void createCubeFromRaw(int x, int y, int z, int gridsize, int resolution, unsign
 
     bool tooSmall = gridsize <= resolutionFactor; // If this small, we need to decide by veto - no recursing into, would be senseless
 
-    Logging::log(Logging::DEBUG, "checked, toosmall, filled: %d,%d,%d\r\n", checked, tooSmall, filled);
+    LOG(DEBUG, "checked, toosmall, filled: %d,%d,%d\r\n", checked, tooSmall, filled);
 
     if (filled == 0 || (tooSmall && filled < checked/2) )
     {
-        Logging::log(Logging::DEBUG, "createCubeFromRaw: empty\r\n");
+        LOG(DEBUG, "createCubeFromRaw: empty\r\n");
         return; // Empty space, do nothing
     }
     else if (filled == checked || (tooSmall && filled >= checked/2) )
     {
-        Logging::log(Logging::DEBUG, "createCubeFromRaw: full\r\n");
+        LOG(DEBUG, "createCubeFromRaw: full\r\n");
 
         // Create a single simple cube, with a default texture
         createCube(x, y, z, gridsize);
@@ -470,7 +470,7 @@ void createCubeFromRaw(int x, int y, int z, int gridsize, int resolution, unsign
     }
     else
     {
-        Logging::log(Logging::DEBUG, "createCubeFromRaw: partial\r\n");
+        LOG(DEBUG, "createCubeFromRaw: partial\r\n");
 
         // Partially-filled space.
 
@@ -488,7 +488,7 @@ int thread__smoothing;
 
 int thread__createMapFromRaw(void *unused)
 {
-    Logging::log(Logging::DEBUG, "createMapFromRaw thread: %d,%lu,%d\r\n", thread__resolution, thread__data, thread__smoothing);
+    LOG(DEBUG, "createMapFromRaw thread: %d,%lu,%d\r\n", thread__resolution, thread__data, thread__smoothing);
 
     eraseGeometry();
 
@@ -511,7 +511,7 @@ void createMapFromRaw(int resolution, double addr, int smoothing)
 
     SDL_Thread *thread = SDL_CreateThread(thread__createMapFromRaw, NULL);
     if ( thread == NULL )
-        Logging::log(Logging::ERROR, "Unable to create createMapFromRaw thread: %s\n", SDL_GetError());
+        LOG(ERROR, "Unable to create createMapFromRaw thread: %s\n", SDL_GetError());
 }
 
 int pushing_needed(float max_height, float curr, int gridsize)
@@ -591,7 +591,7 @@ float* thread__heightmapData;
 
 int thread__createHeightmapFromRaw(void *unused)
 {
-    Logging::log(Logging::DEBUG, "createHeightmapFromRaw thread: %d,%lu\r\n", thread__resolution, thread__heightmapData);
+    LOG(DEBUG, "createHeightmapFromRaw thread: %d,%lu\r\n", thread__resolution, thread__heightmapData);
 
     eraseGeometry();
 
@@ -627,7 +627,7 @@ void createHeightmapFromRaw(int resolution, double addr)
 
     SDL_Thread *thread = SDL_CreateThread(thread__createHeightmapFromRaw, NULL);
     if ( thread == NULL )
-        Logging::log(Logging::ERROR, "Unable to create createHeightmapFromRaw thread: %s\n", SDL_GetError());
+        LOG(ERROR, "Unable to create createHeightmapFromRaw thread: %s\n", SDL_GetError());
 }
 
 LogicEntityPtr getSelectedEntity()
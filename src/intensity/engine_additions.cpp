@@ -15,6 +15,7 @@
 #include "fpsclient_interface.h"
 #include "NPC.h"
 #include "intensity_physics.h"
+#include "entity_index.h"
 
 
 // WorldSystem
@@ -30,6 +31,9 @@ using namespace boost;
 
 int CLogicEntity::getUniqueId()
 {
+    if (uniqueId >= 0)
+        return uniqueId; // Set on registration
+
     switch (getType())
     {
         case LE_DYNAMIC:
@@ -37,7 +41,7 @@ int CLogicEntity::getUniqueId()
         case LE_STATIC:
             return LogicSystem::getUniqueId(staticEntity);
         case LE_NONSAUER:
-            return uniqueId; // This can be made to work for the others, if we ensure that uniqueId is set. Would be faster
+            return uniqueId;
         default:
             assert(0 && "getting the unique ID of a NONE logic entity!\r\n");
             return -1;
@@ -79,7 +83,7 @@ vec CLogicEntity::getOrigin()
                     bbcenter.add(staticEntity->o);
                     return bbcenter;
                 } else {
-                    Logging::log(Logging::WARNING, "Invalid mapmodel model\r\n");
+                    LOG(WARNING, "Invalid mapmodel model\r\n");
                     return staticEntity->o;
                 }
             } else
@@ -112,7 +116,7 @@ float CLogicEntity::getRadius()
                     bbcenter.add(staticEntity->o);
                     return bbradius.x + bbradius.y;
                 } else {
-                    Logging::log(Logging::WARNING, "Invalid mapmodel model, cannot find radius\r\n");
+                    LOG(WARNING, "Invalid mapmodel model, cannot find radius\r\n");
                     return 8;
                 }
 
@@ -195,7 +199,7 @@ void CLogicEntity::setModel(std::string name)
     if (name != "")
         theModel = loadmodel(name.c_str());
 
-    Logging::log(Logging::DEBUG, "CLE:setModel: %s (%lu)\r\n", name.c_str(), (unsigned long)theModel);
+    LOG(DEBUG, "CLE:setModel: %s (%lu)\r\n", name.c_str(), (unsigned long)theModel);
 
     if (staticEntity)
     {
@@ -213,7 +217,7 @@ void CLogicEntity::setModel(std::string name)
 
 void CLogicEntity::setAttachments(std::string _attachments)
 {
-    Logging::log(Logging::DEBUG, "CLogicEntity::setAttachments: %s\r\n", _attachments.c_str());
+    LOG(DEBUG, "CLogicEntity::setAttachments: %s\r\n", _attachments.c_str());
 
     // This is important as this is called before setupExtent.
     if ((!this) || (!staticEntity && !dynamicEntity))
@@ -269,7 +273,7 @@ void CLogicEntity::setAttachments(std::string _attachments)
             //attachments[i].anim = ANIM_VWEP | ANIM_LOOP; // Will become important if/when we have animated attachments
             attachments[i].basetime = 0;
 
-            Logging::log(Logging::DEBUG, "Adding attachment: %s - %s\r\n", attachments[i].name, attachments[i].tag);
+            LOG(DEBUG, "Adding attachment: %s - %s\r\n", attachments[i].name, attachments[i].tag);
         }
 
         attachments[numAttachments].tag  = NULL; // tag=null as well - probably not needed (order reversed with following line)
@@ -285,13 +289,13 @@ void CLogicEntity::setAttachments(std::string _attachments)
 
 void CLogicEntity::setAnimation(int _animation)
 {
-    Logging::log(Logging::DEBUG, "setAnimation: %d\r\n", _animation);
+    LOG(DEBUG, "setAnimation: %d\r\n", _animation);
 
     // This is important as this is called before setupExtent.
     if ((!this) || (!staticEntity && !dynamicEntity))
         return;
 
-    Logging::log(Logging::DEBUG, "(2) setAnimation: %d\r\n", _animation);
+    LOG(DEBUG, "(2) setAnimation: %d\r\n", _animation);
 
     animation = _animation;
     startTime = lastmillis; // Utility::SystemInfo::currTime(); XXX Do NOT want the actual time! We
@@ -325,6 +329,49 @@ void CLogicEntity::noteActualRender()
 }
 
 
+//=========================
+// LogicEntitySlotMap
+//=========================
+
+void LogicEntitySlotMap::insert(LogicEntityPtr entity)
+{
+    int uniqueId = entity->getUniqueId();
+    assert(uniqueId >= 0);
+
+    if (uniqueId >= int(slots.size()))
+        slots.resize(uniqueId + 1);
+
+    assert(slots[uniqueId].index < 0);
+    slots[uniqueId].index = entities.size();
+    entities.push_back(entity);
+}
+
+void LogicEntitySlotMap::erase(int uniqueId)
+{
+    if (uniqueId < 0 || uniqueId >= int(slots.size()) || slots[uniqueId].index < 0)
+        return;
+
+    Slot& slot = slots[uniqueId];
+
+    // Fill the gap with the last entity, keeping the live entities contiguous
+    int last = entities.size() - 1;
+    if (slot.index != last)
+    {
+        entities[slot.index] = entities[last];
+        slots[entities[slot.index]->getUniqueId()].index = slot.index;
+    }
+    entities.pop_back();
+
+    slot.index = -1;
+}
+
+void LogicEntitySlotMap::clear()
+{
+    slots.clear();
+    entities.clear();
+}
+
+
 //=========================
 // LogicSystem
 //=========================
@@ -333,7 +380,7 @@ LogicSystem::LogicEntityMap LogicSystem::logicEntities;
 
 void LogicSystem::clear()
 {
-    Logging::log(Logging::DEBUG, "clear()ing LogicSystem\r\n");
+    LOG(DEBUG, "clear()ing LogicSystem\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     // Removes existing logic entities, which also removes them from C++
@@ -341,6 +388,7 @@ void LogicSystem::clear()
     {
         ScriptEngineManager::getGlobal()->call("removeAllEntities");
         assert(logicEntities.size() == 0);
+        EntityIndex::clear(); // Also forget tags of entities that never registered here
 
         // For client, remove player logic entity
         #ifdef CLIENT
@@ -365,34 +413,44 @@ void LogicSystem::init()
 
 void LogicSystem::registerLogicEntity(LogicEntityPtr newEntity)
 {
-    Logging::log(Logging::DEBUG, "C registerLogicEntity: %d\r\n", newEntity.get()->getUniqueId());
+    LOG(DEBUG, "C registerLogicEntity: %d\r\n", newEntity.get()->getUniqueId());
     INDENT_LOG(Logging::DEBUG);
 
     int uniqueId = newEntity.get()->getUniqueId();
-    assert(logicEntities.find(uniqueId) == logicEntities.end());
-    logicEntities.insert( LogicEntityMap::value_type( uniqueId, newEntity ) );
+    assert(!logicEntities.find(uniqueId).get());
+    newEntity.get()->uniqueId = uniqueId; // So later queries need not look in the Sauer entity
+    logicEntities.insert(newEntity);
+
+    if (newEntity.get()->dynamicEntity)
+        newEntity.get()->dynamicEntity->logicEntity = newEntity.get();
+    else if (newEntity.get()->staticEntity)
+        newEntity.get()->staticEntity->logicEntity = newEntity.get();
 
     newEntity.get()->scriptEntity = ScriptEngineManager::getGlobal()->call("getEntity", uniqueId);
 
     assert(newEntity.get()->scriptEntity.get()); // Cannot be NULL
     assert( ! ( newEntity.get()->scriptEntity->compare(ScriptEngineManager::getNull()) ) ); // Cannot be NULL
 
+    newEntity.get()->scriptEntity->bindLogicEntity(newEntity.get());
+
+    EntityIndex::add(newEntity.get());
+
     newEntity.get()->scriptEntity->debugPrint();
 
-    Logging::log(Logging::DEBUG, "C registerLogicEntity completes\r\n");
+    LOG(DEBUG, "C registerLogicEntity completes\r\n");
 }
 
 LogicEntityPtr LogicSystem::registerLogicEntity(physent* entity)
 {
     if (getUniqueId(entity) < 0)
     {
-        Logging::log(Logging::ERROR, "Trying to register an entity with an invalid unique Id: %d (D)\r\n", getUniqueId(entity));
+        LOG(ERROR, "Trying to register an entity with an invalid unique Id: %d (D)\r\n", getUniqueId(entity));
         assert(0);
     }
 
     LogicEntityPtr newEntity(new CLogicEntity(entity));
 
-    Logging::log(Logging::DEBUG, "adding physent %d\r\n", newEntity.get()->getUniqueId());
+    LOG(DEBUG, "adding physent %d\r\n", newEntity.get()->getUniqueId());
 
     registerLogicEntity(newEntity);
 
@@ -403,13 +461,13 @@ LogicEntityPtr LogicSystem::registerLogicEntity(extentity* entity)
 {
     if (getUniqueId(entity) < 0)
     {
-        Logging::log(Logging::ERROR, "Trying to register an entity with an invalid unique Id: %d (S)\r\n", getUniqueId(entity));
+        LOG(ERROR, "Trying to register an entity with an invalid unique Id: %d (S)\r\n", getUniqueId(entity));
         assert(0);
     }
 
     LogicEntityPtr newEntity(new CLogicEntity(entity));
 
-//    Logging::log(Logging::DEBUG, "adding entity %d : %d,%d,%d,%d\r\n", entity->type, entity->attr1, entity->attr2, entity->attr3, entity->attr4);
+//    LOG(DEBUG, "adding entity %d : %d,%d,%d,%d\r\n", entity->type, entity->attr1, entity->attr2, entity->attr3, entity->attr4);
 
     registerLogicEntity(newEntity);
 
@@ -422,7 +480,7 @@ void LogicSystem::registerLogicEntityNonSauer(int uniqueId)
 
     newEntity.get()->nonSauer = true; // Set as non-Sauer
 
-    Logging::log(Logging::DEBUG, "adding non-Sauer entity %d\r\n", uniqueId);
+    LOG(DEBUG, "adding non-Sauer entity %d\r\n", uniqueId);
 
     registerLogicEntity(newEntity);
 
@@ -433,7 +491,7 @@ void LogicSystem::unregisterLogicEntity(LogicEntityPtr entity)
 {
     assert(0); // Deprecated XXX
 
-    Logging::log(Logging::DEBUG, "UNregisterLogicEntity: %d\r\n", entity.get()->getUniqueId());
+    LOG(DEBUG, "UNregisterLogicEntity: %d\r\n", entity.get()->getUniqueId());
 
     int uniqueId = entity.get()->getUniqueId();
 
@@ -447,46 +505,65 @@ void LogicSystem::unregisterLogicEntity(LogicEntityPtr entity)
 
 void LogicSystem::unregisterLogicEntityByUniqueId(int uniqueId)
 {
-    Logging::log(Logging::DEBUG, "UNregisterLogicEntity by UniqueID: %d\r\n", uniqueId);
+    LOG(DEBUG, "UNregisterLogicEntity by UniqueID: %d\r\n", uniqueId);
+
+    // Unbind, so natives called on the script entity from now on do not find a stale CLE
+    LogicEntityPtr entity = logicEntities.find(uniqueId);
+    if (entity.get() && entity->scriptEntity.get())
+        entity->scriptEntity->bindLogicEntity(NULL);
+
+    EntityIndex::remove(uniqueId);
+
     logicEntities.erase(uniqueId);
 }
 
 void LogicSystem::manageActions(long millis)
 {
-    Logging::log(Logging::INFO, "manageActions: %d\r\n", millis);
+    PROFILE("manageActions");
+
+    LOG(INFO, "manageActions: %d\r\n", millis);
     INDENT_LOG(Logging::INFO);
 
+    static ScriptFunction* manageActions = ScriptEngineManager::getFunction("manageActions");
+
     if (ScriptEngineManager::hasEngine())
-        ScriptEngineManager::getGlobal()->call("manageActions",
-            ScriptValueArgs().append(double(millis)/1000.0f).append(lastmillis)
+        manageActions->call(
+            ScriptArgs().append(double(millis)/1000.0f).append(lastmillis)
         );
 
-    Logging::log(Logging::INFO, "manageActions complete\r\n");
+    LOG(INFO, "manageActions complete\r\n");
 }
 
 LogicEntityPtr LogicSystem::getLogicEntity(int uniqueId)
 {
-    LogicEntityMap::iterator iter = logicEntities.find(uniqueId);
+    LogicEntityPtr entity = logicEntities.find(uniqueId);
 
-    if (iter == logicEntities.end())
-    {
-        Logging::log(Logging::INFO, "(C++) Trying to get a non-existant logic entity %d\r\n", uniqueId);
-        LogicEntityPtr NullEntity;
-        return NullEntity;
-    }
+    if (!entity.get())
+        LOG(INFO, "(C++) Trying to get a non-existant logic entity %d\r\n", uniqueId);
 
-    return iter->second;
+    return entity;
 }
 
 LogicEntityPtr LogicSystem::getLogicEntity(const extentity &extent)
 {
-    return getLogicEntity(extent.uniqueId);
-}
+    if (!extent.logicEntity)
+    {
+        LOG(INFO, "(C++) Trying to get the logic entity of an unregistered extent %d\r\n", extent.uniqueId);
+        return LogicEntityPtr();
+    }
 
+    return logicEntities.find(extent.logicEntity->uniqueId);
+}
 
 LogicEntityPtr LogicSystem::getLogicEntity(physent* entity)
 {
-    return getLogicEntity(getUniqueId(entity)); // TODO: do this directly, without the intermediary getUniqueId, for speed?
+    if (!entity->logicEntity)
+    {
+        LOG(INFO, "(C++) Trying to get the logic entity of an unregistered physent\r\n");
+        return LogicEntityPtr();
+    }
+
+    return logicEntities.find(entity->logicEntity->uniqueId);
 }
 
 int LogicSystem::getUniqueId(extentity* staticEntity)
@@ -504,7 +581,7 @@ void LogicSystem::setUniqueId(extentity* staticEntity, int uniqueId)
 {
     if (getUniqueId(staticEntity) >= 0)
     {
-        Logging::log(Logging::ERROR, "Trying to set to %d a unique Id that has already been set, to %d (S)\r\n",
+        LOG(ERROR, "Trying to set to %d a unique Id that has already been set, to %d (S)\r\n",
                                      uniqueId,
                                      getUniqueId(staticEntity));
         assert(0);
@@ -516,11 +593,11 @@ void LogicSystem::setUniqueId(extentity* staticEntity, int uniqueId)
 // TODO: Use this whereever it should be used
 void LogicSystem::setUniqueId(physent* dynamicEntity, int uniqueId)
 {
-    Logging::log(Logging::DEBUG, "Setting a unique ID: %d (of addr: %d)\r\n", uniqueId, dynamicEntity != NULL);
+    LOG(DEBUG, "Setting a unique ID: %d (of addr: %d)\r\n", uniqueId, dynamicEntity != NULL);
 
     if (getUniqueId(dynamicEntity) >= 0)
     {
-        Logging::log(Logging::ERROR, "Trying to set to %d a unique Id that has already been set, to %d (D)\r\n",
+        LOG(ERROR, "Trying to set to %d a unique Id that has already been set, to %d (D)\r\n",
                                      uniqueId,
                                      getUniqueId(dynamicEntity));
         assert(0);
@@ -533,7 +610,7 @@ void LogicSystem::setupExtent(ScriptValuePtr scriptEntity, int type, float x, fl
 {
     int uniqueId = scriptEntity->getPropertyInt("uniqueId");
 
-    Logging::log(Logging::DEBUG, "setupExtent: %d,  %d : %f,%f,%f : %d,%d,%d,%d\r\n", uniqueId, type, x, y, z, attr1, attr2, attr3, attr4);
+    LOG(DEBUG, "setupExtent: %d,  %d : %f,%f,%f : %d,%d,%d,%d\r\n", uniqueId, type, x, y, z, attr1, attr2, attr3, attr4);
     INDENT_LOG(Logging::DEBUG);
 
     vector<extentity *> &ents = entities::getents();
@@ -570,16 +647,16 @@ void LogicSystem::setupCharacter(ScriptValuePtr scriptEntity)
 
     int uniqueId = scriptEntity->getPropertyInt("uniqueId");
 
-    Logging::log(Logging::DEBUG, "setupCharacter: %d\r\n", uniqueId);
+    LOG(DEBUG, "setupCharacter: %d\r\n", uniqueId);
     INDENT_LOG(Logging::DEBUG);
 
     fpsent* fpsEntity;
 
     int clientNumber = scriptEntity->getPropertyInt("clientNumber");
-    Logging::log(Logging::DEBUG, "(a) clientNumber: %d\r\n", clientNumber);
+    LOG(DEBUG, "(a) clientNumber: %d\r\n", clientNumber);
 
     #ifdef CLIENT
-        Logging::log(Logging::DEBUG, "client numbers: %d, %d\r\n", ClientSystem::playerNumber, clientNumber);
+        LOG(DEBUG, "client numbers: %d, %d\r\n", ClientSystem::playerNumber, clientNumber);
 
         if (uniqueId == ClientSystem::uniqueId)
         {
@@ -587,18 +664,18 @@ void LogicSystem::setupCharacter(ScriptValuePtr scriptEntity)
         }
     #endif
 
-    Logging::log(Logging::DEBUG, "(b) clientNumber: %d\r\n", clientNumber);
+    LOG(DEBUG, "(b) clientNumber: %d\r\n", clientNumber);
 
     assert(clientNumber >= 0);
 
     #ifdef CLIENT
     // If this is the player. There should already have been created an fpsent for this client,
     // which we can fetch with the valid client #
-    Logging::log(Logging::DEBUG, "UIDS: in ClientSystem %d, and given to us%d\r\n", ClientSystem::uniqueId, uniqueId);
+    LOG(DEBUG, "UIDS: in ClientSystem %d, and given to us%d\r\n", ClientSystem::uniqueId, uniqueId);
 
     if (uniqueId == ClientSystem::uniqueId)
     {
-        Logging::log(Logging::DEBUG, "This is the player, use existing clientnumber for fpsent (should use player1?) \r\n");
+        LOG(DEBUG, "This is the player, use existing clientnumber for fpsent (should use player1?) \r\n");
 
         fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
 
@@ -608,7 +685,7 @@ void LogicSystem::setupCharacter(ScriptValuePtr scriptEntity)
     else
     #endif
     {
-        Logging::log(Logging::DEBUG, "This is a remote client or NPC, do a newClient for the fpsent\r\n");
+        LOG(DEBUG, "This is a remote client or NPC, do a newClient for the fpsent\r\n");
 
         // This is another client, perhaps NPC. Connect this new client using newClient
         fpsEntity =  dynamic_cast<fpsent*>( FPSClientInterface::newClient(clientNumber) );
@@ -624,7 +701,7 @@ void LogicSystem::setupNonSauer(ScriptValuePtr scriptEntity)
 {
     int uniqueId = scriptEntity->getPropertyInt("uniqueId");
 
-    Logging::log(Logging::DEBUG, "setupNonSauer: %d\r\n", uniqueId);
+    LOG(DEBUG, "setupNonSauer: %d\r\n", uniqueId);
     INDENT_LOG(Logging::DEBUG);
 
     LogicSystem::registerLogicEntityNonSauer(uniqueId);
@@ -634,12 +711,15 @@ void LogicSystem::dismantleExtent(ScriptValuePtr scriptEntity)
 {
     int uniqueId = scriptEntity->getPropertyInt("uniqueId");
 
-    Logging::log(Logging::DEBUG, "Dismantle extent: %d\r\n", uniqueId);
+    LOG(DEBUG, "Dismantle extent: %d\r\n", uniqueId);
+
+    EntityIndex::remove(uniqueId); // Before the extent is emptied, so queries never see it half-dismantled
 
     extentity* extent = getLogicEntity(uniqueId)->staticEntity;
 
     removeentity(extent);
     extent->type = ET_EMPTY;
+    extent->logicEntity = NULL;
 
 //    entities::deleteentity(extent); extent = NULL; // For symmetry with the newentity() this should be here, but sauer does it
                                                      // in clearents() in the next load_world.
@@ -648,13 +728,23 @@ void LogicSystem::dismantleExtent(ScriptValuePtr scriptEntity)
 void LogicSystem::dismantleCharacter(ScriptValuePtr scriptEntity)
 {
     int clientNumber = scriptEntity->getPropertyInt("clientNumber");
+
+    // Drop it from the index now - the fpsent the index points to may be deleted below, before
+    // the logic entity is unregistered
+    EntityIndex::remove(scriptEntity->getPropertyInt("uniqueId"));
+
+    // The logic entity is about to be unregistered, and the fpsent perhaps deleted
+    physent* dynamicEntity = FPSClientInterface::getPlayerByNumber(clientNumber);
+    if (dynamicEntity)
+        dynamicEntity->logicEntity = NULL;
+
     #ifdef CLIENT
     if (clientNumber == ClientSystem::playerNumber)
-        Logging::log(Logging::DEBUG, "Not dismantling own client\r\n", clientNumber);
+        LOG(DEBUG, "Not dismantling own client\r\n", clientNumber);
     else
     #endif
     {
-        Logging::log(Logging::DEBUG, "Dismantling other client %d\r\n", clientNumber);
+        LOG(DEBUG, "Dismantling other client %d\r\n", clientNumber);
 
 #ifdef SERVER
         fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
@@ -687,7 +777,7 @@ void reloadmodel(char* name)
          iter != LogicSystem::logicEntities.end();
          iter++)
     {
-        LogicEntityPtr entity = iter->second;
+        LogicEntityPtr entity = *iter;
         if (entity->theModel == old)
             entity->theModel = _new;
     }
@@ -130,6 +130,50 @@ private:
 typedef boost::shared_ptr<CLogicEntity> LogicEntityPtr;
 
 
+//! Storage for logic entities, keyed by unique ID. The entities themselves are kept in a dense array with no gaps -
+//! removing one moves the last into its place - so iterating walks only live entities, in memory order. A sparse
+//! array of slots, indexed by unique ID, gives each entity's place in the dense array, so lookups are O(1).
+struct LogicEntitySlotMap
+{
+    typedef std::vector<LogicEntityPtr>::iterator iterator;
+
+    //! Adds an entity, which must have a valid unique ID not already present
+    void insert(LogicEntityPtr entity);
+
+    //! Removes an entity by unique ID, if present
+    void erase(int uniqueId);
+
+    //! Returns the entity with a unique ID, or a NULL pointer if there is none
+    LogicEntityPtr find(int uniqueId)
+    {
+        if (uniqueId < 0 || uniqueId >= int(slots.size()) || slots[uniqueId].index < 0)
+            return LogicEntityPtr();
+        return entities[slots[uniqueId].index];
+    }
+
+    void clear();
+
+    int size() { return entities.size(); };
+    bool empty() { return entities.empty(); };
+
+    //! The live entities, in memory order. Adding or removing entities invalidates these iterators and indexes
+    iterator begin() { return entities.begin(); };
+    iterator end() { return entities.end(); };
+    LogicEntityPtr& operator[](int index) { return entities[index]; };
+
+private:
+    struct Slot
+    {
+        int index; //!< Into entities, or -1 if empty
+
+        Slot() : index(-1) { };
+    };
+
+    std::vector<Slot> slots;             //!< Indexed by unique ID
+    std::vector<LogicEntityPtr> entities; //!< Dense, live entities only
+};
+
+
 //! The main storage for LogicEntities and management of them. All entities appear in the central list
 //! of logic entities here, as well as other scenario-wide data.
 
@@ -137,9 +181,9 @@ typedef boost::shared_ptr<CLogicEntity> LogicEntityPtr;
 
 struct LogicSystem
 {
-    typedef std::map<int, LogicEntityPtr> LogicEntityMap;
+    typedef LogicEntitySlotMap LogicEntityMap;
 
-    static LogicEntityMap logicEntities; //!< All the entities in the scenario
+    static LogicEntityMap logicEntities; //!< All the entities in the scenario. Iterate with begin() and end()
 
     //! Called before a map loads. Empties list of entities, and unloads the PC logic entity. Removes the scripting engine
     static void clear();
@@ -169,6 +213,8 @@ struct LogicSystem
     static void          manageActions(long millis);
 
     static LogicEntityPtr getLogicEntity(int uniqueId);
+
+    //! These use the back-pointer set on the Sauer entity while it is registered, with no lookup by unique ID
     static LogicEntityPtr getLogicEntity(const extentity &extent);
     static LogicEntityPtr getLogicEntity(physent* entity);
 
@@ -0,0 +1,307 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+#include "cube.h"
+#include "engine.h"
+#include "game.h"
+
+#include "utility.h"
+
+#include "entity_index.h"
+
+#include <map>
+#include <set>
+#include <algorithm>
+
+
+// Spatial index
+
+//! The size of a grid cell, in world units. Typical queries (a few dozen to a few hundred units) then look at
+//! a handful of cells
+#define CELL_SIZE 64
+
+typedef long long CellKey;
+
+//! Packs the coordinates of a cell, 20 bits each (which is far more than any map needs)
+static CellKey getCellKey(int x, int y, int z)
+{
+    return ((CellKey(x) & 0xFFFFF) << 40) | ((CellKey(y) & 0xFFFFF) << 20) | (CellKey(z) & 0xFFFFF);
+}
+
+static int getCellCoord(float value)
+{
+    return int(floorf(value / CELL_SIZE));
+}
+
+static CellKey getCellKey(const vec& position)
+{
+    return getCellKey(getCellCoord(position.x), getCellCoord(position.y), getCellCoord(position.z));
+}
+
+struct IndexedEntity
+{
+    CLogicEntity *entity;
+    vec position;
+    CellKey cell;
+};
+
+typedef std::map<int, IndexedEntity> IndexedEntities;
+typedef std::map<CellKey, std::vector<int> > Cells;
+
+static IndexedEntities indexedEntities; //!< By unique ID
+static Cells cells;                     //!< Unique IDs of the entities in each (nonempty) cell
+
+static bool positionsValid = false;
+static int positionsMillis = -1; //!< When positions were last rechecked
+
+//! The position as scripting sees it
+static vec getPosition(CLogicEntity *entity)
+{
+    if (entity->isDynamic())
+        return entity->dynamicEntity->feetpos();
+    else
+        return entity->staticEntity->o;
+}
+
+static void addToCell(int uniqueId, CellKey cell)
+{
+    cells[cell].push_back(uniqueId);
+}
+
+static void removeFromCell(int uniqueId, CellKey cell)
+{
+    Cells::iterator iter = cells.find(cell);
+    assert(iter != cells.end());
+    std::vector<int>& ids = iter->second;
+    std::vector<int>::iterator position = std::find(ids.begin(), ids.end(), uniqueId);
+    assert(position != ids.end());
+    *position = ids.back();
+    ids.pop_back();
+    if (ids.empty())
+        cells.erase(iter);
+}
+
+//! Moves entities to their current cells, if we have not done so this frame
+static void updatePositions()
+{
+    if (positionsValid && positionsMillis == totalmillis)
+        return;
+
+    for (IndexedEntities::iterator iter = indexedEntities.begin(); iter != indexedEntities.end(); iter++)
+    {
+        IndexedEntity& indexed = iter->second;
+        indexed.position = getPosition(indexed.entity);
+        CellKey cell = getCellKey(indexed.position);
+        if (cell != indexed.cell)
+        {
+            removeFromCell(iter->first, indexed.cell);
+            addToCell(iter->first, cell);
+            indexed.cell = cell;
+        }
+    }
+
+    positionsValid = true;
+    positionsMillis = totalmillis;
+}
+
+//! Finds the unique IDs of the entities in cells overlapping a box. Some may be outside the box itself
+static void getCandidates(const vec& lo, const vec& hi, std::vector<int>& candidates)
+{
+    int loX = getCellCoord(lo.x), loY = getCellCoord(lo.y), loZ = getCellCoord(lo.z);
+    int hiX = getCellCoord(hi.x), hiY = getCellCoord(hi.y), hiZ = getCellCoord(hi.z);
+
+    double numCells = double(hiX - loX + 1) * double(hiY - loY + 1) * double(hiZ - loZ + 1);
+    if (numCells > cells.size())
+    {
+        // Huge query - cheaper to check every entity than to look up every cell in the range
+        for (IndexedEntities::iterator iter = indexedEntities.begin(); iter != indexedEntities.end(); iter++)
+            candidates.push_back(iter->first);
+        return;
+    }
+
+    for (int x = loX; x <= hiX; x++)
+        for (int y = loY; y <= hiY; y++)
+            for (int z = loZ; z <= hiZ; z++)
+            {
+                Cells::iterator iter = cells.find(getCellKey(x, y, z));
+                if (iter != cells.end())
+                    candidates.insert(candidates.end(), iter->second.begin(), iter->second.end());
+            }
+}
+
+
+// Tag index
+
+typedef std::map<int, std::vector<std::string> > EntityTags;
+typedef std::map<std::string, std::set<int> > TagEntities;
+
+static EntityTags entityTags;   //!< By unique ID
+static TagEntities tagEntities; //!< By tag
+
+//! Returns the entities with a tag, or NULL if there are none
+static std::set<int>* getTagged(const char *tag)
+{
+    TagEntities::iterator iter = tagEntities.find(tag);
+    return iter != tagEntities.end() ? &iter->second : NULL;
+}
+
+
+// Queries
+
+//! Sorts by distance, then unique ID, so results do not depend on the order in the index
+static bool closerThan(const std::pair<int, float>& a, const std::pair<int, float>& b)
+{
+    if (a.second != b.second)
+        return a.second < b.second;
+    return a.first < b.first;
+}
+
+//! Finds the entities in a box, optionally with a tag, keeping those that 'accept' - which also sets their distance
+template<class Accept>
+static void query(const vec& lo, const vec& hi, const char *tag, Accept accept, EntityIndex::Results& results)
+{
+    updatePositions();
+
+    std::vector<int> candidates;
+    if (tag && tag[0])
+    {
+        // Entities with a particular tag are typically few, so just check them all
+        std::set<int> *tagged = getTagged(tag);
+        if (!tagged)
+            return;
+        candidates.assign(tagged->begin(), tagged->end());
+    } else
+        getCandidates(lo, hi, candidates);
+
+    for (unsigned int i = 0; i < candidates.size(); i++)
+    {
+        IndexedEntities::iterator iter = indexedEntities.find(candidates[i]);
+        if (iter == indexedEntities.end())
+            continue; // A tagged non-Sauer entity
+        float distance;
+        if (accept(iter->second.position, distance))
+            results.push_back(std::make_pair(candidates[i], distance));
+    }
+
+    std::sort(results.begin(), results.end(), closerThan);
+}
+
+struct AcceptInRadius
+{
+    vec origin;
+    float radius;
+
+    AcceptInRadius(const vec& _origin, float _radius) : origin(_origin), radius(_radius) { };
+
+    bool operator()(const vec& position, float& distance)
+    {
+        distance = position.dist(origin);
+        return distance <= radius;
+    }
+};
+
+struct AcceptInBox
+{
+    vec lo, hi, center;
+
+    AcceptInBox(const vec& _lo, const vec& _hi) : lo(_lo), hi(_hi), center(vec(_lo).add(_hi).mul(0.5f)) { };
+
+    bool operator()(const vec& position, float& distance)
+    {
+        if (position.x < lo.x || position.y < lo.y || position.z < lo.z ||
+            position.x > hi.x || position.y > hi.y || position.z > hi.z)
+            return false;
+        distance = position.dist(center);
+        return true;
+    }
+};
+
+
+// EntityIndex
+
+void EntityIndex::add(CLogicEntity *entity)
+{
+    if (!entity->isDynamic() && !entity->isStatic())
+        return;
+
+    int uniqueId = entity->getUniqueId();
+    assert(indexedEntities.find(uniqueId) == indexedEntities.end());
+
+    IndexedEntity& indexed = indexedEntities[uniqueId];
+    indexed.entity = entity;
+    indexed.position = getPosition(entity);
+    indexed.cell = getCellKey(indexed.position);
+    addToCell(uniqueId, indexed.cell);
+}
+
+void EntityIndex::remove(int uniqueId)
+{
+    IndexedEntities::iterator iter = indexedEntities.find(uniqueId);
+    if (iter != indexedEntities.end())
+    {
+        removeFromCell(uniqueId, iter->second.cell);
+        indexedEntities.erase(iter);
+    }
+
+    setTags(uniqueId, std::vector<std::string>());
+}
+
+void EntityIndex::clear()
+{
+    indexedEntities.clear();
+    cells.clear();
+    entityTags.clear();
+    tagEntities.clear();
+    positionsValid = false;
+}
+
+void EntityIndex::invalidate()
+{
+    positionsValid = false;
+}
+
+void EntityIndex::getInRadius(const vec& origin, float radius, const char *tag, Results& results)
+{
+    vec extent(radius, radius, radius);
+    query(vec(origin).sub(extent), vec(origin).add(extent), tag, AcceptInRadius(origin, radius), results);
+}
+
+void EntityIndex::getInBox(const vec& lo, const vec& hi, const char *tag, Results& results)
+{
+    query(lo, hi, tag, AcceptInBox(lo, hi), results);
+}
+
+void EntityIndex::setTags(int uniqueId, const std::vector<std::string>& tags)
+{
+    EntityTags::iterator iter = entityTags.find(uniqueId);
+    if (iter != entityTags.end())
+    {
+        std::vector<std::string>& oldTags = iter->second;
+        for (unsigned int i = 0; i < oldTags.size(); i++)
+        {
+            TagEntities::iterator tagged = tagEntities.find(oldTags[i]);
+            if (tagged == tagEntities.end())
+                continue; // Appeared twice
+            tagged->second.erase(uniqueId);
+            if (tagged->second.empty())
+                tagEntities.erase(tagged);
+        }
+        entityTags.erase(iter);
+    }
+
+    if (tags.empty())
+        return;
+
+    entityTags[uniqueId] = tags;
+    for (unsigned int i = 0; i < tags.size(); i++)
+        tagEntities[tags[i]].insert(uniqueId);
+}
+
+void EntityIndex::getByTag(const char *tag, std::vector<int>& results)
+{
+    std::set<int> *tagged = getTagged(tag);
+    if (tagged)
+        results.assign(tagged->begin(), tagged->end());
+}
+
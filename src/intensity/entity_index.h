@@ -0,0 +1,44 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+//! Indexes of logic entities, for fast queries from scripting:
+//!
+//!  * A spatial index, a uniform grid over the positions of the Sauer entities (dynamic and static). Positions
+//!    are those that scripts see, i.e., feet positions for dynamic entities. The grid is brought up to date
+//!    at most once a frame, lazily, when queried, by rechecking the positions of all entities - which is cheap
+//!    compared to the queries - and whenever scripts move entities themselves (see invalidate()).
+//!  * A tag index, from tags to the unique IDs of entities having them. Scripting tells us of every change to
+//!    the tags of an entity.
+//!
+//! Non-Sauer entities are not in the spatial index, as their positions, if any, live only in scripting.
+
+struct EntityIndex
+{
+    //! Unique IDs and distances, sorted from close to far
+    typedef std::vector< std::pair<int, float> > Results;
+
+    //! Called when the LogicSystem registers or unregisters an entity
+    static void add(CLogicEntity *entity);
+    static void remove(int uniqueId);
+
+    //! Forgets all entities and tags, when the LogicSystem is cleared
+    static void clear();
+
+    //! Forces a recheck of all positions on the next query. Called when scripts move entities
+    static void invalidate();
+
+    //! Finds the entities within 'radius' of 'origin', optionally only those with a tag
+    static void getInRadius(const vec& origin, float radius, const char *tag, Results& results);
+
+    //! Finds the entities in the box between 'lo' and 'hi', sorted by their distance from its center, optionally
+    //! only those with a tag
+    static void getInBox(const vec& lo, const vec& hi, const char *tag, Results& results);
+
+    //! Replaces the tags of an entity
+    static void setTags(int uniqueId, const std::vector<std::string>& tags);
+
+    //! Finds the entities with a tag, by increasing unique ID
+    static void getByTag(const char *tag, std::vector<int>& results);
+};
+
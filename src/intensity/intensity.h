@@ -11,6 +11,7 @@
     #include "script_engine.h"
     #include "engine_additions.h"
     #include "logging.h"
+    #include "profiler.h"
 
     // Additional externs from sauer
 
@@ -33,7 +33,7 @@ AssetHash getIntensityLocalAssetHash(const AssetId& id, AssetManager* manager)
 
     std::string hash = python::extract<std::string>( calculate_file_hash(path) );
 
-    Logging::log(Logging::DEBUG, "Calculated IntensityHash: %s ==== %s\r\n", id.c_str(), hash.c_str());
+    LOG(DEBUG, "Calculated IntensityHash: %s ==== %s\r\n", id.c_str(), hash.c_str());
 
     return hash;
 }
@@ -93,14 +93,14 @@ const AssetInfo IntensityAssetManager::getAssetInfo(const AssetId& id)
 
 void SubfileAction::act(std::string path, float secondsElapsed)
 {
-    Logging::log(Logging::DEBUG, "SubfileAction::act\r\n");
+    LOG(DEBUG, "SubfileAction::act\r\n");
 
     parent->subfileNotification();
 };
 
 bool MapfileLoadAction::shouldAbandon(float secondsElapsed)
 {
-    Logging::log(Logging::DEBUG, "Waiting for mapfile... %.1f seconds\r\n", secondsElapsed);
+    LOG(DEBUG, "Waiting for mapfile... %.1f seconds\r\n", secondsElapsed);
     INDENT_LOG(Logging::DEBUG);
 
     if (!acted)
@@ -138,7 +138,7 @@ void MapfileLoadAction::act(std::string path, float secondsElapsed)
 
 void MapfileLoadAction::subfileNotification()
 {
-    Logging::log(Logging::DEBUG, "MapfileLoadAction::subfileNotification\r\n");
+    LOG(DEBUG, "MapfileLoadAction::subfileNotification\r\n");
 
     // Hackish way to notice when all subfiles arrive
     AssetManager* manager = AssetManager::getManagerByType(AssetManager::MAPFILE);
@@ -175,7 +175,7 @@ AssetHash MapfileManager::getLocalAssetHash(const AssetId& id)
 
 bool MapfileManager::checkLocalAssetPresence(const AssetId& id, bool takeAction)
 {
-    Logging::log(Logging::DEBUG, "MapfileManager::checkLocalAssetPresence : %s (action: %d)\r\n", id.c_str(), takeAction);
+    LOG(DEBUG, "MapfileManager::checkLocalAssetPresence : %s (action: %d)\r\n", id.c_str(), takeAction);
     INDENT_LOG(Logging::DEBUG);
 
     return AssetManager::getManagerByType(AssetManager::RAWFILE)->checkLocalAssetPresence(getSubfileName(id + ".cfg")) &&
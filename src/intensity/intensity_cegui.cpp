@@ -160,26 +160,26 @@ void init()
 {
   try
   {
-	Logging::log(Logging::DEBUG, "Initializing CEGUI\r\n");
+	LOG(DEBUG, "Initializing CEGUI\r\n");
 	INDENT_LOG(Logging::DEBUG);
 
     // Rendering
     CEGUI::OpenGLRenderer* myRenderer = new CEGUI::OpenGLRenderer( 0 );
-	Logging::log(Logging::DEBUG, "Renderer: %d\r\n", myRenderer != NULL);
+	LOG(DEBUG, "Renderer: %d\r\n", myRenderer != NULL);
 
 #ifdef LINUX
     // Resources - we use a copy of DefaultResourceProvider, as CEGUI's version causes 'illegal instruction' crashes, oddly,
     // http://www.cegui.org.uk/phpBB2/viewtopic.php?t=3691&sid=d447e856b966dab7ede5bbdb73f3b23c
     // Just using it in this way, instead of CEGUI's DefaultResourceProvider, avoid the crash - not sure why.
     CEGUI::SimpleResourceProvider* rp = new CEGUI::SimpleResourceProvider();
-    Logging::log(Logging::DEBUG, "Resources: %d\r\n", rp != NULL);
+    LOG(DEBUG, "Resources: %d\r\n", rp != NULL);
 
     // System
-    Logging::log(Logging::DEBUG, "System\r\n");
+    LOG(DEBUG, "System\r\n");
     new CEGUI::System( myRenderer, rp );
 
 #else // WINDOWS (OS X also?) Use the normal CEGUI DefaultResourceProvider - works fine
-    Logging::log(Logging::DEBUG, "System\r\n");
+    LOG(DEBUG, "System\r\n");
     new CEGUI::System( myRenderer );
 
     CEGUI::DefaultResourceProvider* rp = static_cast<CEGUI::DefaultResourceProvider*>
@@ -201,25 +201,25 @@ void init()
     CEGUI::ScriptModule::setDefaultResourceGroup     ("lua_scripts");
 
     // Initialize scripting
-    Logging::log(Logging::DEBUG, "Scripting\r\n");
+    LOG(DEBUG, "Scripting\r\n");
 
 	CEGUI::LuaScriptModule* script = new CEGUI::LuaScriptModule();
     CEGUI::System::getSingleton().setScriptingModule(script);
 
     // Init tolua++ package
-    Logging::log(Logging::DEBUG, "tolua++\r\n");
+    LOG(DEBUG, "tolua++\r\n");
 
     tolua__open ( script->getLuaState() );
 //    tolua_sauer_cegui_open ( script->getLuaState() );
 
     // Lua preparations
-    Logging::log(Logging::DEBUG, "Lua Library and Init scripts\r\n");
+    LOG(DEBUG, "Lua Library and Init scripts\r\n");
 
     CEGUI::System::getSingleton().executeScriptFile("Library.lua"); // General-purpose functions
     CEGUI::System::getSingleton().executeScriptFile("Init.lua");    // Initialization, before doing anything
 
     // Fonts
-    Logging::log(Logging::DEBUG, "Fonts\r\n");
+    LOG(DEBUG, "Fonts\r\n");
 
     drawTextFont = CEGUI::FontManager::getSingleton().getFont("DejaVuSans-10");
 
@@ -268,12 +268,12 @@ void drawText(std::string str, int left, int top, int r, int g, int b, int a, in
         );
     else
 #endif
-    Logging::log(Logging::INFO, "Writing drawText to console: %s\r\n", str.c_str());
+    LOG(INFO, "Writing drawText to console: %s\r\n", str.c_str());
 }
 
 bool handleKeypress(SDLKey sym, int unicode, bool isdown)
 {
-    Logging::log(Logging::INFO, "Handling (SDL, CEGUI, unicode, down) %d, %d, %d, %d", sym, SDLKeyToCEGUIKey(sym), unicode, isdown);
+    LOG(INFO, "Handling (SDL, CEGUI, unicode, down) %d, %d, %d, %d", sym, SDLKeyToCEGUIKey(sym), unicode, isdown);
 
     bool handled = false;
 
@@ -282,7 +282,7 @@ bool handleKeypress(SDLKey sym, int unicode, bool isdown)
 
     if (unicode && isdown)
     {
-        Logging::log(Logging::INFO, "Injecting unicode %d", unicode);
+        LOG(INFO, "Injecting unicode %d", unicode);
 
         switch (unicode)
         {
@@ -323,7 +323,7 @@ bool handleKeypress(SDLKey sym, int unicode, bool isdown)
     }
     else
     {
-        Logging::log(Logging::INFO, "Injecting keydown or keyup\r\n");
+        LOG(INFO, "Injecting keydown or keyup\r\n");
         if (isdown)
             handled = handled || CEGUI::System::getSingleton().injectKeyDown( SDLKeyToCEGUIKey(sym) );
         else
@@ -333,7 +333,7 @@ bool handleKeypress(SDLKey sym, int unicode, bool isdown)
     if (!handled) // If the layout has a modal window, we 'handle' events so Sauer doesn't get them
         handled = CEGUI::System::getSingleton().getScriptingModule()->executeScriptGlobal("isLayoutModal");
 
-    Logging::log(Logging::INFO, "Handled: %d\r\n", handled);
+    LOG(INFO, "Handled: %d\r\n", handled);
 
     return handled;
 }
@@ -360,14 +360,14 @@ bool handleMousebuttonupEvent(Uint8 SDLbutton)
             handled =  CEGUI::System::getSingleton().injectMouseWheelChange(+0.1f);
             break;
         default:
-            Logging::log(Logging::WARNING, "Odd, a non-standard SDL mousebutton pressed up: %d\r\n", SDLbutton);
+            LOG(WARNING, "Odd, a non-standard SDL mousebutton pressed up: %d\r\n", SDLbutton);
             handled =  false;
     }
 
     if (!handled) // If the layout has a modal window, we 'handle' events so Sauer doesn't get them
         handled = CEGUI::System::getSingleton().getScriptingModule()->executeScriptGlobal("isLayoutModal");
 
-    Logging::log(Logging::INFO, "IntensityCEGUI handling upclick: %d\r\n", handled);
+    LOG(INFO, "IntensityCEGUI handling upclick: %d\r\n", handled);
 
     return handled;
 }
@@ -395,7 +395,7 @@ bool handleMousebuttondownEvent(Uint8 SDLbutton)
             handled =  CEGUI::System::getSingleton().injectMouseWheelChange(+0.1f);
             break;
         default:
-            Logging::log(Logging::WARNING, "Odd, a non-standard SDL mousebutton pressed down: %d\r\n", SDLbutton);
+            LOG(WARNING, "Odd, a non-standard SDL mousebutton pressed down: %d\r\n", SDLbutton);
             handled =  false;
     }
 
@@ -405,7 +405,7 @@ bool handleMousebuttondownEvent(Uint8 SDLbutton)
     if (!handled)
         CEGUI::System::getSingleton().executeScriptFile("HandleOutsideClick.lua");
 
-    Logging::log(Logging::INFO, "IntensityCEGUI handling downclick: %d\r\n", handled);
+    LOG(INFO, "IntensityCEGUI handling downclick: %d\r\n", handled);
 
     return handled;
 }
@@ -317,8 +317,8 @@ void luaPopulateEntityList(CEGUI::Window* entityListWindow)
         iter != LogicSystem::logicEntities.end();
         iter++)
     {
-        int uniqueId = iter->first;
-        ScriptValuePtr scriptEntity = iter->second.get()->scriptEntity;
+        int uniqueId = (*iter)->getUniqueId();
+        ScriptValuePtr scriptEntity = (*iter)->scriptEntity;
         std::string className = scriptEntity->getPropertyString("_class");
 
         CEGUI::TreeItem* item = new CEGUI::TreeItem( Utility::toString(uniqueId) );
@@ -351,8 +351,8 @@ void luaPopulateEntityList(CEGUI::Window* entityListWindow)
         iter != LogicSystem::logicEntities.end();
         iter++)
     {
-        int uniqueId = iter->first;
-        ScriptValuePtr scriptEntity = iter->second.get()->scriptEntity;
+        int uniqueId = (*iter)->getUniqueId();
+        ScriptValuePtr scriptEntity = (*iter)->scriptEntity;
         ScriptValuePtr tags = scriptEntity->getProperty("tags");
         int numTags = tags->getPropertyInt("length");
 
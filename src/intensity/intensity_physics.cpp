@@ -31,24 +31,24 @@ void createEngine(std::string type)
 {
     destroyEngine();
 
-    Logging::log(Logging::DEBUG, "Creating physics engine: %s\r\n", type.c_str());
+    LOG(DEBUG, "Creating physics engine: %s\r\n", type.c_str());
 
     if (type == "sauer")
     {
-        Logging::log(Logging::DEBUG, "Using sauer physics engine\r\n");
+        LOG(DEBUG, "Using sauer physics engine\r\n");
         engine = new SauerPhysicsEngine();
     }
 #ifdef INTENSITY_BULLET
     else if (type == "bullet")
     {
-        Logging::log(Logging::DEBUG, "Using bullet physics engine\r\n");
+        LOG(DEBUG, "Using bullet physics engine\r\n");
         engine = new BulletPhysicsEngine();
     }
 #endif
     else
     {
         #ifdef CLIENT
-            Logging::log(Logging::ERROR, "Invalid physics engine: %s, disconnecting\r\n", type.c_str());
+            LOG(ERROR, "Invalid physics engine: %s, disconnecting\r\n", type.c_str());
             EXEC_PYTHON(
                 "def do_disconnect():\n"
                 "    CModule.disconnect()\n"
@@ -56,7 +56,7 @@ void createEngine(std::string type)
             ); // We are loading a map now - must disconnect after that is complete
             return;
         #else // SERVER
-            Logging::log(Logging::ERROR, "Invalid physics engine: %s, quitting\r\n", type.c_str());
+            LOG(ERROR, "Invalid physics engine: %s, quitting\r\n", type.c_str());
             ServerSystem::fatalMessageToClients("Invalid physics engine, quitting");
             assert(0);
         #endif
@@ -69,7 +69,7 @@ void destroyEngine()
 {
     if (engine != NULL)
     {
-        Logging::log(Logging::DEBUG, "Destroying physics engine\r\n");
+        LOG(DEBUG, "Destroying physics engine\r\n");
 
         engine->destroy();
         delete engine;
@@ -94,7 +94,7 @@ void clearWorldGeometry()
 {
     REQUIRE_ENGINE
 
-    Logging::log(Logging::DEBUG, "*** Clear world geometry ***\r\n");
+    LOG(DEBUG, "*** Clear world geometry ***\r\n");
 
     engine->clearStaticGeometry();
 }
@@ -137,7 +137,7 @@ void setupWorldGeometryTriGroup(usvector& data, int tex, int lightmapTex, int or
     assert(ibufCount % 3 == 0);
     unsigned int numTris = ibufCount/3;
 
-    Logging::log(Logging::DEBUG, "IO: setupWorldGeometryTriGroup: %d\r\n", ibufCount);
+    LOG(DEBUG, "IO: setupWorldGeometryTriGroup: %d\r\n", ibufCount);
 
     std::vector<vec> currPolygon;
     int base;
@@ -161,7 +161,91 @@ void finishWorldGeometryVerts()
     currVecs = NULL;
 }
 
-// Cube world processing utilities
+// Cube world processing utilities. Fully solid leaf cubes, and partial cubes that happen to be boxes, are
+// gathered as boxes, and merged before they are given to the physics engine: in a typical map, most of the
+// tens of thousands of solid cubes are neighbors with the same cross-section, which merge into far fewer
+// boxes. Other partial cubes are given as convex hulls.
+
+    //! An axis-aligned box, in world units
+    struct StaticBox
+    {
+        int lo[3], hi[3];
+    };
+
+    std::vector<StaticBox> staticBoxes;
+
+    void addStaticBox(int loX, int loY, int loZ, int hiX, int hiY, int hiZ)
+    {
+        StaticBox box;
+        box.lo[0] = loX; box.lo[1] = loY; box.lo[2] = loZ;
+        box.hi[0] = hiX; box.hi[1] = hiY; box.hi[2] = hiZ;
+        staticBoxes.push_back(box);
+    }
+
+    //! Orders boxes so that those with the same extent in the other axes are consecutive, and sorted along 'axis'
+    struct StaticBoxOrder
+    {
+        int axis;
+
+        StaticBoxOrder(int _axis) : axis(_axis) { };
+
+        bool operator()(const StaticBox& a, const StaticBox& b) const
+        {
+            for (int i = 1; i <= 2; i++)
+            {
+                int other = (axis + i) % 3;
+                if (a.lo[other] != b.lo[other]) return a.lo[other] < b.lo[other];
+                if (a.hi[other] != b.hi[other]) return a.hi[other] < b.hi[other];
+            }
+            return a.lo[axis] < b.lo[axis];
+        }
+    };
+
+    //! Merges boxes that touch along an axis and have the same extent in the other two.
+    //! @return Whether any were merged
+    bool mergeStaticBoxes(std::vector<StaticBox>& boxes, int axis)
+    {
+        if (boxes.size() < 2)
+            return false;
+
+        std::sort(boxes.begin(), boxes.end(), StaticBoxOrder(axis));
+
+        unsigned int last = 0;
+        for (unsigned int i = 1; i < boxes.size(); i++)
+        {
+            StaticBox& merged = boxes[last];
+            const StaticBox& curr = boxes[i];
+            bool sameSection = true;
+            for (int j = 1; j <= 2; j++)
+            {
+                int other = (axis + j) % 3;
+                sameSection = sameSection && merged.lo[other] == curr.lo[other] && merged.hi[other] == curr.hi[other];
+            }
+            if (sameSection && merged.hi[axis] == curr.lo[axis])
+                merged.hi[axis] = curr.hi[axis];
+            else
+                boxes[++last] = curr;
+        }
+
+        bool ret = last + 1 < boxes.size();
+        boxes.resize(last + 1);
+        return ret;
+    }
+
+    //! Greedily merges boxes, along each axis in turn, until nothing more can be merged. Merging along one axis
+    //! makes boxes that may then merge along the others
+    void mergeStaticBoxes(std::vector<StaticBox>& boxes)
+    {
+        int axis = 0, unchanged = 0;
+        while (unchanged < 3)
+        {
+            if (mergeStaticBoxes(boxes, axis))
+                unchanged = 0;
+            else
+                unchanged++;
+            axis = (axis + 1) % 3;
+        }
+    }
 
     void loopOctree(cube* c, int size, ivec o);
 
@@ -169,17 +253,21 @@ void finishWorldGeometryVerts()
     {
         if (!c->children)
         {
-            renderprogress(float(o.x)/getworldsize(), "processing octree for physics...");
+            static int counter = 0;
+            if (++counter == 1000)
+            {
+                counter = 0;
+                renderprogress(float(o.x)/getworldsize(), "processing octree for physics...");
+            }
 
-            Logging::log(Logging::DEBUG, "processOctanode: %4d,%4d,%4d : %4d,%4d,%4d   (%.8x,%.8x,%.8x)\r\n", o.x, o.y, o.z, o.x+size, o.y+size, o.z+size, c->faces[0], c->faces[1], c->faces[2]);
+            LOG(DEBUG, "processOctanode: %4d,%4d,%4d : %4d,%4d,%4d   (%.8x,%.8x,%.8x)\r\n", o.x, o.y, o.z, o.x+size, o.y+size, o.z+size, c->faces[0], c->faces[1], c->faces[2]);
 
             if (isentirelysolid(*c))
-                engine->addStaticCube(vec(o.x+size/2, o.y+size/2, o.z+size/2), vec(size/2));
+                addStaticBox(o.x, o.y, o.z, o.x+size, o.y+size, o.z+size);
             else if (!isempty(*c))
             {
                 // Not fully solid, create convex shape with the verts
-                // TODO: Optimize, use addStaticCube when rectangular
-                Logging::log(Logging::DEBUG, "Not fully solid nor empty\r\n");
+                LOG(DEBUG, "Not fully solid nor empty\r\n");
                 vvec vv[8];
                 bool usefaces[8];
                 int vertused = calcverts(*c, o.x, o.y, o.z, size, vv, usefaces);
@@ -187,12 +275,12 @@ void finishWorldGeometryVerts()
                 loopi(8) if(vertused&(1<<i))
                 {
                     vec t = vv[i].tovec(o);
-                    Logging::log(Logging::INFO, "vv: %f,%f,%f\r\n", t.x, t.y, t.z);
+                    LOG(INFO, "vv: %f,%f,%f\r\n", t.x, t.y, t.z);
                     vecs.push_back(t);
                 }
                 assert(vecs.size() > 0);
 
-                // Test for simple rectangular objects, which we sent as Cubes, not Convexes
+                // Test for simple rectangular objects, which we send as boxes, not convexes
                 std::set<int> dimensionValues[3];
                 int dimensionMins[3], dimensionMaxes[3];
                 for (unsigned int j = 0; j < vecs.size(); j++)
@@ -213,7 +301,7 @@ void finishWorldGeometryVerts()
                 for (int k = 0; k < 3; k++)
                     if (dimensionValues[k].size() > 2)
                     {
-                        Logging::log(Logging::DEBUG, "Adding as Convex\r\n");
+                        LOG(DEBUG, "Adding as Convex\r\n");
                         engine->addStaticConvex(vecs);
                         return;
                     }
@@ -235,21 +323,13 @@ void finishWorldGeometryVerts()
                 for (int i = 0; i < 8; i++)
                     if (!found[i])
                     {
-                        Logging::log(Logging::DEBUG, "In the end, adding as Convex\r\n");
+                        LOG(DEBUG, "In the end, adding as Convex\r\n");
                         engine->addStaticConvex(vecs);
                         return;
                     }
 
-                Logging::log(Logging::DEBUG, "Adding as Cube\r\n");
-                engine->addStaticCube(vec(
-                    (dimensionMins[0]+dimensionMaxes[0])/2,
-                    (dimensionMins[1]+dimensionMaxes[1])/2,
-                    (dimensionMins[2]+dimensionMaxes[2])/2
-                ), vec(
-                    (dimensionMaxes[0]-dimensionMins[0])/2,
-                    (dimensionMaxes[1]-dimensionMins[1])/2,
-                    (dimensionMaxes[2]-dimensionMins[2])/2
-                ));
+                LOG(DEBUG, "Adding as box\r\n");
+                addStaticBox(dimensionMins[0], dimensionMins[1], dimensionMins[2], dimensionMaxes[0], dimensionMaxes[1], dimensionMaxes[2]);
             }
         } else {
             loopOctree(c->children, size, o);
@@ -268,14 +348,34 @@ void finalizeWorldGeometry()
 {
     REQUIRE_ENGINE
 
-    Logging::log(Logging::DEBUG, "*** Finalize world geometry ***\r\n");
+    LOG(DEBUG, "*** Finalize world geometry ***\r\n");
 
     if (engine->requiresStaticCubes())
     {
         renderprogress(0, "generating physics geometries");
 
+        Profiler::Nanoseconds startTime = Profiler::now();
+
         // Loop the octree and provide the physics engine with the cube info
+        staticBoxes.clear();
         loopOctree(worldroot, worldsize, vec(0));
+
+        int numCubes = staticBoxes.size();
+        mergeStaticBoxes(staticBoxes);
+
+        for (unsigned int i = 0; i < staticBoxes.size(); i++)
+        {
+            StaticBox& box = staticBoxes[i];
+            engine->addStaticCube(
+                vec(box.lo[0] + box.hi[0], box.lo[1] + box.hi[1], box.lo[2] + box.hi[2]).mul(0.5f),
+                vec(box.hi[0] - box.lo[0], box.hi[1] - box.lo[1], box.hi[2] - box.lo[2]).mul(0.5f)
+            );
+        }
+
+        LOG(INFO, "Physics: Octree processed in %.2f ms, %d solid cubes merged into %d boxes\r\n",
+            (Profiler::now() - startTime) / 1000000.0f, numCubes, int(staticBoxes.size()));
+
+        std::vector<StaticBox>().swap(staticBoxes); // Free the memory
     }
 
     engine->finalizeStaticGeometry();
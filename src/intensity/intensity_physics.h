@@ -42,7 +42,7 @@ public:
     virtual bool requiresStaticPolygons() { return false; };
 
     //! Add a polygon to be collided against, that is treated as completely fixed - static geometry
-    virtual void addStaticPolygon(std::vector<vec> vertexes) { };
+    virtual void addStaticPolygon(const std::vector<vec>& vertexes) { };
 
     virtual void finalizeStaticGeometry() { };
 
@@ -30,6 +30,12 @@
 #include "intensity_physics_realistic.h"
 #include "intensity_physics_bullet.h"
 
+#include "utility.h"
+
+
+//! Whether to cache the BVHs of static geometry, see loadStaticBvh()
+static Utility::Config::Int useBvhCache("Physics", "bvh_cache", 1);
+
 
 // Sauer coordinates are in 'cubes', not metres as in Bullet
 #define SAUER_FACTOR 17.0
@@ -141,10 +147,10 @@ void BulletPhysicsEngine::init()
         m_dynamicsWorld->setDebugDrawer(m_debugDrawer);
     #endif
 
-    m_staticTriangleVertices = NULL;
-    m_staticTriangleIndexes = NULL;
     m_indexVertexArrays = NULL;
     m_globalStaticGeometry = NULL;
+    m_staticBvhBuffer = NULL;
+    m_staticCompound = NULL;
 }
 
 void BulletPhysicsEngine::destroy()
@@ -161,10 +167,8 @@ void BulletPhysicsEngine::destroy()
     delete m_broadPhase;
     delete m_constraintSolver;
 
-    DELETEP(m_globalStaticGeometry);
-    DELETEP(m_indexVertexArrays);
-    DELETEP(m_staticTriangleVertices);
-    DELETEP(m_staticTriangleIndexes);
+    destroyStaticGeometry();
+    destroyStaticCompound();
 
     #ifdef CLIENT
         delete m_debugDrawer;
@@ -189,14 +193,61 @@ void BulletPhysicsEngine::clearStaticGeometry()
     for (unsigned int i = 0; i < toErase.size(); i++)
         removeBody(toErase[i]);
 
+    destroyStaticCompound();
+
     // Prepare global static
     if (requiresStaticPolygons())
     {
-        m_staticTriangles.clear();
+        destroyStaticGeometry();
+        m_staticVertexes.clear();
+        m_staticIndexes.clear();
+        m_staticVertexMap.clear();
+        m_staticTriangleMap.clear();
+    }
+}
+
+void BulletPhysicsEngine::destroyStaticGeometry()
+{
+    DELETEP(m_globalStaticGeometry); // Does not own a BVH loaded from the cache, so free that after it
+    DELETEP(m_indexVertexArrays);
+    if (m_staticBvhBuffer)
+    {
+        btAlignedFree(m_staticBvhBuffer);
+        m_staticBvhBuffer = NULL;
     }
 }
 
-void BulletPhysicsEngine::addStaticPolygon(std::vector<vec> vertexes)
+int BulletPhysicsEngine::addStaticVertex(const btVector3& position)
+{
+    BulletStaticVertexKey key(position);
+    int *index = m_staticVertexMap.find(key);
+    if (index)
+        return *index;
+
+    int ret = m_staticVertexes.size();
+    m_staticVertexes.push_back(position);
+    m_staticVertexMap.insert(key, ret);
+    return ret;
+}
+
+void BulletPhysicsEngine::removeStaticTriangle(int triangle)
+{
+    int *indexes = &m_staticIndexes[3*triangle];
+    m_staticTriangleMap.remove(BulletStaticTriangleKey(indexes[0], indexes[1], indexes[2]));
+
+    // Fill the gap with the last triangle
+    int last = m_staticIndexes.size()/3 - 1;
+    if (triangle != last)
+    {
+        int *lastIndexes = &m_staticIndexes[3*last];
+        for (int i = 0; i < 3; i++)
+            indexes[i] = lastIndexes[i];
+        *m_staticTriangleMap.find(BulletStaticTriangleKey(indexes[0], indexes[1], indexes[2])) = triangle;
+    }
+    m_staticIndexes.resize(3*last);
+}
+
+void BulletPhysicsEngine::addStaticPolygon(const std::vector<vec>& vertexes)
 {
 // XXX "Avoid huge or degenerate triangles in a triangle mesh Keep the size of triangles reasonable, say below 10 units/meters."
 // - from PDF
@@ -217,12 +268,37 @@ void BulletPhysicsEngine::addStaticPolygon(std::vector<vec> vertexes)
 
     // btBvhTriangleMeshShape method
     assert(vertexes.size() == 3);
-    for (unsigned int i = 0; i < vertexes.size(); i++)
+    int indexes[3];
+    for (int i = 0; i < 3; i++)
+        indexes[i] = addStaticVertex(FROM_SAUER_VEC(vertexes[i]));
+
+    // Degenerate triangles - with repeated vertexes, or no area - are useless for collision, and bad for Bullet
+    if (indexes[0] == indexes[1] || indexes[1] == indexes[2] || indexes[0] == indexes[2])
+        return;
+    btVector3 edge1 = m_staticVertexes[indexes[1]] - m_staticVertexes[indexes[0]];
+    btVector3 edge2 = m_staticVertexes[indexes[2]] - m_staticVertexes[indexes[0]];
+    if (edge1.cross(edge2).length2() < SIMD_EPSILON)
+        return;
+
+    BulletStaticTriangleKey key(indexes[0], indexes[1], indexes[2]);
+    int *existing = m_staticTriangleMap.find(key);
+    if (existing)
     {
-        vec& currVec = vertexes[i];
-        btVector3 currBtVec = FROM_SAUER_VEC(currVec);
-        m_staticTriangles.push_back(currBtVec);
+        // The same triangle in the same winding adds nothing to what we already have. In the opposite winding,
+        // the two are coplanar faces back to back, which are internal to the geometry, so both are removed
+        int *other = &m_staticIndexes[3*(*existing)];
+        bool sameWinding = false;
+        for (int i = 0; i < 3; i++)
+            if (other[i] == indexes[0] && other[(i+1)%3] == indexes[1] && other[(i+2)%3] == indexes[2])
+                sameWinding = true;
+        if (!sameWinding)
+            removeStaticTriangle(*existing);
+        return;
     }
+    m_staticTriangleMap.insert(key, m_staticIndexes.size()/3);
+
+    for (int i = 0; i < 3; i++)
+        m_staticIndexes.push_back(indexes[i]);
 }
 
 #define CREATE_MESH(staticTriangles, staticTriangleVertices, staticTriangleIndexes, indexVertexArrays, shape) \
@@ -256,17 +332,147 @@ void BulletPhysicsEngine::addStaticPolygon(std::vector<vec> vertexes)
 
 void BulletPhysicsEngine::finalizeStaticGeometry()
 {
+    if (requiresStaticCubes())
+    {
+        if (m_staticCompound)
+        {
+            m_staticCompound->recalculateLocalAabb();
+            addBody(m_staticCompound, 0, true);
+            LOG(INFO, "Physics: Static geometry of %d shapes, in a single body\r\n", m_staticCompound->getNumChildShapes());
+        }
+        return;
+    }
+
     if (!requiresStaticPolygons()) return;
 
-    DELETEP(m_staticTriangleVertices);
-    DELETEP(m_staticTriangleIndexes);
-    DELETEP(m_indexVertexArrays);
-    DELETEP(m_globalStaticGeometry);
+    destroyStaticGeometry();
+
+    // The lookup structures are only needed while adding
+    m_staticVertexMap.clear();
+    m_staticTriangleMap.clear();
+
+    int numIndexes = m_staticIndexes.size(), numVertexes = m_staticVertexes.size();
+    if (numIndexes == 0)
+        return; // Bullet cannot handle an empty mesh
+
+    Profiler::Nanoseconds startTime = Profiler::now();
+
+    m_indexVertexArrays = new btTriangleIndexVertexArray(
+        numIndexes/3,
+        &m_staticIndexes[0],
+        3*sizeof(int),
+        numVertexes,
+        (btScalar*) &m_staticVertexes[0].x(),
+        sizeof(btVector3)
+    );
+
+    // The BVH depends only on the welded mesh, so a checksum of that identifies it
+    unsigned int key = crc32(0, NULL, 0);
+    key = crc32(key, (const Bytef*)&m_staticVertexes[0], numVertexes*sizeof(btVector3));
+    key = crc32(key, (const Bytef*)&m_staticIndexes[0], numIndexes*sizeof(int));
+
+    btOptimizedBvh *bvh = useBvhCache.get() ? loadStaticBvh(key, numVertexes, numIndexes) : NULL;
+    if (bvh)
+    {
+        m_globalStaticGeometry = new btBvhTriangleMeshShape(m_indexVertexArrays, true, false);
+        m_globalStaticGeometry->setOptimizedBvh(bvh);
+    } else {
+        m_globalStaticGeometry = new btBvhTriangleMeshShape(m_indexVertexArrays, true);
+        if (useBvhCache.get())
+            saveStaticBvh(key, numVertexes, numIndexes, m_globalStaticGeometry->getOptimizedBvh());
+    }
+
+    LOG(INFO, "Physics: Static mesh of %d triangles, %d vertexes, BVH %s in %.2f ms\r\n",
+        numIndexes/3, numVertexes, bvh ? "loaded" : "built", (Profiler::now() - startTime) / 1000000.0f);
 
-    CREATE_MESH(m_staticTriangles, m_staticTriangleVertices, m_staticTriangleIndexes, m_indexVertexArrays, m_globalStaticGeometry);
     addBody(m_globalStaticGeometry, 0, true); // We rely on removal of static bodies elsewhere in the code
 }
 
+// Cache of static mesh BVHs, so that reloading a map does not rebuild them. The file is a header followed
+// by the BVH in Bullet's in-place serialization format (native endianness, as the cache is local).
+// deSerializeInPlace trusts the data completely, so besides the checksum the header records everything the
+// BVH's triangle indexes and layout depend on, and a file that differs in any of it is rebuilt.
+
+struct StaticBvhCacheHeader
+{
+    char magic[4];
+    int version;
+    unsigned int key, size;
+    int numVertexes, numIndexes;
+    int bulletVersion, scalarSize;
+};
+
+#define STATIC_BVH_CACHE_MAGIC "IBVH"
+#define STATIC_BVH_CACHE_VERSION 2
+
+static std::string getStaticBvhCacheFile(unsigned int key)
+{
+    defformatstring(filename)("cache/physics/%08x.bvh", key);
+    return path(filename);
+}
+
+btOptimizedBvh* BulletPhysicsEngine::loadStaticBvh(unsigned int key, int numVertexes, int numIndexes)
+{
+    stream *f = openrawfile(getStaticBvhCacheFile(key).c_str(), "rb");
+    if (!f)
+        return NULL;
+
+    btOptimizedBvh *bvh = NULL;
+    StaticBvhCacheHeader header;
+    if (f->read(&header, sizeof(header)) == sizeof(header) &&
+        !memcmp(header.magic, STATIC_BVH_CACHE_MAGIC, 4) &&
+        header.version == STATIC_BVH_CACHE_VERSION &&
+        header.key == key &&
+        header.size > 0 &&
+        header.numVertexes == numVertexes &&
+        header.numIndexes == numIndexes &&
+        header.bulletVersion == BT_BULLET_VERSION &&
+        header.scalarSize == int(sizeof(btScalar)))
+    {
+        m_staticBvhBuffer = btAlignedAlloc(header.size, 16);
+        if (f->read(m_staticBvhBuffer, header.size) == int(header.size))
+            bvh = btOptimizedBvh::deSerializeInPlace(m_staticBvhBuffer, header.size, false);
+        if (!bvh)
+        {
+            btAlignedFree(m_staticBvhBuffer);
+            m_staticBvhBuffer = NULL;
+        }
+    }
+    delete f;
+
+    if (!bvh)
+        LOG(WARNING, "Physics: Ignoring invalid BVH cache file for %08x\r\n", key);
+
+    return bvh;
+}
+
+void BulletPhysicsEngine::saveStaticBvh(unsigned int key, int numVertexes, int numIndexes, btOptimizedBvh* bvh)
+{
+    unsigned int size = bvh->calculateSerializeBufferSize();
+    void *buffer = btAlignedAlloc(size, 16);
+    if (bvh->serializeInPlace(buffer, size, false))
+    {
+        stream *f = openrawfile(getStaticBvhCacheFile(key).c_str(), "wb");
+        if (f)
+        {
+            StaticBvhCacheHeader header;
+            memcpy(header.magic, STATIC_BVH_CACHE_MAGIC, 4);
+            header.version = STATIC_BVH_CACHE_VERSION;
+            header.key = key;
+            header.size = size;
+            header.numVertexes = numVertexes;
+            header.numIndexes = numIndexes;
+            header.bulletVersion = BT_BULLET_VERSION;
+            header.scalarSize = sizeof(btScalar);
+            f->write(&header, sizeof(header));
+            f->write(buffer, size);
+            delete f;
+        } else
+            LOG(WARNING, "Physics: Cannot write BVH cache file for %08x\r\n", key);
+    }
+    btAlignedFree(buffer);
+}
+
 physicsHandle BulletPhysicsEngine::addBody(btCollisionShape *shape, float mass, bool isWorldGeometry)
 {
     btVector3 localInertia(0, 0, 0);
@@ -285,13 +491,13 @@ physicsHandle BulletPhysicsEngine::addBody(btCollisionShape *shape, float mass,
     handleBodyMap[handle] = body;
     handleBodyCounter += 1; // TODO: Handle overflow etc. etc. etc.
 
-    Logging::log(Logging::DEBUG, "Physics: Created body: %d\r\n", handle);
+    LOG(DEBUG, "Physics: Created body: %d\r\n", handle);
 
     return handle; // garbage collect ***shape***. Also body also motionstate in previous func, etc.}
 
 void BulletPhysicsEngine::removeBody(physicsHandle handle)
 {
-    Logging::log(Logging::DEBUG, "Physics: Removing body: %d\r\n", handle);
+    LOG(DEBUG, "Physics: Removing body: %d\r\n", handle);
 
     assert(handleBodyMap.count(handle) == 1);
     IntensityBulletBody* body = handleBodyMap[handle];
@@ -313,11 +519,30 @@ void BulletPhysicsEngine::removeConstraint(physicsHandle handle)
     assert(0);
 }
 
+btCompoundShape* BulletPhysicsEngine::getStaticCompound()
+{
+    if (!m_staticCompound)
+        m_staticCompound = new btCompoundShape(true);
+    return m_staticCompound;
+}
+
+void BulletPhysicsEngine::destroyStaticCompound()
+{
+    if (!m_staticCompound)
+        return;
+
+    // Its body was removed with the other static bodies
+    for (int i = 0; i < m_staticCompound->getNumChildShapes(); i++)
+        delete m_staticCompound->getChildShape(i);
+    DELETEP(m_staticCompound);
+}
+
 void BulletPhysicsEngine::addStaticCube(vec o, vec r)
 {
-    btVector3 halfExtents = FROM_SAUER_VEC(r);
-    physicsHandle handle = addBody(new btBoxShape(halfExtents), 0, true);
-    setBodyPosition(handle, o);
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(FROM_SAUER_VEC(o));
+    getStaticCompound()->addChildShape(transform, new btBoxShape(FROM_SAUER_VEC(r)));
 }
 
 void BulletPhysicsEngine::addStaticConvex(std::vector<vec>& vecs)
@@ -336,8 +561,11 @@ void BulletPhysicsEngine::addStaticConvex(std::vector<vec>& vecs)
         btVector3 btRel = FROM_SAUER_VEC(rel);
         convex->addPoint(btRel);
     }
-    physicsHandle handle = addBody(convex, 0, true);
-    setBodyPosition(handle, center);
+
+    btTransform transform;
+    transform.setIdentity();
+    transform.setOrigin(FROM_SAUER_VEC(center));
+    getStaticCompound()->addChildShape(transform, convex);
 }
 
 physicsHandle BulletPhysicsEngine::addSphere(float mass, float radius)
@@ -384,7 +612,7 @@ physicsHandle BulletPhysicsEngine::addMesh(float mass, std::vector<triangle> &tr
 }
 
 #define GET_BODY(handle, body) \
-    Logging::log(Logging::DEBUG, "Physics: Accessing body: %d (line %d)\r\n", handle, __LINE__); \
+    LOG(DEBUG, "Physics: Accessing body: %d (line %d)\r\n", handle, __LINE__); \
     IntensityBulletBody* body = handleBodyMap[handle]; \
     assert(body);
 
@@ -28,6 +28,50 @@
 
 #define BULLET_STATIC_POLYGONS 1
 
+//! Key for welding identical vertexes of the static geometry
+struct BulletStaticVertexKey
+{
+    btVector3 position;
+
+    BulletStaticVertexKey(const btVector3& _position) : position(_position) { };
+
+    bool equals(const BulletStaticVertexKey& other) const { return position == other.position; };
+
+    unsigned int getHash() const
+    {
+        unsigned int hash = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            btScalar value = position[i] + btScalar(0); // -0 and 0 must hash the same, as they compare equal
+            unsigned int bits = 0;
+            memcpy(&bits, &value, min(sizeof(bits), sizeof(value)));
+            hash = hash*131071 ^ bits;
+        }
+        return hash;
+    };
+};
+
+//! Key for finding duplicate static triangles, by their (welded) vertex indexes, regardless of winding
+struct BulletStaticTriangleKey
+{
+    int indexes[3];
+
+    BulletStaticTriangleKey(int a, int b, int c)
+    {
+        if (a > b) swap(a, b);
+        if (b > c) swap(b, c);
+        if (a > b) swap(a, b);
+        indexes[0] = a; indexes[1] = b; indexes[2] = c;
+    };
+
+    bool equals(const BulletStaticTriangleKey& other) const
+    {
+        return indexes[0] == other.indexes[0] && indexes[1] == other.indexes[1] && indexes[2] == other.indexes[2];
+    };
+
+    unsigned int getHash() const { return indexes[0] ^ (indexes[1]*31) ^ (indexes[2]*131071); };
+};
+
 class BulletPhysicsEngine : public RealisticPhysicsEngine
 {
     btBroadphaseInterface* m_overlappingPairCache;
@@ -40,11 +84,37 @@ class BulletPhysicsEngine : public RealisticPhysicsEngine
         btIDebugDraw* m_debugDrawer;
     #endif
 
-    btAlignedObjectArray<btVector3> m_staticTriangles;
-    btVector3* m_staticTriangleVertices;
-    int* m_staticTriangleIndexes;
+    //! The static geometry, as a welded mesh: each distinct vertex appears once, and is shared by index
+    btAlignedObjectArray<btVector3> m_staticVertexes;
+    btAlignedObjectArray<int> m_staticIndexes;
+    btHashMap<BulletStaticVertexKey, int> m_staticVertexMap;
+    btHashMap<BulletStaticTriangleKey, int> m_staticTriangleMap;
     btStridingMeshInterface* m_indexVertexArrays;
-    btCollisionShape* m_globalStaticGeometry;
+    btBvhTriangleMeshShape* m_globalStaticGeometry;
+    void* m_staticBvhBuffer; //!< When the BVH was loaded from the cache, it lives in this buffer
+
+    //! The static geometry, as boxes and convexes (when not using static polygons). All are children of a single
+    //! compound shape, in a single body, so the broadphase sees one static object, and the compound's own AABB
+    //! tree finds the children that matter
+    btCompoundShape* m_staticCompound;
+
+    btCompoundShape* getStaticCompound();
+
+    //! Frees the compound shape and its children
+    void destroyStaticCompound();
+
+    //! Frees the static mesh shape and the structures it refers to
+    void destroyStaticGeometry();
+
+    //! Returns the welded vertex index for a position, adding it if new
+    int addStaticVertex(const btVector3& position);
+
+    //! Removes a triangle of the static mesh, moving the last one into its place
+    void removeStaticTriangle(int triangle);
+
+    //! Loads the BVH of the static mesh from the cache, if one matches 'key' and the mesh's size
+    btOptimizedBvh* loadStaticBvh(unsigned int key, int numVertexes, int numIndexes);
+    void saveStaticBvh(unsigned int key, int numVertexes, int numIndexes, btOptimizedBvh* bvh);
 
     //! Adds a bullet body. Takes ownership of 'shape'.
     physicsHandle addBody(btCollisionShape *shape, float mass, bool isWorldGeometry=false);
@@ -64,7 +134,7 @@ public:
 #else
     virtual bool requiresStaticPolygons() { return false; };
 #endif
-    virtual void addStaticPolygon(std::vector<vec> vertexes);
+    virtual void addStaticPolygon(const std::vector<vec>& vertexes);
     virtual void finalizeStaticGeometry();
 
 #ifdef BULLET_STATIC_POLYGONS
@@ -14,7 +14,7 @@ public:
 
     virtual void clear();
 
-    virtual void addStaticPolygon(std::vector<vec> vertexes);
+    virtual void addStaticPolygon(const std::vector<vec>& vertexes);
 
     virtual void* addDynamic(float mass, float radius);
     virtual void removeDynamic(void* handle);
@@ -62,17 +62,17 @@ void doBackgroundLoading(bool all)
 
 void info_callback(const char* msg, void*)
 {
-    Logging::log(Logging::DEBUG, "OpenJPEG: %s", msg);
+    LOG(DEBUG, "OpenJPEG: %s", msg);
 }
 
 void warning_callback(const char* msg, void*)
 {
-    Logging::log(Logging::WARNING, "OpenJPEG: %s", msg);
+    LOG(WARNING, "OpenJPEG: %s", msg);
 }
 
 void error_callback(const char* msg, void*)
 {
-    Logging::log(Logging::ERROR, "OpenJPEG: %s", msg);
+    LOG(ERROR, "OpenJPEG: %s", msg);
 }
 
 void genopenjpeg(char *infile, char *outfile)
@@ -89,7 +89,7 @@ void genopenjpeg(char *infile, char *outfile)
     int read = file->read(data, size);
     assert(read == size);
 
-    Logging::log(Logging::DEBUG, "Converting jpeg2000 '%s', size: %ld\r\n", infile, size);
+    LOG(DEBUG, "Converting jpeg2000 '%s', size: %ld\r\n", infile, size);
 
     //=========================
     //= Uncompress JPEG2000
@@ -130,7 +130,7 @@ void genopenjpeg(char *infile, char *outfile)
     ImageData sauerimage(width, height, components);
     uchar *rawData = sauerimage.data;
 
-    Logging::log(Logging::DEBUG, " components: %d  w: %d  h: %d\r\n", components, width, height);
+    LOG(DEBUG, " components: %d  w: %d  h: %d\r\n", components, width, height);
 
     for (int i = 0; i < components; i++)
     {
@@ -144,7 +144,7 @@ void genopenjpeg(char *infile, char *outfile)
             assert(component.prec == 8);
         #endif
 
-        Logging::log(Logging::DEBUG, " component %d:  prec: %d  bpp: %d  sgned: %d  resno_d: %d\r\n", i, component.prec, component.bpp, component.sgnd, component.resno_decoded);
+        LOG(DEBUG, " component %d:  prec: %d  bpp: %d  sgned: %d  resno_d: %d\r\n", i, component.prec, component.bpp, component.sgnd, component.resno_decoded);
 
         int offset = i;
         for (int y = (height-1); y >= 0; y--)
@@ -179,7 +179,7 @@ void genopenjpeg(char *infile, char *outfile)
         outfile = buf;
     }
 
-    Logging::log(Logging::DEBUG, "Saving PNG data to: %s\r\n", outfile);
+    LOG(DEBUG, "Saving PNG data to: %s\r\n", outfile);
 
     saveimage(outfile, IMG_PNG, sauerimage, true);
 
@@ -208,7 +208,7 @@ void convertJP2toPNG(std::string source, std::string dest)
     if (boost::python::extract<bool>(check_newer_than(full_dest, full_source)))
         return;
 
-    Logging::log(Logging::DEBUG, "convertJP2toPNG: %s ==> %s\r\n", source.c_str(), dest.c_str());
+    LOG(DEBUG, "convertJP2toPNG: %s ==> %s\r\n", source.c_str(), dest.c_str());
 
     renderprogress(0, ("decompressing image: " + source).c_str());
 
@@ -218,7 +218,7 @@ void convertJP2toPNG(std::string source, std::string dest)
 
 void convertPNGtoDDS(std::string source, std::string dest)
 {
-    Logging::log(Logging::WARNING, "Creating DDS files should not be done in this way!\r\n");
+    LOG(WARNING, "Creating DDS files should not be done in this way!\r\n");
 
     FIX_PATH(source);
     FIX_PATH(dest);
@@ -227,7 +227,7 @@ void convertPNGtoDDS(std::string source, std::string dest)
     if (boost::python::extract<bool>(check_newer_than(full_dest, full_source)))
         return;
 
-    Logging::log(Logging::DEBUG, "convertPNGtoDDS: %s ==> %s\r\n", source.c_str(), dest.c_str());
+    LOG(DEBUG, "convertPNGtoDDS: %s ==> %s\r\n", source.c_str(), dest.c_str());
 
     renderprogress(0, ("preparing dds image: " + source).c_str());
 
@@ -245,7 +245,7 @@ void combineImages(std::string primary, std::string secondary, std::string dest)
     if (boost::python::extract<bool>(check_newer_than(full_dest, full_primary, full_secondary)))
         return;
 
-    Logging::log(Logging::DEBUG, "combineImages: %s + %s ==> %s\r\n", primary.c_str(), secondary.c_str(), dest.c_str());
+    LOG(DEBUG, "combineImages: %s + %s ==> %s\r\n", primary.c_str(), secondary.c_str(), dest.c_str());
 
     renderprogress(0, ("combining image: " + full_dest).c_str());
 
@@ -267,7 +267,7 @@ void uploadTextureData(std::string name, int x, int y, int w, int h, void *pixel
     Texture *t = textures.access(path(name.c_str(), true));
     if (!t)
     {
-        Logging::log(Logging::WARNING, "uploadTextureData: %s is missing\r\n", name.c_str());
+        LOG(WARNING, "uploadTextureData: %s is missing\r\n", name.c_str());
         return;
     }
 
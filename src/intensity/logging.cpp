@@ -12,8 +12,7 @@ namespace Logging
 {
 
 
-//! The current level of logging. Only log messages with equal or higher severity will be shown
-Level currLevel;
+Level currLevel = INFO;
 
 int currIndent = 0;
 
@@ -43,9 +42,109 @@ void setCurrLevel(Level level)
     printf("<<< Setting logging level to %s >>>\r\n", levelNames[currLevel].c_str());
 }
 
-bool shouldShow(Level level)
+
+// Output. Log messages are appended to a buffer, which a separate thread writes out, flushing
+// at least every FLUSH_INTERVAL ms. Warnings and errors are written out immediately, as they
+// may precede a crash. Without the thread (before init(), or if Logging/async is 0), messages
+// are written out directly.
+
+namespace Output
 {
-    return level >= currLevel;
+    enum { FLUSH_INTERVAL = 250 };
+
+    SDL_Thread *thread = NULL;
+    SDL_mutex *lock = NULL;
+    SDL_cond *shouldWrite = NULL;
+    bool running = false;
+
+    //! Messages waiting to be written out by the thread
+    std::string pending;
+
+    //! Writes out the pending messages. Must be called with the lock held.
+    void writePending()
+    {
+        if (pending.empty()) return;
+        fwrite(pending.data(), 1, pending.size(), stdout);
+        fflush(stdout);
+        pending.clear();
+    }
+
+    int run(void *data) // runs on a separate thread
+    {
+        SDL_LockMutex(lock);
+        while (running)
+        {
+            SDL_CondWaitTimeout(shouldWrite, lock, FLUSH_INTERVAL);
+            writePending();
+        }
+        SDL_UnlockMutex(lock);
+        return 0;
+    }
+
+    void start()
+    {
+        if (thread) return;
+
+        lock = SDL_CreateMutex();
+        shouldWrite = SDL_CreateCond();
+        running = true;
+        thread = SDL_CreateThread(run, NULL);
+        if (!thread)
+        {
+            printf("<<< Could not start logging thread, logging directly >>>\r\n");
+            running = false;
+            SDL_DestroyCond(shouldWrite);
+            SDL_DestroyMutex(lock);
+            shouldWrite = NULL;
+            lock = NULL;
+        }
+    }
+
+    void stop()
+    {
+        if (!thread) return;
+
+        SDL_LockMutex(lock);
+        running = false;
+        SDL_CondSignal(shouldWrite);
+        SDL_UnlockMutex(lock);
+
+        SDL_WaitThread(thread, NULL);
+        thread = NULL;
+
+        writePending(); // Anything logged since the thread's last write
+
+        SDL_DestroyCond(shouldWrite);
+        SDL_DestroyMutex(lock);
+        shouldWrite = NULL;
+        lock = NULL;
+    }
+
+    //! Writes out the pending messages right away
+    void flush()
+    {
+        if (!thread) return;
+
+        SDL_LockMutex(lock);
+        writePending();
+        SDL_UnlockMutex(lock);
+    }
+
+    void write(Level level, const std::string& text)
+    {
+        if (!thread)
+        {
+            fwrite(text.data(), 1, text.size(), stdout);
+            fflush(stdout);
+            return;
+        }
+
+        SDL_LockMutex(lock);
+        pending += text;
+        if (level >= WARNING)
+            writePending();
+        SDL_UnlockMutex(lock);
+    }
 }
 
 void init()
@@ -56,55 +155,68 @@ void init()
     assert(currLevel >= 0 && currLevel < NUM_LEVELS);
 
     printf("<<< Setting logging level to %s >>>\r\n", levelNames[currLevel].c_str());
+
+    if (Utility::Config::getInt("Logging", "async", 1))
+    {
+        static bool registered = false;
+        if (!registered)
+        {
+            atexit(quit);
+            registered = true;
+        }
+
+        Output::start();
+    }
+}
+
+void quit()
+{
+    Output::stop();
 }
 
 void log(Level level, const char *fmt, ...)
 {
     assert(level >= 0 && level < NUM_LEVELS);
 
-    if (shouldShow(level))
+    if (!shouldShow(level)) return;
+
+    const std::string& levelString = levelNames[level];
+
+    // Indent to the appropriate amount
+    std::string text;
+    for (int i = 0; i < currIndent; i++)
+        text += "   ";
+
+    if (strlen(fmt) <= MAXSTRLEN)
     {
-        std::string levelString = "--UNKNOWN--";
+        defvformatstring(sf, fmt, fmt);
 
-        switch (level)
+        // On the client, show errors in conoutf
+        #ifdef CLIENT
+        if (level == ERROR)
         {
-            case INFO   : levelString = "INFO"   ; break;
-            case DEBUG  : levelString = "DEBUG"  ; break;
-            case WARNING: levelString = "WARNING"; break;
-            case ERROR  : levelString = "ERROR"  ; break;
-            case OFF    : levelString = "OFF"    ; break;
+            std::string total = "[[" + levelString + "]] - ";
+            total += sf; 
+            Output::flush(); // Keep the order of earlier messages
+            conoutf(CON_ERROR, total.c_str());
+            return;
         }
+        #endif
 
-        // Indent to the appropriate amount
-        for (int i = 0; i < currIndent; i++)
-            printf("   ");
-
-        if (strlen(fmt) <= MAXSTRLEN)
-        {
-            defvformatstring(sf, fmt, fmt);
-
-            // On the client, show errors in conoutf
-            #ifdef CLIENT
-            if (level == ERROR)
-            {
-                std::string total = "[[" + levelString + "]] - ";
-                total += sf; 
-                conoutf(CON_ERROR, total.c_str());
-            }
-            else
-            #endif
-                printf("[[%s]] - %s", levelString.c_str(), sf);
-        } else
-            printf("((%s)) - %s", levelString.c_str(), fmt);
-    }
+        text += "[[" + levelString + "]] - ";
+        text += sf;
+    } else
+        text += "((" + levelString + ")) - " + fmt;
 
-    fflush(stdout); // Ensure it all gets out
+    Output::write(level, text);
 }
 
 void log_noformat(int level, std::string text)
 {
     assert(level >= 0 && level < NUM_LEVELS);
 
+    if (!shouldShow(levelEnums[level])) return;
+
     for (unsigned int i = 0; i < text.size(); i++)
     {
         if (text[i] == '%')
@@ -9,6 +9,23 @@
 
 #define INDENT_LOG(level) Logging::Indent ind(level)
 
+//! The lowest level that is compiled in at all. Messages below it are removed at compile time, including
+//! the evaluation of their arguments. Define as e.g. WARNING in release builds to drop INFO and DEBUG.
+#ifndef LOGGING_MIN_LEVEL
+    #define LOGGING_MIN_LEVEL INFO
+#endif
+
+//! Log a message, using standard printf format, with a level from Logging::Level, for example
+//!     LOG(INFO, "Added entity %d\r\n", uniqueId);
+//! A message that will not be shown costs a single compare: the arguments are not evaluated, and
+//! Logging::log is not called.
+#define LOG(level, ...) \
+    do \
+    { \
+        if (Logging::level >= Logging::LOGGING_MIN_LEVEL && Logging::shouldShow(Logging::level)) \
+            Logging::log(Logging::level, __VA_ARGS__); \
+    } while (0)
+
 namespace Logging
 {
     //! INFO: low-importance messages that may also appear very often (e.g., once/frame)
@@ -18,16 +35,24 @@ namespace Logging
     //! OFF: no logging will be done
     enum Level { INFO, DEBUG, WARNING, ERROR, OFF };
 
+    //! The current level of logging. Only log messages with equal or higher severity will be shown
+    extern Level currLevel;
+
     //! Sets the current debugging level
     void setCurrLevel(Level level);
 
     //! Test whether a level would be shown (useful to know if we are in debug mode)
-    bool shouldShow(Level level);
+    inline bool shouldShow(Level level) { return level >= currLevel; }
 
-    //! Prepare logging system. Reads currLevel from config file
+    //! Prepare logging system. Reads currLevel from config file, and starts the output thread if
+    //! Logging/async is set
     void init();
 
-    //! Log a message, using standard printf format
+    //! Writes out everything logged so far, and stops the output thread. Called automatically at exit.
+    void quit();
+
+    //! Log a message, using standard printf format. Prefer the LOG macro, which avoids even evaluating
+    //! the arguments if the message will not be shown.
     void log(Level level, const char *fmt, ...);
 
     //! The logging function Python will call
@@ -0,0 +1,387 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+#include "cube.h"
+#include "engine.h"
+
+#include "utility.h"
+
+#include "map_cache.h"
+
+#ifndef WIN32
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+
+static Utility::Config::Int useMapCache("World", "map_cache", 1);
+
+extern string ogzname; // worldio.cpp
+
+
+// File layout. Cubes are stored in groups of 8 siblings, as they are allocated. A group always comes after the
+// group of its parent, so loading can allocate each group before reaching it, in a single forward pass.
+
+struct MapCacheHeader
+{
+    char magic[4];
+    int version;
+    unsigned int key;
+    int worldsize;
+    int cubeSize; //!< sizeof(CachedCube), as a sanity check of the layout
+    int numCubes, numExts, numNormals, numMerges;
+};
+
+struct CachedCube
+{
+    int children; //!< Index of the first of the 8 children, or -1
+    int ext;      //!< Index of the extended info, or -1
+    uchar edges[12];
+    ushort texture[6];
+};
+
+struct CachedCubeExt
+{
+    uchar material, merged, mergeorigin, padding;
+    int normals; //!< Index of the first of 6 surfacenormals, or -1
+    int merges;  //!< Index of the first mergeinfo (one per bit in mergeorigin), or -1
+};
+
+#define MAP_CACHE_MAGIC "IOCT"
+#define MAP_CACHE_VERSION 1
+
+static std::string getMapCacheFile(unsigned int key)
+{
+    defformatstring(filename)("cache/maps/%08x.oct", key);
+    return path(filename);
+}
+
+static int countMerges(uchar mergeorigin)
+{
+    int num = 0;
+    loopi(6) if (mergeorigin & (1 << i)) num++;
+    return num;
+}
+
+
+// Mapping files. Where mmap is not available, the file is just read into memory
+
+static const uchar* mapFile(const char *filename, size_t& size)
+{
+#ifndef WIN32
+    const char *found = findfile(filename, "rb");
+    int fd = open(found, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    const uchar *data = NULL;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        size = info.st_size;
+        void *mapped = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED)
+            data = (const uchar*)mapped;
+    }
+    close(fd);
+    return data;
+#else
+    stream *f = openrawfile(filename, "rb");
+    if (!f)
+        return NULL;
+
+    uchar *data = NULL;
+    long fileSize = f->size();
+    if (fileSize > 0)
+    {
+        size = fileSize;
+        data = new uchar[size];
+        if (f->read(data, int(size)) != int(size))
+            DELETEA(data);
+    }
+    delete f;
+    return data;
+#endif
+}
+
+static void unmapFile(const uchar *data, size_t size)
+{
+#ifndef WIN32
+    munmap((void*)data, size);
+#else
+    delete[] data;
+#endif
+}
+
+
+// Saving
+
+struct MapCacheWriter
+{
+    std::vector<CachedCube> cubes;
+    std::vector<CachedCubeExt> exts;
+    std::vector<surfacenormals> normals;
+    std::vector<mergeinfo> merges;
+
+    //! Adds a group of 8 cubes, and then their children
+    //! @return The index of the group, or -1 if it cannot be cached
+    int addGroup(cube *c)
+    {
+        int first = cubes.size();
+        cubes.resize(first + 8);
+        loopi(8)
+        {
+            // Set the children last, as adding them resizes 'cubes'
+            CachedCube& cached = cubes[first + i];
+            memcpy(cached.edges, c[i].edges, sizeof(cached.edges));
+            memcpy(cached.texture, c[i].texture, sizeof(cached.texture));
+            cached.ext = -1;
+            cached.children = -1;
+
+            if (c[i].ext)
+            {
+                cubeext& ext = *c[i].ext;
+                if (ext.surfaces)
+                    return -1; // Lighting info is not cached
+
+                cached.ext = exts.size();
+                exts.push_back(CachedCubeExt());
+                CachedCubeExt& cachedExt = exts.back();
+                cachedExt.material = ext.material;
+                cachedExt.merged = ext.merged;
+                cachedExt.mergeorigin = ext.mergeorigin;
+                cachedExt.padding = 0;
+                cachedExt.normals = -1;
+                cachedExt.merges = -1;
+                if (ext.normals)
+                {
+                    cachedExt.normals = normals.size();
+                    normals.insert(normals.end(), ext.normals, ext.normals + 6);
+                }
+                int numMerges = countMerges(ext.mergeorigin);
+                if (ext.merges && numMerges)
+                {
+                    cachedExt.merges = merges.size();
+                    merges.insert(merges.end(), ext.merges, ext.merges + numMerges);
+                }
+            }
+        }
+        loopi(8)
+        {
+            if (!c[i].children)
+                continue;
+            int children = addGroup(c[i].children);
+            if (children < 0)
+                return -1;
+            cubes[first + i].children = children;
+        }
+        return first;
+    }
+};
+
+bool MapCache::save(unsigned int key, int worldsize)
+{
+    Profiler::Nanoseconds startTime = Profiler::now();
+
+    MapCacheWriter writer;
+    if (writer.addGroup(worldroot) < 0)
+    {
+        LOG(DEBUG, "Map cache: Not caching a lit octree\r\n");
+        return false;
+    }
+
+    std::string filename = getMapCacheFile(key);
+    stream *f = openrawfile(filename.c_str(), "wb");
+    if (!f)
+    {
+        LOG(WARNING, "Map cache: Cannot write %s\r\n", filename.c_str());
+        return false;
+    }
+
+    MapCacheHeader header;
+    memcpy(header.magic, MAP_CACHE_MAGIC, 4);
+    header.version = MAP_CACHE_VERSION;
+    header.key = key;
+    header.worldsize = worldsize;
+    header.cubeSize = sizeof(CachedCube);
+    header.numCubes = writer.cubes.size();
+    header.numExts = writer.exts.size();
+    header.numNormals = writer.normals.size();
+    header.numMerges = writer.merges.size();
+
+    f->write(&header, sizeof(header));
+    f->write(&writer.cubes[0], writer.cubes.size()*sizeof(CachedCube));
+    if (!writer.exts.empty())
+        f->write(&writer.exts[0], writer.exts.size()*sizeof(CachedCubeExt));
+    if (!writer.normals.empty())
+        f->write(&writer.normals[0], writer.normals.size()*sizeof(surfacenormals));
+    if (!writer.merges.empty())
+        f->write(&writer.merges[0], writer.merges.size()*sizeof(mergeinfo));
+    delete f;
+
+    LOG(DEBUG, "Map cache: Wrote %s (%d cubes) in %.2f ms\r\n", filename.c_str(), header.numCubes,
+        (Profiler::now() - startTime) / 1000000.0f);
+    return true;
+}
+
+
+// Loading
+
+//! Builds the octree from the records, in a single pass. Indexes are checked, so a corrupt file fails
+//! cleanly rather than crashing.
+//! @return The root group, or NULL if the records are invalid
+static cube* buildOctree(const MapCacheHeader& header, const CachedCube *cubes, const CachedCubeExt *exts,
+                         const surfacenormals *normals, const mergeinfo *merges)
+{
+    std::vector<cube*> groups(header.numCubes / 8, (cube*)NULL);
+    groups[0] = newcubes();
+
+    bool valid = true;
+    for (int index = 0; index < header.numCubes && valid; index++)
+    {
+        cube *group = groups[index / 8];
+        if (!group)
+        {
+            valid = false; // A group no parent referred to
+            break;
+        }
+
+        const CachedCube& cached = cubes[index];
+        cube& c = group[index % 8];
+        memcpy(c.edges, cached.edges, sizeof(c.edges));
+        memcpy(c.texture, cached.texture, sizeof(c.texture));
+
+        if (cached.children >= 0)
+        {
+            // Children come after their parent, and are referred to once
+            if (cached.children <= index || cached.children % 8 || cached.children >= header.numCubes ||
+                groups[cached.children / 8])
+            {
+                valid = false;
+                break;
+            }
+            c.children = groups[cached.children / 8] = newcubes();
+        }
+
+        if (cached.ext >= 0)
+        {
+            if (cached.ext >= header.numExts)
+            {
+                valid = false;
+                break;
+            }
+            const CachedCubeExt& cachedExt = exts[cached.ext];
+            cubeext& e = *newcubeext(c);
+            e.material = cachedExt.material;
+            e.merged = cachedExt.merged;
+            e.mergeorigin = cachedExt.mergeorigin;
+
+            if (cachedExt.normals >= 0)
+            {
+                if (cachedExt.normals > header.numNormals - 6)
+                {
+                    valid = false;
+                    break;
+                }
+                e.normals = newoctaarray<surfacenormals>(6);
+                memcpy(e.normals, &normals[cachedExt.normals], 6*sizeof(surfacenormals));
+            }
+
+            if (cachedExt.merges >= 0)
+            {
+                int numMerges = countMerges(cachedExt.mergeorigin);
+                if (!numMerges || cachedExt.merges > header.numMerges - numMerges)
+                {
+                    valid = false;
+                    break;
+                }
+                e.merges = newoctaarray<mergeinfo>(numMerges);
+                memcpy(e.merges, &merges[cachedExt.merges], numMerges*sizeof(mergeinfo));
+            }
+        }
+    }
+
+    if (!valid)
+    {
+        // Every group allocated so far is linked into the tree
+        freeocta(groups[0]);
+        return NULL;
+    }
+
+    return groups[0];
+}
+
+bool MapCache::load(unsigned int key, int worldsize)
+{
+    std::string filename = getMapCacheFile(key);
+    size_t size = 0;
+    const uchar *data = mapFile(filename.c_str(), size);
+    if (!data)
+        return false;
+
+    cube *root = NULL;
+    const MapCacheHeader& header = *(const MapCacheHeader*)data;
+    if (size >= sizeof(MapCacheHeader) &&
+        !memcmp(header.magic, MAP_CACHE_MAGIC, 4) &&
+        header.version == MAP_CACHE_VERSION &&
+        header.key == key &&
+        header.worldsize == worldsize &&
+        header.cubeSize == int(sizeof(CachedCube)) &&
+        header.numCubes >= 8 && header.numCubes % 8 == 0 &&
+        header.numExts >= 0 && header.numNormals >= 0 && header.numMerges >= 0 &&
+        size == sizeof(MapCacheHeader) + size_t(header.numCubes)*sizeof(CachedCube) +
+                size_t(header.numExts)*sizeof(CachedCubeExt) +
+                size_t(header.numNormals)*sizeof(surfacenormals) +
+                size_t(header.numMerges)*sizeof(mergeinfo))
+    {
+        const uchar *current = data + sizeof(MapCacheHeader);
+        const CachedCube *cubes = (const CachedCube*)current;
+        current += header.numCubes*sizeof(CachedCube);
+        const CachedCubeExt *exts = (const CachedCubeExt*)current;
+        current += header.numExts*sizeof(CachedCubeExt);
+        const surfacenormals *normals = (const surfacenormals*)current;
+        current += header.numNormals*sizeof(surfacenormals);
+        const mergeinfo *merges = (const mergeinfo*)current;
+
+        root = buildOctree(header, cubes, exts, normals, merges);
+    }
+
+    unmapFile(data, size);
+
+    if (!root)
+    {
+        LOG(WARNING, "Map cache: Ignoring invalid cache file %s\r\n", filename.c_str());
+        return false;
+    }
+
+    worldroot = root;
+    return true;
+}
+
+bool MapCache::getKey(unsigned int& key)
+{
+    stream *f = openfile(ogzname, "rb");
+    if (!f)
+        return false;
+
+    key = crc32(0, NULL, 0);
+    uchar buffer[64*1024];
+    for (;;)
+    {
+        int bytes = f->read(buffer, sizeof(buffer));
+        if (bytes <= 0)
+            break;
+        key = crc32(key, buffer, bytes);
+    }
+    delete f;
+    return true;
+}
+
+bool MapCache::enabled()
+{
+    return useMapCache.get() != 0;
+}
+
@@ -0,0 +1,33 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+//! A cache of decoded map octrees, for the server. Decoding the octree from the .ogz - decompressing it, and
+//! parsing it a byte at a time - is most of the time it takes to load a map. The cache keeps the octree as
+//! it is after decoding (and the fixups and validation that follow), in a flat layout of fixed-size records
+//! that refer to each other by index rather than by pointer, so it can be mapped into memory as is, and
+//! turned into cubes in a single pass.
+//!
+//! Cache files are in cache/maps/, named by a checksum of the (compressed) .ogz file, so a changed map never
+//! uses a stale cache. They are in native byte order, as they are local.
+//!
+//! Only the server uses the cache, as the client still needs to read what follows the octree in the .ogz
+//! (lightmaps, PVS and blendmap). Entities in .ogz files are not used in this engine, so are not cached.
+//!
+//! Setting: World/map_cache (default 1).
+
+struct MapCache
+{
+    //! Checksums the current map's .ogz file, to identify its cache
+    static bool getKey(unsigned int& key);
+
+    //! Loads the octree into worldroot, if there is a valid cache for it.
+    //! @return Whether it was loaded
+    static bool load(unsigned int key, int worldsize);
+
+    //! Saves the octree in worldroot
+    static bool save(unsigned int key, int worldsize);
+
+    static bool enabled();
+};
+
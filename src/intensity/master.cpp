@@ -27,7 +27,7 @@ SVAR(error_message, ""); // TODO: Move
 //! Log in to the master server
 void do_login(char *username, char *password)
 {
-    Logging::log(Logging::DEBUG, "Preparing to log in to master server with: %s / ----\r\n", username);
+    LOG(DEBUG, "Preparing to log in to master server with: %s / ----\r\n", username);
 
     std::string _username = username;
     std::string _password = password;
@@ -14,6 +14,9 @@
 
 #include "server_system.h"
 #include "message_system.h"
+#include "fpsclient_interface.h"
+#include "utility.h"
+#include "script_engine_manager.h"
 
 
 namespace MessageSystem
@@ -23,7 +26,7 @@ namespace MessageSystem
 
 void MessageType::receive(int receiver, int sender, ucharbuf &p)
 {
-    Logging::log(Logging::ERROR, "Trying to receive a message, but no handler present: %s (%d)\r\n", type_name.c_str(), type_code);
+    LOG(ERROR, "Trying to receive a message, but no handler present: %s (%d)\r\n", type_name.c_str(), type_code);
     assert(0);
 }
 
@@ -34,7 +37,7 @@ MessageManager::MessageMap MessageManager::messageTypes;
 
 void MessageManager::registerMessageType(MessageType *newMessageType)
 {
-    Logging::log(Logging::DEBUG, "MessageSystem: Registering message %s (%d)\r\n",
+    LOG(DEBUG, "MessageSystem: Registering message %s (%d)\r\n",
                                  newMessageType->type_name.c_str(),
                                  newMessageType->type_code);
 
@@ -45,23 +48,451 @@ void MessageManager::registerMessageType(MessageType *newMessageType)
 
 bool MessageManager::receive(int type, int receiver, int sender, ucharbuf &p)
 {
-    Logging::log(Logging::DEBUG, "MessageSystem: Trying to handle a message, type/sender:: %d/%d\r\n", type, sender);
+    LOG(DEBUG, "MessageSystem: Trying to handle a message, type/sender:: %d/%d\r\n", type, sender);
     INDENT_LOG(Logging::DEBUG);
 
     MessageMap::iterator messageType = messageTypes.find(type);
     if (messageType == messageTypes.end())
     {
-        Logging::log(Logging::DEBUG, "Message type not found in our extensions to Sauer: %d\r\n", type);
+        LOG(DEBUG, "Message type not found in our extensions to Sauer: %d\r\n", type);
         return false; // This isn't one of our messages, hopefully it's a sauer one
     }
 
     messageType->second->receive(receiver, sender, p);
 
-    Logging::log(Logging::DEBUG, "MessageSystem: message successfully handled\r\n");
+    LOG(DEBUG, "MessageSystem: message successfully handled\r\n");
 
     return true;
 }
 
+// Recipients
+
+namespace Recipients
+{
+
+vector<int> kinds;
+bool valid = false;
+
+void invalidate()
+{
+    valid = false;
+}
+
+#ifdef SERVER
+int calculateKind(int clientNumber)
+{
+    if (!getclientinfo(clientNumber)) return 0;
+
+    if (FPSServerInterface::getUniqueId(clientNumber) == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) return DUMMY;
+
+    // Remote clients are sent messages even if their uniqueId is still negative (during the login process)
+    fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
+    return (fpsEntity && fpsEntity->serverControlled) ? NPC : REMOTE;
+}
+#endif
+
+int getKind(int clientNumber)
+{
+#ifdef SERVER
+    if (!valid || !kinds.inrange(clientNumber))
+    {
+        kinds.setsize(0);
+        for (int i = 0; i < getnumclients(); i++)
+            kinds.add(calculateKind(i));
+        valid = true;
+
+        if (!kinds.inrange(clientNumber)) return 0;
+    }
+    return kinds[clientNumber];
+#else // CLIENT
+    return REMOTE | DUMMY | NPC;
+#endif
+}
+
+}
+
+void broadcast(ENetPacket *packet, int channel, int kinds, int exclude)
+{
+    for (int clientNumber = 0; clientNumber < getnumclients(); clientNumber++)
+    {
+        if (clientNumber == exclude) continue;
+        if (!(Recipients::getKind(clientNumber) & kinds)) continue;
+
+        LOG(DEBUG, "Broadcasting to %d\r\n", clientNumber);
+        sendpacket(clientNumber, channel, packet);
+    }
+}
+
+// StateDataEncoding
+
+namespace StateDataEncoding
+{
+
+void encode(const std::string& value, vector<uchar>& out)
+{
+    ucharbuf buf = out.reserve(2*5 + value.length());
+    putint(buf, STRING);
+    putint(buf, value.length());
+    buf.put((const uchar*)value.data(), value.length());
+    out.addbuf(buf);
+}
+
+//! Whether a value can be sent as a FLOAT. NaN, infinities and values whose quantization overflows an int
+//! cannot, and are sent as strings instead, as before typed encoding - fromWire on the client parses them
+inline bool isFloatEncodable(double value)
+{
+    return fabs(value*FLOAT_PRECISION) < double(INT_MAX); // Also false for NaN
+}
+
+inline void putFloat(ucharbuf& buf, double value)
+{
+    putint(buf, int(floor(value*FLOAT_PRECISION + 0.5)));
+}
+
+void encode(int wireType, ScriptValuePtr value, vector<uchar>& out)
+{
+    switch (wireType)
+    {
+        case INTEGER:
+        {
+            ucharbuf buf = out.reserve(2*5);
+            putint(buf, INTEGER);
+            putint(buf, value->getInt());
+            out.addbuf(buf);
+            break;
+        }
+        case FLOAT:
+        {
+            double floatValue = value->getFloat();
+            if (!isFloatEncodable(floatValue))
+            {
+                encode(value->getString(), out);
+                break;
+            }
+            ucharbuf buf = out.reserve(2*5);
+            putint(buf, FLOAT);
+            putFloat(buf, floatValue);
+            out.addbuf(buf);
+            break;
+        }
+        case FLOAT_ARRAY:
+        {
+            int length = value->getPropertyInt("length");
+            ucharbuf buf = out.reserve((2 + length)*5);
+            putint(buf, FLOAT_ARRAY);
+            putint(buf, length);
+            int i = 0;
+            for (; i < length; i++)
+            {
+                double item = value->getPropertyFloat(Utility::toString(i));
+                if (!isFloatEncodable(item))
+                    break;
+                putFloat(buf, item);
+            }
+            if (i < length)
+            {
+                encode(STRING_ARRAY, value, out); // Nothing was added yet, so send the whole array as strings
+                break;
+            }
+            out.addbuf(buf);
+            break;
+        }
+        case STRING_ARRAY:
+        {
+            int length = value->getPropertyInt("length");
+            ucharbuf buf = out.reserve(2*5);
+            putint(buf, STRING_ARRAY);
+            putint(buf, length);
+            out.addbuf(buf);
+            for (int i = 0; i < length; i++)
+            {
+                std::string item = value->getPropertyString(Utility::toString(i));
+                buf = out.reserve(5 + item.length());
+                putint(buf, item.length());
+                buf.put((const uchar*)item.data(), item.length());
+                out.addbuf(buf);
+            }
+            break;
+        }
+        default:
+            LOG(ERROR, "Invalid state data wire type: %d\r\n", wireType);
+            // Fall through, to at least send something readable
+        case STRING:
+            encode(value->getString(), out);
+            break;
+    }
+}
+
+//! Reads a length-prefixed string
+inline bool getString(ucharbuf& p, std::string& value)
+{
+    int length = getint(p);
+    if (length < 0 || length > p.remaining())
+    {
+        p.forceoverread();
+        return false;
+    }
+    value.assign((const char*)&p.buf[p.len], length);
+    p.len += length;
+    return true;
+}
+
+//! Reads an array length. Each item takes at least a byte, which limits how much we allocate for invalid input
+inline bool getLength(ucharbuf& p, int& length)
+{
+    length = getint(p);
+    if (length < 0 || length > p.remaining())
+    {
+        p.forceoverread();
+        return false;
+    }
+    return true;
+}
+
+ScriptValuePtr decode(ucharbuf& p)
+{
+    int wireType = getint(p);
+    switch (wireType)
+    {
+        case STRING:
+        {
+            std::string value;
+            if (!getString(p, value)) break;
+            return ScriptEngineManager::createScriptValue(value);
+        }
+        case INTEGER:
+            return ScriptEngineManager::createScriptValue(getint(p));
+        case FLOAT:
+            return ScriptEngineManager::createScriptValue(double(getint(p))/FLOAT_PRECISION);
+        case FLOAT_ARRAY:
+        case STRING_ARRAY:
+        {
+            int length;
+            if (!getLength(p, length)) break;
+
+            ScriptValuePtr array = ScriptEngineManager::getGlobal()->call("Array");
+            std::string item;
+            for (int i = 0; i < length; i++)
+            {
+                if (wireType == FLOAT_ARRAY)
+                    array->setProperty(Utility::toString(i), double(getint(p))/FLOAT_PRECISION);
+                else if (getString(p, item))
+                    array->setProperty(Utility::toString(i), item);
+            }
+            if (p.overread()) break;
+            return array;
+        }
+    }
+
+    return ScriptValuePtr();
+}
+
+}
+
+// StateDataBatching
+
+namespace StateDataBatching
+{
+
+struct Update
+{
+    int clientNumber, uniqueId, keyProtocolId;
+    std::string value; //!< Encoded, as in StateDataEncoding
+    int originalClientNumber;
+    bool superseded;
+};
+
+//! The pending updates of one kind (reliable or unreliable), in the order they were made
+struct Queue
+{
+    std::vector<Update> updates; // Not a vector<>, which would memcpy the strings when growing
+
+    //! (clientNumber, uniqueId, keyProtocolId) to the index of the latest such update
+    typedef std::map< std::pair<int, std::pair<int, int> >, int > Latest;
+    Latest latest;
+
+    void add(int clientNumber, int uniqueId, int keyProtocolId, vector<uchar>& value, int originalClientNumber)
+    {
+        std::pair<Latest::iterator, bool> found = latest.insert(
+            Latest::value_type(std::make_pair(clientNumber, std::make_pair(uniqueId, keyProtocolId)), updates.size())
+        );
+        if (!found.second)
+        {
+            // Supersede the earlier update. The new one goes at the end, so the order of the latest changes is kept
+            updates[found.first->second].superseded = true;
+            found.first->second = updates.size();
+        }
+
+        Update update;
+        update.clientNumber = clientNumber;
+        update.uniqueId = uniqueId;
+        update.keyProtocolId = keyProtocolId;
+        update.value.assign((const char*)value.getbuf(), value.length());
+        update.originalClientNumber = originalClientNumber;
+        update.superseded = false;
+        updates.push_back(update);
+    }
+
+    void clear()
+    {
+        updates.clear();
+        latest.clear();
+    }
+
+    //! Appends an update to a StateDataUpdates buffer
+    static void encode(Update& update, vector<uchar>& out)
+    {
+        ucharbuf buf = out.reserve(2*5 + update.value.length());
+        putint(buf, update.uniqueId);
+        putint(buf, update.keyProtocolId);
+        buf.put((const uchar*)update.value.data(), update.value.length());
+        out.addbuf(buf);
+    }
+
+    //! Sends the updates, with one message per client.
+    //! @return Whether anything was sent
+    bool flush(bool reliable)
+    {
+        void (*send)(int, int, vector<uchar>&) = reliable ? send_StateDataUpdates : send_UnreliableStateDataUpdates;
+
+        // If all the updates are for everyone, they can be encoded once, and broadcast
+        bool forEveryone = true;
+        int numUpdates = 0;
+        for (unsigned int i = 0; i < updates.size(); i++)
+        {
+            if (updates[i].superseded) continue;
+            numUpdates++;
+            if (updates[i].clientNumber != -1 || updates[i].originalClientNumber != -1)
+                forEveryone = false;
+        }
+
+        if (numUpdates == 0)
+        {
+            clear();
+            return false;
+        }
+
+        static vector<uchar> data;
+        if (forEveryone)
+        {
+            data.setsizenodelete(0);
+            for (unsigned int i = 0; i < updates.size(); i++)
+                if (!updates[i].superseded) encode(updates[i], data);
+            send(-1, numUpdates, data);
+        } else {
+            for (int clientNumber = 0; clientNumber < getnumclients(); clientNumber++)
+            {
+                if (!Recipients::getKind(clientNumber)) continue;
+
+                data.setsizenodelete(0);
+                int numRelevant = 0;
+                for (unsigned int i = 0; i < updates.size(); i++)
+                {
+                    Update& update = updates[i];
+                    if (update.superseded) continue;
+                    if (update.clientNumber != -1 && update.clientNumber != clientNumber) continue;
+                    if (update.originalClientNumber == clientNumber) continue; // The client made this change itself
+                    encode(update, data);
+                    numRelevant++;
+                }
+
+                if (numRelevant > 0)
+                    send(clientNumber, numRelevant, data);
+            }
+        }
+
+        LOG(DEBUG, "Flushed %d %s state data updates\r\n", numUpdates, reliable ? "reliable" : "unreliable");
+
+        clear();
+        return true;
+    }
+};
+
+Queue reliableQueue, unreliableQueue;
+
+//! Read from the config once per flush, as queue() is called far more often
+int enabled = -1;
+
+bool batching()
+{
+#ifdef SERVER
+    if (enabled == -1)
+        enabled = Utility::Config::getInt("Network", "state_data_batching", 1);
+    return enabled;
+#else // CLIENT - its local server sends right away, like all its other messages
+    return false;
+#endif
+}
+
+bool queue(bool reliable, int clientNumber, int uniqueId, int keyProtocolId, std::string value, int originalClientNumber)
+{
+    if (!batching()) return false;
+
+    static vector<uchar> encoded;
+    encoded.setsizenodelete(0);
+    StateDataEncoding::encode(value, encoded);
+    (reliable ? reliableQueue : unreliableQueue).add(clientNumber, uniqueId, keyProtocolId, encoded, originalClientNumber);
+    return true;
+}
+
+void send(bool reliable, int clientNumber, int uniqueId, int keyProtocolId, int wireType,
+          ScriptValuePtr value, int originalClientNumber)
+{
+    static vector<uchar> encoded;
+    encoded.setsizenodelete(0);
+    StateDataEncoding::encode(wireType, value, encoded);
+
+    if (batching())
+    {
+        (reliable ? reliableQueue : unreliableQueue).add(clientNumber, uniqueId, keyProtocolId, encoded, originalClientNumber);
+        return;
+    }
+
+    // Send it right away, as a batch of one
+    Queue single;
+    single.add(clientNumber, uniqueId, keyProtocolId, encoded, originalClientNumber);
+    single.flush(reliable);
+}
+
+void clientDisconnected(int clientNumber)
+{
+    Queue* queues[] = { &reliableQueue, &unreliableQueue };
+    for (int q = 0; q < 2; q++)
+    {
+        std::vector<Update>& updates = queues[q]->updates;
+        for (unsigned int i = 0; i < updates.size(); i++)
+            if (updates[i].clientNumber == clientNumber)
+                updates[i].superseded = true;
+    }
+}
+
+//! Set while flushing, as sending the batches goes through the same send functions that flush
+bool flushing = false;
+
+void flushReliable()
+{
+    if (flushing || reliableQueue.updates.empty()) return;
+
+    flushing = true;
+    reliableQueue.flush(true);
+    flushing = false;
+}
+
+bool flush()
+{
+    flushing = true;
+    bool sent = reliableQueue.flush(true);
+    sent = unreliableQueue.flush(false) || sent;
+    flushing = false;
+
+    enabled = -1;
+
+    return sent;
+}
+
+}
+
+
 std::string awaitedFile = "";
 
 void MessageManager::awaitFile(std::string name)
@@ -70,14 +501,14 @@ void MessageManager::awaitFile(std::string name)
 
     awaitedFile = name;
 
-    Logging::log(Logging::DEBUG, "Awaiting file '%s'\r\n", awaitedFile.c_str());
+    LOG(DEBUG, "Awaiting file '%s'\r\n", awaitedFile.c_str());
 }
 
 std::string MessageManager::getAwaitingFile()
 {
     assert(awaitedFile != "");
 
-    Logging::log(Logging::DEBUG, "No longer awaiting file '%s'\r\n", awaitedFile.c_str());
+    LOG(DEBUG, "No longer awaiting file '%s'\r\n", awaitedFile.c_str());
 
     std::string ret = awaitedFile;
     awaitedFile = "";
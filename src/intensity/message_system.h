@@ -6,6 +6,9 @@
 
 #include "tools.h"
 
+class ScriptValue;
+namespace boost { template<class T> class shared_ptr; }
+
 //! All out new messages types should have higher value. This might be lower than the current '1000', and it might
 //! then fit into a char, for better network bandwidth...
 #define INTENSITY_MSG_TYPE_MIN 1000
@@ -75,6 +78,103 @@ struct MessageManager
     static std::string getAwaitingFile();
 };
 
+
+//! Who server->client messages go to. Whether a client is a remote one, the server's singleton dummy
+//! client or an NPC is cached per client, so that sending (especially broadcasting) does not need
+//! to look up every client's entity for every message.
+
+namespace Recipients
+{
+    enum
+    {
+        REMOTE = 1, //!< An actual remote client
+        DUMMY  = 2, //!< The server's singleton dummy client, which updates the server's internal fpsclient
+        NPC    = 4  //!< An NPC controlled by the server
+    };
+
+    //! Marks the cached kinds as stale, so they are recalculated when next needed. Must be called when
+    //! clients connect or disconnect, or their uniqueId or serverControlled status changes. Also
+    //! called once per server slice, for safety.
+    void invalidate();
+
+    //! Gets the kind of a client (one of the above, or 0 for an empty slot). On the client (i.e., for
+    //! its local server) all kinds are returned, as there everyone is sent everything.
+    int getKind(int clientNumber);
+}
+
+//! Sends a single packet to all clients whose kind is in a mask of Recipients kinds, except for one.
+//! This lets a message be encoded once, into one refcounted packet, instead of once per client.
+void broadcast(ENetPacket *packet, int channel, int kinds, int exclude = -1);
+
+
+//! Typed binary encoding of state data values. Each value is sent as its wire type (one of the below,
+//! given per state variable by its class in Variables.js), followed by:
+//!     STRING       - length, then the raw bytes
+//!     INTEGER      - the value
+//!     FLOAT        - the value, quantized to 1/FLOAT_PRECISION
+//!     FLOAT_ARRAY  - the number of items, then each as a FLOAT
+//!     STRING_ARRAY - the number of items, then each as a STRING
+//! A FLOAT that does not fit the quantization (NaN, infinite, or too large) is sent as a STRING, and a
+//! FLOAT_ARRAY with any such item as a STRING_ARRAY.
+//! with putint's variable-length integers throughout. On receipt, values are decoded directly into
+//! the script engine's numbers, strings and arrays, with no parsing in scripts.
+
+namespace StateDataEncoding
+{
+    //! Must match WireTypes in Variables.js. STRING is 0, so scripts that do not give a type send strings
+    enum
+    {
+        STRING = 0,
+        INTEGER,
+        FLOAT,
+        FLOAT_ARRAY,
+        STRING_ARRAY
+    };
+
+    //! The same 2 decimal places as decimal2() in Variables.js
+    enum { FLOAT_PRECISION = 100 };
+
+    //! Appends a string value to a buffer
+    void encode(const std::string& value, vector<uchar>& out);
+
+    //! Appends a script value, of a wire type, to a buffer
+    void encode(int wireType, boost::shared_ptr<ScriptValue> value, vector<uchar>& out);
+
+    //! Reads a value from a buffer, into a script value. Returns a null pointer if the buffer is invalid.
+    boost::shared_ptr<ScriptValue> decode(ucharbuf& p);
+}
+
+
+//! Coalescing of state data updates. Instead of a separate StateDataUpdate (or UnreliableStateDataUpdate)
+//! for each change, the changes made during a tick are collected, and each client is sent a single
+//! StateDataUpdates (or UnreliableStateDataUpdates) with all of those relevant to it. A change to the
+//! same state variable of the same entity, for the same clients, supersedes the earlier one. Set
+//! Network/state_data_batching to 0 to send each update as it happens, as before.
+
+namespace StateDataBatching
+{
+    //! Queues a state data update, with the same parameters as send_StateDataUpdate.
+    //! @return Whether it was queued. If not, the caller should send it right away.
+    bool queue(bool reliable, int clientNumber, int uniqueId, int keyProtocolId, std::string value, int originalClientNumber);
+
+    //! Queues a state data update with a typed value (see StateDataEncoding). If batching is off,
+    //! sends it right away, by itself.
+    void send(bool reliable, int clientNumber, int uniqueId, int keyProtocolId, int wireType,
+              boost::shared_ptr<ScriptValue> value, int originalClientNumber);
+
+    //! Drops the queued updates meant only for a client, as its slot may be reused
+    void clientDisconnected(int clientNumber);
+
+    //! Sends out the queued reliable updates. Called before any other reliable message is sent, so
+    //! the updates keep their order relative to it (e.g., an entity's creation, then its state)
+    void flushReliable();
+
+    //! Sends out all the queued updates. Called once per tick, when the server sends packets.
+    //! @return Whether anything was sent
+    bool flush();
+}
+
+
 // Include all the procedurally-generated message data
 #include "messages.h"
 
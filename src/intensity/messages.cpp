@@ -35,44 +35,26 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type PersonalServerMessage (1001)\r\n");
+        LOG(DEBUG, "Sending a message of type PersonalServerMessage (1001)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1001);
+            putint(buf, originClientNumber);
+            sendstring(title.c_str(), buf);
+            sendstring(content.c_str(), buf);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riiss", 1001, originClientNumber, title.c_str(), content.c_str());
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riiss", 1001, originClientNumber, title.c_str(), content.c_str());
         }
     }
 
@@ -81,7 +63,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type PersonalServerMessage (1001)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type PersonalServerMessage (1001)\r\n");
 
         int originClientNumber = getint(p);
         char tmp_title[MAXTRANS];
@@ -100,7 +82,7 @@ namespace MessageSystem
 
     void send_RequestServerMessageToAll(std::string message)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type RequestServerMessageToAll (1002)\r\n");
+        LOG(DEBUG, "Sending a message of type RequestServerMessageToAll (1002)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1002, "rs", message.c_str());
@@ -109,7 +91,7 @@ namespace MessageSystem
 #ifdef SERVER
     void RequestServerMessageToAll::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RequestServerMessageToAll (1002)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RequestServerMessageToAll (1002)\r\n");
 
         char tmp_message[MAXTRANS];
         getstring(tmp_message, p);
@@ -123,7 +105,7 @@ namespace MessageSystem
 
     void send_LoginRequest(std::string code)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type LoginRequest (1003)\r\n");
+        LOG(DEBUG, "Sending a message of type LoginRequest (1003)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1003, "rs", code.c_str());
@@ -132,7 +114,7 @@ namespace MessageSystem
 #ifdef SERVER
     void LoginRequest::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type LoginRequest (1003)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type LoginRequest (1003)\r\n");
 
         char tmp_code[MAXTRANS];
         getstring(tmp_code, p);
@@ -156,46 +138,27 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type YourUniqueId (1004)\r\n");
+        LOG(DEBUG, "Sending a message of type YourUniqueId (1004)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  // Remember this client's unique ID. Done here so always in sync with the client's belief about its uniqueId.
         FPSServerInterface::getUniqueId(clientNumber) = uniqueId;
+        MessageSystem::Recipients::invalidate();
+
 
+        StateDataBatching::flushReliable();
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1004);
+            putint(buf, uniqueId);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "rii", 1004, uniqueId);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "rii", 1004, uniqueId);
         }
     }
 
@@ -204,11 +167,11 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type YourUniqueId (1004)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type YourUniqueId (1004)\r\n");
 
         int uniqueId = getint(p);
 
-        Logging::log(Logging::DEBUG, "Told my unique ID: %d\r\n", uniqueId);
+        LOG(DEBUG, "Told my unique ID: %d\r\n", uniqueId);
         ClientSystem::uniqueId = uniqueId;
     }
 #endif
@@ -220,7 +183,7 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type LoginResponse (1005)\r\n");
+        LOG(DEBUG, "Sending a message of type LoginResponse (1005)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  // If logged in OK, this is the time to create a scripting logic entity for the client. Also adds to internal FPSClient
@@ -228,39 +191,20 @@ namespace MessageSystem
             server::createScriptingEntity(clientNumber);
 
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1005);
+            putint(buf, success);
+            putint(buf, local);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riii", 1005, success, local);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riii", 1005, success, local);
         }
     }
 
@@ -269,7 +213,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type LoginResponse (1005)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type LoginResponse (1005)\r\n");
 
         bool success = getint(p);
         bool local = getint(p);
@@ -293,44 +237,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type PrepareForNewScenario (1006)\r\n");
+        LOG(DEBUG, "Sending a message of type PrepareForNewScenario (1006)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1006);
+            sendstring(scenarioCode.c_str(), buf);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "ris", 1006, scenarioCode.c_str());
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "ris", 1006, scenarioCode.c_str());
         }
     }
 
@@ -339,7 +263,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type PrepareForNewScenario (1006)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type PrepareForNewScenario (1006)\r\n");
 
         char tmp_scenarioCode[MAXTRANS];
         getstring(tmp_scenarioCode, p);
@@ -355,7 +279,7 @@ namespace MessageSystem
 
     void send_RequestCurrentScenario()
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type RequestCurrentScenario (1007)\r\n");
+        LOG(DEBUG, "Sending a message of type RequestCurrentScenario (1007)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1007, "r");
@@ -364,7 +288,7 @@ namespace MessageSystem
 #ifdef SERVER
     void RequestCurrentScenario::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RequestCurrentScenario (1007)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RequestCurrentScenario (1007)\r\n");
 
 
         if (!ServerSystem::isRunningMap()) return;
@@ -379,44 +303,25 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type NotifyAboutCurrentScenario (1008)\r\n");
+        LOG(DEBUG, "Sending a message of type NotifyAboutCurrentScenario (1008)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1008);
+            sendstring(mapAssetId.c_str(), buf);
+            sendstring(scenarioCode.c_str(), buf);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riss", 1008, mapAssetId.c_str(), scenarioCode.c_str());
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riss", 1008, mapAssetId.c_str(), scenarioCode.c_str());
         }
     }
 
@@ -425,7 +330,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type NotifyAboutCurrentScenario (1008)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type NotifyAboutCurrentScenario (1008)\r\n");
 
         char tmp_mapAssetId[MAXTRANS];
         getstring(tmp_mapAssetId, p);
@@ -447,7 +352,7 @@ namespace MessageSystem
 
     void send_RestartMap()
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type RestartMap (1009)\r\n");
+        LOG(DEBUG, "Sending a message of type RestartMap (1009)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1009, "r");
@@ -456,13 +361,13 @@ namespace MessageSystem
 #ifdef SERVER
     void RestartMap::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RestartMap (1009)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RestartMap (1009)\r\n");
 
 
         if (!ServerSystem::isRunningMap()) return;
         if (!server::isAdmin(sender))
         {
-            Logging::log(Logging::WARNING, "Non-admin tried to restart the map\r\n");
+            LOG(WARNING, "Non-admin tried to restart the map\r\n");
             send_PersonalServerMessage(sender, -1, "Server", "You are not an administrator, and cannot restart the map");
             return;
         }
@@ -476,7 +381,7 @@ namespace MessageSystem
     void send_NewEntityRequest(std::string _class, float x, float y, float z, std::string stateData)
     {        EditingSystem::madeChanges = true;
 
-        Logging::log(Logging::DEBUG, "Sending a message of type NewEntityRequest (1010)\r\n");
+        LOG(DEBUG, "Sending a message of type NewEntityRequest (1010)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1010, "rsiiis", _class.c_str(), int(x*DMF), int(y*DMF), int(z*DMF), stateData.c_str());
@@ -485,7 +390,7 @@ namespace MessageSystem
 #ifdef SERVER
     void NewEntityRequest::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type NewEntityRequest (1010)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type NewEntityRequest (1010)\r\n");
 
         char tmp__class[MAXTRANS];
         getstring(tmp__class, p);
@@ -500,14 +405,14 @@ namespace MessageSystem
         if (!ServerSystem::isRunningMap()) return;
         if (!server::isAdmin(sender))
         {
-            Logging::log(Logging::WARNING, "Non-admin tried to add an entity\r\n");
+            LOG(WARNING, "Non-admin tried to add an entity\r\n");
             send_PersonalServerMessage(sender, -1, "Server", "You are not an administrator, and cannot create entities");
             return;
         }
         // Validate class
         if (!EditingSystem::validateEntityClass(_class))
         {
-            Logging::log(Logging::WARNING, "User tried to add an invalid entity: %s\r\n", _class.c_str());
+            LOG(WARNING, "User tried to add an invalid entity: %s\r\n", _class.c_str());
             send_PersonalServerMessage(
                 sender,
                 -1,
@@ -517,10 +422,10 @@ namespace MessageSystem
             return;
         }
         // Add entity
-        Logging::log(Logging::DEBUG, "Creating new entity, %s   %f,%f,%f   %s\r\n", _class.c_str(), x, y, z, stateData.c_str());
+        LOG(DEBUG, "Creating new entity, %s   %f,%f,%f   %s\r\n", _class.c_str(), x, y, z, stateData.c_str());
         if ( !server::isRunningCurrentScenario(sender) ) return; // Silently ignore info from previous scenario
         std::string sauerType = ScriptEngineManager::getGlobal()->call("getEntitySauerType", _class)->getString();
-        Logging::log(Logging::DEBUG, "Sauer type: %s\r\n", sauerType.c_str());
+        LOG(DEBUG, "Sauer type: %s\r\n", sauerType.c_str());
         python::list params;
         if (sauerType != "dynent")
             params.append(findtype((char*)sauerType.c_str()));
@@ -539,7 +444,7 @@ namespace MessageSystem
             ScriptValueArgs().append(_class).append(kwargs)
         );
         int newUniqueId = scriptEntity->getPropertyInt("uniqueId");
-        Logging::log(Logging::DEBUG, "Created Entity: %d - %s  (%f,%f,%f) \r\n",
+        LOG(DEBUG, "Created Entity: %d - %s  (%f,%f,%f) \r\n",
                                       newUniqueId, _class.c_str(), x, y, z);
     }
 #endif
@@ -550,45 +455,31 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type StateDataUpdate (1011)\r\n");
+        LOG(DEBUG, "Sending a message of type StateDataUpdate (1011)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  exclude = originalClientNumber;
+        // Coalesced with the other updates this tick, and sent as StateDataUpdates
+        if (StateDataBatching::queue(true, clientNumber, uniqueId, keyProtocolId, value, originalClientNumber))
+            return;
+
 
+        StateDataBatching::flushReliable();
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1011);
+            putint(buf, uniqueId);
+            putint(buf, keyProtocolId);
+            sendstring(value.c_str(), buf);
+            putint(buf, originalClientNumber);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (true && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riiisi", 1011, uniqueId, keyProtocolId, value.c_str(), originalClientNumber);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riiisi", 1011, uniqueId, keyProtocolId, value.c_str(), originalClientNumber);
         }
     }
 
@@ -600,7 +491,7 @@ namespace MessageSystem
 #else // SERVER
         is_npc = true;
 #endif
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type StateDataUpdate (1011)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type StateDataUpdate (1011)\r\n");
 
         int uniqueId = getint(p);
         int keyProtocolId = getint(p);
@@ -620,13 +511,14 @@ namespace MessageSystem
             #define STATE_DATA_UPDATE \
                 assert(originalClientNumber == -1 || ClientSystem::playerNumber != originalClientNumber); /* Can be -1, or else cannot be us */ \
                 \
-                Logging::log(Logging::DEBUG, "StateDataUpdate: %d, %d, %s \r\n", uniqueId, keyProtocolId, value.c_str()); \
+                LOG(DEBUG, "StateDataUpdate: %d, %d, %s \r\n", uniqueId, keyProtocolId, value.c_str()); \
                 \
                 if (!ScriptEngineManager::hasEngine()) \
                     return; \
                 \
-                ScriptEngineManager::getGlobal()->call("setStateDatum", \
-                    ScriptValueArgs().append(uniqueId).append(keyProtocolId).append(value) \
+                static ScriptFunction* setStateDatum = ScriptEngineManager::getFunction("setStateDatum"); \
+                setStateDatum->call( \
+                    ScriptArgs().append(uniqueId).append(keyProtocolId).append(value) \
                 );
         #endif
         STATE_DATA_UPDATE
@@ -646,7 +538,7 @@ namespace MessageSystem
         if (editmode)
             EditingSystem::madeChanges = true;
 
-        Logging::log(Logging::DEBUG, "Sending a message of type StateDataChangeRequest (1012)\r\n");
+        LOG(DEBUG, "Sending a message of type StateDataChangeRequest (1012)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1012, "riis", uniqueId, keyProtocolId, value.c_str());
@@ -655,7 +547,7 @@ namespace MessageSystem
 #ifdef SERVER
     void StateDataChangeRequest::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type StateDataChangeRequest (1012)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type StateDataChangeRequest (1012)\r\n");
 
         int uniqueId = getint(p);
         int keyProtocolId = getint(p);
@@ -667,12 +559,13 @@ namespace MessageSystem
         #define STATE_DATA_REQUEST \
         int actorUniqueId = FPSServerInterface::getUniqueId(sender); \
         \
-        Logging::log(Logging::DEBUG, "client %d requests to change %d to value: %s\r\n", actorUniqueId, keyProtocolId, value.c_str()); \
+        LOG(DEBUG, "client %d requests to change %d to value: %s\r\n", actorUniqueId, keyProtocolId, value.c_str()); \
         \
         if ( !server::isRunningCurrentScenario(sender) ) return; /* Silently ignore info from previous scenario */ \
         \
-        ScriptEngineManager::getGlobal()->call("setStateDatum", \
-            ScriptValueArgs().append(uniqueId).append(keyProtocolId).append(value).append(actorUniqueId) \
+        static ScriptFunction* setStateDatum = ScriptEngineManager::getFunction("setStateDatum"); \
+        setStateDatum->call( \
+            ScriptArgs().append(uniqueId).append(keyProtocolId).append(value).append(actorUniqueId) \
         );
         STATE_DATA_REQUEST
     }
@@ -684,45 +577,28 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type UnreliableStateDataUpdate (1013)\r\n");
+        LOG(DEBUG, "Sending a message of type UnreliableStateDataUpdate (1013)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  exclude = originalClientNumber;
+        if (StateDataBatching::queue(false, clientNumber, uniqueId, keyProtocolId, value, originalClientNumber))
+            return;
 
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, 0);
+            putint(buf, 1013);
+            putint(buf, uniqueId);
+            putint(buf, keyProtocolId);
+            sendstring(value.c_str(), buf);
+            putint(buf, originalClientNumber);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (true && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "iiisi", 1013, uniqueId, keyProtocolId, value.c_str(), originalClientNumber);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "iiisi", 1013, uniqueId, keyProtocolId, value.c_str(), originalClientNumber);
         }
     }
 
@@ -734,7 +610,7 @@ namespace MessageSystem
 #else // SERVER
         is_npc = true;
 #endif
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type UnreliableStateDataUpdate (1013)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type UnreliableStateDataUpdate (1013)\r\n");
 
         int uniqueId = getint(p);
         int keyProtocolId = getint(p);
@@ -751,7 +627,7 @@ namespace MessageSystem
 
     void send_UnreliableStateDataChangeRequest(int uniqueId, int keyProtocolId, std::string value)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type UnreliableStateDataChangeRequest (1014)\r\n");
+        LOG(DEBUG, "Sending a message of type UnreliableStateDataChangeRequest (1014)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1014, "iis", uniqueId, keyProtocolId, value.c_str());
@@ -760,7 +636,7 @@ namespace MessageSystem
 #ifdef SERVER
     void UnreliableStateDataChangeRequest::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type UnreliableStateDataChangeRequest (1014)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type UnreliableStateDataChangeRequest (1014)\r\n");
 
         int uniqueId = getint(p);
         int keyProtocolId = getint(p);
@@ -779,44 +655,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type NotifyNumEntities (1015)\r\n");
+        LOG(DEBUG, "Sending a message of type NotifyNumEntities (1015)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1015);
+            putint(buf, num);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "rii", 1015, num);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "rii", 1015, num);
         }
     }
 
@@ -825,7 +681,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type NotifyNumEntities (1015)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type NotifyNumEntities (1015)\r\n");
 
         int num = getint(p);
 
@@ -840,44 +696,23 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type AllActiveEntitiesSent (1016)\r\n");
+        LOG(DEBUG, "Sending a message of type AllActiveEntitiesSent (1016)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1016);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "ri", 1016);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "ri", 1016);
         }
     }
 
@@ -886,7 +721,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type AllActiveEntitiesSent (1016)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type AllActiveEntitiesSent (1016)\r\n");
 
 
         ClientSystem::finishLoadWorld();
@@ -898,7 +733,7 @@ namespace MessageSystem
 
     void send_ActiveEntitiesRequest(std::string scenarioCode)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type ActiveEntitiesRequest (1017)\r\n");
+        LOG(DEBUG, "Sending a message of type ActiveEntitiesRequest (1017)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1017, "rs", scenarioCode.c_str());
@@ -907,7 +742,7 @@ namespace MessageSystem
 #ifdef SERVER
     void ActiveEntitiesRequest::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type ActiveEntitiesRequest (1017)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type ActiveEntitiesRequest (1017)\r\n");
 
         char tmp_scenarioCode[MAXTRANS];
         getstring(tmp_scenarioCode, p);
@@ -919,7 +754,7 @@ namespace MessageSystem
             server::setClientScenario(sender, scenarioCode);
             if ( !server::isRunningCurrentScenario(sender) )
             {
-                Logging::log(Logging::WARNING, "Client %d requested active entities for an invalid scenario: %s\r\n",
+                LOG(WARNING, "Client %d requested active entities for an invalid scenario: %s\r\n",
                     sender, scenarioCode.c_str()
                 );
                 send_PersonalServerMessage(sender, -1, "Invalid scenario", "An error occured in synchronizing scenarios");
@@ -949,44 +784,27 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type LogicEntityCompleteNotification (1018)\r\n");
+        LOG(DEBUG, "Sending a message of type LogicEntityCompleteNotification (1018)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1018);
+            putint(buf, otherClientNumber);
+            putint(buf, otherUniqueId);
+            sendstring(otherClass.c_str(), buf);
+            sendstring(stateData.c_str(), buf);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (true && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riiiss", 1018, otherClientNumber, otherUniqueId, otherClass.c_str(), stateData.c_str());
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riiiss", 1018, otherClientNumber, otherUniqueId, otherClass.c_str(), stateData.c_str());
         }
     }
 
@@ -998,7 +816,7 @@ namespace MessageSystem
 #else // SERVER
         is_npc = true;
 #endif
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type LogicEntityCompleteNotification (1018)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type LogicEntityCompleteNotification (1018)\r\n");
 
         int otherClientNumber = getint(p);
         int otherUniqueId = getint(p);
@@ -1015,13 +833,13 @@ namespace MessageSystem
         #endif
         if (!ScriptEngineManager::hasEngine())
             return;
-        Logging::log(Logging::DEBUG, "RECEIVING LE: %d,%d,%s\r\n", otherClientNumber, otherUniqueId, otherClass.c_str());
+        LOG(DEBUG, "RECEIVING LE: %d,%d,%s\r\n", otherClientNumber, otherUniqueId, otherClass.c_str());
         INDENT_LOG(Logging::DEBUG);
         // If a logic entity does not yet exist, create one
         LogicEntityPtr entity = LogicSystem::getLogicEntity(otherUniqueId);
         if (entity.get() == NULL)
         {
-            Logging::log(Logging::DEBUG, "Creating new active LogicEntity\r\n");
+            LOG(DEBUG, "Creating new active LogicEntity\r\n");
             ScriptValuePtr kwargs = ScriptEngineManager::createScriptObject();
             if (otherClientNumber >= 0) // If this is another client, NPC, etc., then send the clientnumber, critical for setup
             {
@@ -1029,7 +847,7 @@ namespace MessageSystem
                     // If this is the player, validate it is the clientNumber we already have
                     if (otherUniqueId == ClientSystem::uniqueId)
                     {
-                        Logging::log(Logging::DEBUG, "This is the player's entity (%d), validating client num: %d,%d\r\n",
+                        LOG(DEBUG, "This is the player's entity (%d), validating client num: %d,%d\r\n",
                             otherUniqueId, otherClientNumber, ClientSystem::playerNumber);
                         assert(otherClientNumber == ClientSystem::playerNumber);
                     }
@@ -1042,22 +860,22 @@ namespace MessageSystem
             entity = LogicSystem::getLogicEntity(otherUniqueId);
             if (!entity.get())
             {
-                Logging::log(Logging::ERROR, "Received a LogicEntityCompleteNotification for a LogicEntity that cannot be created: %d - %s. Ignoring\r\n", otherUniqueId, otherClass.c_str());
+                LOG(ERROR, "Received a LogicEntityCompleteNotification for a LogicEntity that cannot be created: %d - %s. Ignoring\r\n", otherUniqueId, otherClass.c_str());
                 return;
             }
         } else
-            Logging::log(Logging::DEBUG, "Existing LogicEntity %d,%d,%d, no need to create\r\n", entity.get() != NULL, entity->getUniqueId(),
+            LOG(DEBUG, "Existing LogicEntity %d,%d,%d, no need to create\r\n", entity.get() != NULL, entity->getUniqueId(),
                                             otherUniqueId);
         // A logic entity now exists (either one did before, or we created one), we now update the stateData, if we
         // are remotely connected (TODO: make this not segfault for localconnect)
-        Logging::log(Logging::DEBUG, "Updating stateData with: %s\r\n", stateData.c_str());
+        LOG(DEBUG, "Updating stateData with: %s\r\n", stateData.c_str());
         ScriptValuePtr sd = ScriptEngineManager::createScriptValue(stateData);
         entity.get()->scriptEntity->call("_updateCompleteStateData", sd);
         #ifdef CLIENT
             // If this new entity is in fact the Player's entity, then we finally have the player's LE, and can link to it.
             if (otherUniqueId == ClientSystem::uniqueId)
             {
-                Logging::log(Logging::DEBUG, "Linking player information, uid: %d\r\n", otherUniqueId);
+                LOG(DEBUG, "Linking player information, uid: %d\r\n", otherUniqueId);
                 // Note in C++
                 ClientSystem::playerLogicEntity = LogicSystem::getLogicEntity(ClientSystem::uniqueId);
                 // Note in Scripting
@@ -1074,7 +892,7 @@ namespace MessageSystem
     void send_RequestLogicEntityRemoval(int uniqueId)
     {        EditingSystem::madeChanges = true;
 
-        Logging::log(Logging::DEBUG, "Sending a message of type RequestLogicEntityRemoval (1019)\r\n");
+        LOG(DEBUG, "Sending a message of type RequestLogicEntityRemoval (1019)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1019, "ri", uniqueId);
@@ -1083,14 +901,14 @@ namespace MessageSystem
 #ifdef SERVER
     void RequestLogicEntityRemoval::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RequestLogicEntityRemoval (1019)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RequestLogicEntityRemoval (1019)\r\n");
 
         int uniqueId = getint(p);
 
         if (!ServerSystem::isRunningMap()) return;
         if (!server::isAdmin(sender))
         {
-            Logging::log(Logging::WARNING, "Non-admin tried to remove an entity\r\n");
+            LOG(WARNING, "Non-admin tried to remove an entity\r\n");
             send_PersonalServerMessage(sender, -1, "Server", "You are not an administrator, and cannot remove entities");
             return;
         }
@@ -1105,44 +923,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type LogicEntityRemoval (1020)\r\n");
+        LOG(DEBUG, "Sending a message of type LogicEntityRemoval (1020)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1020);
+            putint(buf, uniqueId);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "rii", 1020, uniqueId);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "rii", 1020, uniqueId);
         }
     }
 
@@ -1151,7 +949,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type LogicEntityRemoval (1020)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type LogicEntityRemoval (1020)\r\n");
 
         int uniqueId = getint(p);
 
@@ -1168,44 +966,33 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type ExtentCompleteNotification (1021)\r\n");
+        LOG(DEBUG, "Sending a message of type ExtentCompleteNotification (1021)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1021);
+            putint(buf, otherUniqueId);
+            sendstring(otherClass.c_str(), buf);
+            sendstring(stateData.c_str(), buf);
+            putint(buf, int(x*DMF));
+            putint(buf, int(y*DMF));
+            putint(buf, int(z*DMF));
+            putint(buf, attr1);
+            putint(buf, attr2);
+            putint(buf, attr3);
+            putint(buf, attr4);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riissiiiiiii", 1021, otherUniqueId, otherClass.c_str(), stateData.c_str(), int(x*DMF), int(y*DMF), int(z*DMF), attr1, attr2, attr3, attr4);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riissiiiiiii", 1021, otherUniqueId, otherClass.c_str(), stateData.c_str(), int(x*DMF), int(y*DMF), int(z*DMF), attr1, attr2, attr3, attr4);
         }
     }
 
@@ -1214,7 +1001,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type ExtentCompleteNotification (1021)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type ExtentCompleteNotification (1021)\r\n");
 
         int otherUniqueId = getint(p);
         char tmp_otherClass[MAXTRANS];
@@ -1244,14 +1031,14 @@ namespace MessageSystem
             e.attr1 = attr1; e.attr2 = attr2; e.attr3 = attr3; e.attr4 = attr4;
             addentity(i);
         #endif
-        Logging::log(Logging::DEBUG, "RECEIVING Extent: %d,%s - %f,%f,%f  %d,%d,%d\r\n", otherUniqueId, otherClass.c_str(),
+        LOG(DEBUG, "RECEIVING Extent: %d,%s - %f,%f,%f  %d,%d,%d\r\n", otherUniqueId, otherClass.c_str(),
             x, y, z, attr1, attr2, attr3, attr4);
         INDENT_LOG(Logging::DEBUG);
         // If a logic entity does not yet exist, create one
         LogicEntityPtr entity = LogicSystem::getLogicEntity(otherUniqueId);
         if (entity.get() == NULL)
         {
-            Logging::log(Logging::DEBUG, "Creating new active LogicEntity\r\n");
+            LOG(DEBUG, "Creating new active LogicEntity\r\n");
             std::string sauerType = ScriptEngineManager::getGlobal()->call("getEntitySauerType", otherClass)->getString();
             ScriptValuePtr kwargs = ScriptEngineManager::createScriptObject();
             kwargs->setProperty("_type", findtype((char*)sauerType.c_str()));
@@ -1268,11 +1055,11 @@ namespace MessageSystem
             entity = LogicSystem::getLogicEntity(otherUniqueId);
             assert(entity.get() != NULL);
         } else
-            Logging::log(Logging::DEBUG, "Existing LogicEntity %d,%d,%d, no need to create\r\n", entity.get() != NULL, entity->getUniqueId(),
+            LOG(DEBUG, "Existing LogicEntity %d,%d,%d, no need to create\r\n", entity.get() != NULL, entity->getUniqueId(),
                                             otherUniqueId);
         // A logic entity now exists (either one did before, or we created one), we now update the stateData, if we
         // are remotely connected (TODO: make this not segfault for localconnect)
-        Logging::log(Logging::DEBUG, "Updating stateData\r\n");
+        LOG(DEBUG, "Updating stateData\r\n");
         ScriptValuePtr sd = ScriptEngineManager::createScriptValue(stateData);
         entity.get()->scriptEntity->call("_updateCompleteStateData", sd);
         // Events post-reception
@@ -1287,44 +1074,25 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type InitS2C (1022)\r\n");
+        LOG(DEBUG, "Sending a message of type InitS2C (1022)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1022);
+            putint(buf, explicitClientNumber);
+            putint(buf, protocolVersion);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riii", 1022, explicitClientNumber, protocolVersion);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riii", 1022, explicitClientNumber, protocolVersion);
         }
     }
 
@@ -1333,14 +1101,14 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type InitS2C (1022)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type InitS2C (1022)\r\n");
 
         int explicitClientNumber = getint(p);
         int protocolVersion = getint(p);
 
         if (!is_npc)
         {
-            Logging::log(Logging::DEBUG, "client.h: SV_INITS2C gave us cn/protocol: %d/%d\r\n", explicitClientNumber, protocolVersion);
+            LOG(DEBUG, "client.h: SV_INITS2C gave us cn/protocol: %d/%d\r\n", explicitClientNumber, protocolVersion);
             if(protocolVersion != PROTOCOL_VERSION)
             {
                 conoutf(CON_ERROR, "You are using a different network protocol (you: %d, server: %d)", PROTOCOL_VERSION, protocolVersion);
@@ -1355,7 +1123,7 @@ namespace MessageSystem
             #endif
         } else {
             // NPC
-            Logging::log(Logging::INFO, "client.h (npc): SV_INITS2C gave us cn/protocol: %d/%d\r\n", explicitClientNumber, protocolVersion);
+            LOG(INFO, "client.h (npc): SV_INITS2C gave us cn/protocol: %d/%d\r\n", explicitClientNumber, protocolVersion);
             assert(0); //does this ever occur?
         }
     }
@@ -1366,7 +1134,7 @@ namespace MessageSystem
 
     void send_MapVote(std::string name)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type MapVote (1023)\r\n");
+        LOG(DEBUG, "Sending a message of type MapVote (1023)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1023, "rs", name.c_str());
@@ -1375,7 +1143,7 @@ namespace MessageSystem
 #ifdef SERVER
     void MapVote::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type MapVote (1023)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type MapVote (1023)\r\n");
 
         char tmp_name[MAXTRANS];
         getstring(tmp_name, p);
@@ -1391,44 +1159,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type MapChange (1024)\r\n");
+        LOG(DEBUG, "Sending a message of type MapChange (1024)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1024);
+            sendstring(name.c_str(), buf);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "ris", 1024, name.c_str());
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "ris", 1024, name.c_str());
         }
     }
 
@@ -1437,7 +1185,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type MapChange (1024)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type MapChange (1024)\r\n");
 
         char tmp_name[MAXTRANS];
         getstring(tmp_name, p);
@@ -1454,7 +1202,7 @@ namespace MessageSystem
 
     void send_SoundToServer(int soundId)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type SoundToServer (1025)\r\n");
+        LOG(DEBUG, "Sending a message of type SoundToServer (1025)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1025, "i", soundId);
@@ -1463,7 +1211,7 @@ namespace MessageSystem
 #ifdef SERVER
     void SoundToServer::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type SoundToServer (1025)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type SoundToServer (1025)\r\n");
 
         int soundId = getint(p);
 
@@ -1481,45 +1229,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type SoundToClients (1026)\r\n");
+        LOG(DEBUG, "Sending a message of type SoundToClients (1026)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  exclude = originalClientNumber; // This is how to ensure we do not send back to the client who originally sent it
 
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, 0);
+            putint(buf, 1026);
+            putint(buf, soundId);
+            putint(buf, originalClientNumber);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "iii", 1026, soundId, originalClientNumber);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "iii", 1026, soundId, originalClientNumber);
         }
     }
 
@@ -1528,7 +1255,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type SoundToClients (1026)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type SoundToClients (1026)\r\n");
 
         int soundId = getint(p);
         int originalClientNumber = getint(p);
@@ -1559,45 +1286,27 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type SoundToClientsByName (1027)\r\n");
+        LOG(DEBUG, "Sending a message of type SoundToClientsByName (1027)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  exclude = originalClientNumber; // This is how to ensure we do not send back to the client who originally sent it
 
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, 0);
+            putint(buf, 1027);
+            putint(buf, int(x*DMF));
+            putint(buf, int(y*DMF));
+            putint(buf, int(z*DMF));
+            sendstring(soundName.c_str(), buf);
+            putint(buf, originalClientNumber);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "iiiisi", 1027, int(x*DMF), int(y*DMF), int(z*DMF), soundName.c_str(), originalClientNumber);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "iiiisi", 1027, int(x*DMF), int(y*DMF), int(z*DMF), soundName.c_str(), originalClientNumber);
         }
     }
 
@@ -1606,7 +1315,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type SoundToClientsByName (1027)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type SoundToClientsByName (1027)\r\n");
 
         float x = float(getint(p))/DMF;
         float y = float(getint(p))/DMF;
@@ -1630,7 +1339,7 @@ namespace MessageSystem
 
     void send_EditModeC2S(int mode)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type EditModeC2S (1028)\r\n");
+        LOG(DEBUG, "Sending a message of type EditModeC2S (1028)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1028, "ri", mode);
@@ -1639,7 +1348,7 @@ namespace MessageSystem
 #ifdef SERVER
     void EditModeC2S::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type EditModeC2S (1028)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type EditModeC2S (1028)\r\n");
 
         int mode = getint(p);
 
@@ -1682,45 +1391,26 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type EditModeS2C (1029)\r\n");
+        LOG(DEBUG, "Sending a message of type EditModeS2C (1029)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
                  exclude = otherClientNumber;
 
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1029);
+            putint(buf, otherClientNumber);
+            putint(buf, mode);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::DUMMY, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::DUMMY)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (true && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "riii", 1029, otherClientNumber, mode);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "riii", 1029, otherClientNumber, mode);
         }
     }
 
@@ -1732,7 +1422,7 @@ namespace MessageSystem
 #else // SERVER
         is_npc = true;
 #endif
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type EditModeS2C (1029)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type EditModeS2C (1029)\r\n");
 
         int otherClientNumber = getint(p);
         int mode = getint(p);
@@ -1758,7 +1448,7 @@ namespace MessageSystem
 
     void send_RequestMap()
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type RequestMap (1030)\r\n");
+        LOG(DEBUG, "Sending a message of type RequestMap (1030)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1030, "r");
@@ -1767,7 +1457,7 @@ namespace MessageSystem
 #ifdef SERVER
     void RequestMap::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RequestMap (1030)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RequestMap (1030)\r\n");
 
 
         if (!ServerSystem::isRunningMap()) return;
@@ -1780,7 +1470,7 @@ namespace MessageSystem
 
     void send_DoClick(int button, int down, float x, float y, float z, int uniqueId)
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type DoClick (1031)\r\n");
+        LOG(DEBUG, "Sending a message of type DoClick (1031)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1031, "riiiiii", button, down, int(x*DMF), int(y*DMF), int(z*DMF), uniqueId);
@@ -1789,7 +1479,7 @@ namespace MessageSystem
 #ifdef SERVER
     void DoClick::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type DoClick (1031)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type DoClick (1031)\r\n");
 
         int button = getint(p);
         int down = getint(p);
@@ -1800,24 +1490,26 @@ namespace MessageSystem
 
         if (!ServerSystem::isRunningMap()) return;
         if ( !server::isRunningCurrentScenario(sender) ) return; // Silently ignore info from previous scenario
-        ScriptValuePtr position = ScriptEngineManager::runScript(
-            "new Vector3(" + 
-                Utility::toString(x) + "," + 
-                Utility::toString(y) + "," + 
-                Utility::toString(z) +
-            ")"
+        static ScriptFunction* newObject = ScriptEngineManager::getFunction("__new__");
+        ScriptValuePtr position = newObject->call(
+            ScriptArgs().append(ScriptEngineManager::getGlobal()->getProperty("Vector3"))
+                .append(double(x))
+                .append(double(y))
+                .append(double(z))
         );
-        ScriptValueArgs args;
+        ScriptArgs args;
         args.append(button).append(down).append(position);
+        LogicEntityPtr entity;
         if (uniqueId != -1)
         {
-            LogicEntityPtr entity = LogicSystem::getLogicEntity(uniqueId);
+            entity = LogicSystem::getLogicEntity(uniqueId);
             if (entity.get())
                 args.append(entity->scriptEntity);
             else
                 return; // No need to do a click that was on an entity that vanished meanwhile/does not yet exist!
         }
-        ScriptEngineManager::getGlobal()->getProperty("ApplicationManager")->getProperty("instance")->call("click", args);
+        static ScriptFunction* click = ScriptEngineManager::getFunction("ApplicationManager.instance.click");
+        click->call(args);
     }
 #endif
 
@@ -1827,44 +1519,24 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type MapUpdated (1032)\r\n");
+        LOG(DEBUG, "Sending a message of type MapUpdated (1032)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1032);
+            putint(buf, updatingClientNumber);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "rii", 1032, updatingClientNumber);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "rii", 1032, updatingClientNumber);
         }
     }
 
@@ -1873,7 +1545,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type MapUpdated (1032)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type MapUpdated (1032)\r\n");
 
         int updatingClientNumber = getint(p);
 
@@ -1895,44 +1567,27 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type ParticleSplashToClients (1033)\r\n");
+        LOG(DEBUG, "Sending a message of type ParticleSplashToClients (1033)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, 0);
+            putint(buf, 1033);
+            putint(buf, _type);
+            putint(buf, num);
+            putint(buf, fade);
+            putint(buf, int(x*DMF));
+            putint(buf, int(y*DMF));
+            putint(buf, int(z*DMF));
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "iiiiiii", 1033, _type, num, fade, int(x*DMF), int(y*DMF), int(z*DMF));
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "iiiiiii", 1033, _type, num, fade, int(x*DMF), int(y*DMF), int(z*DMF));
         }
     }
 
@@ -1941,7 +1596,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type ParticleSplashToClients (1033)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type ParticleSplashToClients (1033)\r\n");
 
         int _type = getint(p);
         int num = getint(p);
@@ -1960,7 +1615,7 @@ namespace MessageSystem
 
     void send_RequestPrivateEditMode()
     {
-        Logging::log(Logging::DEBUG, "Sending a message of type RequestPrivateEditMode (1034)\r\n");
+        LOG(DEBUG, "Sending a message of type RequestPrivateEditMode (1034)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         game::addmsg(1034, "r");
@@ -1969,7 +1624,7 @@ namespace MessageSystem
 #ifdef SERVER
     void RequestPrivateEditMode::receive(int receiver, int sender, ucharbuf &p)
     {
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type RequestPrivateEditMode (1034)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type RequestPrivateEditMode (1034)\r\n");
 
 
         if (!ServerSystem::isRunningMap()) return;
@@ -1984,44 +1639,23 @@ namespace MessageSystem
     {
         int exclude = -1; // Set this to clientNumber to not send to
 
-        Logging::log(Logging::DEBUG, "Sending a message of type NotifyPrivateEditMode (1035)\r\n");
+        LOG(DEBUG, "Sending a message of type NotifyPrivateEditMode (1035)\r\n");
         INDENT_LOG(Logging::DEBUG);
 
          
 
-        int start, finish;
+        StateDataBatching::flushReliable();
+
         if (clientNumber == -1)
         {
-            // Send to all clients
-            start  = 0;
-            finish = getnumclients() - 1;
-        } else {
-            start  = clientNumber;
-            finish = clientNumber;
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1035);
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE, exclude);
         }
-
-#ifdef SERVER
-        int testUniqueId;
-#endif
-        for (clientNumber = start; clientNumber <= finish; clientNumber++)
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE)))
         {
-            if (clientNumber == exclude) continue;
-#ifdef SERVER
-            fpsent* fpsEntity = dynamic_cast<fpsent*>( FPSClientInterface::getPlayerByNumber(clientNumber) );
-            bool serverControlled = fpsEntity ? fpsEntity->serverControlled : false;
-
-            testUniqueId = FPSServerInterface::getUniqueId(clientNumber);
-            if ( (!serverControlled && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If a remote client, send even if negative (during login process)
-                 (false && testUniqueId == DUMMY_SINGLETON_CLIENT_UNIQUE_ID) || // If need to send to dummy server, send there
-                 (false && testUniqueId != DUMMY_SINGLETON_CLIENT_UNIQUE_ID && serverControlled) )  // If need to send to npcs, send there
-#endif
-            {
-                #ifdef SERVER
-                    Logging::log(Logging::DEBUG, "Sending to %d (%d) ((%d))\r\n", clientNumber, testUniqueId, serverControlled);
-                #endif
-                sendf(clientNumber, MAIN_CHANNEL, "ri", 1035);
-
-            }
+            sendf(clientNumber, MAIN_CHANNEL, "ri", 1035);
         }
     }
 
@@ -2030,7 +1664,7 @@ namespace MessageSystem
     {
         bool is_npc;
         is_npc = false;
-        Logging::log(Logging::DEBUG, "MessageSystem: Receiving a message of type NotifyPrivateEditMode (1035)\r\n");
+        LOG(DEBUG, "MessageSystem: Receiving a message of type NotifyPrivateEditMode (1035)\r\n");
 
 
         IntensityGUI::showMessage("", "Server: You are now in private edit mode");
@@ -2039,6 +1673,132 @@ namespace MessageSystem
 #endif
 
 
+// StateDataUpdates
+
+    void send_StateDataUpdates(int clientNumber, int numUpdates, vector<uchar> &updates)
+    {
+        int exclude = -1; // Set this to clientNumber to not send to
+
+        LOG(DEBUG, "Sending a message of type StateDataUpdates (1036)\r\n");
+        INDENT_LOG(Logging::DEBUG);
+
+         
+
+        StateDataBatching::flushReliable();
+
+        if (clientNumber == -1)
+        {
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, ENET_PACKET_FLAG_RELIABLE);
+            putint(buf, 1036);
+            putint(buf, numUpdates);
+            putint(buf, updates.length());
+            buf.put(updates.getbuf(), updates.length());
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC, exclude);
+        }
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC)))
+        {
+            sendf(clientNumber, MAIN_CHANNEL, "riiim", 1036, numUpdates, updates.length(), updates.length(), updates.getbuf());
+        }
+    }
+
+    void StateDataUpdates::receive(int receiver, int sender, ucharbuf &p)
+    {
+        bool is_npc;
+#ifdef CLIENT
+        is_npc = false;
+#else // SERVER
+        is_npc = true;
+#endif
+        LOG(DEBUG, "MessageSystem: Receiving a message of type StateDataUpdates (1036)\r\n");
+
+        int numUpdates = getint(p);
+        int length_updates = getint(p);
+        ucharbuf updates = p.subbuf(max(length_updates, 0));
+
+        #ifdef SERVER
+            #define STATE_DATA_UPDATES \
+                numUpdates = numUpdates; /* Prevent warnings */ \
+                updates = updates; \
+                is_npc = is_npc; \
+                return; /* As with StateDataUpdate, no need to process these on the server */
+        #else
+            #define STATE_DATA_UPDATES \
+                is_npc = is_npc; /* Prevent warnings */ \
+                \
+                LOG(DEBUG, "StateDataUpdates: %d\r\n", numUpdates); \
+                \
+                if (!ScriptEngineManager::hasEngine()) \
+                    return; \
+                \
+                /* A flat array of uniqueId, keyProtocolId, value triplets */ \
+                ScriptValuePtr data = ScriptEngineManager::createScriptObject(); \
+                for (int i = 0; i < numUpdates; i++) \
+                { \
+                    data->setProperty(Utility::toString(3*i), getint(updates)); \
+                    data->setProperty(Utility::toString(3*i + 1), getint(updates)); \
+                    ScriptValuePtr value = StateDataEncoding::decode(updates); \
+                    if (!value.get() || updates.overread()) \
+                    { \
+                        LOG(ERROR, "Invalid StateDataUpdates\r\n"); \
+                        return; \
+                    } \
+                    data->setProperty(Utility::toString(3*i + 2), value); \
+                } \
+                data->setProperty("length", 3*numUpdates); \
+                \
+                static ScriptFunction* setStateData = ScriptEngineManager::getFunction("setStateData"); \
+                setStateData->call(ScriptArgs().append(data));
+        #endif
+        STATE_DATA_UPDATES
+    }
+
+
+// UnreliableStateDataUpdates
+
+    void send_UnreliableStateDataUpdates(int clientNumber, int numUpdates, vector<uchar> &updates)
+    {
+        int exclude = -1; // Set this to clientNumber to not send to
+
+        LOG(DEBUG, "Sending a message of type UnreliableStateDataUpdates (1037)\r\n");
+        INDENT_LOG(Logging::DEBUG);
+
+         
+
+        if (clientNumber == -1)
+        {
+            // Send to all clients: encode once, into a single packet that they all share
+            packetbuf buf(MAXTRANS, 0);
+            putint(buf, 1037);
+            putint(buf, numUpdates);
+            putint(buf, updates.length());
+            buf.put(updates.getbuf(), updates.length());
+            broadcast(buf.finalize(), MAIN_CHANNEL, MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC, exclude);
+        }
+        else if (clientNumber != exclude && (MessageSystem::Recipients::getKind(clientNumber) & (MessageSystem::Recipients::REMOTE | MessageSystem::Recipients::NPC)))
+        {
+            sendf(clientNumber, MAIN_CHANNEL, "iiim", 1037, numUpdates, updates.length(), updates.length(), updates.getbuf());
+        }
+    }
+
+    void UnreliableStateDataUpdates::receive(int receiver, int sender, ucharbuf &p)
+    {
+        bool is_npc;
+#ifdef CLIENT
+        is_npc = false;
+#else // SERVER
+        is_npc = true;
+#endif
+        LOG(DEBUG, "MessageSystem: Receiving a message of type UnreliableStateDataUpdates (1037)\r\n");
+
+        int numUpdates = getint(p);
+        int length_updates = getint(p);
+        ucharbuf updates = p.subbuf(max(length_updates, 0));
+
+        STATE_DATA_UPDATES
+    }
+
+
 // Register all messages
 
 void MessageManager::registerAll()
@@ -2078,6 +1838,8 @@ void MessageManager::registerAll()
     registerMessageType( new ParticleSplashToClients() );
     registerMessageType( new RequestPrivateEditMode() );
     registerMessageType( new NotifyPrivateEditMode() );
+    registerMessageType( new StateDataUpdates() );
+    registerMessageType( new UnreliableStateDataUpdates() );
 }
 
 }
@@ -486,3 +486,27 @@ struct NotifyPrivateEditMode : MessageType
 
 void send_NotifyPrivateEditMode(int clientNumber);
 
+
+// StateDataUpdates
+
+struct StateDataUpdates : MessageType
+{
+    StateDataUpdates() : MessageType(1036, "StateDataUpdates") { };
+
+    void receive(int receiver, int sender, ucharbuf &p);
+};
+
+void send_StateDataUpdates(int clientNumber, int numUpdates, vector<uchar> &updates);
+
+
+// UnreliableStateDataUpdates
+
+struct UnreliableStateDataUpdates : MessageType
+{
+    UnreliableStateDataUpdates() : MessageType(1037, "UnreliableStateDataUpdates") { };
+
+    void receive(int receiver, int sender, ucharbuf &p);
+};
+
+void send_UnreliableStateDataUpdates(int clientNumber, int numUpdates, vector<uchar> &updates);
+
@@ -0,0 +1,650 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+#include "cube.h"
+#include "engine.h"
+#include "game.h"
+
+#include "utility.h"
+
+#include "navigation.h"
+
+#include <map>
+#include <list>
+#include <queue>
+#include <algorithm>
+
+
+VAR(navspacing, 2, 8, 64);                // Distance between columns of nodes
+VAR(navheight, 4, 16, 64);                // Headroom needed above a floor
+VAR(navclimb, 1, 6, 32);                  // Largest difference in height that can be walked between neighboring nodes
+VAR(navradius, 0, 3, 32);                 // Clearance needed from walls
+VAR(navmaxsearch, 100, 20000, 1000000);   // Most nodes a full search may expand
+VAR(navrejoin, 0, 256, 100000);           // Most nodes a search to rejoin a cached path may expand
+VAR(navcachesize, 0, 256, 10000);         // How many paths to cache
+
+//! The most floors looked for in a single column
+#define MAX_FLOORS 16
+
+
+// The graph
+
+struct NavNode
+{
+    vec position; //!< On the floor
+    int firstEdge, numEdges;
+};
+
+static int spacing = 0;             //!< That the graph was generated with, which may differ from the current navspacing
+static unsigned int worldCrc = 0;   //!< Of the world the graph was generated from
+static std::vector<NavNode> nodes;  //!< Grouped by column, and in each column from top to bottom
+static std::vector<int> edges;      //!< Indexes of the nodes each node leads to
+static std::vector<int> columnKeys; //!< The nonempty columns, sorted
+static std::vector<int> columnFirst;//!< The first node of each column, and a final entry of the number of nodes
+
+static int getColumnKey(int x, int y)
+{
+    return (x << 16) | y;
+}
+
+static int getColumnCoord(float value)
+{
+    return int(floorf(value / spacing));
+}
+
+//! Returns the index of a column, or -1 if it has no nodes
+static int findColumn(int x, int y)
+{
+    if (x < 0 || y < 0 || x >= 0x8000 || y >= 0x10000)
+        return -1;
+    int key = getColumnKey(x, y);
+    std::vector<int>::iterator iter = std::lower_bound(columnKeys.begin(), columnKeys.end(), key);
+    if (iter == columnKeys.end() || *iter != key)
+        return -1;
+    return iter - columnKeys.begin();
+}
+
+//! A checksum of the world geometry and materials, to tell whether a saved graph is still valid (getmapcrc()
+//! cannot be used, as it is not calculated when maps are loaded)
+static unsigned int crcCubes(unsigned int crc, cube *c)
+{
+    loopi(8)
+    {
+        uchar children = c[i].children ? 1 : 0;
+        crc = crc32(crc, &children, 1);
+        if (c[i].children)
+            crc = crcCubes(crc, c[i].children);
+        else
+        {
+            crc = crc32(crc, (const Bytef*)c[i].faces, sizeof(c[i].faces));
+            uchar material = c[i].ext ? c[i].ext->material : 0;
+            crc = crc32(crc, &material, 1);
+        }
+    }
+    return crc;
+}
+
+static unsigned int getWorldCrc()
+{
+    unsigned int crc = crc32(0, NULL, 0);
+    crc = crc32(crc, (const Bytef*)&worldsize, sizeof(worldsize));
+    return crcCubes(crc, worldroot);
+}
+
+
+// Generation
+
+//! Finds the floors with enough headroom in a column, from top to bottom
+static void findFloors(float x, float y, std::vector<float>& floors)
+{
+    float z = worldsize - 0.5f;
+    while (z > 0 && floors.size() < MAX_FLOORS)
+    {
+        cube& c = lookupcube(int(x), int(y), int(z));
+        if (isentirelysolid(c))
+        {
+            z = lu.z - 0.5f; // Skip to under this cube
+            continue;
+        }
+
+        float distance = raycube(vec(x, y, z), vec(0, 0, -1), z + 1, RAY_CLIPMAT);
+        if (distance <= 0)
+        {
+            z -= 1; // Inside the solid part of a partly solid cube
+            continue;
+        }
+        if (distance >= z)
+            break; // Nothing below
+
+        float floor = z - distance;
+        if (raycube(vec(x, y, floor + 0.1f), vec(0, 0, 1), navheight, RAY_CLIPMAT) >= navheight - 0.1f)
+            floors.push_back(floor);
+        z = floor - 0.5f;
+    }
+}
+
+//! Whether there is room around a floor, at the height of obstacles that cannot be climbed
+static bool hasClearance(const vec& floor)
+{
+    if (navradius <= 0)
+        return true;
+
+    static const vec directions[4] = { vec(1, 0, 0), vec(-1, 0, 0), vec(0, 1, 0), vec(0, -1, 0) };
+    vec knee(floor.x, floor.y, floor.z + navclimb + 0.5f);
+    loopi(4)
+    {
+        if (raycube(knee, directions[i], navradius, RAY_CLIPMAT) < navradius)
+            return false;
+    }
+    return true;
+}
+
+//! Whether an NPC can walk between two neighboring nodes: nothing is in the way, and there is a floor between them
+static bool canWalk(const vec& a, const vec& b)
+{
+    vec hit;
+    loopi(2)
+    {
+        float height = i == 0 ? navclimb + 0.5f : navheight - 0.5f;
+        if (!raycubelos(vec(a).add(vec(0, 0, height)), vec(b).add(vec(0, 0, height)), hit))
+            return false;
+    }
+
+    vec middle = vec(a).add(b).mul(0.5f);
+    middle.z = max(a.z, b.z) + navclimb;
+    return raycube(middle, vec(0, 0, -1), 3*navclimb, RAY_CLIPMAT) <= 2*navclimb;
+}
+
+static void addEdges(int node, int x, int y)
+{
+    NavNode& curr = nodes[node];
+    curr.firstEdge = edges.size();
+    for (int dx = -1; dx <= 1; dx++)
+        for (int dy = -1; dy <= 1; dy++)
+        {
+            if (!dx && !dy)
+                continue;
+            int column = findColumn(x + dx, y + dy);
+            if (column < 0)
+                continue;
+            for (int other = columnFirst[column]; other < columnFirst[column+1]; other++)
+            {
+                if (fabs(nodes[other].position.z - curr.position.z) <= navclimb &&
+                    canWalk(curr.position, nodes[other].position))
+                    edges.push_back(other);
+            }
+        }
+    curr.numEdges = edges.size() - curr.firstEdge;
+}
+
+bool NavigationSystem::generate()
+{
+    clear();
+
+    Profiler::Nanoseconds startTime = Profiler::now();
+
+    spacing = navspacing;
+    int numColumns = worldsize / spacing;
+
+    std::vector<float> floors;
+    for (int x = 0; x < numColumns; x++)
+    {
+        if (x % 16 == 0)
+            renderprogress(float(x) / numColumns, "generating navigation graph...");
+
+        for (int y = 0; y < numColumns; y++)
+        {
+            float centerX = (x + 0.5f)*spacing, centerY = (y + 0.5f)*spacing;
+            floors.clear();
+            findFloors(centerX, centerY, floors);
+
+            int first = nodes.size();
+            for (unsigned int i = 0; i < floors.size(); i++)
+            {
+                NavNode node;
+                node.position = vec(centerX, centerY, floors[i]);
+                node.firstEdge = node.numEdges = 0;
+                if (hasClearance(node.position))
+                    nodes.push_back(node);
+            }
+            if (int(nodes.size()) > first)
+            {
+                columnKeys.push_back(getColumnKey(x, y));
+                columnFirst.push_back(first);
+            }
+        }
+    }
+    columnFirst.push_back(nodes.size());
+
+    for (unsigned int column = 0; column < columnKeys.size(); column++)
+    {
+        if (column % 1024 == 0)
+            renderprogress(float(column) / columnKeys.size(), "connecting navigation graph...");
+
+        int x = columnKeys[column] >> 16, y = columnKeys[column] & 0xFFFF;
+        for (int node = columnFirst[column]; node < columnFirst[column+1]; node++)
+            addEdges(node, x, y);
+    }
+
+    worldCrc = getWorldCrc();
+
+    conoutf("generated navigation graph: %d nodes, %d edges, in %.2f seconds",
+        int(nodes.size()), int(edges.size()), (Profiler::now() - startTime) / 1000000000.0f);
+
+    return save();
+}
+
+
+// Saving and loading. The file is little-endian, as it is distributed with the map
+
+#define NAV_MAGIC "INAV"
+#define NAV_VERSION 1
+
+extern string ogzname; // worldio.cpp
+
+//! The map file, with .nav instead of .ogz
+static std::string getFilename()
+{
+    std::string filename = ogzname;
+    if (filename.size() > 4 && filename.substr(filename.size() - 4) == ".ogz")
+        filename = filename.substr(0, filename.size() - 4);
+    return filename + ".nav";
+}
+
+bool NavigationSystem::save()
+{
+    if (!hasGraph())
+        return false;
+
+    std::string filename = getFilename();
+    stream *f = openrawfile(filename.c_str(), "wb");
+    if (!f)
+    {
+        conoutf(CON_ERROR, "could not write navigation graph to %s", filename.c_str());
+        return false;
+    }
+
+    f->write(NAV_MAGIC, 4);
+    f->putlil<int>(NAV_VERSION);
+    f->putlil<uint>(worldCrc);
+    f->putlil<int>(spacing);
+    f->putlil<int>(nodes.size());
+    f->putlil<int>(edges.size());
+    f->putlil<int>(columnKeys.size());
+
+    for (unsigned int i = 0; i < nodes.size(); i++)
+    {
+        loopj(3) f->putlil<float>(nodes[i].position[j]);
+        f->putlil<int>(nodes[i].firstEdge);
+        f->putlil<int>(nodes[i].numEdges);
+    }
+    for (unsigned int i = 0; i < edges.size(); i++)
+        f->putlil<int>(edges[i]);
+    for (unsigned int i = 0; i < columnKeys.size(); i++)
+    {
+        f->putlil<int>(columnKeys[i]);
+        f->putlil<int>(columnFirst[i]);
+    }
+
+    delete f;
+
+    conoutf("wrote navigation graph to %s", filename.c_str());
+    return true;
+}
+
+bool NavigationSystem::load()
+{
+    clear();
+
+    std::string filename = getFilename();
+    stream *f = openrawfile(filename.c_str(), "rb");
+    if (!f)
+    {
+        LOG(DEBUG, "No navigation graph at %s\r\n", filename.c_str());
+        return false;
+    }
+
+    char magic[4];
+    bool valid = f->read(magic, 4) == 4 && !memcmp(magic, NAV_MAGIC, 4) && f->getlil<int>() == NAV_VERSION;
+    int numNodes = 0, numEdges = 0, numColumns = 0;
+    if (valid)
+    {
+        worldCrc = f->getlil<uint>();
+        spacing = f->getlil<int>();
+        numNodes = f->getlil<int>();
+        numEdges = f->getlil<int>();
+        numColumns = f->getlil<int>();
+        valid = spacing > 0 && numNodes >= 0 && numEdges >= 0 && numColumns >= 0;
+    }
+
+    if (valid)
+    {
+        nodes.resize(numNodes);
+        for (int i = 0; i < numNodes; i++)
+        {
+            loopj(3) nodes[i].position[j] = f->getlil<float>();
+            nodes[i].firstEdge = f->getlil<int>();
+            nodes[i].numEdges = f->getlil<int>();
+            valid = valid && nodes[i].firstEdge >= 0 && nodes[i].numEdges >= 0 &&
+                             nodes[i].firstEdge + nodes[i].numEdges <= numEdges;
+        }
+        edges.resize(numEdges);
+        for (int i = 0; i < numEdges; i++)
+        {
+            edges[i] = f->getlil<int>();
+            valid = valid && edges[i] >= 0 && edges[i] < numNodes;
+        }
+        columnKeys.resize(numColumns);
+        columnFirst.resize(numColumns);
+        for (int i = 0; i < numColumns; i++)
+        {
+            columnKeys[i] = f->getlil<int>();
+            columnFirst[i] = f->getlil<int>();
+            valid = valid && columnFirst[i] >= 0 && columnFirst[i] <= numNodes;
+        }
+        columnFirst.push_back(numNodes);
+        valid = valid && !f->end(); // Nothing was cut off
+    }
+
+    delete f;
+
+    if (!valid)
+    {
+        clear();
+        conoutf(CON_WARN, "ignoring invalid navigation graph %s", filename.c_str());
+        return false;
+    }
+
+    if (worldCrc != getWorldCrc())
+    {
+        clear();
+        conoutf(CON_WARN, "navigation graph %s is out of date, run 'navgen' to regenerate it", filename.c_str());
+        return false;
+    }
+
+    LOG(DEBUG, "Loaded navigation graph: %d nodes, %d edges\r\n", numNodes, numEdges);
+    return true;
+}
+
+
+// Searching
+
+struct SearchNode
+{
+    float cost;         //!< From the start
+    int parent;
+    unsigned int stamp; //!< The search this was last reached in; data from earlier searches is stale
+    bool closed;
+};
+
+static std::vector<SearchNode> searchNodes;
+static unsigned int searchStamp = 0;
+
+typedef std::pair<float, int> OpenEntry; //!< Estimated total cost, and node
+typedef std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> > OpenList;
+
+static float estimate(int node, int goal)
+{
+    return goal >= 0 ? nodes[node].position.dist(nodes[goal].position) : 0;
+}
+
+//! Searches from 'start' until reaching 'goal' (A*), or, if goal is -1, any of 'targets' (Dijkstra). Gives up after
+//! expanding 'maxExpansions' nodes.
+//! @return The node reached, or -1. The path to it, including both ends, is put in 'path'
+static int searchGraph(int start, int goal, const std::map<int, int>* targets, int maxExpansions, std::vector<int>& path)
+{
+    if (searchNodes.size() != nodes.size())
+    {
+        searchNodes.assign(nodes.size(), SearchNode());
+        for (unsigned int i = 0; i < searchNodes.size(); i++)
+            searchNodes[i].stamp = 0;
+        searchStamp = 0;
+    }
+    searchStamp++;
+
+    OpenList open;
+    SearchNode& first = searchNodes[start];
+    first.cost = 0;
+    first.parent = -1;
+    first.stamp = searchStamp;
+    first.closed = false;
+    open.push(OpenEntry(estimate(start, goal), start));
+
+    int expansions = 0;
+    while (!open.empty())
+    {
+        int curr = open.top().second;
+        open.pop();
+
+        SearchNode& currSearch = searchNodes[curr];
+        if (currSearch.closed)
+            continue; // A stale entry, superseded by a cheaper one
+        currSearch.closed = true;
+
+        if (curr == goal || (targets && targets->find(curr) != targets->end()))
+        {
+            path.clear();
+            for (int node = curr; node >= 0; node = searchNodes[node].parent)
+                path.push_back(node);
+            std::reverse(path.begin(), path.end());
+            return curr;
+        }
+
+        if (++expansions > maxExpansions)
+            break;
+
+        NavNode& node = nodes[curr];
+        for (int i = node.firstEdge; i < node.firstEdge + node.numEdges; i++)
+        {
+            int next = edges[i];
+            float cost = currSearch.cost + node.position.dist(nodes[next].position);
+            SearchNode& nextSearch = searchNodes[next];
+            if (nextSearch.stamp != searchStamp)
+            {
+                nextSearch.stamp = searchStamp;
+                nextSearch.closed = false;
+            } else if (nextSearch.closed || cost >= nextSearch.cost)
+                continue;
+            nextSearch.cost = cost;
+            nextSearch.parent = curr;
+            open.push(OpenEntry(cost + estimate(next, goal), next));
+        }
+    }
+
+    return -1;
+}
+
+//! Finds the node for a position: the closest one in its column or those around it, not on a floor above it
+static int findNearestNode(const vec& position)
+{
+    int x = getColumnCoord(position.x), y = getColumnCoord(position.y);
+
+    int best = -1;
+    float bestDistance = 1e16f;
+    for (int ring = 0; ring <= 2 && best < 0; ring++) // Look further only if nothing was found closer
+        for (int dx = -ring; dx <= ring; dx++)
+            for (int dy = -ring; dy <= ring; dy++)
+            {
+                if (max(abs(dx), abs(dy)) != ring)
+                    continue;
+                int column = findColumn(x + dx, y + dy);
+                if (column < 0)
+                    continue;
+                for (int node = columnFirst[column]; node < columnFirst[column+1]; node++)
+                {
+                    const vec& nodePosition = nodes[node].position;
+                    if (nodePosition.z > position.z + navclimb)
+                        continue;
+                    float distance = nodePosition.dist(position);
+                    if (distance < bestDistance)
+                    {
+                        best = node;
+                        bestDistance = distance;
+                    }
+                }
+            }
+
+    return best;
+}
+
+
+// Path cache. Paths are kept by their goal and start nodes, most recently used first. Paths that were not
+// found are cached too (as empty), so NPCs that cannot reach a goal do not search for it over and over.
+
+struct CachedPath
+{
+    int goal, start;
+    std::vector<int> nodes;
+};
+
+typedef std::list<CachedPath> CachedPaths;
+typedef std::map<std::pair<int, int>, CachedPaths::iterator> PathIndex; //!< By goal, then start
+
+static CachedPaths cachedPaths;
+static PathIndex pathIndex;
+
+static void usedPath(PathIndex::iterator iter)
+{
+    cachedPaths.splice(cachedPaths.begin(), cachedPaths, iter->second);
+}
+
+static void cachePath(int start, int goal, const std::vector<int>& path)
+{
+    if (navcachesize <= 0)
+        return;
+
+    std::pair<int, int> key(goal, start);
+    PathIndex::iterator iter = pathIndex.find(key);
+    if (iter != pathIndex.end())
+    {
+        cachedPaths.erase(iter->second);
+        pathIndex.erase(iter);
+    }
+
+    CachedPath cached;
+    cached.goal = goal;
+    cached.start = start;
+    cached.nodes = path;
+    cachedPaths.push_front(cached);
+    pathIndex[key] = cachedPaths.begin();
+
+    while (int(cachedPaths.size()) > navcachesize)
+    {
+        CachedPath& last = cachedPaths.back();
+        pathIndex.erase(std::make_pair(last.goal, last.start));
+        cachedPaths.pop_back();
+    }
+}
+
+static bool findNodePath(int start, int goal, std::vector<int>& path)
+{
+    if (start == goal)
+    {
+        path.assign(1, start);
+        return true;
+    }
+
+    // An earlier query between the same nodes
+    PathIndex::iterator iter = pathIndex.find(std::make_pair(goal, start));
+    if (iter != pathIndex.end())
+    {
+        usedPath(iter);
+        path = iter->second->nodes;
+        return !path.empty();
+    }
+
+    // A path to the same goal that we are on, typically because we are following it
+    CachedPath *rejoin = NULL;
+    for (iter = pathIndex.lower_bound(std::make_pair(goal, INT_MIN)); iter != pathIndex.end() && iter->first.first == goal; iter++)
+    {
+        std::vector<int>& cachedNodes = iter->second->nodes;
+        if (cachedNodes.empty())
+            continue;
+        std::vector<int>::iterator found = std::find(cachedNodes.begin(), cachedNodes.end(), start);
+        if (found != cachedNodes.end())
+        {
+            path.assign(found, cachedNodes.end());
+            usedPath(iter);
+            return true;
+        }
+        if (!rejoin)
+            rejoin = &*iter->second;
+    }
+
+    // A path to the same goal that we are near, typically because we drifted off it: replan only the way back to it
+    if (rejoin && navrejoin > 0)
+    {
+        std::map<int, int> targets; // Nodes on the path, and their index in it
+        for (int i = rejoin->nodes.size() - 1; i >= 0; i--)
+            targets[rejoin->nodes[i]] = i;
+
+        int reached = searchGraph(start, -1, &targets, navrejoin, path);
+        if (reached >= 0)
+        {
+            path.insert(path.end(), rejoin->nodes.begin() + targets[reached] + 1, rejoin->nodes.end());
+            cachePath(start, goal, path);
+            return true;
+        }
+    }
+
+    // Nothing to reuse
+    if (searchGraph(start, goal, NULL, navmaxsearch, path) < 0)
+        path.clear();
+    cachePath(start, goal, path);
+    return !path.empty();
+}
+
+
+// NavigationSystem
+
+void NavigationSystem::clear()
+{
+    spacing = 0;
+    worldCrc = 0;
+    nodes.clear();
+    edges.clear();
+    columnKeys.clear();
+    columnFirst.clear();
+    searchNodes.clear();
+    cachedPaths.clear();
+    pathIndex.clear();
+}
+
+bool NavigationSystem::hasGraph()
+{
+    return !nodes.empty();
+}
+
+bool NavigationSystem::findPath(const vec& from, const vec& to, std::vector<vec>& path)
+{
+    if (!hasGraph())
+        return false;
+
+    PROFILE("findPath");
+
+    int start = findNearestNode(from), goal = findNearestNode(to);
+    if (start < 0 || goal < 0)
+        return false;
+
+    std::vector<int> nodePath;
+    if (!findNodePath(start, goal, nodePath))
+        return false;
+
+    path.clear();
+    for (unsigned int i = 0; i < nodePath.size(); i++)
+        path.push_back(nodes[nodePath[i]].position);
+    path.push_back(to);
+    return true;
+}
+
+
+// Cubescript accessibility
+
+void navgen()
+{
+    NavigationSystem::generate();
+}
+
+COMMAND(navgen, "");
+
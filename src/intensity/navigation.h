@@ -0,0 +1,32 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+//! Navigation for NPCs. A graph of walkable positions is generated offline from the octree world (the 'navgen'
+//! command, run when editing), and saved alongside the map (as mapname.nav), from where it is loaded with the map.
+//! Nodes are the floors of a grid of columns, navspacing apart; edges connect neighboring nodes that can be walked
+//! between. Only world geometry is considered, not entities.
+//!
+//! Path queries use A*, and their results are cached. When an NPC asks again for a path to the same goal, it
+//! typically gets the rest of a cached path; and if it drifted off that path, only a short search is done, to
+//! rejoin it. So NPCs can ask for paths often, and most queries are cheap lookups.
+
+struct NavigationSystem
+{
+    //! Generates the graph for the current world, and saves it
+    static bool generate();
+
+    //! Loads the graph for the current world, if one was saved and is up to date. Called when a map loads
+    static bool load();
+
+    static bool save();
+
+    static void clear();
+
+    static bool hasGraph();
+
+    //! Finds a path between two (feet) positions. The path consists of positions to walk through, ending in 'to'.
+    //! @return Whether a path was found
+    static bool findPath(const vec& from, const vec& to, std::vector<vec>& path);
+};
+
@@ -117,6 +117,19 @@ void showOtherClients()
 namespace PositionUpdater
 {
 
+int clockOverride = -1;
+
+void setClock(int time)
+{
+    clockOverride = time;
+}
+
+//! The clock for all position update decisions
+inline int getTime()
+{
+    return clockOverride != -1 ? clockOverride : Utility::SystemInfo::currTime();
+}
+
 int QuantizedInfo::getLifeSequence()
 {
     return (misc >> 3) & 1;
@@ -236,16 +249,16 @@ void QuantizedInfo::applyToEntity(fpsent *d)
     // Only possibly discard if we get a value for the lifesequence
     if(!d || (hasMisc && (getLifeSequence()!=(d->lifesequence&1))))
     {
-        Logging::log(Logging::WARNING, "Not applying position update for client %d, reasons: %lu,%d,%d (real:%d)\r\n",
+        LOG(WARNING, "Not applying position update for client %d, reasons: %lu,%d,%d (real:%d)\r\n",
                      clientNumber, (unsigned long)d, getLifeSequence(), d ? d->lifesequence&1 : -1, d ? d->lifesequence : -1);
         return;
     } else
-        Logging::log(Logging::INFO, "Applying position update for client %d\r\n", clientNumber);
+        LOG(INFO, "Applying position update for client %d\r\n", clientNumber);
 
     #ifdef SERVER
     if(d->serverControlled) // Server does not need to update positions of its own NPCs. TODO: Don't even send to here.
     {
-        Logging::log(Logging::INFO, "Not applying position update for server NPC: (uid: %d , addr %d):\r\n", d->uniqueId, d != NULL);
+        LOG(INFO, "Not applying position update for server NPC: (uid: %d , addr %d):\r\n", d->uniqueId, d != NULL);
         return;
     }
     #endif
@@ -335,6 +348,11 @@ void QuantizedInfo::applyToBuffer(ucharbuf& q)
 {
     putint(q, SV_POS);// printf("(PUT SV_POS): %d\r\n", SV_POS);
 
+    applyFieldsToBuffer(q);
+}
+
+void QuantizedInfo::applyFieldsToBuffer(ucharbuf& q)
+{
     putint(q, clientNumber);// printf("START PUT: %d\r\n", clientNumber);
 
     unsigned char indicator = 0; // Indicates which fields are in fact present (the has[X] stuff)
@@ -397,6 +415,14 @@ void QuantizedInfo::applyToBuffer(ucharbuf& q)
 ///////////////////////printf("***Generated size: %d\r\n", q.length());
 }
 
+void QuantizedInfo::applyToBuffer(vector<uchar>& q)
+{
+    ucharbuf buf = q.reserve(MAX_BUFFER_SIZE);
+    applyToBuffer(buf);
+    assert(!buf.overwrote());
+    q.addbuf(buf);
+}
+
 
 //======================================
 // Bandwidth optimization system for
@@ -465,6 +491,8 @@ bool positionDatumDecider(bool sameValue, int sinceSend, int receiveLatencyRaw,
 }
 
 
+static Utility::Config::Int rate("Network", "rate", 33);
+
 //! Client-specific data about position updates. Used to optimize the protocol.
 class ClientDatum
 {
@@ -484,7 +512,7 @@ private:
 
     void updateReceiveStats()
     {
-        int currTime = Utility::SystemInfo::currTime();
+        int currTime = getTime();
         if (lastReceived != -1)
         {
             int currLatency = currTime - lastReceived;
@@ -492,7 +520,7 @@ private:
             if (receiveLatency == -1)
             {
                 // Our initial guess is the normal latency and 0 variance
-                receiveLatency = Utility::Config::getInt("Network", "rate", 33);
+                receiveLatency = rate.get();
                 receiveLatencyVariance = 0;
             }
 
@@ -511,7 +539,7 @@ private:
         if (receiveLatency != -1)
             return int( receiveLatency + (standardDevs*sqrtf(receiveLatencyVariance)) );
         else
-            return Utility::Config::getInt("Network", "rate", 33);; // Meaningless
+            return rate.get(); // Meaningless
     }
 
     #define DATUMINFO(name, type)                    \
@@ -540,7 +568,7 @@ private:
     //      If send, remember this last value and time
     #define PROCESSDATUM(name, indicator)                                 \
         {                                                                 \
-            int currTime = Utility::SystemInfo::currTime();               \
+            int currTime = getTime();                                     \
             if (!indicator) return;                                       \
             bool sameValue = (info.name == last##name.value);             \
             indicator = positionDatumDecider(                             \
@@ -601,12 +629,487 @@ public:
 
 std::map<int, ClientDatum> clientData;
 
+static FILE *recording = NULL;
+
+static void closeRecording()
+{
+    if (recording) fclose(recording);
+    recording = NULL;
+}
+
+void recordPositionReception(QuantizedInfo& info)
+{
+    static bool checked = false;
+    if (!checked)
+    {
+        checked = true;
+        std::string filename = Utility::Config::getString("Network", "position_recording", "");
+        if (filename != "")
+        {
+            recording = fopen(filename.c_str(), "wb");
+            if (recording)
+                atexit(closeRecording); // Flushes what is still buffered, so the recording ends on a whole update
+            else
+                LOG(ERROR, "Cannot open position recording file %s\r\n", filename.c_str());
+        }
+    }
+    if (!recording) return;
+
+    static vector<uchar> update;
+    update.setsizenodelete(0);
+    info.applyToBuffer(update);
+
+    uchar header[10];
+    ucharbuf q(header, sizeof(header));
+    putint(q, getTime());
+    putuint(q, update.length());
+
+    fwrite(header, 1, q.length(), recording);
+    fwrite(update.getbuf(), 1, update.length(), recording);
+}
+
 void processServerPositionReception(QuantizedInfo& info)
 {
+    recordPositionReception(info);
+
+    InterestManager::updateSource(info);
+
     ClientDatum& data = clientData[info.clientNumber];
     data.process(info);
 }
 
+
+//======================================
+// Delta compression of relayed
+// position updates
+//======================================
+
+namespace DeltaCompression
+{
+
+bool enabled()
+{
+    static Utility::Config::Int deltaCompression("Network", "delta_compression", 1);
+    return deltaCompression.get() != 0;
+}
+
+//! Expands a macro for each field, in a fixed order, to indicate, put, get or apply the deltas
+#define DELTA_FIELDS(IVEC_FIELD, BYTE_FIELD, UINT_FIELD) \
+    IVEC_FIELD(position, 1)                             \
+    BYTE_FIELD(yaw, 2)                                  \
+    BYTE_FIELD(pitch, 4)                                \
+    BYTE_FIELD(roll, 8)                                 \
+    IVEC_FIELD(velocity, 16)                            \
+    IVEC_FIELD(falling, 32)                             \
+    BYTE_FIELD(misc, 64)                                \
+    UINT_FIELD(mapDefinedPositionData, 128)
+
+#define INDICATE(name, bit) \
+    if (state.name != baseline.state.name) indicator |= bit;
+
+#define PUT_IVEC_DELTA(name, bit)                                     \
+    if (indicator & bit)                                              \
+    {                                                                 \
+        putint(q, state.name.x - baseline.state.name.x);              \
+        putint(q, state.name.y - baseline.state.name.y);              \
+        putint(q, state.name.z - baseline.state.name.z);              \
+    }
+
+#define PUT_BYTE(name, bit) \
+    if (indicator & bit) q.put(state.name);
+
+#define PUT_UINT(name, bit) \
+    if (indicator & bit) putuint(q, state.name);
+
+void encode(QuantizedInfo& state, Baseline& baseline, int keyframeInterval, vector<uchar>& out)
+{
+    int currTime = getTime();
+
+    bool keyframe = (baseline.sequence == -1 || currTime - baseline.lastKeyframe >= keyframeInterval);
+
+    unsigned char indicator = 0;
+    if (!keyframe)
+    {
+        DELTA_FIELDS(INDICATE, INDICATE, INDICATE);
+        if (!indicator) return; // Nothing new to tell
+    }
+
+    int sequence = (baseline.sequence + 1) & 0xFF;
+
+    ucharbuf q = out.reserve(MAX_BUFFER_SIZE);
+    if (keyframe)
+    {
+        putint(q, SV_POSKEYFRAME);
+        q.put(sequence);
+        state.applyFieldsToBuffer(q);
+        baseline.lastKeyframe = currTime;
+    } else {
+        putint(q, SV_POSDELTA);
+        q.put(sequence);
+        putint(q, state.clientNumber);
+        q.put(indicator);
+        DELTA_FIELDS(PUT_IVEC_DELTA, PUT_BYTE, PUT_UINT);
+    }
+    assert(!q.overwrote());
+    out.addbuf(q);
+
+    baseline.state = state;
+    baseline.sequence = sequence;
+}
+
+//! The client's baselines, per client number
+std::map<int, Baseline> baselines;
+
+#define GET_IVEC_DELTA(name, bit)              \
+    ivec name##Delta(0, 0, 0);                 \
+    if (indicator & bit)                       \
+    {                                          \
+        name##Delta.x = getint(p);             \
+        name##Delta.y = getint(p);             \
+        name##Delta.z = getint(p);             \
+    }
+
+#define GET_BYTE(name, bit) \
+    unsigned char name = (indicator & bit) ? p.get() : 0;
+
+#define GET_UINT(name, bit) \
+    unsigned int name = (indicator & bit) ? getuint(p) : 0;
+
+#define APPLY_IVEC_DELTA(name, bit) \
+    state.name.add(name##Delta);
+
+#define APPLY_VALUE(name, bit) \
+    if (indicator & bit) state.name = name;
+
+bool decode(int type, ucharbuf& p, QuantizedInfo& info)
+{
+    int sequence = p.get();
+
+    if (type == SV_POSKEYFRAME)
+    {
+        info.generateFrom(p);
+
+        Baseline& baseline = baselines[info.clientNumber];
+        baseline.state = info;
+        baseline.sequence = sequence;
+        return true;
+    }
+
+    assert(type == SV_POSDELTA);
+
+    // Read everything first, as we must consume the message even if we cannot use it
+    int clientNumber = info.clientNumber = getint(p);
+    unsigned char indicator = p.get();
+    DELTA_FIELDS(GET_IVEC_DELTA, GET_BYTE, GET_UINT);
+
+    std::map<int, Baseline>::iterator iter = baselines.find(clientNumber);
+    if (iter == baselines.end()) return false;
+    Baseline& baseline = iter->second;
+    if (baseline.sequence == -1 || baseline.sequence != ((sequence - 1) & 0xFF))
+    {
+        // We missed a message, so our baseline is useless until the next keyframe
+        baseline.sequence = -1;
+        return false;
+    }
+
+    QuantizedInfo& state = baseline.state;
+    DELTA_FIELDS(APPLY_IVEC_DELTA, APPLY_VALUE, APPLY_VALUE);
+    baseline.sequence = sequence;
+
+    info = state;
+    info.hasPosition = info.hasYaw = info.hasPitch = info.hasRoll = info.hasVelocity = info.hasMisc =
+        info.hasMapDefinedPositionData = true;
+    info.hasFalling = (info.falling.x || info.falling.y || info.falling.z); // As in generateFrom(entity)
+    return true;
+}
+
+}
+
+
+//======================================
+// Interest management for relaying
+// position updates
+//======================================
+
+namespace InterestManager
+{
+
+//! Settings, read from the config once per round
+struct Settings
+{
+    int cellSize, nearRadius, farRadius, midInterval, farInterval;
+    bool deltaCompression;
+    int keyframeInterval;
+
+    void load()
+    {
+        deltaCompression = DeltaCompression::enabled();
+        keyframeInterval = Utility::Config::getInt("Network", "delta_keyframe_interval", 500);
+        cellSize    = max(Utility::Config::getInt("Network", "interest_cell_size", 256), 16);
+        nearRadius  = Utility::Config::getInt("Network", "interest_near_radius", 256);
+        farRadius   = max(Utility::Config::getInt("Network", "interest_far_radius", 1024), nearRadius);
+        midInterval = Utility::Config::getInt("Network", "interest_mid_interval", 100);
+        farInterval = Utility::Config::getInt("Network", "interest_far_interval", 1000);
+    }
+} settings;
+
+//! What we know about a client as a source of position updates
+struct SourceDatum
+{
+    //! The latest full state of this client, merged from all its updates
+    QuantizedInfo state;
+    //! Whether we have received a position from this client yet
+    bool hasPosition;
+    //! Unquantized position, for distance checks
+    vec position;
+
+    //! The update pending for relaying this round, if hasUpdate
+    bool hasUpdate;
+    vector<uchar> update;
+
+    //! The state, encoded as a full SV_POS. Generated lazily, at most once per round
+    vector<uchar> snapshot;
+    int snapshotRound;
+
+    //! The rounds of this source's current and previous updates
+    int updateRound, prevUpdateRound;
+
+    SourceDatum() : hasPosition(false), hasUpdate(false), snapshotRound(-1), updateRound(-1), prevUpdateRound(-1) { };
+
+    void merge(QuantizedInfo& info)
+    {
+        state.clientNumber = info.clientNumber;
+        if (info.hasPosition)
+        {
+            state.position = info.position;
+            position = vec(info.position.x/DMF, info.position.y/DMF, info.position.z/DMF);
+            hasPosition = true;
+        }
+        if (info.hasYaw) state.yaw = info.yaw;
+        if (info.hasPitch) state.pitch = info.pitch;
+        if (info.hasRoll) state.roll = info.roll;
+        if (info.hasVelocity) state.velocity = info.velocity;
+        state.falling = info.falling; // Not present means 0, so always take it
+        state.hasFalling = (state.falling.x || state.falling.y || state.falling.z);
+        if (info.hasMisc) state.misc = info.misc;
+        if (info.hasMapDefinedPositionData) state.mapDefinedPositionData = info.mapDefinedPositionData;
+    }
+};
+
+//! What a recipient has been sent about a single source
+struct PairDatum
+{
+    int lastSnapshot;
+    //! Whether the source was in the near tier the last time we considered it. When a
+    //! source enters the near tier we send a snapshot, since the partial updates
+    //! of the near tier assume the recipient is up to date.
+    bool wasNear;
+
+    //! What the recipient knows about the source, for delta compression
+    DeltaCompression::Baseline baseline;
+
+    //! The last round in which we considered the source for this recipient
+    int lastRound;
+
+    PairDatum() : lastSnapshot(-1), wasNear(false), lastRound(-1) { };
+};
+
+struct RecipientDatum
+{
+    int lastFullRound;
+    std::map<int, PairDatum> pairs;
+
+    RecipientDatum() : lastFullRound(getTime()) { };
+};
+
+typedef std::map<int, SourceDatum> SourceData;
+SourceData sourceData;
+
+typedef std::map<int, RecipientDatum> RecipientData;
+RecipientData recipientData;
+
+//! Client numbers of the sources with updates this round
+vector<int> roundSources;
+
+//! The spatial grid of this round's sources, over X and Y
+typedef std::map<int, vector<int> > Grid;
+Grid grid;
+
+int currRound = 0;
+
+inline int getCellKey(int cellX, int cellY)
+    { return (cellX & 0xFFFF) | ((cellY & 0xFFFF) << 16); };
+
+inline int getCell(float coord)
+    { return int(floor(coord / settings.cellSize)); };
+
+vector<uchar>& getSnapshot(SourceDatum& source)
+{
+    if (source.snapshotRound != currRound)
+    {
+        source.snapshot.setsizenodelete(0);
+        source.state.applyToBuffer(source.snapshot);
+        source.snapshotRound = currRound;
+    }
+    return source.snapshot;
+}
+
+inline void append(vector<uchar>& out, vector<uchar>& data)
+{
+    out.put(data.getbuf(), data.length());
+}
+
+bool enabled()
+{
+    static Utility::Config::Int interestManagement("Network", "interest_management", 1);
+    return interestManagement.get() != 0;
+}
+
+void updateSource(QuantizedInfo& info)
+{
+    sourceData[info.clientNumber].merge(info);
+}
+
+void clientDisconnected(int clientNumber)
+{
+    sourceData.erase(clientNumber);
+    recipientData.erase(clientNumber);
+    for (RecipientData::iterator iter = recipientData.begin(); iter != recipientData.end(); iter++)
+        iter->second.pairs.erase(clientNumber);
+}
+
+void startRound()
+{
+    settings.load();
+    currRound++;
+
+    loopv(roundSources)
+    {
+        SourceData::iterator iter = sourceData.find(roundSources[i]);
+        if (iter != sourceData.end())
+            iter->second.hasUpdate = false;
+    }
+    roundSources.setsizenodelete(0);
+    grid.clear();
+}
+
+void addSource(int clientNumber, vector<uchar>& update)
+{
+    SourceDatum& source = sourceData[clientNumber];
+    source.hasUpdate = true;
+    source.prevUpdateRound = source.updateRound;
+    source.updateRound = currRound;
+    source.update.setsizenodelete(0);
+    append(source.update, update);
+    roundSources.add(clientNumber);
+
+    if (source.hasPosition)
+        grid[getCellKey(getCell(source.position.x), getCell(source.position.y))].add(clientNumber);
+}
+
+//! Sends a recipient a source's update. A full update is a complete snapshot (sent to
+//! all but the near tier); otherwise the update as received. With delta compression,
+//! both are just the difference from what the recipient already knows.
+void send(PairDatum& pair, SourceDatum& source, bool full, vector<uchar>& out)
+{
+    if (settings.deltaCompression)
+        DeltaCompression::encode(source.state, pair.baseline, settings.keyframeInterval, out);
+    else
+        append(out, full ? getSnapshot(source) : source.update);
+}
+
+//! Decides what, if anything, to send a recipient about a source, and appends it
+void considerSource(RecipientDatum& recipient, const vec& center, int clientNumber, bool fullRound, int currTime,
+                    vector<uchar>& out)
+{
+    SourceData::iterator iter = sourceData.find(clientNumber);
+    if (iter == sourceData.end()) return;
+    SourceDatum& source = iter->second;
+    if (!source.hasUpdate) return; // Nothing from this source this round
+
+    PairDatum& pair = recipient.pairs[clientNumber];
+
+    // If we skipped the source's previous update for this recipient (it was outside the
+    // scanned cells, or the recipient had no position), the recipient may have missed
+    // partial updates or deltas, so start over as if it knows nothing
+    if (pair.lastRound != source.prevUpdateRound)
+    {
+        pair.wasNear = false;
+        pair.baseline = DeltaCompression::Baseline();
+    }
+    pair.lastRound = currRound;
+
+    float distance = source.hasPosition ? center.dist(source.position) : 0;
+    if (distance <= settings.nearRadius)
+    {
+        send(pair, source, !pair.wasNear, out);
+        pair.wasNear = true;
+        return;
+    }
+
+    pair.wasNear = false;
+
+    bool due = fullRound ||
+               (distance <= settings.farRadius && currTime - pair.lastSnapshot >= settings.midInterval);
+    if (due)
+    {
+        send(pair, source, true, out);
+        pair.lastSnapshot = currTime;
+    }
+}
+
+void appendRelevantPositions(int recipient, vector<uchar>& out)
+{
+    SourceData::iterator self = sourceData.find(recipient);
+    if (self == sourceData.end() || !self->second.hasPosition)
+    {
+        // We don't know where this recipient is, so everything might be relevant
+        loopv(roundSources)
+        {
+            if (roundSources[i] == recipient) continue;
+            append(out, sourceData[roundSources[i]].update);
+        }
+        return;
+    }
+
+    const vec center = self->second.position;
+    RecipientDatum& recipientDatum = recipientData[recipient];
+    int currTime = getTime();
+
+    bool fullRound = settings.farInterval > 0 && currTime - recipientDatum.lastFullRound >= settings.farInterval;
+    if (fullRound)
+        recipientDatum.lastFullRound = currTime;
+
+    // Only the grid cells within the far radius can contain relevant sources. Sources that
+    // have not sent a position yet are not in the grid, and wait for a full round. If there
+    // are more cells to look at than sources, just go over the sources.
+    int minX = getCell(center.x - settings.farRadius), maxX = getCell(center.x + settings.farRadius);
+    int minY = getCell(center.y - settings.farRadius), maxY = getCell(center.y + settings.farRadius);
+    if (fullRound || (maxX - minX + 1)*(maxY - minY + 1) > roundSources.length())
+    {
+        loopv(roundSources)
+        {
+            if (roundSources[i] == recipient) continue;
+            considerSource(recipientDatum, center, roundSources[i], fullRound, currTime, out);
+        }
+    } else {
+        for (int cellX = minX; cellX <= maxX; cellX++)
+            for (int cellY = minY; cellY <= maxY; cellY++)
+            {
+                Grid::iterator cell = grid.find(getCellKey(cellX, cellY));
+                if (cell == grid.end()) continue;
+                vector<int>& sources = cell->second;
+                loopv(sources)
+                {
+                    if (sources[i] == recipient) continue;
+                    considerSource(recipientDatum, center, sources[i], false, currTime, out);
+                }
+            }
+    }
+}
+
+}
+
 }
 
 }
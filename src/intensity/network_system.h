@@ -96,6 +96,20 @@ namespace NetworkSystem
             //! fields in quantized form. Applies compression of bitfields, packing, unsent
             //! fields, etc., i.e., the opposite of generateFrom(buffer).
             void applyToBuffer(ucharbuf& q);
+
+            //! Like applyToBuffer, but without the leading SV_POS message code. This is the
+            //! part generateFrom(buffer) reads, and is reused by other messages.
+            void applyFieldsToBuffer(ucharbuf& q);
+
+            //! Applies the fields to the end of a vector, writing directly into its
+            //! reserved storage. Once the vector has grown to fit, this does no allocation,
+            //! so it is the one to use on hot paths like relaying on the server.
+            void applyToBuffer(vector<uchar>& q);
+
+            //! The largest size applyToBuffer can write: SV_POS, clientNumber and 6 velocity/falling
+            //! ints (5 bytes each), 4 uints (4 bytes each), and 5 bytes for the indicator, yaw,
+            //! pitch, roll and misc.
+            enum { MAX_BUFFER_SIZE = 8*5 + 4*4 + 5 };
         };
 
         //! Process a position updated which is received by the server, in preparation for
@@ -106,5 +120,92 @@ namespace NetworkSystem
         //!     - The server reduces the size of those updates, and their frequency,
         //!       in order to save bandwidth
         void processServerPositionReception(QuantizedInfo& info);
+
+        //! Records a position update received by the server, before any processing, if
+        //! Network/position_recording is set to a filename. Records are the time (int), the
+        //! length (uint), and the update as an SV_POS. Useful to replay a session through
+        //! the encoders offline, see network_system__unittest.
+        void recordPositionReception(QuantizedInfo& info);
+
+        //! Sets the clock used by all position update decisions (for replaying recordings).
+        //! -1 returns to using the system clock.
+        void setClock(int time);
+
+        //! Delta compression of relayed position updates. Instead of absolute values, the
+        //! server sends each recipient the difference from the last state it sent that
+        //! recipient about that client (small differences fit in a byte). As channel 0 is
+        //! unreliable, every message carries a sequence number, and a delta is only applied
+        //! on top of the message right before it; after a loss, the recipient waits for the
+        //! next keyframe (a full absolute state), sent every Network/delta_keyframe_interval ms.
+        //!
+        //! Wire formats:
+        //!     SV_POSKEYFRAME, sequence (byte), [the SV_POS fields, all present]
+        //!     SV_POSDELTA, sequence (byte), clientNumber, indicator, [deltas of the indicated fields]
+        namespace DeltaCompression
+        {
+            //! Whether delta compression is active (Network/delta_compression). Applies to
+            //! recipients handled by the InterestManager.
+            bool enabled();
+
+            //! What one side knows the other has, about a single client
+            struct Baseline
+            {
+                QuantizedInfo state;
+                int sequence; //!< -1 if there is no baseline yet
+                int lastKeyframe;
+
+                Baseline() : sequence(-1), lastKeyframe(-1) { };
+            };
+
+            //! The largest size encode() can write: the message code, clientNumber and 9
+            //! deltas (5 bytes each), mapDefinedPositionData (4 bytes), and 6 single bytes.
+            enum { MAX_BUFFER_SIZE = 11*5 + 4 + 6 };
+
+            //! Server: appends a full state to a buffer, as a keyframe or as a delta against the baseline,
+            //! which is then updated. Nothing is written if nothing changed and no keyframe is due.
+            //! @param state The full current state of the client, all fields present.
+            void encode(QuantizedInfo& state, Baseline& baseline, int keyframeInterval, vector<uchar>& out);
+
+            //! Client: reads an SV_POSKEYFRAME or SV_POSDELTA, whose code has already been read,
+            //! into a full state.
+            //! @return Whether the message could be applied. If not (we missed the previous
+            //!         message), info must be ignored.
+            bool decode(int type, ucharbuf& p, QuantizedInfo& info);
+        }
+
+        //! Interest management for relaying position updates. Instead of sending every
+        //! client's position update to every other client, each recipient gets only the
+        //! updates that are relevant to it, based on distance:
+        //!     - Near (within Network/interest_near_radius): every update, as received
+        //!     - Mid (within Network/interest_far_radius): a full snapshot of the client's
+        //!       state, at most every Network/interest_mid_interval ms
+        //!     - Far: a full snapshot every Network/interest_far_interval ms (0 disables)
+        //! Relevance is found using a uniform grid (cells of Network/interest_cell_size)
+        //! over the last known positions of the clients. Recipients whose position we
+        //! do not know (like the server's singleton dummy client) get everything.
+        //! Set Network/interest_management to 0 to relay all-to-all as before. If delta
+        //! compression is enabled, whatever is sent to a recipient is delta compressed.
+        namespace InterestManager
+        {
+            //! Whether interest management is active
+            bool enabled();
+
+            //! Remembers the full state of a client, merged from the (possibly partial)
+            //! position updates it sends us. Called for each SV_POS the server receives.
+            void updateSource(QuantizedInfo& info);
+
+            //! Forget all about a client, both as a source and as a recipient
+            void clientDisconnected(int clientNumber);
+
+            //! Starts a round of relaying. Call once per worldstate, before addSource().
+            void startRound();
+
+            //! Registers (copies) the position update a client has pending for relaying this round.
+            void addSource(int clientNumber, vector<uchar>& update);
+
+            //! Appends the position updates relevant to a recipient, for this round, to a buffer.
+            //! A recipient never receives its own position updates.
+            void appendRelevantPositions(int recipient, vector<uchar>& out);
+        }
     }
 }
@@ -7,6 +7,7 @@
 #include "game.h"
 
 #include "network_system.h"
+#include "utility.h"
 
 
 void compareEntities(std::string title, fpsent& d, fpsent& d2)
@@ -153,7 +154,167 @@ void testPositionUpdater()
     }
 }
 
-int main()
+void testDeltaCompression()
+{
+    using namespace NetworkSystem::PositionUpdater;
+
+    fpsent d;
+    d.clientnum = 3;
+    d.o = vec(512, 512, 512);
+
+    DeltaCompression::Baseline serverBaseline;
+    vector<uchar> data;
+
+    for (int i = 0; i < 2000; i++)
+    {
+        // Walk around, with the occasional jump
+        d.o.add(vec(float(rnd(64) - 32)/16.0f, float(rnd(64) - 32)/16.0f, rnd(50) ? 0 : 10));
+        d.yaw = rnd(360);
+        d.vel = vec(rnd(200) - 100, rnd(200) - 100, 0);
+        d.move = rnd(3) - 1;
+
+        NetworkSystem::PositionUpdater::QuantizedInfo info;
+        info.generateFrom(&d);
+
+        // A keyframe at the start and every 100, deltas otherwise
+        setClock(i*33);
+        data.setsizenodelete(0);
+        DeltaCompression::encode(info, serverBaseline, 3300, data);
+        if (!data.length()) continue; // Nothing changed
+
+        bool lost = (i % 100 == 50); // Drop one message now and then
+        if (lost) continue;
+
+        ucharbuf q(data.getbuf(), data.length());
+        int type = getint(q);
+        NetworkSystem::PositionUpdater::QuantizedInfo info2;
+        bool applied = DeltaCompression::decode(type, q, info2);
+
+        if (i % 100 > 50)
+        {
+            // After a loss, nothing applies until the next keyframe
+            if (applied)
+            {
+                printf("Delta applied without a baseline: %d\r\n", i);
+                exit(0);
+            }
+            continue;
+        }
+
+        if (!applied || info2.position != info.position || info2.velocity != info.velocity || info2.yaw != info.yaw ||
+            info2.misc != info.misc)
+        {
+            printf("Delta compression failure: %d\r\n", i);
+            exit(0);
+        }
+    }
+    setClock(-1);
+}
+
+//! Micro-benchmark of the server's SV_POS re-encoding: the old way, with a temporary heap
+//! buffer that is then copied byte by byte, against encoding in place into a reused vector.
+void benchmarkPositionEncoding()
+{
+    const int iterations = 1000000;
+
+    fpsent d;
+    d.clientnum = 7;
+    d.o = vec(512.25f, 1024.5f, 520.125f);
+    d.yaw = 45;
+    d.vel = vec(20, -10, 0);
+    d.move = 1;
+
+    NetworkSystem::PositionUpdater::QuantizedInfo info;
+    info.generateFrom(&d);
+
+    vector<uchar> position;
+
+    int start = Utility::SystemInfo::currTime();
+    loopi(iterations)
+    {
+        int maxLength = 200;
+        unsigned char* data = new unsigned char[maxLength];
+        ucharbuf temp(data, maxLength);
+        info.applyToBuffer(temp);
+        position.setsizenodelete(0);
+        loopk(temp.length()) position.add(temp.buf[k]);
+        delete[] data;
+    }
+    int tempBufferTime = max(Utility::SystemInfo::currTime() - start, 1);
+
+    start = Utility::SystemInfo::currTime();
+    loopi(iterations)
+    {
+        position.setsizenodelete(0);
+        info.applyToBuffer(position);
+    }
+    int inPlaceTime = max(Utility::SystemInfo::currTime() - start, 1);
+
+    printf("   Temporary buffer: %.0f positions/sec\r\n", 1000.0f*iterations/tempBufferTime);
+    printf("   In place:         %.0f positions/sec\r\n", 1000.0f*iterations/inPlaceTime);
+}
+
+//! Bandwidth comparison: replays a recording (see recordPositionReception) through both
+//! encoders, as relayed to a single recipient that receives everything. The absolute
+//! encoder is preceded by the server's usual send/skip decisions.
+void comparePositionEncoders(const char *filename)
+{
+    using namespace NetworkSystem::PositionUpdater;
+
+    FILE *file = fopen(filename, "rb");
+    if (!file)
+    {
+        printf("Cannot open %s\r\n", filename);
+        exit(0);
+    }
+    vector<uchar> data;
+    uchar chunk[4096];
+    int read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) data.put(chunk, read);
+    fclose(file);
+
+    int keyframeInterval = Utility::Config::getInt("Network", "delta_keyframe_interval", 500);
+    std::map<int, DeltaCompression::Baseline> baselines;
+    vector<uchar> absolute, delta;
+    int updates = 0, absoluteBytes = 0, deltaBytes = 0, firstTime = -1, lastTime = 0;
+
+    ucharbuf p(data.getbuf(), data.length());
+    while (p.remaining() > 0)
+    {
+        int time = getint(p);
+        int length = getuint(p);
+        ucharbuf record = p.subbuf(length);
+        if (p.overread() || getint(record) != SV_POS) break;
+
+        QuantizedInfo info;
+        info.generateFrom(record);
+        setClock(time);
+
+        if (firstTime == -1) firstTime = time;
+        lastTime = time;
+        updates++;
+
+        QuantizedInfo relayed = info;
+        processServerPositionReception(relayed);
+        absolute.setsizenodelete(0);
+        relayed.applyToBuffer(absolute);
+        absoluteBytes += absolute.length();
+
+        // The delta encoder needs the full state; recorded updates are from clients, which send everything
+        delta.setsizenodelete(0);
+        DeltaCompression::encode(info, baselines[info.clientNumber], keyframeInterval, delta);
+        deltaBytes += delta.length();
+    }
+    setClock(-1);
+
+    float seconds = max(lastTime - firstTime, 1)/1000.0f;
+    printf("   %d updates over %.1f seconds\r\n", updates, seconds);
+    printf("   Absolute: %8d bytes, %.2f KB/sec\r\n", absoluteBytes, absoluteBytes/seconds/1024);
+    printf("   Delta:    %8d bytes, %.2f KB/sec (%.1f%% of absolute)\r\n", deltaBytes, deltaBytes/seconds/1024,
+           100.0f*deltaBytes/max(absoluteBytes, 1));
+}
+
+int main(int argc, char **argv)
 {
     // TODO: Test with missing values
 
@@ -163,14 +324,29 @@ int main()
 
     printf("You should now see an INFO message shown for testing purposes\r\n");
 
-    Logging::log(Logging::INFO, "Testing showing of an INFO message\r\n");
+    LOG(INFO, "Testing showing of an INFO message\r\n");
 
     initserver(false, true);
 
+    if (argc > 1)
+    {
+        printf("Comparing position encoders on recording %s\r\n", argv[1]);
+        comparePositionEncoders(argv[1]);
+        return 1;
+    }
+
     printf("Running PositionUpdater tests\r\n");
 
     testPositionUpdater();
 
+    printf("Running DeltaCompression tests\r\n");
+
+    testDeltaCompression();
+
+    printf("Running PositionUpdater encoding benchmark\r\n");
+
+    benchmarkPositionEncoding();
+
     printf("All tests completed successfully\r\n");
     return 1;
 };
@@ -17,7 +17,7 @@ struct particle_model : animmodel
     {
         // In the future, allow all sorts of particles, with parameters, multiple locations (say, all along the sword)
         // for now, just some sparklies
-        Logging::log(Logging::DEBUG, "Trying to load sparkly %s\r\n", loadname);
+        LOG(DEBUG, "Trying to load sparkly %s\r\n", loadname);
 
         parts.add(new part);
         parts[0]->model = this;
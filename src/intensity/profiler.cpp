@@ -0,0 +1,425 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+#include "cube.h"
+#include "engine.h"
+
+#include "utility.h"
+
+#include <map>
+#include <algorithm>
+
+#ifdef WIN32
+    #define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+    #define PROFILER_THREAD_LOCAL __thread
+    #ifdef __APPLE__
+        #include <mach/mach_time.h>
+    #else
+        #include <time.h>
+    #endif
+#endif
+
+
+namespace Profiler
+{
+
+bool enabled = false;
+
+Nanoseconds now()
+{
+#ifdef WIN32
+    static LARGE_INTEGER frequency;
+    if (!frequency.QuadPart)
+        QueryPerformanceFrequency(&frequency);
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return Nanoseconds(counter.QuadPart / frequency.QuadPart) * 1000000000ULL +
+           Nanoseconds(counter.QuadPart % frequency.QuadPart) * 1000000000ULL / frequency.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase;
+    if (!timebase.denom)
+        mach_timebase_info(&timebase);
+    return mach_absolute_time() * timebase.numer / timebase.denom;
+#else
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return Nanoseconds(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+
+// Statistics. Durations are also counted in a histogram, to estimate percentiles: a value falls in
+// bucket SUB_BUCKETS*floor(log2(value)) + (the next bits after the highest), i.e., buckets are about
+// 1/SUB_BUCKETS of a power of 2 wide.
+
+enum { SUB_BITS = 2, SUB_BUCKETS = 1 << SUB_BITS, HISTOGRAM_SIZE = 64*SUB_BUCKETS };
+
+int bucketOf(Nanoseconds value)
+{
+    if (value < SUB_BUCKETS)
+        return int(value);
+    int log2 = 63;
+    while (!(value & (1ULL << log2)))
+        log2--;
+    int sub = int(value >> (log2 - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return log2*SUB_BUCKETS + sub;
+}
+
+//! The upper end of a bucket
+Nanoseconds bucketTop(int bucket)
+{
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    int log2 = bucket / SUB_BUCKETS, sub = bucket % SUB_BUCKETS;
+    return (Nanoseconds(SUB_BUCKETS + sub + 1) << (log2 - SUB_BITS)) - 1;
+}
+
+struct ZoneStats
+{
+    const char *name;
+    int depth; //!< Where it was first seen, for indenting the report
+    unsigned int count;
+    Nanoseconds total, min, max;
+    unsigned int histogram[HISTOGRAM_SIZE];
+
+    ZoneStats(const char *_name, int _depth) : name(_name), depth(_depth) { reset(); };
+
+    void reset()
+    {
+        count = 0;
+        total = max = 0;
+        min = ~Nanoseconds(0);
+        memset(histogram, 0, sizeof(histogram));
+    }
+
+    void add(Nanoseconds duration)
+    {
+        count++;
+        total += duration;
+        min = std::min(min, duration);
+        max = std::max(max, duration);
+        histogram[bucketOf(duration)]++;
+    }
+
+    void merge(const ZoneStats& other)
+    {
+        count += other.count;
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        for (int i = 0; i < HISTOGRAM_SIZE; i++)
+            histogram[i] += other.histogram[i];
+    }
+
+    Nanoseconds percentile(float fraction)
+    {
+        unsigned int wanted = (unsigned int)(ceilf(count*fraction)), seen = 0;
+        for (int i = 0; i < HISTOGRAM_SIZE; i++)
+        {
+            seen += histogram[i];
+            if (seen >= wanted)
+                return std::min(bucketTop(i), max);
+        }
+        return max;
+    }
+};
+
+typedef std::map<const char*, ZoneStats*> ZoneStatsMap;
+
+
+// Per-thread data. Each thread writes only to its own; the lock is taken by that thread when it
+// closes a zone, and by report() and dumpTrace() when they read it.
+
+enum { MAX_DEPTH = 64, TRACE_SIZE = 1 << 16 };
+
+struct Event
+{
+    const char *name;
+    Nanoseconds start, end;
+};
+
+struct ThreadData
+{
+    int id;
+    SDL_mutex *lock;
+
+    struct { const char *name; Nanoseconds start; } open[MAX_DEPTH];
+    int depth;
+
+    Event *trace; //!< A ring buffer of the last TRACE_SIZE closed zones
+    int traceNext;
+    bool traceWrapped;
+
+    ZoneStatsMap stats;
+
+    ThreadData(int _id) : id(_id), depth(0), traceNext(0), traceWrapped(false)
+    {
+        lock = SDL_CreateMutex();
+        trace = new Event[TRACE_SIZE];
+    }
+};
+
+static PROFILER_THREAD_LOCAL ThreadData *currThread = NULL;
+
+SDL_mutex *threadsLock = NULL;
+std::vector<ThreadData*> threads; //!< Never freed, there are only a few threads
+
+Nanoseconds startTime = 0;
+
+ThreadData* getThreadData()
+{
+    if (!currThread)
+    {
+        SDL_mutexP(threadsLock);
+        currThread = new ThreadData(threads.size());
+        threads.push_back(currThread);
+        SDL_mutexV(threadsLock);
+    }
+    return currThread;
+}
+
+void begin(const char *name)
+{
+    ThreadData *data = getThreadData();
+    if (data->depth < MAX_DEPTH)
+    {
+        data->open[data->depth].name = name;
+        data->open[data->depth].start = now();
+    }
+    data->depth++;
+}
+
+void end()
+{
+    Nanoseconds endTime = now();
+
+    ThreadData *data = getThreadData();
+    if (data->depth <= 0)
+        return; // Profiling was turned on inside this zone
+    data->depth--;
+    if (data->depth >= MAX_DEPTH)
+        return;
+
+    const char *name = data->open[data->depth].name;
+    Nanoseconds zoneStart = data->open[data->depth].start;
+
+    SDL_mutexP(data->lock);
+
+    Event& event = data->trace[data->traceNext];
+    event.name = name;
+    event.start = zoneStart;
+    event.end = endTime;
+    data->traceNext++;
+    if (data->traceNext == TRACE_SIZE)
+    {
+        data->traceNext = 0;
+        data->traceWrapped = true;
+    }
+
+    ZoneStatsMap::iterator iter = data->stats.find(name);
+    if (iter == data->stats.end())
+        iter = data->stats.insert(ZoneStatsMap::value_type(name, new ZoneStats(name, data->depth))).first;
+    iter->second->add(endTime - zoneStart);
+
+    SDL_mutexV(data->lock);
+}
+
+
+// Management
+
+static Utility::Config::Int reportInterval("Profiling", "report_interval", 10);
+
+Nanoseconds lastReport = 0;
+
+std::string traceFile; //!< Read in init(), as the config may not be accessible when quitting
+
+void init()
+{
+    if (!threadsLock)
+        threadsLock = SDL_CreateMutex();
+
+    startTime = lastReport = now();
+
+    traceFile = Utility::Config::getString("Profiling", "trace_file", "");
+
+    setEnabled(Utility::Config::getInt("Profiling", "enabled", 0));
+
+    atexit(quit);
+}
+
+void quit()
+{
+    if (enabled && traceFile != "")
+        dumpTrace(traceFile);
+}
+
+void setEnabled(bool value)
+{
+    assert(threadsLock); // init() must be called first
+    enabled = value;
+    LOG(WARNING, "Profiling %s\r\n", enabled ? "enabled" : "disabled");
+}
+
+void frame()
+{
+    if (!enabled || reportInterval.get() <= 0)
+        return;
+
+    if (now() - lastReport >= Nanoseconds(reportInterval.get()) * 1000000000ULL)
+        report();
+}
+
+//! Sorts zones by nesting depth, then name
+bool zoneOrder(ZoneStats *a, ZoneStats *b)
+{
+    if (a->depth != b->depth)
+        return a->depth < b->depth;
+    return strcmp(a->name, b->name) < 0;
+}
+
+void report()
+{
+    Nanoseconds currTime = now();
+    float seconds = float(currTime - lastReport) / 1000000000.0f;
+    lastReport = currTime;
+
+    // Merge all the threads' statistics, and reset them
+    ZoneStatsMap merged;
+
+    SDL_mutexP(threadsLock);
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        ThreadData *data = threads[i];
+        SDL_mutexP(data->lock);
+        for (ZoneStatsMap::iterator iter = data->stats.begin(); iter != data->stats.end(); iter++)
+        {
+            ZoneStats *stats = iter->second;
+            if (!stats->count)
+                continue;
+            ZoneStatsMap::iterator target = merged.find(stats->name);
+            if (target == merged.end())
+                target = merged.insert(ZoneStatsMap::value_type(stats->name, new ZoneStats(stats->name, stats->depth))).first;
+            target->second->merge(*stats);
+            stats->reset();
+        }
+        SDL_mutexV(data->lock);
+    }
+    SDL_mutexV(threadsLock);
+
+    std::vector<ZoneStats*> sorted;
+    for (ZoneStatsMap::iterator iter = merged.begin(); iter != merged.end(); iter++)
+        sorted.push_back(iter->second);
+    std::sort(sorted.begin(), sorted.end(), zoneOrder);
+
+    printf("[[ Profile of the last %.1f secs ]]\r\n", seconds);
+    printf("%-40s %8s %8s %10s %10s %10s %10s\r\n", "zone", "count", "% time", "min (us)", "avg (us)", "p99 (us)", "max (us)");
+    for (unsigned int i = 0; i < sorted.size(); i++)
+    {
+        ZoneStats *stats = sorted[i];
+        std::string name = std::string(min(stats->depth, 10)*2, ' ') + stats->name;
+        printf("%-40s %8u %8.2f %10.1f %10.1f %10.1f %10.1f\r\n",
+            name.c_str(),
+            stats->count,
+            100.0f * float(stats->total) / (seconds * 1000000000.0f),
+            stats->min / 1000.0f,
+            (stats->total / stats->count) / 1000.0f,
+            stats->percentile(0.99f) / 1000.0f,
+            stats->max / 1000.0f
+        );
+        delete stats;
+    }
+}
+
+//! Writes a string as a JSON string literal
+void writeJSONString(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (const char *c = text; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', out);
+        if ((unsigned char)(*c) >= 32)
+            fputc(*c, out);
+    }
+    fputc('"', out);
+}
+
+bool dumpTrace(std::string filename)
+{
+    FILE *out = fopen(filename.c_str(), "w");
+    if (!out)
+    {
+        LOG(ERROR, "Cannot write profiler trace to %s\r\n", filename.c_str());
+        return false;
+    }
+
+    fprintf(out, "{\"traceEvents\":[\n");
+    bool first = true;
+
+    SDL_mutexP(threadsLock);
+    for (unsigned int i = 0; i < threads.size(); i++)
+    {
+        ThreadData *data = threads[i];
+        SDL_mutexP(data->lock);
+
+        int num = data->traceWrapped ? TRACE_SIZE : data->traceNext;
+        int oldest = data->traceWrapped ? data->traceNext : 0;
+        for (int j = 0; j < num; j++)
+        {
+            Event& event = data->trace[(oldest + j) % TRACE_SIZE];
+            if (event.start < startTime)
+                continue; // From before init()
+
+            if (!first)
+                fprintf(out, ",\n");
+            first = false;
+
+            // Complete ('X') events, with times in microseconds
+            fprintf(out, "{\"name\":");
+            writeJSONString(out, event.name);
+            fprintf(out, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                data->id,
+                (event.start - startTime) / 1000.0,
+                (event.end - event.start) / 1000.0
+            );
+        }
+
+        SDL_mutexV(data->lock);
+    }
+    SDL_mutexV(threadsLock);
+
+    fprintf(out, "\n]}\n");
+    fclose(out);
+
+    LOG(WARNING, "Wrote profiler trace to %s\r\n", filename.c_str());
+    return true;
+}
+
+};
+
+
+// Cubescript accessibility
+
+void profiler(int *on)
+{
+    Profiler::setEnabled(*on != 0);
+}
+
+COMMAND(profiler, "i");
+
+void profiler_dump(char *filename)
+{
+    Profiler::dumpTrace(filename);
+}
+
+COMMAND(profiler_dump, "s");
+
+void profiler_report()
+{
+    Profiler::report();
+}
+
+COMMAND(profiler_report, "");
+
@@ -0,0 +1,69 @@
+
+// Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
+// This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
+
+//! Frame profiler. Zones of code are marked with
+//!
+//!     PROFILE("physics");
+//!
+//! which times from there to the end of the enclosing scope. Zones can be nested, and can be used in any
+//! thread (each thread records into its own buffers). When profiling is off, a zone costs a check of a
+//! single flag. When on, each thread keeps a ring buffer of its recent zones, which can be dumped as
+//! Chrome trace JSON (load it in chrome://tracing), and statistics per zone (count, min, avg, p99, max),
+//! which are printed every Profiling/report_interval seconds.
+//!
+//! Settings, in the [Profiling] section:
+//!     enabled         - Whether to profile at all (also toggled by the 'profiler' command)
+//!     report_interval - Seconds between printed reports, or 0 for none
+//!     trace_file      - If set, the trace is dumped there when quitting (also see 'profiler_dump')
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+//! Profile the rest of the current scope. The name must remain valid for as long as the program runs
+//! (e.g., a string literal), as only the pointer is kept.
+#define PROFILE(name) Profiler::Zone PROFILE_CONCAT(__profilerZone, __LINE__)(name)
+
+namespace Profiler
+{
+    typedef unsigned long long Nanoseconds;
+
+    //! Whether zones are being recorded
+    extern bool enabled;
+
+    //! The current time from a monotonic, high-resolution clock
+    Nanoseconds now();
+
+    //! Reads the settings. Call after the config file is available
+    void init();
+
+    //! Dumps the trace, if Profiling/trace_file is set. Called automatically at exit
+    void quit();
+
+    void setEnabled(bool value);
+
+    //! Opens a zone in the current thread. Prefer PROFILE, which closes it automatically
+    void begin(const char *name);
+
+    //! Closes the last opened zone in the current thread
+    void end();
+
+    //! Called once per frame (or server tick). Prints a report if it is time
+    void frame();
+
+    //! Prints the statistics gathered since the last report, and starts gathering anew
+    void report();
+
+    //! Writes the recorded zones of all threads as Chrome trace JSON
+    bool dumpTrace(std::string filename);
+
+    struct Zone
+    {
+        Zone(const char *name) : active(enabled) { if (active) begin(name); };
+        ~Zone() { if (active) end(); };
+
+    private:
+        bool active; //!< So that toggling profiling inside a zone does not unbalance it
+    };
+};
+
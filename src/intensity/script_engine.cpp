@@ -48,6 +48,41 @@ ScriptValueArgs& ScriptValueArgs::append(ScriptValuePtr value)
 }
 
 
+// Script Args
+
+ScriptArgs& ScriptArgs::append(int value)
+{
+    assert(numArgs < MAX_ARGS);
+    args[numArgs].type = INT;
+    args[numArgs++].intValue = value;
+    return *this;
+}
+
+ScriptArgs& ScriptArgs::append(double value)
+{
+    assert(numArgs < MAX_ARGS);
+    args[numArgs].type = DOUBLE;
+    args[numArgs++].doubleValue = value;
+    return *this;
+}
+
+ScriptArgs& ScriptArgs::append(const std::string& value)
+{
+    assert(numArgs < MAX_ARGS);
+    args[numArgs].type = STRING;
+    args[numArgs++].stringValue = &value;
+    return *this;
+}
+
+ScriptArgs& ScriptArgs::append(ScriptValuePtr value)
+{
+    assert(numArgs < MAX_ARGS);
+    args[numArgs].type = VALUE;
+    args[numArgs++].value = value.get();
+    return *this;
+}
+
+
 // Script Value
 
 ScriptValue::ScriptValue(ScriptEngine* _engine) : engine(_engine)
@@ -57,7 +92,7 @@ ScriptValue::ScriptValue(ScriptEngine* _engine) : engine(_engine)
 
 ScriptValue::~ScriptValue()
 {
-    Logging::log(Logging::INFO, "~ScriptValue: %d\r\n", isValid());
+    LOG(INFO, "~ScriptValue: %d\r\n", isValid());
 
     if (isValid())
         invalidate(); // C++: we are a base class here, so a derived class func would not be called
@@ -66,7 +101,7 @@ ScriptValue::~ScriptValue()
 
 void ScriptValue::invalidate()
 {
-    Logging::log(Logging::INFO, "ScriptValue::invalidate %d\r\n", isValid());
+    LOG(INFO, "ScriptValue::invalidate %d\r\n", isValid());
 
     assert(isValid());
 
@@ -86,28 +121,34 @@ bool ScriptValue::isValid()
 
 ScriptEngine::~ScriptEngine()
 {
-    Logging::log(Logging::DEBUG, "~ScriptEngine (0)\r\n");
+    LOG(DEBUG, "~ScriptEngine (0)\r\n");
 
-    ScriptValueStore temp(registeredScriptValues); // Iterate on temp, as inside the next loop we operate on registeredScriptValues
-    for (ScriptValueStore::iterator iter = temp.begin(); iter != temp.end(); iter++)
-    {
-        (*iter)->invalidate();
-    }
-
-    assert(registeredScriptValues.size() == 0); // They were all removed
+    while (registeredScriptValues)
+        registeredScriptValues->invalidate(); // Unregisters it, moving the next one to the head of the list
 
-    Logging::log(Logging::DEBUG, "~ScriptEngine (1)\r\n");
+    LOG(DEBUG, "~ScriptEngine (1)\r\n");
 }
 
 void ScriptEngine::registerScriptValue(ScriptValue* value)
 {
-    assert(registeredScriptValues.find(value) == registeredScriptValues.end());
-    registeredScriptValues.insert(value);
+    value->prevRegistered = NULL;
+    value->nextRegistered = registeredScriptValues;
+    if (registeredScriptValues)
+        registeredScriptValues->prevRegistered = value;
+    registeredScriptValues = value;
 }
 
 void ScriptEngine::unregisterScriptValue(ScriptValue* value)
 {
-    assert(registeredScriptValues.find(value) != registeredScriptValues.end());
-    registeredScriptValues.erase(value);
+    if (value->prevRegistered)
+        value->prevRegistered->nextRegistered = value->nextRegistered;
+    else
+    {
+        assert(registeredScriptValues == value);
+        registeredScriptValues = value->nextRegistered;
+    }
+
+    if (value->nextRegistered)
+        value->nextRegistered->prevRegistered = value->prevRegistered;
 }
 
@@ -11,6 +11,8 @@ typedef boost::shared_ptr<ScriptValue> ScriptValuePtr;
 
 class ScriptEngine;
 
+struct CLogicEntity;
+
 struct ScriptValueArgs
 {
     std::vector<ScriptValuePtr> args;
@@ -26,11 +28,53 @@ struct ScriptValueArgs
     ScriptValueArgs& append(ScriptValuePtr value);
 };
 
+//! Arguments for ScriptValue::callPath, kept as native values. Unlike ScriptValueArgs, no
+//! ScriptValue is created for each argument; they are converted directly when the call is made.
+//! Strings and script values are referred to, not copied, so they must outlive the call.
+struct ScriptArgs
+{
+    enum { MAX_ARGS = 8 };
+
+    enum Type { INT, DOUBLE, STRING, VALUE };
+
+    struct Arg
+    {
+        Type type;
+        union
+        {
+            int intValue;
+            double doubleValue;
+            const std::string *stringValue;
+            ScriptValue *value;
+        };
+    };
+
+    Arg args[MAX_ARGS];
+    int numArgs;
+
+    ScriptArgs() : numArgs(0) { };
+
+    ScriptArgs& append(int value);
+    ScriptArgs& append(bool value) { return append(int(value)); }; // As in ScriptValueArgs
+    ScriptArgs& append(double value);
+    ScriptArgs& append(const std::string& value);
+    ScriptArgs& append(ScriptValuePtr value);
+
+private:
+    ScriptArgs& append(const char *value); //!< Not implemented, so literals are not silently taken as bools
+};
+
 //! A wrapper for a scripting value. We are wrapping scripting languages,
 //! specifically dynamic ones, so these values can represent any possible
 //! value in the scripting language.
 class ScriptValue
 {
+    friend class ScriptEngine;
+
+    //! The engine's list of registered values, kept in the values themselves so that registering
+    //! does not allocate
+    ScriptValue *prevRegistered, *nextRegistered;
+
 protected:
     ScriptEngine* engine;
 public:
@@ -69,9 +113,18 @@ public:
     virtual ScriptValuePtr call(std::string funcName, std::string arg1) = 0;
     virtual ScriptValuePtr call(std::string funcName, ScriptValueArgs& args) = 0;
 
+    //! Calls the function at a path of properties from this value, given as string values (e.g., "a", "b", "c"
+    //! calls this.a.b.c, with this.a.b as 'this'). The properties are looked up on each call, as scripts may
+    //! replace them at any time.
+    virtual ScriptValuePtr callPath(std::vector<ScriptValuePtr>& keys, ScriptArgs& args) = 0;
+
     //! Returns true if equal to another ScriptValue
     virtual bool compare(ScriptValuePtr other) = 0;
 
+    //! Binds a logic entity to this value, which must be an object, so that natives called on it can find
+    //! the entity without looking it up by unique ID. The binding is not visible to scripts. NULL unbinds.
+    virtual void bindLogicEntity(CLogicEntity* entity) = 0;
+
     //! For debug purposes, dump the contents of this value to the log.
     virtual void debugPrint() = 0;
 };
@@ -83,11 +136,11 @@ class ScriptEngine
 {
     std::string scriptDir;
 
-    typedef std::set<ScriptValue*> ScriptValueStore;
-    ScriptValueStore registeredScriptValues;
+    //! The first of the registered values, which are a list using ScriptValue::nextRegistered
+    ScriptValue* registeredScriptValues;
 
 public:
-    ScriptEngine() : scriptDir("") { };
+    ScriptEngine() : scriptDir(""), registeredScriptValues(NULL) { };
     ~ScriptEngine();
 
     virtual void init() = 0;
@@ -41,6 +41,8 @@
 #endif
 
 #include "intensity_physics.h"
+#include "entity_index.h"
+#include "navigation.h"
 
 #define MAKE_VECTOR3(scriptvec, sauervec) \
     scriptvec = ScriptEngineManager::getGlobal()->call("__new__", \
@@ -86,6 +88,10 @@ extern void addentity(extentity* entity);
 
 V8_FUNC_is(__script__log, { Logging::log_noformat(arg1, arg2); } );
 
+V8_FUNC_i(__script__shouldShow, {
+    V8_RETURN_BOOL(arg1 >= 0 && arg1 < Logging::OFF && Logging::shouldShow((Logging::Level)arg1));
+} );
+
 
 //
 // Normal CAPI
@@ -102,7 +108,7 @@ V8_FUNC_T(__script__getStartTime, , {
     V8_RETURN_INT( self.get()->getStartTime() );
 });
 V8_FUNC_T(__script__setModelName, s, {
-    Logging::log(Logging::DEBUG, "__script__setModelName(%s)\r\n", arg2);
+    LOG(DEBUG, "__script__setModelName(%s)\r\n", arg2);
     self.get()->setModel(arg2);
 } );
 V8_FUNC_T(__script__setAttachments_raw, s, { self.get()->setAttachments(arg2); } );
@@ -220,7 +226,7 @@ V8_FUNC_T(__script__##getterName, , { \
 }); \
  \
 V8_FUNC_T(__script__##setterName, d, { \
-    Logging::log(Logging::DEBUG, "ACCESSOR: Setting %s to %d\r\n", #setterName, arg2); \
+    LOG(DEBUG, "ACCESSOR: Setting %s to %d\r\n", #setterName, arg2); \
     assert(self->staticEntity); \
     if (!WorldSystem::loadingWorld) removeentity(self->staticEntity); /* Need to remove, then add, to the octa world on each change. */ \
     self->attribName = arg2; \
@@ -239,11 +245,18 @@ V8_FUNC_T(__script__getExtentO_raw, i, {
     assert(e);
     assert(arg2 >= 0 && arg2 <= 2);
 
-    Logging::log(Logging::INFO, "__script__getExtentO_raw(%d): %f\r\n", arg2, e->o[arg2]);
+    LOG(INFO, "__script__getExtentO_raw(%d): %f\r\n", arg2, e->o[arg2]);
 
     V8_RETURN_DOUBLE(e->o[arg2]);
 });
 
+V8_FUNC_T(__script__getExtentO, , {
+    extentity* e = self.get()->staticEntity;
+    assert(e);
+
+    V8_RETURN_FARRAY(e->o, 3);
+});
+
 V8_FUNC_T(__script__setExtentO_raw, ddd, {
     extentity* e = self.get()->staticEntity;
     assert(e);
@@ -253,6 +266,8 @@ V8_FUNC_T(__script__setExtentO_raw, ddd, {
     e->o.y = arg3;
     e->o.z = arg4;
     addentity(e);
+
+    EntityIndex::invalidate();
 });
 
 
@@ -318,7 +333,9 @@ V8_FUNC_T(__script__setDynentO_raw, ddd, {
 
     d->resetinterp(); // No need to interpolate to last position - just jump
 
-    Logging::log(Logging::INFO, "(%d).setDynentO(%f, %f, %f)\r\n", d->uniqueId, d->o.x, d->o.y, d->o.z);
+    EntityIndex::invalidate();
+
+    LOG(INFO, "(%d).setDynentO(%f, %f, %f)\r\n", d->uniqueId, d->o.x, d->o.y, d->o.z);
 });
 
 V8_FUNC_T(__script__getDynentVel_raw, i, {
@@ -338,6 +355,92 @@ V8_FUNC_T(__script__setDynentVel_raw, ddd, {
     d->vel.z = arg4;
 });
 
+// Whole vectors, in one call
+
+V8_FUNC_T(__script__getDynentO, , {
+    fpsent* d = dynamic_cast<fpsent*>(self.get()->dynamicEntity);
+    assert(d);
+
+    vec feet = d->o;
+    feet.z -= d->eyeheight;
+    V8_RETURN_FARRAY(feet, 3);
+});
+
+V8_FUNC_T(__script__getDynentVel, , {
+    fpsent* d = (fpsent*)(self.get()->dynamicEntity);
+    assert(d);
+
+    V8_RETURN_FARRAY(d->vel, 3);
+});
+
+V8_FUNC_T(__script__getDynentFalling, , {
+    fpsent* d = (fpsent*)(self.get()->dynamicEntity);
+    assert(d);
+
+    V8_RETURN_FARRAY(d->falling, 3);
+});
+
+// Batched versions, for many entities in one call. The values are in a single flat array,
+// [x0, y0, z0, x1, y1, z1, ...], in the same order as the array of entities
+
+static fpsent* getBatchedDynent(Handle<Object> entities, unsigned int index)
+{
+    LogicEntityPtr entity = V8Engine::getCLogicEntity(entities->Get(Integer::New(index))->ToObject());
+    if (!entity.get() || !entity->dynamicEntity)
+        return NULL;
+    return (fpsent*)(entity->dynamicEntity);
+}
+
+#define DYNENT_BATCHED_ACCESSORS(getterName, setterName, getVec, setVec) \
+V8_FUNC_o(__script__##getterName, { \
+    if (!arg1->IsArray()) { RAISE_SCRIPT_ERROR(#getterName needs an array of entities); return Undefined(); } \
+    unsigned int num = Handle<Array>::Cast(arg1)->Length(); \
+    Handle<Array> ret = Array::New(num*3); \
+    for (unsigned int i = 0; i < num; i++) \
+    { \
+        fpsent* d = getBatchedDynent(arg1, i); \
+        if (!d) { RAISE_SCRIPT_ERROR(#getterName called on a non-dynent); return Undefined(); } \
+        vec v; \
+        getVec; \
+        for (int j = 0; j < 3; j++) \
+            ret->Set(Integer::New(i*3 + j), Number::New(v[j])); \
+    } \
+    return ret; \
+}); \
+ \
+V8_FUNC_oo(__script__##setterName, { \
+    if (!arg1->IsArray() || !arg2->IsArray()) \
+    { \
+        RAISE_SCRIPT_ERROR(#setterName needs an array of entities and an array of values); \
+        return Undefined(); \
+    } \
+    unsigned int num = Handle<Array>::Cast(arg1)->Length(); \
+    if (Handle<Array>::Cast(arg2)->Length() != num*3) \
+    { \
+        RAISE_SCRIPT_ERROR(#setterName given an array of the wrong length); \
+        return Undefined(); \
+    } \
+    for (unsigned int i = 0; i < num; i++) \
+    { \
+        fpsent* d = getBatchedDynent(arg1, i); \
+        if (!d) { RAISE_SCRIPT_ERROR(#setterName called on a non-dynent); return Undefined(); } \
+        vec v; \
+        for (int j = 0; j < 3; j++) \
+            v[j] = arg2->Get(Integer::New(i*3 + j))->NumberValue(); \
+        setVec; \
+    } \
+});
+
+DYNENT_BATCHED_ACCESSORS(getDynentsO, setDynentsO,
+    { v = d->o; v.z -= d->eyeheight; },
+    { d->o = v; d->o.z += d->eyeheight; d->newpos = d->o; d->resetinterp(); EntityIndex::invalidate(); } // As in setDynentO_raw
+);
+
+DYNENT_BATCHED_ACCESSORS(getDynentsVel, setDynentsVel,
+    { v = d->vel; },
+    { d->vel = v; }
+);
+
 V8_FUNC_T(__script__getDynentFalling_raw, i, {
     fpsent* d = (fpsent*)(self.get()->dynamicEntity);
     assert(d);
@@ -380,6 +483,69 @@ V8_FUNC_dddd(__script__rayFloor, {
     V8_RETURN_DOUBLE(rayfloor(o, floor, 0, arg4));
 });
 
+// Entity queries, using the native indexes in EntityIndex. Results are unique IDs, which scripting
+// looks up in its store; spatial results are a flat array [id0, distance0, id1, distance1, ...], from
+// close to far
+
+static Handle<Value> entityIndexResults(const EntityIndex::Results& results)
+{
+    Handle<Array> ret = Array::New(results.size()*2);
+    for (unsigned int i = 0; i < results.size(); i++)
+    {
+        ret->Set(Integer::New(i*2), Integer::New(results[i].first));
+        ret->Set(Integer::New(i*2 + 1), Number::New(results[i].second));
+    }
+    return ret;
+}
+
+V8_FUNC_dddds(__script__getEntitiesInRadius, {
+    EntityIndex::Results results;
+    EntityIndex::getInRadius(vec(arg1, arg2, arg3), arg4, arg5, results);
+    return entityIndexResults(results);
+});
+
+V8_FUNC_dddddds(__script__getEntitiesInBox, {
+    EntityIndex::Results results;
+    EntityIndex::getInBox(vec(arg1, arg2, arg3), vec(arg4, arg5, arg6), arg7, results);
+    return entityIndexResults(results);
+});
+
+V8_FUNC_io(__script__setEntityTags, {
+    if (!arg2->IsArray()) { RAISE_SCRIPT_ERROR(setEntityTags needs an array of tags); return Undefined(); }
+    unsigned int num = Handle<Array>::Cast(arg2)->Length();
+    std::vector<std::string> tags;
+    for (unsigned int i = 0; i < num; i++)
+        tags.push_back(*(v8::String::Utf8Value(arg2->Get(Integer::New(i)))));
+    EntityIndex::setTags(arg1, tags);
+});
+
+V8_FUNC_s(__script__getEntitiesByTag, {
+    std::vector<int> results;
+    EntityIndex::getByTag(arg1, results);
+    Handle<Array> ret = Array::New(results.size());
+    for (unsigned int i = 0; i < results.size(); i++)
+        ret->Set(Integer::New(i), Integer::New(results[i]));
+    return ret;
+});
+
+// Navigation. Paths are a flat array of positions, [x0, y0, z0, x1, ...], or null if there is none
+
+V8_FUNC_NOPARAM(__script__hasNavigationGraph, {
+    V8_RETURN_BOOL(NavigationSystem::hasGraph());
+});
+
+V8_FUNC_dddddd(__script__findPath, {
+    std::vector<vec> path;
+    if (!NavigationSystem::findPath(vec(arg1, arg2, arg3), vec(arg4, arg5, arg6), path))
+        V8_RETURN_NULL;
+
+    Handle<Array> ret = Array::New(path.size()*3);
+    for (unsigned int i = 0; i < path.size(); i++)
+        for (int j = 0; j < 3; j++)
+            ret->Set(Integer::New(i*3 + j), Number::New(path[i][j]));
+    return ret;
+});
+
 // Effects
 
 #ifdef CLIENT
@@ -478,8 +644,9 @@ V8_FUNC_iis(__script__UnreliableStateDataChangeRequest, { send_UnreliableStateDa
 V8_FUNC_ii(__script__NotifyNumEntities, { send_NotifyNumEntities(arg1, arg2); });
 V8_FUNC_iiiss(__script__LogicEntityCompleteNotification, { send_LogicEntityCompleteNotification(arg1, arg2, arg3, arg4, arg5); });
 V8_FUNC_ii(__script__LogicEntityRemoval, { send_LogicEntityRemoval(arg1, arg2); });
-V8_FUNC_iiisi(__script__StateDataUpdate, { send_StateDataUpdate(arg1, arg2, arg3, arg4, arg5); });
-V8_FUNC_iiisi(__script__UnreliableStateDataUpdate, { send_UnreliableStateDataUpdate(arg1, arg2, arg3, arg4, arg5); });
+// The value is of the wire type given last (see StateDataEncoding), a string if none is given
+V8_FUNC_iiivii(__script__StateDataUpdate, { StateDataBatching::send(true, arg1, arg2, arg3, arg6, arg4, arg5); });
+V8_FUNC_iiivii(__script__UnreliableStateDataUpdate, { StateDataBatching::send(false, arg1, arg2, arg3, arg6, arg4, arg5); });
 V8_FUNC_iidddi(__script__DoClick, { send_DoClick(arg1, arg2, arg3, arg4, arg5, arg6); });
 V8_FUNC_iissdddiiii(__script__ExtentCompleteNotification, { send_ExtentCompleteNotification(arg1, arg2, arg3,arg4, arg5, arg6, arg7, arg8, arg9, arg10, arg11); });
 
@@ -927,7 +1094,7 @@ V8_FUNC_d(__script__setGravity, {
     {
         PhysicsManager::getEngine()->setGravity(arg1);
     } else {
-        Logging::log(Logging::DEBUG, "Setting gravity using sauer system, as no physics engine\r\n");
+        LOG(DEBUG, "Setting gravity using sauer system, as no physics engine\r\n");
         extern float GRAVITY;
         GRAVITY = arg1;
     }
@@ -1057,7 +1224,7 @@ V8_FUNC_ddd(__script__getMaterial, {
             ScriptEngineManager::engineParameters["setDefaultThirdpersonMode"] = "set";
             thirdperson = arg1;
         } else
-            Logging::log(Logging::WARNING, "Can only set default thirdperson mode once per map\r\n");
+            LOG(WARNING, "Can only set default thirdperson mode once per map\r\n");
     });
 #endif
 
@@ -1428,7 +1595,7 @@ V8_FUNC_ddd(__script__physicsAddCapsule, {
 	v = vec(scriptVec->getPropertyFloat("x"), scriptVec->getPropertyFloat("y"), scriptVec->getPropertyFloat("z"));
 
 V8_FUNC_do(__script__physicsAddMesh, {
-    ScriptValuePtr scriptTris(new V8Value(ScriptEngineManager::getEngine(), arg2));
+    ScriptValuePtr scriptTris = V8Value::create(ScriptEngineManager::getEngine(), arg2);
     std::vector<triangle> tris;
     int num = scriptTris->getPropertyInt("length");
     for (int i = 0; i < num; i++)
@@ -83,6 +83,7 @@ EMBED_CAPI_FUNC("getCollisionRadiusHeight", __script__getCollisionRadiusHeight,
 EMBED_CAPI_FUNC("setCollisionRadiusHeight", __script__setCollisionRadiusHeight, 2);
 
 EMBED_CAPI_FUNC("getExtentO_raw", __script__getExtentO_raw, 2); EMBED_CAPI_FUNC("setExtentO_raw", __script__setExtentO_raw, 4);
+EMBED_CAPI_FUNC("getExtentO", __script__getExtentO, 1);
 
 // Dynents
 
@@ -109,12 +110,31 @@ EMBED_CAPI_FUNC("getDynentO_raw", __script__getDynentO_raw, 2); EMBED_CAPI_FUNC(
 EMBED_CAPI_FUNC("getDynentVel_raw", __script__getDynentVel_raw, 2); EMBED_CAPI_FUNC("setDynentVel_raw", __script__setDynentVel_raw, 4);
 EMBED_CAPI_FUNC("getDynentFalling_raw", __script__getDynentFalling_raw, 2); EMBED_CAPI_FUNC("setDynentFalling_raw", __script__setDynentFalling_raw, 4);
 
+EMBED_CAPI_FUNC("getDynentO", __script__getDynentO, 1);
+EMBED_CAPI_FUNC("getDynentVel", __script__getDynentVel, 1);
+EMBED_CAPI_FUNC("getDynentFalling", __script__getDynentFalling, 1);
+
+EMBED_CAPI_FUNC("getDynentsO", __script__getDynentsO, 1); EMBED_CAPI_FUNC("setDynentsO", __script__setDynentsO, 2);
+EMBED_CAPI_FUNC("getDynentsVel", __script__getDynentsVel, 1); EMBED_CAPI_FUNC("setDynentsVel", __script__setDynentsVel, 2);
+
 // Geometry utilities
 
 EMBED_CAPI_FUNC("rayLos", __script__rayLos, 6);
 EMBED_CAPI_FUNC("rayPos", __script__rayPos, 7);
 EMBED_CAPI_FUNC("rayFloor", __script__rayFloor, 4);
 
+// Entity queries
+
+EMBED_CAPI_FUNC("getEntitiesInRadius", __script__getEntitiesInRadius, 5);
+EMBED_CAPI_FUNC("getEntitiesInBox", __script__getEntitiesInBox, 7);
+EMBED_CAPI_FUNC("setEntityTags", __script__setEntityTags, 2);
+EMBED_CAPI_FUNC("getEntitiesByTag", __script__getEntitiesByTag, 1);
+
+// Navigation
+
+EMBED_CAPI_FUNC("hasNavigationGraph", __script__hasNavigationGraph, 0);
+EMBED_CAPI_FUNC("findPath", __script__findPath, 6);
+
 // Effects
 
 #ifdef CLIENT
@@ -146,8 +166,8 @@ EMBED_CAPI_FUNC("UnreliableStateDataChangeRequest", __script__UnreliableStateDat
 EMBED_CAPI_FUNC("NotifyNumEntities", __script__NotifyNumEntities, 2);
 EMBED_CAPI_FUNC("LogicEntityCompleteNotification", __script__LogicEntityCompleteNotification, 5);
 EMBED_CAPI_FUNC("LogicEntityRemoval", __script__LogicEntityRemoval, 2);
-EMBED_CAPI_FUNC("StateDataUpdate", __script__StateDataUpdate, 5);
-EMBED_CAPI_FUNC("UnreliableStateDataUpdate", __script__UnreliableStateDataUpdate, 5);
+EMBED_CAPI_FUNC("StateDataUpdate", __script__StateDataUpdate, 6);
+EMBED_CAPI_FUNC("UnreliableStateDataUpdate", __script__UnreliableStateDataUpdate, 6);
 EMBED_CAPI_FUNC("ExtentCompleteNotification", __script__ExtentCompleteNotification, 11);
 
 // File access
@@ -75,17 +75,18 @@ void ScriptEngineManager::setupLogging(bool runTests)
     module->setProperty("OFF", Logging::OFF);
 
     module->setProperty("log", engine->createFunction((NativeFunction)__script__log, 2));
+    module->setProperty("shouldShow", engine->createFunction((NativeFunction)__script__shouldShow, 1));
 
     engine->getGlobal()->setProperty("assert", engine->createObject()); // Dummy placeholder,
     runFile(SCRIPT_DIR + "LoggingExtras.js", true);                     // replaced here.
 
     if (runTests)
     {
-        Logging::log(Logging::DEBUG, "Logging module tests starting.\r\n");
+        LOG(DEBUG, "Logging module tests starting.\r\n");
         INDENT_LOG(Logging::DEBUG);
 
 // TODO: Apply        assert(Logging::shouldShow(Logging::DEBUG)); // We must run tests at debug level or more!
-        Logging::log(Logging::DEBUG, "You should now see a warning and an error\r\n");
+        LOG(DEBUG, "You should now see a warning and an error\r\n");
         runScript("Logging.log(Logging.WARNING, 'A warning which you can ignore.');");
         runScript("Logging.log(Logging.ERROR, 'An error which you can ignore.');");
         assert(runScript("typeof Logging == 'object';"));
@@ -95,13 +96,19 @@ void ScriptEngineManager::setupLogging(bool runTests)
         assert(runScript("Logging.ERROR == " + Utility::toString(Logging::ERROR)));
         assert(runScript("Logging.OFF == " + Utility::toString(Logging::OFF)));
         assert(runScript("typeof Logging.log === 'function';"));
+        assert(runScript("typeof Logging.shouldShow === 'function';"));
+        assert(runScript("Logging.shouldShow(Logging.ERROR)")->getBool() == Logging::shouldShow(Logging::ERROR));
+        assert(!runScript("Logging.shouldShow(Logging.OFF)")->getBool());
 
-        Logging::log(Logging::DEBUG, "You should now see an assertion failure\r\n");
+        // Messages given as functions are only built if they will be shown
+        assert(runScript("var built = false; log(Logging.OFF, function() { built = true; return ''; }); !built;")->getBool());
+
+        LOG(DEBUG, "You should now see an assertion failure\r\n");
         runScript("try { assert('0'); } catch (e) { };");
-        Logging::log(Logging::DEBUG, "You should now NOT see an assertion failure\r\n");
+        LOG(DEBUG, "You should now NOT see an assertion failure\r\n");
         runScript("assert('1');");
 
-        Logging::log(Logging::DEBUG, "Logging module tests complete.\r\n");
+        LOG(DEBUG, "Logging module tests complete.\r\n");
     }
 }
 
@@ -116,12 +123,12 @@ void ScriptEngineManager::setupSignals(bool runTests)
 
     if (runTests)
     {
-        Logging::log(Logging::DEBUG, "Signals module tests starting.\r\n");
+        LOG(DEBUG, "Signals module tests starting.\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         runFile(SCRIPT_DIR + "Signals__test.js", true);
 
-        Logging::log(Logging::DEBUG, "Signals module tests complete.\r\n");
+        LOG(DEBUG, "Signals module tests complete.\r\n");
     }
 }
 
@@ -139,12 +146,12 @@ void ScriptEngineManager::setupInheritance(bool runTests)
 
     if (runTests)
     {
-        Logging::log(Logging::DEBUG, "Inheritance module tests starting.\r\n");
+        LOG(DEBUG, "Inheritance module tests starting.\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         runFile(SCRIPT_DIR + "SimpleInheritance__test.js", true);
 
-        Logging::log(Logging::DEBUG, "Inheritance module tests complete.\r\n");
+        LOG(DEBUG, "Inheritance module tests complete.\r\n");
     }
 }
 
@@ -160,18 +167,18 @@ void ScriptEngineManager::setupMochiKit(bool runTests)
 
     if (runTests)
     {
-        Logging::log(Logging::DEBUG, "MochiKit module tests starting.\r\n");
+        LOG(DEBUG, "MochiKit module tests starting.\r\n");
         INDENT_LOG(Logging::DEBUG);
 
         runFile(SCRIPT_DIR + "MochiKit__test.js", true);
 
-        Logging::log(Logging::DEBUG, "MochiKit module tests complete.\r\n");
+        LOG(DEBUG, "MochiKit module tests complete.\r\n");
     }
 }
 
 void ScriptEngineManager::setupIntensityModule(std::string scriptBaseName, bool runTests)
 {
-    Logging::log(Logging::DEBUG, "%s scripting module setting up...\r\n", scriptBaseName.c_str());
+    LOG(DEBUG, "%s scripting module setting up...\r\n", scriptBaseName.c_str());
     INDENT_LOG(Logging::DEBUG);
 
     // Allow stack traces to know the source file
@@ -181,11 +188,11 @@ void ScriptEngineManager::setupIntensityModule(std::string scriptBaseName, bool
 
     if (runTests)
     {
-        Logging::log(Logging::DEBUG, "%s module tests starting.\r\n", scriptBaseName.c_str());
+        LOG(DEBUG, "%s module tests starting.\r\n", scriptBaseName.c_str());
 
         runFile(SCRIPT_DIR + scriptBaseName + "__test.js", true);
 
-        Logging::log(Logging::DEBUG, "%s module tests complete.\r\n", scriptBaseName.c_str());
+        LOG(DEBUG, "%s module tests complete.\r\n", scriptBaseName.c_str());
     }
 }
 
@@ -203,7 +210,7 @@ void ScriptEngineManager::setupCAPIModule(bool runTests)
 //! Set up all the modules etc. for the embedding
 void ScriptEngineManager::setupEmbedding()
 {
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::setupEmbedding.\r\n");
+    LOG(DEBUG, "ScriptEngineManager::setupEmbedding.\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     bool runTests = Utility::Config::getInt("Logging", "scripting_tests", 1);
@@ -253,7 +260,7 @@ void ScriptEngineManager::setupEmbedding()
     setupIntensityModule("intensity/Projectiles", runTests);
     setupIntensityModule("intensity/Steering", runTests);
 
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::setupEmbedding complete.\r\n");
+    LOG(DEBUG, "ScriptEngineManager::setupEmbedding complete.\r\n");
 }
 
 
@@ -261,26 +268,30 @@ void ScriptEngineManager::setupEmbedding()
 
 void ScriptEngineManager::createEngine()
 {
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::createEngine()\r\n");
+    LOG(DEBUG, "ScriptEngineManager::createEngine()\r\n");
 
     engineParameters.clear();
 
+    invalidateFunctions();
+
     // Engine-specific creation (might want to generalize this, but just 1 line)
     engine = new V8Engine(); // new TraceMonkeyEngine();
 
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::createEngine(): Init engine modules\r\n");
+    LOG(DEBUG, "ScriptEngineManager::createEngine(): Init engine modules\r\n");
 
     // Generic initialization code that runs specific initialization in engine
     engine->init();
 
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::createEngine(): Setup embedding\r\n");
+    LOG(DEBUG, "ScriptEngineManager::createEngine(): Setup embedding\r\n");
 
     setupEmbedding();
 }
 
 void ScriptEngineManager::destroyEngine()
 {
-    Logging::log(Logging::DEBUG, "ScriptEngineManager::destroyEngine()\r\n");
+    LOG(DEBUG, "ScriptEngineManager::destroyEngine()\r\n");
+
+    invalidateFunctions(); // Release their values while the engine is still alive
 
     if (engine != NULL) {
         engine->quit();
@@ -302,7 +313,7 @@ ScriptEngine* ScriptEngineManager::getEngine()
 ScriptValuePtr ScriptEngineManager::runScript(std::string script, std::string identifier)
 {
     assert(engine);
-    Logging::log(Logging::INFO, "Running script: %s\r\n", script.c_str());
+    LOG(INFO, "Running script: %s\r\n", script.c_str());
     // TODO: Try to compile with and without processing, and warn about discrepancies
     REFLECT_PYTHON( process_script );
     script = boost::python::extract<std::string>(process_script(script));
@@ -312,7 +323,7 @@ ScriptValuePtr ScriptEngineManager::runScript(std::string script, std::string id
 bool ScriptEngineManager::runFile(std::string name, bool msg, std::string postfix)
 {
     assert(engine);
-    Logging::log(Logging::INFO, "Running script file: %s\r\n", name.c_str());
+    LOG(INFO, "Running script file: %s\r\n", name.c_str());
     char *buf = loadfile(name.c_str(), NULL);
     if(!buf) 
     {
@@ -327,7 +338,7 @@ bool ScriptEngineManager::runFile(std::string name, bool msg, std::string postfi
 void ScriptEngineManager::runScriptNoReturn(std::string script, std::string identifier)
 {
     assert(engine);
-    Logging::log(Logging::INFO, "Running script: %s\r\n", script.c_str());
+    LOG(INFO, "Running script: %s\r\n", script.c_str());
     runScript(script, identifier);
 }
 
@@ -336,14 +347,14 @@ void run_script(char* script)
 {
     if (!ScriptEngineManager::hasEngine())
     {
-        Logging::log(Logging::WARNING, "Trying to run script '%s' without an engine\r\n", script);
+        LOG(WARNING, "Trying to run script '%s' without an engine\r\n", script);
         return;
     }
 
 #ifdef CLIENT
     if (!ClientSystem::isAdmin())
     {
-        Logging::log(Logging::WARNING, "Cannot run scripts when not in admin mode\r\n");
+        LOG(WARNING, "Cannot run scripts when not in admin mode\r\n");
         return;
     }
 #endif
@@ -355,14 +366,14 @@ COMMAND(run_script, "s");
 std::string ScriptEngineManager::runScriptString(std::string script, std::string identifier)
 {
     assert(engine);
-    Logging::log(Logging::INFO, "Running script: %s\r\n", script.c_str());
+    LOG(INFO, "Running script: %s\r\n", script.c_str());
     return runScript(script, identifier)->getString();
 }
 
 int ScriptEngineManager::runScriptInt(std::string script, std::string identifier)
 {
     assert(engine);
-    Logging::log(Logging::INFO, "Running script: %s\r\n", script.c_str());
+    LOG(INFO, "Running script: %s\r\n", script.c_str());
     return runScript(script, identifier)->getInt();
 }
 
@@ -408,3 +419,73 @@ ScriptValuePtr ScriptEngineManager::getNull()
     return engine->getNull();
 }
 
+ScriptEngineManager::FunctionRegistry ScriptEngineManager::functions;
+int ScriptEngineManager::generation = 0;
+
+ScriptFunction* ScriptEngineManager::getFunction(std::string path)
+{
+    FunctionRegistry::iterator iter = functions.find(path);
+    if (iter != functions.end())
+        return iter->second;
+
+    ScriptFunction* ret = new ScriptFunction(path);
+    functions[path] = ret;
+    return ret;
+}
+
+void ScriptEngineManager::invalidateFunctions()
+{
+    generation++;
+
+    for (FunctionRegistry::iterator iter = functions.begin(); iter != functions.end(); iter++)
+        iter->second->reset();
+}
+
+
+// Script functions
+
+ScriptFunction::ScriptFunction(std::string _path) : path(_path), generation(-1)
+{
+}
+
+void ScriptFunction::makeKeys()
+{
+    LOG(DEBUG, "Making keys for script function %s\r\n", path.c_str());
+
+    keys.clear();
+
+    std::string::size_type start = 0, end;
+    while ((end = path.find('.', start)) != std::string::npos)
+    {
+        keys.push_back(ScriptEngineManager::createScriptValue(path.substr(start, end - start)));
+        start = end + 1;
+    }
+    keys.push_back(ScriptEngineManager::createScriptValue(path.substr(start)));
+
+    generation = ScriptEngineManager::generation;
+}
+
+void ScriptFunction::reset()
+{
+    keys.clear();
+    generation = -1;
+}
+
+ScriptValuePtr ScriptFunction::call(ScriptArgs& args)
+{
+    PROFILE(path.c_str()); // The path is never changed, so its characters remain valid
+
+    assert(ScriptEngineManager::engine);
+
+    if (generation != ScriptEngineManager::generation)
+        makeKeys();
+
+    return ScriptEngineManager::getGlobal()->callPath(keys, args);
+}
+
+ScriptValuePtr ScriptFunction::call()
+{
+    ScriptArgs args;
+    return call(args);
+}
+
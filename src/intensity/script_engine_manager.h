@@ -5,10 +5,42 @@
 class ScriptEngine;
 //class ScriptValue;
 
+//! A script function, given by its path from the global object (e.g., "ApplicationManager.instance.click"),
+//! for fast calls from frequently-run C++ code. Get these from ScriptEngineManager::getFunction. The names
+//! along the path are converted to script strings once (again after the engine is recreated), but the
+//! properties are looked up on each call, as scripts replace these functions at runtime (e.g., cutscenes
+//! and action plugins).
+class ScriptFunction
+{
+    std::string path;
+    int generation; //!< The ScriptEngineManager generation in which the keys were made
+    std::vector<ScriptValuePtr> keys;
+
+    void makeKeys();
+
+public:
+    ScriptFunction(std::string _path);
+
+    //! Drops the keys, so they are made again when next called
+    void reset();
+
+    ScriptValuePtr call(ScriptArgs& args);
+    ScriptValuePtr call();
+};
+
 class ScriptEngineManager
 {
+    friend class ScriptFunction;
+
     static ScriptEngine* engine;
 
+    //! All the ScriptFunctions, by path. These are never deleted, so pointers to them can be kept
+    typedef std::map<std::string, ScriptFunction*> FunctionRegistry;
+    static FunctionRegistry functions;
+
+    //! Incremented whenever the ScriptFunctions' keys become stale
+    static int generation;
+
     static void setupLogging(bool runTests = false);
     static void setupSignals(bool runTests = false);
     static void setupInheritance(bool runTests = false);
@@ -48,5 +80,12 @@ public:
 
     static ScriptValuePtr getGlobal();
     static ScriptValuePtr getNull();
+
+    //! Gets the ScriptFunction for a path, creating it if needed. Typically kept in a static, e.g.
+    //!     static ScriptFunction* click = ScriptEngineManager::getFunction("ApplicationManager.instance.click");
+    static ScriptFunction* getFunction(std::string path);
+
+    //! Makes all ScriptFunctions drop their keys, e.g. when the engine is destroyed
+    static void invalidateFunctions();
 };
 
@@ -33,22 +33,22 @@ std::string JSSTRING_TO_STRING(JSString* jsstr)
 void printJSVAL(jsval value)
 {
     if (JSVAL_IS_INT(value))
-        Logging::log(Logging::INFO, "INT: %d\r\n", JSVAL_TO_INT(value));
+        LOG(INFO, "INT: %d\r\n", JSVAL_TO_INT(value));
     else if (JSVAL_IS_NULL(value))
-        Logging::log(Logging::INFO, "NULL (null)\r\n");
+        LOG(INFO, "NULL (null)\r\n");
     else if (JSVAL_IS_VOID(value))
-        Logging::log(Logging::INFO, "VOID (undefined)\r\n");
+        LOG(INFO, "VOID (undefined)\r\n");
     else if (JSVAL_IS_BOOLEAN(value))
-        Logging::log(Logging::INFO, "BOOLEAN: %d\r\n", JSVAL_TO_BOOLEAN(value));
+        LOG(INFO, "BOOLEAN: %d\r\n", JSVAL_TO_BOOLEAN(value));
     else if (JSVAL_IS_NUMBER(value))
-        Logging::log(Logging::INFO, "NUMBER: %f\r\n", *JSVAL_TO_DOUBLE(value));
+        LOG(INFO, "NUMBER: %f\r\n", *JSVAL_TO_DOUBLE(value));
     else if (JSVAL_IS_DOUBLE(value))
-        Logging::log(Logging::INFO, "DOUBLE: %f\r\n", *JSVAL_TO_DOUBLE(value));
+        LOG(INFO, "DOUBLE: %f\r\n", *JSVAL_TO_DOUBLE(value));
     else if (JSVAL_IS_STRING(value))
     {
         JSString* str = JS_ValueToString(TraceMonkeyEngine::context, value);
         char* chr = JS_GetStringBytes(str);
-        Logging::log(Logging::INFO, "STRING: %s\r\n", chr);
+        LOG(INFO, "STRING: %s\r\n", chr);
 
 /*
         INDENT_LOG(Logging::DEBUG);
@@ -71,16 +71,16 @@ void printJSVAL(jsval value)
     }
     else if (JSVAL_IS_OBJECT(value))
     {
-        Logging::log(Logging::INFO, "OBJECT (object)\r\n");
+        LOG(INFO, "OBJECT (object)\r\n");
 
         assert(!JSVAL_IS_NULL(value));
         jsval ret;
         JS_GetProperty(TraceMonkeyEngine::context, JSVAL_TO_OBJECT(value), "uniqueId", &ret);
 
         if (JSVAL_IS_INT(ret))
-            Logging::log(Logging::INFO, "OBJECT (object) has uniqueId: %d\r\n", JSVAL_TO_INT(ret));
+            LOG(INFO, "OBJECT (object) has uniqueId: %d\r\n", JSVAL_TO_INT(ret));
         else
-            Logging::log(Logging::INFO, "OBJECT (object) has no uniqueId\r\n");
+            LOG(INFO, "OBJECT (object) has no uniqueId\r\n");
 
 /*
         if (TraceMonkeyEngine::global)
@@ -98,7 +98,7 @@ void printJSVAL(jsval value)
 */
     }
     else {
-        Logging::log(Logging::INFO, "Uncertain jsval\r\n");
+        LOG(INFO, "Uncertain jsval\r\n");
     }
 }
 
@@ -112,7 +112,7 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine) : ScriptValue(_engine)
 
     debugName = "NULL value no. " + Utility::toString(__nameCounter);
 
-    Logging::log(Logging::INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
     INDENT_LOG(Logging::INFO);
 
     printJSVAL(value);
@@ -120,19 +120,19 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine) : ScriptValue(_engine)
     bool ret = JS_AddNamedRoot(TraceMonkeyEngine::context, &(this->value), debugName.c_str()); // Ensure our value won't be GCed
     assert(ret);
 
-    Logging::log(Logging::INFO, "Created a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a TM value of: %s\r\n", debugName.c_str());
 
     __nameCounter += 1;
 
     JS_GC(TraceMonkeyEngine::context); // XXX For debugging purposes 
-    Logging::log(Logging::INFO, "post-creation GC ok.\r\n");
+    LOG(INFO, "post-creation GC ok.\r\n");
 }
 
 TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, int _value) : ScriptValue(_engine)
 {
     debugName = "int value no. " + Utility::toString(__nameCounter);
 
-    Logging::log(Logging::INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
     INDENT_LOG(Logging::INFO);
 
     value = INT_TO_JSVAL(_value);
@@ -141,19 +141,19 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, int _value) : ScriptVa
 
     printJSVAL(value);
 
-    Logging::log(Logging::INFO, "Created a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a TM value of: %s\r\n", debugName.c_str());
 
     __nameCounter += 1;
 
     JS_GC(TraceMonkeyEngine::context); // XXX For debugging purposes
-    Logging::log(Logging::INFO, "post-creation GC ok.\r\n");
+    LOG(INFO, "post-creation GC ok.\r\n");
 }
 
 TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, double _value) : ScriptValue(_engine)
 {
     debugName = "double value no. " + Utility::toString(__nameCounter);
 
-    Logging::log(Logging::INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
     INDENT_LOG(Logging::INFO);
 
     value = DOUBLE_TO_JSVAL(_value);
@@ -162,12 +162,12 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, double _value) : Scrip
 
     printJSVAL(value);
 
-    Logging::log(Logging::INFO, "Created a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a TM value of: %s\r\n", debugName.c_str());
 
     __nameCounter += 1;
 
     JS_GC(TraceMonkeyEngine::context); // XXX For debugging purposes
-    Logging::log(Logging::INFO, "post-creation GC ok.\r\n");
+    LOG(INFO, "post-creation GC ok.\r\n");
 }
 
 TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, bool internal, jsval _value) : ScriptValue(_engine)
@@ -176,7 +176,7 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, bool internal, jsval _
 
     debugName = "jsval value no. " + Utility::toString(__nameCounter);
 
-    Logging::log(Logging::INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
     INDENT_LOG(Logging::INFO);
 
     value = _value;
@@ -185,12 +185,12 @@ TraceMonkeyValue::TraceMonkeyValue(ScriptEngine* _engine, bool internal, jsval _
 
     printJSVAL(value);
 
-    Logging::log(Logging::INFO, "Created a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a TM value of: %s\r\n", debugName.c_str());
 
     __nameCounter += 1;
 
     JS_GC(TraceMonkeyEngine::context); // XXX For debugging purposes
-    Logging::log(Logging::INFO, "post-creation GC ok.\r\n");
+    LOG(INFO, "post-creation GC ok.\r\n");
 }
 
 /*
@@ -198,7 +198,7 @@ TraceMonkeyValue::TraceMonkeyValue(std::string _value) : ScriptValue(_engine)
 {
     debugName = "int value no. " + Utility::toString(__nameCounter);
 
-    Logging::log(Logging::INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Going to create a TM value of: %s\r\n", debugName.c_str());
     INDENT_LOG(Logging::INFO);
 
     value = INT_TO_JSVAL(_value);
@@ -207,12 +207,12 @@ TraceMonkeyValue::TraceMonkeyValue(std::string _value) : ScriptValue(_engine)
 
     printJSVAL(value);
 
-    Logging::log(Logging::INFO, "Created a TM value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a TM value of: %s\r\n", debugName.c_str());
 
     __nameCounter += 1;
 
     JS_GC(TraceMonkeyEngine::context); // XXX For debugging purposes
-    Logging::log(Logging::INFO, "post-creation GC ok.\r\n");
+    LOG(INFO, "post-creation GC ok.\r\n");
 }
 */
 
@@ -220,7 +220,7 @@ void TraceMonkeyValue::invalidate()
 {
     assert(isValid());
 
-    Logging::log(Logging::INFO, "Removing TM root for %s\r\n", debugName.c_str());
+    LOG(INFO, "Removing TM root for %s\r\n", debugName.c_str());
 
     bool success = JS_RemoveRoot(TraceMonkeyEngine::context, &(this->value)); // Allow GCing (unless others use it)
     assert(success);
@@ -271,7 +271,7 @@ ScriptValuePtr TraceMonkeyValue::getProperty(std::string propertyName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getProperty(%s): \r\n", propertyName.c_str()); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getProperty(%s): \r\n", propertyName.c_str()); printJSVAL(value);
 
     assert(JSVAL_IS_OBJECT(value));
     jsval ret;
@@ -279,7 +279,7 @@ ScriptValuePtr TraceMonkeyValue::getProperty(std::string propertyName)
     bool success = JS_AddNamedRoot(TraceMonkeyEngine::context, &ret, "TraceMonkeyValue::getProperty temp val"); // Ensure our value won't be GCed
     assert(success);
 
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     ScriptValuePtr retValue(new TraceMonkeyValue(engine, true, ret));
 
@@ -293,7 +293,7 @@ int TraceMonkeyValue::getPropertyInt(std::string propertyName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getPropertyInt(%s): \r\n", propertyName.c_str()); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getPropertyInt(%s): \r\n", propertyName.c_str()); printJSVAL(value);
 
     assert(JSVAL_IS_OBJECT(value));
     jsval ret;
@@ -301,7 +301,7 @@ int TraceMonkeyValue::getPropertyInt(std::string propertyName)
     assert(success);
     assert(JSVAL_IS_INT(ret));
 
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     return JSVAL_TO_INT(ret);
 }
@@ -310,7 +310,7 @@ bool TraceMonkeyValue::getPropertyBool(std::string propertyName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getPropertyBool(%s): \r\n", propertyName.c_str()); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getPropertyBool(%s): \r\n", propertyName.c_str()); printJSVAL(value);
 
     assert(JSVAL_IS_OBJECT(value));
     jsval ret;
@@ -318,7 +318,7 @@ bool TraceMonkeyValue::getPropertyBool(std::string propertyName)
     assert(success);
     assert(JSVAL_IS_BOOLEAN(ret));
 
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     return JSVAL_TO_BOOLEAN(ret);
 }
@@ -327,7 +327,7 @@ double TraceMonkeyValue::getPropertyFloat(std::string propertyName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getPropertyFloat(%s): \r\n", propertyName.c_str()); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getPropertyFloat(%s): \r\n", propertyName.c_str()); printJSVAL(value);
 
     assert(JSVAL_IS_OBJECT(value));
     jsval ret;
@@ -335,7 +335,7 @@ double TraceMonkeyValue::getPropertyFloat(std::string propertyName)
     assert(success);
     assert(JSVAL_IS_DOUBLE(ret));
 
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     return *(JSVAL_TO_DOUBLE(ret));
 }
@@ -344,7 +344,7 @@ std::string TraceMonkeyValue::getPropertyString(std::string propertyName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getPropertyString(%s): \r\n", propertyName.c_str()); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getPropertyString(%s): \r\n", propertyName.c_str()); printJSVAL(value);
 
     assert(JSVAL_IS_OBJECT(value));
     jsval ret;
@@ -352,7 +352,7 @@ std::string TraceMonkeyValue::getPropertyString(std::string propertyName)
     assert(success);
     assert(JSVAL_IS_STRING(ret));
 
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     return JS_GetStringBytes(JSVAL_TO_STRING(ret));
 }
@@ -361,7 +361,7 @@ int TraceMonkeyValue::getInt()
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getInt: \r\n"); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getInt: \r\n"); printJSVAL(value);
 
     assert(JSVAL_IS_INT(value));
     return JSVAL_TO_INT(value);
@@ -371,7 +371,7 @@ bool TraceMonkeyValue::getBool()
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getBool: \r\n"); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getBool: \r\n"); printJSVAL(value);
 
     assert(JSVAL_IS_BOOLEAN(value));
     return JSVAL_TO_BOOLEAN(value);
@@ -381,7 +381,7 @@ double TraceMonkeyValue::getFloat()
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getFloat: \r\n"); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getFloat: \r\n"); printJSVAL(value);
 
     assert(JSVAL_IS_DOUBLE(value));
     return *(JSVAL_TO_DOUBLE(value));
@@ -391,7 +391,7 @@ std::string TraceMonkeyValue::getString()
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TraceMonkeyValue::getString: \r\n"); printJSVAL(value);
+    LOG(DEBUG, "TraceMonkeyValue::getString: \r\n"); printJSVAL(value);
 
     assert(JSVAL_IS_STRING(value));
     return JS_GetStringBytes(JSVAL_TO_STRING(value));
@@ -401,7 +401,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TMV::call(%s)\r\n", funcName.c_str());
+    LOG(DEBUG, "TMV::call(%s)\r\n", funcName.c_str());
 
     ScriptValueArgs args;
     return call(funcName, args);
@@ -411,7 +411,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName, ScriptValuePtr arg1)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TMV::call(%s (SV))\r\n", funcName.c_str());
+    LOG(DEBUG, "TMV::call(%s (SV))\r\n", funcName.c_str());
 
     return call(funcName, ScriptValueArgs().append(arg1));
 }
@@ -420,7 +420,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName, int arg1)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TMV::call(%s, int)\r\n", funcName.c_str());
+    LOG(DEBUG, "TMV::call(%s, int)\r\n", funcName.c_str());
 
     return call(funcName, ScriptValueArgs().append(arg1));
 }
@@ -429,7 +429,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName, double arg1)
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TMV::call(%s, double)\r\n", funcName.c_str());
+    LOG(DEBUG, "TMV::call(%s, double)\r\n", funcName.c_str());
 
     return call(funcName, ScriptValueArgs().append(arg1));
 }
@@ -445,7 +445,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName, ScriptValueArgs& arg
 {
     assert(isValid());
 
-    Logging::log(Logging::DEBUG, "TMV::call(%s, (%d))\r\n", funcName.c_str(), args.args.size());
+    LOG(DEBUG, "TMV::call(%s, (%d))\r\n", funcName.c_str(), args.args.size());
 
     printJSVAL(value);
 
@@ -469,7 +469,7 @@ ScriptValuePtr TraceMonkeyValue::call(std::string funcName, ScriptValueArgs& arg
     JS_CallFunctionValue(TraceMonkeyEngine::context, JSVAL_TO_OBJECT(value), func, numArgs, jsArgs, &ret);
     success = JS_AddNamedRoot(TraceMonkeyEngine::context, &ret, "TraceMonkeyValue::call temp val"); // Ensure our value won't be GCed
     assert(success);
-    Logging::log(Logging::DEBUG, "returning: \r\n"); printJSVAL(ret);
+    LOG(DEBUG, "returning: \r\n"); printJSVAL(ret);
 
     ScriptValuePtr retValue(new TraceMonkeyValue(engine, true, ret));
 
@@ -513,7 +513,7 @@ bool TraceMonkeyValue::compare(ScriptValuePtr other)
             assert(0 && "TODO: compare TM objects");
     }
     else {
-        Logging::log(Logging::INFO, "Can't compare uncertain jsvals\r\n");
+        LOG(INFO, "Can't compare uncertain jsvals\r\n");
     }
     assert(0);
     return false;
@@ -525,7 +525,7 @@ void TraceMonkeyValue::debugPrint()
     {
         printJSVAL(value);
     } else {
-        Logging::log(Logging::DEBUG, "TraceMonkeyValue::debugPrint: inValidated value\r\n");
+        LOG(DEBUG, "TraceMonkeyValue::debugPrint: inValidated value\r\n");
     }
 }
 
@@ -534,9 +534,9 @@ void TraceMonkeyValue::debugPrint()
 
 void reportError(JSContext *context, const char *message, JSErrorReport *report)
 {
-    Logging::log(Logging::WARNING, "TraceMonkey error:\r\n");
+    LOG(WARNING, "TraceMonkey error:\r\n");
 
-    Logging::log(Logging::WARNING, "%s:%u:%s      Code: %s\r\n",
+    LOG(WARNING, "%s:%u:%s      Code: %s\r\n",
             report->filename ? report->filename : "<no filename>",
             (unsigned int) report->lineno,
             message,
@@ -567,7 +567,7 @@ ScriptValuePtr globalValue;
 
 void TraceMonkeyEngine::init()
 {
-    Logging::log(Logging::DEBUG, "TraceMonkeyEngine::init\r\n");
+    LOG(DEBUG, "TraceMonkeyEngine::init\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     assert(runtime == NULL);
@@ -575,7 +575,7 @@ void TraceMonkeyEngine::init()
     runtime = JS_NewRuntime(8L * 1024L * 1024L); // Force GC after X MB.
     if (runtime == NULL)
     {
-        Logging::log(Logging::ERROR, "Cannot create TraceMonkey runtime\r\n");
+        LOG(ERROR, "Cannot create TraceMonkey runtime\r\n");
         assert(0);
     }
 
@@ -583,7 +583,7 @@ void TraceMonkeyEngine::init()
     context = JS_NewContext(runtime, 8192);
     if (context == NULL)
     {
-        Logging::log(Logging::ERROR, "Cannot create TraceMonkey runtime\r\n");
+        LOG(ERROR, "Cannot create TraceMonkey runtime\r\n");
         assert(0);
     }
 
@@ -595,7 +595,7 @@ void TraceMonkeyEngine::init()
     JSObject* _global = JS_NewObject(context, &global_class, NULL, NULL);
     if (_global == NULL)
     {
-        Logging::log(Logging::ERROR, "Cannot create TraceMonkey runtime\r\n");
+        LOG(ERROR, "Cannot create TraceMonkey runtime\r\n");
         assert(0);
     }
 
@@ -603,7 +603,7 @@ void TraceMonkeyEngine::init()
        like Object and Array. */
     if (!JS_InitStandardClasses(context, _global))
     {
-        Logging::log(Logging::ERROR, "Cannot create TraceMonkey runtime\r\n");
+        LOG(ERROR, "Cannot create TraceMonkey runtime\r\n");
         assert(0);
     }
 
@@ -628,7 +628,7 @@ void TraceMonkeyEngine::init()
 
 void TraceMonkeyEngine::quit()
 {
-    Logging::log(Logging::DEBUG, "TraceMonkeyEngine::quit\r\n");
+    LOG(DEBUG, "TraceMonkeyEngine::quit\r\n");
 
     // Clean up our internal wrappers
 
@@ -697,7 +697,7 @@ ScriptValuePtr TraceMonkeyEngine::getGlobal()
 {
     assert(globalValue.get());
 
-    Logging::log(Logging::DEBUG, "TME::getGlobal\r\n");
+    LOG(DEBUG, "TME::getGlobal\r\n");
 //    ((TraceMonkeyValue*)(globalValue.get()))->debugPrint();
 
     return globalValue;
@@ -746,7 +746,7 @@ LogicEntityPtr TraceMonkeyEngine::getCLogicEntity(JSObject* scriptingEntity)
     int uniqueId = JSVAL_TO_INT(temp);
     LogicEntityPtr ret = LogicSystem::getLogicEntity(uniqueId);
 
-    Logging::log(Logging::DEBUG, "TraceMonkey getting the CLE for UID %d\r\n", uniqueId);
+    LOG(DEBUG, "TraceMonkey getting the CLE for UID %d\r\n", uniqueId);
 
     assert(ret.get());
 
@@ -78,7 +78,7 @@ public:
 #define TRACEMONKEY_FUNC_GEN(new_func, arguments_def, arguments_conv, wrapped_code) \
 JSBool new_func(JSContext *cx, JSObject *obj, uintN argc, jsval *argv, jsval *rval) \
 { \
-    Logging::log(Logging::INFO, "TMF: %s\r\n", #new_func); \
+    LOG(INFO, "TMF: %s\r\n", #new_func); \
     *rval = JSVAL_VOID; /* If not changed later, do not return anything */ \
     arguments_def; \
  \
@@ -281,7 +281,7 @@ JSBool new_func(JSContext *cx, JSObject *obj, uintN argc, jsval *argv, jsval *rv
 // Wrap a function with a JSObject interpreted as "this", converted into a LogicEntityPtr, and some other parameters
 #define TRACEMONKEY_FUNC_T(new_func, type_codes, wrapped_code) \
     TRACEMONKEY_FUNC_o##type_codes(new_func, { \
-        Logging::log(Logging::INFO, "TMF_T: %s\r\n", #new_func); \
+        LOG(INFO, "TMF_T: %s\r\n", #new_func); \
         LogicEntityPtr self = TraceMonkeyEngine::getCLogicEntity(arg1); \
         assert(self.get()); \
         wrapped_code; \
@@ -290,7 +290,7 @@ JSBool new_func(JSContext *cx, JSObject *obj, uintN argc, jsval *argv, jsval *rv
 // Wrap a function with a JSObject interpreted as "this", converted into a ScriptValuePtr, and some other parameters
 #define TRACEMONKEY_FUNC_Z(new_func, type_codes, wrapped_code) \
     TRACEMONKEY_FUNC_o##type_codes(new_func, { \
-        Logging::log(Logging::INFO, "TMF_Z: %s\r\n", #new_func); \
+        LOG(INFO, "TMF_Z: %s\r\n", #new_func); \
         ScriptValuePtr self(new TraceMonkeyValue(ScriptEngineManager::getEngine(), true, OBJECT_TO_JSVAL(arg1))); \
         wrapped_code; \
     });
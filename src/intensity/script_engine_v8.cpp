@@ -2,6 +2,8 @@
 // Copyright 2010 Alon Zakai ('kripken'). All rights reserved.
 // This file is part of Syntensity/the Intensity Engine, an open source project. See COPYING.txt for licensing.
 
+#include <boost/smart_ptr/make_shared.hpp>
+
 #include "cube.h"
 #include "engine.h"
 #include "game.h"
@@ -53,21 +55,21 @@ void printV8Value(Handle<Value> value, bool force=false)
 
 void handleException(TryCatch& tc)
 {
-    Logging::log(Logging::ERROR, "V8 exception:\r\n");
+    LOG(ERROR, "V8 exception:\r\n");
 
     HandleScope handleScope;
 
     Handle<Object> exception = tc.Exception()->ToObject();
     String::AsciiValue exception_str(exception);
 
-    Logging::log(Logging::ERROR, "            : %s\r\n", *exception_str);
+    LOG(ERROR, "            : %s\r\n", *exception_str);
 
 /*
     Handle<Array> names = exception->GetPropertyNames();
     for (unsigned int i = 0; i < names->Length(); i++)
     {
         std::string strI = Utility::toString((int)i);
-        Logging::log(Logging::ERROR, "    %d : %s : %s\r\n", i,
+        LOG(ERROR, "    %d : %s : %s\r\n", i,
             *(v8::String::Utf8Value(names->Get(String::New(strI.c_str()))->ToString())),
             *(v8::String::Utf8Value(exception->Get(names->Get(String::New(strI.c_str()))->ToString())->ToString()))
         );
@@ -76,19 +78,19 @@ void handleException(TryCatch& tc)
 
     Local<Message> message = tc.Message();
 
-    Logging::log(Logging::ERROR, "Message: Get: %s\r\n", *(v8::String::Utf8Value( message->Get() )));
-    Logging::log(Logging::ERROR, "Message: GetSourceLine: %s\r\n", *(v8::String::Utf8Value( message->GetSourceLine() )));
-    Logging::log(Logging::ERROR, "Message: GetScriptResourceName: %s\r\n", *(v8::String::Utf8Value( message->GetScriptResourceName()->ToString() )));
-    Logging::log(Logging::ERROR, "Message: GetLineNumber: %d\r\n", message->GetLineNumber() );
+    LOG(ERROR, "Message: Get: %s\r\n", *(v8::String::Utf8Value( message->Get() )));
+    LOG(ERROR, "Message: GetSourceLine: %s\r\n", *(v8::String::Utf8Value( message->GetSourceLine() )));
+    LOG(ERROR, "Message: GetScriptResourceName: %s\r\n", *(v8::String::Utf8Value( message->GetScriptResourceName()->ToString() )));
+    LOG(ERROR, "Message: GetLineNumber: %d\r\n", message->GetLineNumber() );
 
     Local<Value> stackTrace = tc.StackTrace();
     if (!stackTrace.IsEmpty())
     {
-        Logging::log(Logging::ERROR, "Stack trace: %s\r\n", *(v8::String::Utf8Value( stackTrace->ToString() )));
+        LOG(ERROR, "Stack trace: %s\r\n", *(v8::String::Utf8Value( stackTrace->ToString() )));
         printf("\r\n\r\n^Stack trace^: %s\r\n", *(v8::String::Utf8Value( stackTrace->ToString() )));
     }
     else
-        Logging::log(Logging::ERROR, "No stack trace available in C++ handler (see above for possible in-script stack trace)\r\n");
+        LOG(ERROR, "No stack trace available in C++ handler (see above for possible in-script stack trace)\r\n");
 
     #ifdef SERVER
         std::string clientMessage = *(v8::String::Utf8Value( message->Get() ));
@@ -104,127 +106,169 @@ void handleException(TryCatch& tc)
 
 ///////// Values
 
-int __nameCounter = 0;
-
-V8Value::V8Value(ScriptEngine* _engine) : ScriptValue(_engine)
+//! Very many short-lived V8Values are created, e.g. for each argument of each native function call, so
+//! they are allocated, together with their shared_ptr reference counts (see allocate_shared), from free
+//! lists. Memory is kept for reuse, so this never holds more than the peak number of live values.
+//! Values are only created and destroyed on the main thread.
+template<class T> struct V8ValueAllocator
 {
-    value = Persistent<Value>::New(Null());
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
 
-    debugName = "NULL value no. " + Utility::toString(__nameCounter);
+    template<class U> struct rebind { typedef V8ValueAllocator<U> other; };
 
-    Logging::log(Logging::INFO, "Going to create a V8 value of: %s\r\n", debugName.c_str());
-    INDENT_LOG(Logging::INFO);
+    V8ValueAllocator() { };
+    template<class U> V8ValueAllocator(const V8ValueAllocator<U>& other) { };
 
-    printV8Value(value);
+    static void *freeList; //!< Each free block begins with a pointer to the next
 
-    Logging::log(Logging::INFO, "Created a V8 value of: %s\r\n", debugName.c_str());
+    pointer allocate(size_type n, const void *hint = 0)
+    {
+        if (n != 1 || !freeList)
+            return (pointer)::operator new(n * max(sizeof(T), sizeof(void*)));
 
-    __nameCounter += 1;
-}
+        void *ret = freeList;
+        freeList = *(void**)freeList;
+        return (pointer)ret;
+    }
 
-V8Value::V8Value(ScriptEngine* _engine, int _value) : ScriptValue(_engine)
-{
-    debugName = "int value no. " + Utility::toString(__nameCounter);
+    void deallocate(pointer p, size_type n)
+    {
+        if (n != 1)
+        {
+            ::operator delete(p);
+            return;
+        }
+
+        *(void**)p = freeList;
+        freeList = p;
+    }
 
-    Logging::log(Logging::INFO, "Going to create a V8 value of: %s\r\n", debugName.c_str());
-    INDENT_LOG(Logging::INFO);
+    void construct(pointer p, const T& value) { new(p) T(value); };
+    void destroy(pointer p) { p->~T(); };
 
-    value = Persistent<Value>::New(Integer::New(_value));
+    size_type max_size() const { return size_type(-1) / sizeof(T); };
 
-    printV8Value(value);
+    template<class U> bool operator==(const V8ValueAllocator<U>& other) const { return true; };
+    template<class U> bool operator!=(const V8ValueAllocator<U>& other) const { return false; };
+};
 
-    Logging::log(Logging::INFO, "Created a V8 value of: %s\r\n", debugName.c_str());
+template<class T> void *V8ValueAllocator<T>::freeList = NULL;
 
-    __nameCounter += 1;
+ScriptValuePtr V8Value::create(ScriptEngine* _engine)
+{
+    return boost::allocate_shared<V8Value>(V8ValueAllocator<V8Value>(), _engine);
 }
 
-V8Value::V8Value(ScriptEngine* _engine, double _value) : ScriptValue(_engine)
+ScriptValuePtr V8Value::create(ScriptEngine* _engine, Handle<Value> _value)
 {
-    debugName = "double value no. " + Utility::toString(__nameCounter);
+    return boost::allocate_shared<V8Value>(V8ValueAllocator<V8Value>(), _engine, _value);
+}
 
-    Logging::log(Logging::INFO, "Going to create a V8 value of: %s\r\n", debugName.c_str());
-    INDENT_LOG(Logging::INFO);
+#ifdef _DEBUG
+    int __nameCounter = 0;
 
-    value = Persistent<Value>::New(Number::New(_value));
+    #define SET_DEBUG_NAME(prefix) \
+        debugName = prefix " value no. " + Utility::toString(__nameCounter); \
+        __nameCounter += 1;
 
-    printV8Value(value);
+    #define DEBUG_NAME debugName.c_str()
+#else
+    #define SET_DEBUG_NAME(prefix)
+    #define DEBUG_NAME "?"
+#endif
+
+V8Value::V8Value(ScriptEngine* _engine) : ScriptValue(_engine)
+{
+    SET_DEBUG_NAME("NULL");
+
+    value = Persistent<Value>::New(Null());
 
-    Logging::log(Logging::INFO, "Created a V8 value of: %s\r\n", debugName.c_str());
+    printV8Value(value);
 
-    __nameCounter += 1;
+    LOG(INFO, "Created a V8 value of: %s\r\n", DEBUG_NAME);
 }
 
-V8Value::V8Value(ScriptEngine* _engine, Handle<Value> _value) : ScriptValue(_engine)
+V8Value::V8Value(ScriptEngine* _engine, int _value) : ScriptValue(_engine)
 {
-    debugName = "Handle<Value> value no. " + Utility::toString(__nameCounter);
-
-    Logging::log(Logging::INFO, "Going to create a V8 reference: %s\r\n", debugName.c_str());
-    INDENT_LOG(Logging::INFO);
+    SET_DEBUG_NAME("int");
 
-    value = Persistent<Value>::New(_value);
+    value = Persistent<Value>::New(Integer::New(_value));
 
     printV8Value(value);
 
-    Logging::log(Logging::INFO, "Created a V8 reference: %s\r\n", debugName.c_str());
-
-    __nameCounter += 1;
+    LOG(INFO, "Created a V8 value of: %s\r\n", DEBUG_NAME);
 }
 
-/*
-V8Value::V8Value(std::string _value) : ScriptValue(_engine)
+V8Value::V8Value(ScriptEngine* _engine, double _value) : ScriptValue(_engine)
 {
-    debugName = "int value no. " + Utility::toString(__nameCounter);
-
-    Logging::log(Logging::INFO, "Going to create a V8 value of: %s\r\n", debugName.c_str());
-    INDENT_LOG(Logging::INFO);
+    SET_DEBUG_NAME("double");
 
-    value = String::New(_value);
+    value = Persistent<Value>::New(Number::New(_value));
 
     printV8Value(value);
 
-    Logging::log(Logging::INFO, "Created a V8 value of: %s\r\n", debugName.c_str());
+    LOG(INFO, "Created a V8 value of: %s\r\n", DEBUG_NAME);
+}
+
+V8Value::V8Value(ScriptEngine* _engine, Handle<Value> _value) : ScriptValue(_engine)
+{
+    SET_DEBUG_NAME("Handle<Value>");
+
+    value = Persistent<Value>::New(_value);
 
-    __nameCounter += 1;
+    printV8Value(value);
+
+    LOG(INFO, "Created a V8 reference: %s\r\n", DEBUG_NAME);
 }
-*/
 
 V8Value::~V8Value()
 {
-    Logging::log(Logging::INFO, "~V8Value\r\n");
-
-    Logging::log(Logging::INFO, "Removing V8 handle for %s\r\n", debugName.c_str());
+    LOG(INFO, "Removing V8 handle for %s\r\n", DEBUG_NAME);
 
 //    if (value != Null()) XXX?
     value.Dispose();
 }
 
-void V8Value::setProperty(std::string propertyName, ScriptValuePtr propertyValue)
+// Temporary values, such as arguments to call() and properties read by getPropertyInt(), are used
+// as Local handles in the caller's HandleScope, and are never made into (persistent) V8Values.
+// A V8Value is created only when a ScriptValuePtr is returned, as the caller might keep it.
+
+void V8Value::setProperty(std::string propertyName, Handle<Value> propertyValue)
 {
     assert(isValid());
     assert(value->IsObject() && !value->IsNull());
 
-    HandleScope handleScope;
+    value->ToObject()->Set(String::New(propertyName.c_str()), propertyValue);
+}
 
-    Handle<Object> obj = value->ToObject();
-    obj->Set(String::New(propertyName.c_str()), dynamic_cast<V8Value*>(propertyValue.get())->value);
+void V8Value::setProperty(std::string propertyName, ScriptValuePtr propertyValue)
+{
+    HandleScope handleScope;
+    setProperty(propertyName, dynamic_cast<V8Value*>(propertyValue.get())->value);
 }
 
 void V8Value::setProperty(std::string propertyName, int propertyValue)
 {
     HandleScope handleScope;
-    setProperty(propertyName, ScriptValuePtr(new V8Value(engine, Integer::New(propertyValue))));
+    setProperty(propertyName, Integer::New(propertyValue));
 }
 
 void V8Value::setProperty(std::string propertyName, double propertyValue)
 {
     HandleScope handleScope;
-    setProperty(propertyName, ScriptValuePtr(new V8Value(engine, Number::New(propertyValue))));
+    setProperty(propertyName, Number::New(propertyValue));
 }
 
 void V8Value::setProperty(std::string propertyName, std::string propertyValue)
 {
     HandleScope handleScope;
-    setProperty(propertyName, ScriptValuePtr(new V8Value(engine, String::New(propertyValue.c_str()))));
+    setProperty(propertyName, String::New(propertyValue.c_str()));
 }
 
 bool V8Value::hasProperty(std::string propertyName)
@@ -238,45 +282,47 @@ bool V8Value::hasProperty(std::string propertyName)
                                                    // (we can't return 'Null' there - so this is for both undefined and null)
 }
 
+Local<Value> V8Value::getPropertyLocal(std::string propertyName)
+{
+    return value->ToObject()->Get(String::New(propertyName.c_str()));
+}
+
 ScriptValuePtr V8Value::getProperty(std::string propertyName)
 {
     HandleScope handleScope;
-    Local<Object> obj = value->ToObject();
-    Local<Value> propertyValue = obj->Get(String::New(propertyName.c_str()));
-
-    return ScriptValuePtr(new V8Value(engine, propertyValue));
+    return create(engine, getPropertyLocal(propertyName));
 }
 
-#define ASSERT_VALID_PROPERTY assert(!(dynamic_cast<V8Value*>(getProperty(propertyName).get())->value->IsNull()) && !(dynamic_cast<V8Value*>(getProperty(propertyName).get())->value->IsUndefined()));
+#define GET_VALID_PROPERTY \
+    Local<Value> propertyValue = getPropertyLocal(propertyName); \
+    assert(!propertyValue->IsNull() && !propertyValue->IsUndefined());
 
 int V8Value::getPropertyInt(std::string propertyName)
 {
     HandleScope handleScope;
-    ASSERT_VALID_PROPERTY
-    return dynamic_cast<V8Value*>(getProperty(propertyName).get())->value->IntegerValue();
+    GET_VALID_PROPERTY
+    return propertyValue->IntegerValue();
 }
 
 bool V8Value::getPropertyBool(std::string propertyName)
 {
     HandleScope handleScope;
-    ASSERT_VALID_PROPERTY
-    return dynamic_cast<V8Value*>(getProperty(propertyName).get())->value->BooleanValue();
+    GET_VALID_PROPERTY
+    return propertyValue->BooleanValue();
 }
 
 double V8Value::getPropertyFloat(std::string propertyName)
 {
-//printf("getPropertyFloat: %s\r\n", propertyName.c_str()); // collisionRadiusWidth ?
     HandleScope handleScope;
-    ASSERT_VALID_PROPERTY
-    return dynamic_cast<V8Value*>(getProperty(propertyName).get())->value->NumberValue();
+    GET_VALID_PROPERTY
+    return propertyValue->NumberValue();
 }
 
 std::string V8Value::getPropertyString(std::string propertyName)
 {
     HandleScope handleScope;
-    ASSERT_VALID_PROPERTY
-    V8Value *temp = dynamic_cast<V8Value*>(getProperty(propertyName).get());
-    std::string ret = *(v8::String::Utf8Value(temp->value->ToString()));
+    GET_VALID_PROPERTY
+    std::string ret = *(v8::String::Utf8Value(propertyValue->ToString()));
     return ret;
 }
 
@@ -313,55 +359,59 @@ std::string V8Value::getString()
 
 ScriptValuePtr V8Value::call(std::string funcName)
 {
-    assert(isValid());
-
-    Logging::log(Logging::INFO, "V8V::call(%s)\r\n", funcName.c_str());
-
-    ScriptValueArgs args;
-    return call(funcName, args);
+    HandleScope handleScope;
+    return call(funcName, 0, NULL);
 }
 
 ScriptValuePtr V8Value::call(std::string funcName, ScriptValuePtr arg1)
 {
-    assert(isValid());
-
-    Logging::log(Logging::INFO, "V8V::call(%s (SV))\r\n", funcName.c_str());
-
-    return call(funcName, ScriptValueArgs().append(arg1));
+    HandleScope handleScope;
+    Handle<Value> v8Args[1] = { dynamic_cast<V8Value*>(arg1.get())->value };
+    return call(funcName, 1, v8Args);
 }
 
 ScriptValuePtr V8Value::call(std::string funcName, int arg1)
 {
-    assert(isValid());
-
-    Logging::log(Logging::INFO, "V8V::call(%s, int)\r\n", funcName.c_str());
-
-    return call(funcName, ScriptValueArgs().append(arg1));
+    HandleScope handleScope;
+    Handle<Value> v8Args[1] = { Integer::New(arg1) };
+    return call(funcName, 1, v8Args);
 }
 
 ScriptValuePtr V8Value::call(std::string funcName, double arg1)
 {
-    assert(isValid());
-
-    Logging::log(Logging::INFO, "V8V::call(%s, double)\r\n", funcName.c_str());
-
-    return call(funcName, ScriptValueArgs().append(arg1));
+    HandleScope handleScope;
+    Handle<Value> v8Args[1] = { Number::New(arg1) };
+    return call(funcName, 1, v8Args);
 }
 
 ScriptValuePtr V8Value::call(std::string funcName, std::string arg1)
 {
-    assert(isValid());
-
-    return call(funcName, ScriptValueArgs().append(arg1));
+    HandleScope handleScope;
+    Handle<Value> v8Args[1] = { String::New(arg1.c_str()) };
+    return call(funcName, 1, v8Args);
 }
 
 ScriptValuePtr V8Value::call(std::string funcName, ScriptValueArgs& args)
 {
     HandleScope handleScope;
 
+    int numArgs = args.args.size();
+    Handle<Value>* v8Args = new Handle<Value>[numArgs+1]; // +1 for safety in case of 0 args
+    for (int i = 0; i < numArgs; i++)
+    {
+        v8Args[i] = (dynamic_cast<V8Value*>(args.args[i].get()))->value;
+    }
+
+    ScriptValuePtr ret = call(funcName, numArgs, v8Args);
+    delete[] v8Args;
+    return ret;
+}
+
+ScriptValuePtr V8Value::call(std::string funcName, int numArgs, Handle<Value>* v8Args)
+{
     assert(isValid());
 
-    Logging::log(Logging::INFO, "V8V::call(%s, (%d))\r\n", funcName.c_str(), args.args.size());
+    LOG(INFO, "V8V::call(%s, (%d))\r\n", funcName.c_str(), numArgs);
 
     printV8Value(value);
 
@@ -374,24 +424,56 @@ ScriptValuePtr V8Value::call(std::string funcName, ScriptValueArgs& args)
 
     Local<Function> func = Function::Cast(*_func);
 
-    int numArgs = args.args.size();
-    Handle<Value>* v8Args = new Handle<Value>[numArgs+1]; // +1 for safety in case of 0 args
-    for (int i = 0; i < numArgs; i++)
-    {
-        v8Args[i] = (dynamic_cast<V8Value*>(args.args[i].get()))->value;
-    }
-
     TryCatch tc;
     Handle<Value> ret = func->Call(obj, numArgs, v8Args);
-    delete[] v8Args;
     if (ret.IsEmpty())
         handleException(tc);
 
-    Logging::log(Logging::INFO, "returning: \r\n"); printV8Value(ret);
+    LOG(INFO, "returning: \r\n"); printV8Value(ret);
+
+    return create(engine, ret);
+}
+
+ScriptValuePtr V8Value::callPath(std::vector<ScriptValuePtr>& keys, ScriptArgs& args)
+{
+    HandleScope handleScope;
+
+    assert(isValid());
+    assert(!keys.empty());
+
+    LOG(INFO, "V8V::callPath(%d)\r\n", args.numArgs);
+
+    Local<Object> obj;
+    Handle<Value> current = value;
+    for (unsigned int i = 0; i < keys.size(); i++)
+    {
+        assert(current->IsObject() && !current->IsNull());
+        obj = current->ToObject();
+        current = obj->Get(dynamic_cast<V8Value*>(keys[i].get())->value);
+    }
 
-    ScriptValuePtr retValue(new V8Value(engine, ret));
+    assert(current->IsFunction());
+    Handle<Function> func = Handle<Function>::Cast(current);
 
-    return retValue;
+    Handle<Value> v8Args[ScriptArgs::MAX_ARGS];
+    for (int i = 0; i < args.numArgs; i++)
+    {
+        ScriptArgs::Arg& arg = args.args[i];
+        switch (arg.type)
+        {
+            case ScriptArgs::INT: v8Args[i] = Integer::New(arg.intValue); break;
+            case ScriptArgs::DOUBLE: v8Args[i] = Number::New(arg.doubleValue); break;
+            case ScriptArgs::STRING: v8Args[i] = String::New(arg.stringValue->c_str(), arg.stringValue->size()); break;
+            case ScriptArgs::VALUE: v8Args[i] = dynamic_cast<V8Value*>(arg.value)->value; break;
+        }
+    }
+
+    TryCatch tc;
+    Handle<Value> ret = func->Call(obj, args.numArgs, v8Args);
+    if (ret.IsEmpty())
+        handleException(tc);
+
+    return create(engine, ret);
 }
 
 bool V8Value::compare(ScriptValuePtr other)
@@ -402,13 +484,26 @@ bool V8Value::compare(ScriptValuePtr other)
     return value->StrictEquals( (dynamic_cast<V8Value*>(other.get()))->value );
 }
 
+void V8Value::bindLogicEntity(CLogicEntity* entity)
+{
+    HandleScope handleScope;
+
+    assert(value->IsObject());
+    Local<Object> object = value->ToObject();
+
+    if (entity)
+        object->SetHiddenValue(V8Engine::logicEntityKey, External::Wrap(entity));
+    else
+        object->DeleteHiddenValue(V8Engine::logicEntityKey);
+}
+
 void V8Value::debugPrint()
 {
     if (isValid())
     {
         printV8Value(value);
     } else {
-        Logging::log(Logging::DEBUG, "V8Value::debugPrint: inValidated value\r\n");
+        LOG(DEBUG, "V8Value::debugPrint: inValidated value\r\n");
     }
 }
 
@@ -464,6 +559,8 @@ void debuggerListener(DebugEvent event,
 
 Persistent<Context> V8Engine::context;
 
+Persistent<String> V8Engine::logicEntityKey;
+
 // Globals
 
 //Persistent<ObjectTemplate> _global;
@@ -473,27 +570,29 @@ ScriptValuePtr globalValue;
 
 void V8Engine::init()
 {
-    Logging::log(Logging::DEBUG, "V8Engine::init:\r\n");
+    LOG(DEBUG, "V8Engine::init:\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     HandleScope handleScope;
 
     // Create a template for the global object.
-    Logging::log(Logging::DEBUG, "Creating global\r\n");
+    LOG(DEBUG, "Creating global\r\n");
 
 //    _global = ObjectTemplate::New();
 
-    Logging::log(Logging::DEBUG, "Creating context\r\n");
+    LOG(DEBUG, "Creating context\r\n");
 
     context = Context::New(); //NULL, _global);
 
     context->Enter();
 
+    logicEntityKey = Persistent<String>::New(String::New("__CLogicEntity"));
+
     // Create our internal wrappers
 
-    Logging::log(Logging::DEBUG, "Creating wrapper for global\r\n");
+    LOG(DEBUG, "Creating wrapper for global\r\n");
 
-    globalValue = ScriptValuePtr(new V8Value(this, context->Global()));
+    globalValue = V8Value::create(this, context->Global());
 
 #if 0
     // Setup debugger, if required - XXX Doesn't work
@@ -527,26 +626,29 @@ void V8Engine::init()
 assert(0);
 #endif
 
-    Logging::log(Logging::DEBUG, "V8Engine::init complete.\r\n");
+    LOG(DEBUG, "V8Engine::init complete.\r\n");
 }
 
 void V8Engine::quit()
 {
-    Logging::log(Logging::DEBUG, "V8Engine::quit (0)\r\n");
+    LOG(DEBUG, "V8Engine::quit (0)\r\n");
 
     // Clean up our globals
 
     globalValue.reset();
 
-    Logging::log(Logging::DEBUG, "V8Engine::quit (1)\r\n");
+    LOG(DEBUG, "V8Engine::quit (1)\r\n");
 
     context->Exit();
 
-    Logging::log(Logging::DEBUG, "V8Engine::quit (2)\r\n");
+    LOG(DEBUG, "V8Engine::quit (2)\r\n");
 
     context.Dispose();
 
-    Logging::log(Logging::DEBUG, "V8Engine::quit (3)\r\n");
+    logicEntityKey.Dispose();
+    logicEntityKey.Clear();
+
+    LOG(DEBUG, "V8Engine::quit (3)\r\n");
 }
 
 ScriptValuePtr V8Engine::createObject()
@@ -555,7 +657,7 @@ ScriptValuePtr V8Engine::createObject()
 
     Local<Value> ret = Object::New();
 
-    return ScriptValuePtr( new V8Value(this, ret) );
+    return V8Value::create(this, ret);
 }
 
 ScriptValuePtr V8Engine::createFunction(NativeFunction func, int numArgs)
@@ -567,7 +669,7 @@ ScriptValuePtr V8Engine::createFunction(NativeFunction func, int numArgs)
 
     Local<Function> v8Func = t->GetFunction();
 
-    return ScriptValuePtr( new V8Value(this, v8Func) );
+    return V8Value::create(this, v8Func);
 }
 
 ScriptValuePtr V8Engine::createScriptValue(int value)
@@ -576,7 +678,7 @@ ScriptValuePtr V8Engine::createScriptValue(int value)
 
     Local<Value> ret = Integer::New(value);
 
-    return ScriptValuePtr( new V8Value(this, ret) );
+    return V8Value::create(this, ret);
 }
 
 ScriptValuePtr V8Engine::createScriptValue(double value)
@@ -585,7 +687,7 @@ ScriptValuePtr V8Engine::createScriptValue(double value)
 
     Local<Value> ret = Number::New(value);
 
-    return ScriptValuePtr( new V8Value(this, ret) );
+    return V8Value::create(this, ret);
 }
 
 ScriptValuePtr V8Engine::createScriptValue(std::string value)
@@ -594,14 +696,14 @@ ScriptValuePtr V8Engine::createScriptValue(std::string value)
 
     Local<Value> ret = String::New(value.c_str());
 
-    return ScriptValuePtr( new V8Value(this, ret) );
+    return V8Value::create(this, ret);
 }
 
 ScriptValuePtr V8Engine::getGlobal()
 {
     assert(globalValue.get());
 
-    Logging::log(Logging::INFO, "V8E::getGlobal\r\n");
+    LOG(INFO, "V8E::getGlobal\r\n");
 //    ((V8Value*)(globalValue.get()))->debugPrint();
 
     return globalValue;
@@ -609,7 +711,7 @@ ScriptValuePtr V8Engine::getGlobal()
 
 ScriptValuePtr V8Engine::getNull()
 {
-    return ScriptValuePtr( new V8Value(this) );
+    return V8Value::create(this);
 }
 
 ScriptValuePtr V8Engine::runScript(std::string script, std::string identifier)
@@ -635,7 +737,7 @@ ScriptValuePtr V8Engine::runScript(std::string script, std::string identifier)
     if (result.IsEmpty())
         handleException(tc);
 
-    return ScriptValuePtr( new V8Value(this, result) );
+    return V8Value::create(this, result);
 }
 
 std::string V8Engine::compileScript(std::string script)
@@ -673,31 +775,18 @@ std::string V8Engine::compileScript(std::string script)
 
 LogicEntityPtr V8Engine::getCLogicEntity(Handle<Object> scriptingEntity)
 {
-////                static Benchmarker benchmarker;
-////                benchmarker.start();
-    LogicEntityPtr ret;
-
-//  for (int i = 0; i < 10; i++) // For speed testing/profiling - simple way to see how much effect this has, by worsening it
-  { 
-    // We do this in a slow but sure manner: read the uniqueId from JS,
-    // and look up the entity using that. In the future, speed this up
-    // using private data or some other method
-
-    int uniqueId = scriptingEntity->Get(String::New("uniqueId"))->IntegerValue();
-
-    ret = LogicSystem::getLogicEntity(uniqueId);
+    // The CLE is bound to the entity when it is registered, and unbound when it is unregistered,
+    // so there is no need to read the uniqueId from JS and look up the entity by it
+    Local<Value> bound = scriptingEntity->GetHiddenValue(logicEntityKey);
 
-    Logging::log(Logging::INFO, "V8 getting the CLE for UID %d\r\n", uniqueId);
-
-////                benchmarker.stop();
-////                SystemManager::showBenchmark("        ---V8lookup---", benchmarker);
-
-    if (!ret.get())
+    if (bound.IsEmpty())
     {
-        Logging::log(Logging::ERROR, "Cannot find CLE for entity %d\r\n", uniqueId);
+        LOG(ERROR, "Cannot find CLE for entity %d\r\n", int(scriptingEntity->Get(String::New("uniqueId"))->IntegerValue()));
         printV8Value(scriptingEntity, true);
+        return LogicEntityPtr();
     }
-  }
-    return ret;
+
+    CLogicEntity* entity = (CLogicEntity*)External::Unwrap(bound);
+    return LogicSystem::logicEntities.find(entity->uniqueId);
 }
 
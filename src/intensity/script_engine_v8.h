@@ -10,7 +10,13 @@ class V8Value : public ScriptValue
 {
 public:
     Persistent<Value> value;
+#ifdef _DEBUG
     std::string debugName;
+#endif
+
+    //! Use these to create values, rather than new, as they allocate from pools (see V8ValueAllocator)
+    static ScriptValuePtr create(ScriptEngine* _engine);
+    static ScriptValuePtr create(ScriptEngine* _engine, Handle<Value> _value);
 
     V8Value(ScriptEngine* _engine);
     V8Value(ScriptEngine* _engine, int _value);
@@ -45,9 +51,18 @@ public:
     virtual ScriptValuePtr call(std::string funcName, std::string arg1);
     virtual ScriptValuePtr call(std::string funcName, ScriptValueArgs& args);
 
+    virtual ScriptValuePtr callPath(std::vector<ScriptValuePtr>& keys, ScriptArgs& args);
+
     virtual bool compare(ScriptValuePtr other);
 
+    virtual void bindLogicEntity(CLogicEntity* entity);
+
     virtual void debugPrint();
+
+private:
+    void setProperty(std::string propertyName, Handle<Value> propertyValue);
+    Local<Value> getPropertyLocal(std::string propertyName);
+    ScriptValuePtr call(std::string funcName, int numArgs, Handle<Value>* v8Args);
 };
 
 class V8Engine : public ScriptEngine
@@ -55,6 +70,9 @@ class V8Engine : public ScriptEngine
 public:
     static Persistent<Context> context;
 
+    //! The key of the hidden value in which entities' CLogicEntity pointers are bound (see bindLogicEntity)
+    static Persistent<String> logicEntityKey;
+
     virtual void init();
     virtual void quit();
 
@@ -77,7 +95,7 @@ public:
 
 #define RAISE_SCRIPT_ERROR(text) \
     { \
-        Logging::log(Logging::ERROR, #text); \
+        LOG(ERROR, #text); \
         ScriptEngineManager::runScript("eval(assert(' false '))"); \
     }
 
@@ -88,7 +106,7 @@ public:
 #define V8_FUNC_GEN(new_func, arguments_def, wrapped_code) \
 v8::Handle<v8::Value> new_func(const v8::Arguments& args) \
 { \
-    Logging::log(Logging::INFO, "V8F: %s\r\n", #new_func); \
+    LOG(INFO, "V8F: %s\r\n", #new_func); \
     arguments_def; \
  \
     wrapped_code; \
@@ -109,11 +127,10 @@ v8::Handle<v8::Value> new_func(const v8::Arguments& args) \
 // Wrap a function with a Object interpreted as "this", converted into a LogicEntityPtr, and some other parameters
 #define V8_FUNC_T(new_func, type_codes, wrapped_code) \
     V8_FUNC_o##type_codes(new_func, { \
-        Logging::log(Logging::INFO, "V8F_T: %s\r\n", #new_func); \
         LogicEntityPtr self = V8Engine::getCLogicEntity(arg1); \
         if (!self.get()) \
         { \
-            Logging::log(Logging::ERROR, "Cannot find LE for entity - aborting %s\r\n", #new_func); \
+            LOG(ERROR, "Cannot find LE for entity - aborting %s\r\n", #new_func); \
             RAISE_SCRIPT_ERROR("Aborted."); \
         } \
         wrapped_code; \
@@ -122,8 +139,8 @@ v8::Handle<v8::Value> new_func(const v8::Arguments& args) \
 // Wrap a function with a Object interpreted as "this", converted into a ScriptValuePtr, and some other parameters
 #define V8_FUNC_Z(new_func, type_codes, wrapped_code) \
     V8_FUNC_o##type_codes(new_func, { \
-        Logging::log(Logging::INFO, "V8F_Z: %s\r\n", #new_func); \
-        ScriptValuePtr self(new V8Value(ScriptEngineManager::getEngine(), arg1)); \
+        LOG(INFO, "V8F_Z: %s\r\n", #new_func); \
+        ScriptValuePtr self = V8Value::create(ScriptEngineManager::getEngine(), arg1); \
         wrapped_code; \
     });
 
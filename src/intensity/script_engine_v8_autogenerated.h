@@ -43,6 +43,14 @@
         , wrapped_code);
 
 
+// io
+#define V8_FUNC_io(new_func, wrapped_code) \
+    V8_FUNC_GEN(new_func, \
+        int arg1 = args[0]->IntegerValue(); \
+        Handle<Object> arg2 = args[1]->ToObject(); \
+        , wrapped_code);
+
+
 // ss
 #define V8_FUNC_ss(new_func, wrapped_code) \
     V8_FUNC_GEN(new_func, \
@@ -99,6 +107,14 @@
         , wrapped_code);
 
 
+// oo
+#define V8_FUNC_oo(new_func, wrapped_code) \
+    V8_FUNC_GEN(new_func, \
+        Handle<Object> arg1 = args[0]->ToObject(); \
+        Handle<Object> arg2 = args[1]->ToObject(); \
+        , wrapped_code);
+
+
 // dd
 #define V8_FUNC_dd(new_func, wrapped_code) \
     V8_FUNC_GEN(new_func, \
@@ -282,6 +298,17 @@
         , wrapped_code);
 
 
+// dddds
+#define V8_FUNC_dddds(new_func, wrapped_code) \
+    V8_FUNC_GEN(new_func, \
+        double arg1 = args[0]->NumberValue(); if (ISNAN(arg1)) RAISE_SCRIPT_ERROR(isNAN failed on argument 0 in #new_func); \
+        double arg2 = args[1]->NumberValue(); if (ISNAN(arg2)) RAISE_SCRIPT_ERROR(isNAN failed on argument 1 in #new_func); \
+        double arg3 = args[2]->NumberValue(); if (ISNAN(arg3)) RAISE_SCRIPT_ERROR(isNAN failed on argument 2 in #new_func); \
+        double arg4 = args[3]->NumberValue(); if (ISNAN(arg4)) RAISE_SCRIPT_ERROR(isNAN failed on argument 3 in #new_func); \
+        std::string _arg5 = *(v8::String::Utf8Value(args[4])); const char* arg5 = _arg5.c_str(); \
+        , wrapped_code);
+
+
 // iiiss
 #define V8_FUNC_iiiss(new_func, wrapped_code) \
     V8_FUNC_GEN(new_func, \
@@ -449,6 +476,31 @@
         , wrapped_code);
 
 
+// iiivii
+#define V8_FUNC_iiivii(new_func, wrapped_code) \
+    V8_FUNC_GEN(new_func, \
+        int arg1 = args[0]->IntegerValue(); \
+        int arg2 = args[1]->IntegerValue(); \
+        int arg3 = args[2]->IntegerValue(); \
+        ScriptValuePtr arg4 = V8Value::create(ScriptEngineManager::getEngine(), args[3]); \
+        int arg5 = args[4]->IntegerValue(); \
+        int arg6 = args[5]->IntegerValue(); \
+        , wrapped_code);
+
+
+// dddddds
+#define V8_FUNC_dddddds(new_func, wrapped_code) \
+    V8_FUNC_GEN(new_func, \
+        double arg1 = args[0]->NumberValue(); if (ISNAN(arg1)) RAISE_SCRIPT_ERROR(isNAN failed on argument 0 in #new_func); \
+        double arg2 = args[1]->NumberValue(); if (ISNAN(arg2)) RAISE_SCRIPT_ERROR(isNAN failed on argument 1 in #new_func); \
+        double arg3 = args[2]->NumberValue(); if (ISNAN(arg3)) RAISE_SCRIPT_ERROR(isNAN failed on argument 2 in #new_func); \
+        double arg4 = args[3]->NumberValue(); if (ISNAN(arg4)) RAISE_SCRIPT_ERROR(isNAN failed on argument 3 in #new_func); \
+        double arg5 = args[4]->NumberValue(); if (ISNAN(arg5)) RAISE_SCRIPT_ERROR(isNAN failed on argument 4 in #new_func); \
+        double arg6 = args[5]->NumberValue(); if (ISNAN(arg6)) RAISE_SCRIPT_ERROR(isNAN failed on argument 5 in #new_func); \
+        std::string _arg7 = *(v8::String::Utf8Value(args[6])); const char* arg7 = _arg7.c_str(); \
+        , wrapped_code);
+
+
 // ddddddii
 #define V8_FUNC_ddddddii(new_func, wrapped_code) \
     V8_FUNC_GEN(new_func, \
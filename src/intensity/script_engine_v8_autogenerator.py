@@ -9,12 +9,12 @@ os.chdir(os.path.dirname(__file__))
 
 strings = [
     'i', 's', 'd', 'o',
-    'ii', 'is', 'ss', 'sd', 'si', 'oi', 'ob', 'os', 'od', 'dd', 'ds', 'do',
+    'ii', 'is', 'io', 'ss', 'sd', 'si', 'oi', 'ob', 'os', 'od', 'oo', 'dd', 'ds', 'do',
     'iis', 'iii', 'iid', 'ddd', 'sss',
     'oddd', 'dddd', 'iddd', 'iiss', 'iiis', 'ssdd', 'iiii',
-    'sdddi', 'sssdd', 'ddddi', 'sdddd', 'iiiss', 'iiisi', 'iiiii', 'idddd',
-    'dddddd', 'iidddi', 'iiiddd', 'ddddii', 'idddsi', 'ssiiid', 'ddddddd', 'iiiiddd', 'iiddddd', 'iiiiii',
-    'ddddddii', 'ddddiiid', 'ssiiidi', 'iidddddd', 'iiiiiii',
+    'sdddi', 'sssdd', 'ddddi', 'sdddd', 'dddds', 'iiiss', 'iiisi', 'iiiii', 'idddd',
+    'dddddd', 'iidddi', 'iiiddd', 'ddddii', 'idddsi', 'ssiiid', 'ddddddd', 'iiiiddd', 'iiddddd', 'iiiiii', 'iiivii',
+    'dddddds', 'ddddddii', 'ddddiiid', 'ssiiidi', 'iidddddd', 'iiiiiii',
     'ddddddiii', 'oidddiiii', 'idddidddi', 'dddsiiidi',
     'iiidddidii', 'ddddddiiid', 'osiddddddii',
     'iissdddiiii', 'iiddddddidi',
@@ -47,6 +47,9 @@ for string in strings:
             out.write('Handle<Object> arg%(indexplus)d = args[%(index)d]->ToObject(); \\\n' % temp)
         elif param == 'b':
             out.write('bool arg%(indexplus)d = args[%(index)d]->BooleanValue(); \\\n' % temp)
+        elif param == 'v':
+            # Any value, wrapped as is, for code that handles several types
+            out.write('ScriptValuePtr arg%(indexplus)d = V8Value::create(ScriptEngineManager::getEngine(), args[%(index)d]); \\\n' % temp)
         else:
             print 'Invalid parameter:', param
             assert(0)
@@ -34,12 +34,12 @@ assert(0);
 void ServerSystem::setMap(std::string name)
 {
     assert(0); // Do only in Python?
-    Logging::log(Logging::DEBUG, "Setting the map to %s\r\n", name.c_str());
+    LOG(DEBUG, "Setting the map to %s\r\n", name.c_str());
 
     FPSServerInterface::changeMap(name); // Whatever setup the fpsserver class needs
 
     // Load the map. We need the octa and mapmodels for NPC movements and so forth
-    Logging::log(Logging::DEBUG, "Loading world geometry, mapmodels, etc.\r\n");
+    LOG(DEBUG, "Loading world geometry, mapmodels, etc.\r\n");
     load_world(name.c_str());
 
     // Send the map to all connected clients
@@ -183,6 +183,173 @@ void send_text_message(int clientNumber, std::string text, bool sound)
         MessageSystem::send_SoundToClientsByName(clientNumber, 0, 0, 0, "olpc/FlavioGaete/Vla_G_Major", -1);
 }
 
+// Main loop
+
+static Utility::Config::Int tickRate("Network", "rate", 33);
+static Utility::Config::Int maxCatchupTicks("Network", "max_catchup_ticks", 0);
+
+// These are set from Python threads, which hold the GIL, as does the main loop when it reads them
+static bool mainLoopQuit = false;
+static bool mainActionsPending = true; // Actions may have been queued before the loop began
+
+extern void servicenetwork(uint timeout); // from server.cpp
+
+//! Runs something that touches the engine, holding the slicing lock, so that Python threads that
+//! take the lock to access the engine (e.g. the console) never run alongside it
+static void runLocked(boost::python::object& slicingLock, void (*func)())
+{
+    slicingLock.attr("acquire")();
+    try
+    {
+        func();
+    }
+    catch(...)
+    {
+        slicingLock.attr("release")();
+        throw;
+    }
+    slicingLock.attr("release")();
+}
+
+//! Handles the network events that have arrived, without waiting. Packets handled between ticks see
+//! the totalmillis/lastmillis of the previous slice, just as if they had waited for the next one
+static void serviceNetworkNow()
+{
+    PROFILE("servicenetwork");
+    servicenetwork(0);
+}
+
+//! Waits until a time, letting other Python threads run meanwhile, and handling network events as they arrive
+static void waitUntil(Profiler::Nanoseconds until, boost::python::object& slicingLock)
+{
+    extern ENetHost *serverhost;
+
+    for (;;)
+    {
+        Profiler::Nanoseconds now = Profiler::now();
+        if (now >= until)
+            return;
+
+        enet_uint32 milliseconds = enet_uint32((until - now) / 1000000ULL);
+        if (milliseconds == 0)
+        {
+            // Less than the resolution of the socket wait, so yield until it is time
+            PyThreadState *state = PyEval_SaveThread();
+            while (Profiler::now() < until)
+                SDL_Delay(0);
+            PyEval_RestoreThread(state);
+            return;
+        }
+
+        enet_uint32 condition = ENET_SOCKET_WAIT_RECEIVE;
+        int result = 0;
+        PyThreadState *state = PyEval_SaveThread();
+        if (serverhost)
+            result = enet_socket_wait(serverhost->socket, &condition, milliseconds);
+        else
+            SDL_Delay(milliseconds);
+        PyEval_RestoreThread(state);
+
+        if (serverhost && result >= 0 && (condition & ENET_SOCKET_WAIT_RECEIVE))
+            runLocked(slicingLock, serviceNetworkNow);
+    }
+}
+
+// Tick jitter: how late each tick began, relative to its scheduled time, over the last JITTER_SAMPLES ticks
+
+enum { JITTER_SAMPLES = 1024 };
+
+static Profiler::Nanoseconds jitterSamples[JITTER_SAMPLES];
+static int numJitterSamples = 0, nextJitterSample = 0;
+static int skippedTicks = 0;
+
+static void recordJitter(Profiler::Nanoseconds lateness)
+{
+    jitterSamples[nextJitterSample] = lateness;
+    nextJitterSample = (nextJitterSample + 1) % JITTER_SAMPLES;
+    numJitterSamples = min(numJitterSamples + 1, int(JITTER_SAMPLES));
+}
+
+void ServerSystem::showTickStats()
+{
+    if (!numJitterSamples)
+        return;
+
+    std::vector<Profiler::Nanoseconds> sorted(jitterSamples, jitterSamples + numJitterSamples);
+    std::sort(sorted.begin(), sorted.end());
+    printf("Tick lateness over last %d ticks: p50 %.2f ms, p99 %.2f ms, max %.2f ms; %d ticks skipped\r\n",
+        numJitterSamples,
+        sorted[sorted.size()/2] / 1000000.0f,
+        sorted[min(int(sorted.size()*99/100), int(sorted.size()) - 1)] / 1000000.0f,
+        sorted.back() / 1000000.0f,
+        skippedTicks
+    );
+
+    numJitterSamples = nextJitterSample = skippedTicks = 0;
+}
+
+void ServerSystem::mainLoop(boost::python::object slicingLock, boost::python::object runActions,
+                            boost::python::object runPeriodic, double periodicInterval)
+{
+    Profiler::Nanoseconds nextTick = Profiler::now();
+    Profiler::Nanoseconds nextPeriodic = nextTick;
+
+    while (!mainLoopQuit)
+    {
+        waitUntil(nextTick, slicingLock);
+        if (mainLoopQuit)
+            break; // Do not slice any more once a quit was requested
+
+        Profiler::Nanoseconds tickStart = Profiler::now();
+        recordJitter(tickStart - nextTick);
+
+        runLocked(slicingLock, server_runslice);
+
+        if (mainActionsPending)
+        {
+            mainActionsPending = false; // Before running them, as they may queue more
+            runActions();
+        }
+
+        if (tickStart >= nextPeriodic)
+        {
+            nextPeriodic = tickStart + Profiler::Nanoseconds(periodicInterval * 1000000000.0);
+            runPeriodic();
+        }
+
+        // E.g., a KeyboardInterrupt, which Python itself would only notice once it runs again
+        if (PyErr_CheckSignals() < 0)
+            boost::python::throw_error_already_set();
+
+        // Keep to the grid of tick times. If we fell behind, the next tick runs at once, as do up to
+        // Network/max_catchup_ticks more that are also due, back to back; the rest are skipped
+        Profiler::Nanoseconds interval = Profiler::Nanoseconds(max(tickRate.get(), 1)) * 1000000ULL;
+        nextTick += interval;
+        Profiler::Nanoseconds now = Profiler::now();
+        if (now > nextTick)
+        {
+            int missed = int((now - nextTick) / interval);
+            int skip = missed - max(maxCatchupTicks.get(), 0);
+            if (skip > 0)
+            {
+                nextTick += skip*interval;
+                skippedTicks += skip;
+            }
+        }
+    }
+}
+
+void ServerSystem::notifyMainActions()
+{
+    mainActionsPending = true;
+}
+
+void ServerSystem::quitMainLoop()
+{
+    mainLoopQuit = true;
+}
+
+
 //! Main starting point - initialize Python, set up the embedding, and
 //! run the main Python script that sets everything in motion
 int main(int argc, char **argv)
@@ -211,6 +378,9 @@ int main(int argc, char **argv)
     exposeToPython("init", server_init);
     exposeToPython("show_server_stats", show_server_stats);
     exposeToPython("slice", server_runslice);
+    exposeToPython("main_loop", &ServerSystem::mainLoop);
+    exposeToPython("notify_main_actions", &ServerSystem::notifyMainActions);
+    exposeToPython("quit_main_loop", &ServerSystem::quitMainLoop);
     exposeToPython("force_network_flush", force_network_flush);
     exposeToPython("update_username", update_username);
     exposeToPython("disconnect_client", disconnect_client);
@@ -237,7 +407,7 @@ void show_out_of_renderloop_progress(float bar1, const char *text1, float bar2,
 {
     std::string text = text1;
     text = text + "\r\n";
-    Logging::log(Logging::DEBUG, text.c_str());
+    LOG(DEBUG, text.c_str());
 }
 
 #define CONSTRLEN 512
@@ -384,7 +554,7 @@ bool hasVBO = false, hasDRE = false, hasOQ = false, hasTR = false, hasFBO = fals
 GLuint fogtex = -1;
 glmatrixf mvmatrix, projmatrix, mvpmatrix, invmvmatrix, invmvpmatrix;
 volatile bool check_calclight_progress = false;
-bool calclight_canceled = false;
+volatile bool calclight_canceled = false;
 int curtexnum = 0;
 Shader *defaultshader = NULL, *rectshader = NULL, *foggedshader = NULL, *foggednotextureshader = NULL, *stdworldshader = NULL;
 bool inbetweenframes = false, renderedframe = false;
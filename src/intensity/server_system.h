@@ -37,5 +37,23 @@ struct ServerSystem
     static void fatalMessageToClients(std::string message);
 
     static bool isRunningMap();
+
+    //! The main loop of the dedicated server. Ticks run at a fixed rate (Network/rate milliseconds apart), scheduled
+    //! on a grid of absolute times from a monotonic clock, so that late wakeups do not accumulate into drift. Between
+    //! ticks we wait on the server socket, and handle network events as soon as they arrive. Python is called only
+    //! when there is work for it: 'runActions' when actions were queued (see notifyMainActions), and 'runPeriodic'
+    //! every 'periodicInterval' seconds. 'slicingLock' is held during each tick, so the interactive console does not
+    //! run in parallel to it. Returns when quitMainLoop is called.
+    static void mainLoop(boost::python::object slicingLock, boost::python::object runActions,
+                         boost::python::object runPeriodic, double periodicInterval);
+
+    //! Called from Python, in any thread, when it queues an action for the main loop
+    static void notifyMainActions();
+
+    //! Called from Python, in any thread, when quitting
+    static void quitMainLoop();
+
+    //! Prints statistics of how late ticks ran, since the last call
+    static void showTickStats();
 };
 
@@ -25,6 +25,8 @@ void SystemManager::init()
 {
     printf("SystemManager::init()\r\n");
 
+    Profiler::init();
+
     printf("SystemManager::MessageSystem setup\r\n");
     MessageSystem::MessageManager::registerAll();
 
@@ -35,7 +37,7 @@ void SystemManager::init()
         {
             setvar("logged_into_master", 1);
             execute("setup_main_menu");
-            Logging::log(Logging::DEBUG, "No master server; working entirely remotely\r\n");
+            LOG(DEBUG, "No master server; working entirely remotely\r\n");
         }
     #endif
 }
@@ -45,25 +47,10 @@ void SystemManager::quit()
     ScriptEngineManager::destroyEngine();
 }
 
-// XXX Not used, deprecated
-bool SystemManager::benchmarking = false;
-
-void SystemManager::showBenchmark(std::string title, Benchmarker& benchmark)
-{
-    int benchmarkingSeconds = Utility::Config::getInt("System", "benchmarking", 0);
-
-    if (benchmarkingSeconds)
-    {
-        if (benchmark.totalPassed() > benchmarkingSeconds*1000)
-        {
-            printf("[[ last %d secs ]]   %s : %3.1f%% \r\n", benchmarkingSeconds, title.c_str(), benchmark.percentage());
-            benchmark.reset();
-        }
-    }
-}
-
 void SystemManager::frameTrigger(int curtime)
 {
+    Profiler::frame();
+
     #ifdef CLIENT
         ClientSystem::frameTrigger(curtime);
     #endif
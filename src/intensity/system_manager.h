@@ -12,11 +12,7 @@ struct SystemManager
     //! Calls all quittings for all of our systems
     static void quit();
 
-    static bool benchmarking;
-
-    static void showBenchmark(std::string title, Benchmarker& benchmark);
-
-    //! Stuff done on each frame
+    //! Stuff done on each frame (or server tick)
     static void frameTrigger(int curtime);
 };
 
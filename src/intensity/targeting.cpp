@@ -321,7 +321,7 @@ void TargetingControl::calcPhysicsFrames(physent *entity)
 
     fpsent* fpsEntity = dynamic_cast<fpsent*>(entity);
 
-    Logging::log(Logging::INFO, "physicsframe() lastmillis: %d  curtime: %d  lastphysframe: %d\r\n", lastmillis, curtime, fpsEntity->lastphysframe);
+    LOG(INFO, "physicsframe() lastmillis: %d  curtime: %d  lastphysframe: %d\r\n", lastmillis, curtime, fpsEntity->lastphysframe);
 
     // If no previous physframe - this is the first time - then don't bother
     // running physics, wait for that first frame. Or else we might run
@@ -337,15 +337,19 @@ void TargetingControl::calcPhysicsFrames(physent *entity)
         // Kripken: Use an configurable frame time. In particular this lets the server use a slower rate
         int entityFrameTime;
 
+        static Utility::Config::Int frameTime("Physics", "frame_time", PHYSFRAMETIME);
+        static Utility::Config::Int adaptive("Physics", "adaptive", 0);
+
         #ifdef CLIENT
             if (fpsEntity == player)
             {
-                entityFrameTime = Utility::Config::getInt("Physics", "player_frame_time", PHYSFRAMETIME);
+                static Utility::Config::Int playerFrameTime("Physics", "player_frame_time", PHYSFRAMETIME);
+                entityFrameTime = playerFrameTime.get();
             } else {
                 // For other clients, we pick the frame time in an visibility-dependent way
-                entityFrameTime = Utility::Config::getInt("Physics", "frame_time", PHYSFRAMETIME);
+                entityFrameTime = frameTime.get();
 
-                if (Utility::Config::getInt("Physics", "adaptive", 0))
+                if (adaptive.get())
                 {
                     // Visible size in pixels (2D coordinates)
                     int pixelChange = max(1.0f, scr_w*scr_h*(estimatePlayerPotentialVisiblityChange(fpsEntity)/100.0f));
@@ -361,10 +365,10 @@ void TargetingControl::calcPhysicsFrames(physent *entity)
 //            if (dynamic_cast<fpsent*>(fpsEntity)->serverControlled) Disable this and MAXFRAMETIME for now - buggy (fall through floor)
             {
                 float movement = calculateMovement(fpsEntity);
-                if (movement >= 0.001 || !Utility::Config::getInt("Physics", "adaptive", 0))
-                    entityFrameTime = Utility::Config::getInt("Physics", "frame_time", PHYSFRAMETIME);
+                if (movement >= 0.001 || !adaptive.get())
+                    entityFrameTime = frameTime.get();
                 else
-                    entityFrameTime = Utility::Config::getInt("Physics", "frame_time", PHYSFRAMETIME) * 2; // Conservative speedup
+                    entityFrameTime = frameTime.get() * 2; // Conservative speedup
             }
 //            } else
 //                entityFrameTime = MAXFRAMETIME; // Low physics for non-controlled entities
@@ -380,11 +384,11 @@ void TargetingControl::calcPhysicsFrames(physent *entity)
 
     if (fpsEntity->physsteps * fpsEntity->physframetime > 2000)
     {
-        Logging::log(Logging::WARNING, "Trying to run over 2 seconds of physics prediction at once for %d: %d/%d (%d fps) (diff: %d ; %d, %d). Aborting physics for this round.\r\n", fpsEntity->uniqueId, fpsEntity->physframetime, fpsEntity->physsteps, 1000/fpsEntity->physframetime, diff, lastmillis, fpsEntity->lastphysframe - (fpsEntity->physsteps * fpsEntity->physframetime));
+        LOG(WARNING, "Trying to run over 2 seconds of physics prediction at once for %d: %d/%d (%d fps) (diff: %d ; %d, %d). Aborting physics for this round.\r\n", fpsEntity->uniqueId, fpsEntity->physframetime, fpsEntity->physsteps, 1000/fpsEntity->physframetime, diff, lastmillis, fpsEntity->lastphysframe - (fpsEntity->physsteps * fpsEntity->physframetime));
         fpsEntity->physsteps = 1; // If we had a ton of physics to run - like, say, after 19 seconds of lightmap calculations -
                                   // then just give up, don't run all that physics, do just one frame. Back to normal next time, after all.
     }
 
-    Logging::log(Logging::INFO, "physicsframe() Decided on physframetime/physsteps: %d/%d (%d fps) (diff: %d)\r\n", fpsEntity->physframetime, fpsEntity->physsteps, 1000/fpsEntity->physframetime, diff);
+    LOG(INFO, "physicsframe() Decided on physframetime/physsteps: %d/%d (%d fps) (diff: %d)\r\n", fpsEntity->physframetime, fpsEntity->physsteps, 1000/fpsEntity->physframetime, diff);
 }
 
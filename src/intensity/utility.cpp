@@ -68,7 +68,7 @@ bool Utility::validateAlphaNumeric(std::string input, std::string alsoAllow)
     bool ret = (test == original); // After escaping all non-alphanumeric, must be no change
 
     if (!ret)
-        Logging::log(Logging::WARNING, "Validation of %s failed (using alphanumeric + %s)\r\n", input.c_str(), alsoAllow.c_str());
+        LOG(WARNING, "Validation of %s failed (using alphanumeric + %s)\r\n", input.c_str(), alsoAllow.c_str());
 
     return ret;
 }
@@ -123,7 +123,7 @@ inline std::string getCacheKey(std::string section, std::string option)
 #define GET_CONFIG(type, Name, python_type)                                           \
 type pythonGet##Name(std::string section, std::string option, type defaultVal)        \
 {                                                                                     \
-    Logging::log(Logging::DEBUG, "Config cache fail, going to Python: %s/%s\r\n",     \
+    LOG(DEBUG, "Config cache fail, going to Python: %s/%s\r\n",     \
                  section.c_str(), option.c_str());                                    \
     REFLECT_PYTHON(get_config);                                                       \
     REFLECT_PYTHON_ALTNAME(python_type, ptype);                                       \
@@ -154,12 +154,63 @@ void Utility::Config::set##Name(std::string section, std::string option, type va
     set_config(section, option, value);                                         \
     std::string cacheKey = getCacheKey(section, option); \
     configCache##Name[cacheKey] = value; \
+    Handle::invalidate(section, option); \
 }
 
 SET_CONFIG(std::string, String)
 SET_CONFIG(int,         Int)
 SET_CONFIG(float,       Float)
 
+void Utility::Config::changed(std::string section, std::string option)
+{
+    LOG(DEBUG, "Config changed: %s/%s\r\n", section.c_str(), option.c_str());
+
+    if (section == "")
+    {
+        configCacheString.clear();
+        configCacheInt.clear();
+        configCacheFloat.clear();
+    } else {
+        std::string cacheKey = getCacheKey(section, option);
+        configCacheString.erase(cacheKey);
+        configCacheInt.erase(cacheKey);
+        configCacheFloat.erase(cacheKey);
+    }
+
+    Handle::invalidate(section, option);
+}
+
+// Handles
+
+static Utility::Config::Handle *first = NULL; // Constant-initialized, so valid before any static handle is constructed
+
+Utility::Config::Handle::Handle(const char *_section, const char *_option) : section(_section), option(_option), resolved(false)
+{
+    next = first;
+    first = this;
+}
+
+Utility::Config::Handle::~Handle()
+{
+    for (Handle **curr = &first; *curr; curr = &((*curr)->next))
+    {
+        if (*curr == this)
+        {
+            *curr = next;
+            break;
+        }
+    }
+}
+
+void Utility::Config::Handle::invalidate(std::string section, std::string option)
+{
+    for (Handle *curr = first; curr; curr = curr->next)
+    {
+        if (section == "" || (section == curr->section && option == curr->option))
+            curr->resolved = false;
+    }
+}
+
 
 // Cubescript accessibility
 
@@ -48,6 +48,60 @@ struct Utility
         static void setInt   (std::string section, std::string option, int         value);
         //! Sets a float configuration variable
         static void setFloat (std::string section, std::string option, float       value);
+
+        //! Notes that a configuration variable was changed other than through the setters here, e.g., in Python,
+        //! so that cached values of it are dropped. An empty section means all variables.
+        static void changed(std::string section, std::string option);
+
+        static std::string get(std::string section, std::string option, std::string defaultVal) { return getString(section, option, defaultVal); };
+        static int         get(std::string section, std::string option, int         defaultVal) { return getInt   (section, option, defaultVal); };
+        static float       get(std::string section, std::string option, float       defaultVal) { return getFloat (section, option, defaultVal); };
+
+        //! A configuration variable that is looked up once, after which reading it just reads a field. For variables
+        //! that are read often. Changing the variable (see changed()) makes the handle look it up again when next read.
+        //! Handles are meant to be statics, e.g.,
+        //!
+        //!     static Utility::Config::Int rate("Network", "rate", 33);
+        //!     ... rate.get() ...
+        struct Handle
+        {
+            Handle(const char *_section, const char *_option);
+            ~Handle();
+
+            //! Marks the handles of a variable as stale. An empty section means all handles.
+            static void invalidate(std::string section, std::string option);
+
+        protected:
+            const char *section, *option;
+            bool resolved;
+
+        private:
+            Handle *next; //!< All handles are in a list, kept in utility.cpp
+        };
+
+        template<class T>
+        struct TypedHandle : Handle
+        {
+            TypedHandle(const char *_section, const char *_option, T _defaultVal)
+                : Handle(_section, _option), defaultVal(_defaultVal) { };
+
+            T get()
+            {
+                if (!resolved)
+                {
+                    value = Config::get(section, option, defaultVal);
+                    resolved = true;
+                }
+                return value;
+            }
+
+        private:
+            T defaultVal, value;
+        };
+
+        typedef TypedHandle<std::string> String;
+        typedef TypedHandle<int>         Int;
+        typedef TypedHandle<float>       Float;
     };
 
     //! System information
@@ -70,17 +124,4 @@ struct Timer
     virtual void reset() { startTime = Utility::SystemInfo::currTime(); };
 };
 
-struct Benchmarker : Timer
-{
-    //! The last time start() was called
-    int currStartTime;
-
-    //! The total amount of time between start() and stop() calls
-    int totalTime;
-
-    void start() { currStartTime = Utility::SystemInfo::currTime(); };
-    void stop() { totalTime += Utility::SystemInfo::currTime() - currStartTime; currStartTime = -1; };
-    float percentage() { return 100.0f * float(totalTime) / totalPassed(); };
-    virtual void reset() { Timer::reset(); currStartTime = -1; totalTime = 0; };
-};
 
@@ -29,7 +29,7 @@ bool WorldSystem::loadingWorld = false;
 void WorldSystem::placeInWorld(int entityUniqueId, int locationEntityUniqueId)
 {
     assert(0); // Be wary of this code, in particular see the XXX below about converting physent to dynent
-    Logging::log(Logging::DEBUG, "Placing entity in world\r\n");
+    LOG(DEBUG, "Placing entity in world\r\n");
     INDENT_LOG(Logging::DEBUG);
 
     LogicEntityPtr entity = LogicSystem::getLogicEntity(entityUniqueId);
@@ -45,31 +45,31 @@ void WorldSystem::placeInWorld(int entityUniqueId, int locationEntityUniqueId)
     entity.get()->dynamicEntity->yaw = locationEntity.get()->staticEntity->attr1;
 
     if (!entinmap((dynent*)entity.get()->dynamicEntity, true)) // XXX This conversion to dynent might be bad.
-        Logging::log(Logging::ERROR, "Cannot place entity %d in world at %d\r\n",
+        LOG(ERROR, "Cannot place entity %d in world at %d\r\n",
                                      entity.get()->getUniqueId(),
                                      locationEntityUniqueId);
 }
 
 void WorldSystem::triggerCollide(LogicEntityPtr mapmodel, physent* d, bool ellipse)
 {
-    Logging::log(Logging::INFO, "triggerCollide: %lu, %lu\r\n", (unsigned long)mapmodel.get(), (unsigned long)d);
+    LOG(INFO, "triggerCollide: %lu, %lu\r\n", (unsigned long)mapmodel.get(), (unsigned long)d);
 
     if (d->type != ENT_PLAYER)
     {
-//        Logging::log(Logging::INFO, "Non-player causing collide, so ignore\r\n");
+//        LOG(INFO, "Non-player causing collide, so ignore\r\n");
         return; // No need to trigger collisions for cameras, lights, etc. TODO: ENT_AI?
     }
 
     if (!mapmodel.get() || mapmodel.get()->isNone())
     {
-        Logging::log(Logging::ERROR, "Invalid mapmodel to trigger collide for\r\n");
+        LOG(ERROR, "Invalid mapmodel to trigger collide for\r\n");
         return; // Invalid or uninialized mapmodel
     }
 
     LogicEntityPtr colliderEntity = LogicSystem::getLogicEntity(d);
     if (!colliderEntity.get() || colliderEntity.get()->isNone())
     {
-        Logging::log(Logging::INFO, "Invalid colliding entity to collide with\r\n");
+        LOG(INFO, "Invalid colliding entity to collide with\r\n");
         return; // Most likely a raycasting collision, or camera, etc. - not things we trigger events for
     }
 
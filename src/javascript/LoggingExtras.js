@@ -9,7 +9,20 @@ function AssertionError(message) {
 
 
 // Export as global
-log = Logging.log
+
+//! Log a message. The message can also be a function that returns it, which is only called if
+//! the level will be shown, so that a disabled log statement does not build its message:
+//!     log(INFO, function() { return "Value: " + serializeJSON(value); });
+log = function(level, message) {
+    if (typeof message === 'function') {
+        if (!Logging.shouldShow(level)) return;
+        message = message();
+    }
+    Logging.log(level, message);
+};
+
+//! Whether a level will be shown, e.g. to skip preparing something only needed for logging
+shouldShow = Logging.shouldShow;
 
 INFO = Logging.INFO;
 DEBUG = Logging.DEBUG;
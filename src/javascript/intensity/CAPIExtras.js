@@ -38,35 +38,31 @@ CAPI.setDynentFalling = function(self, vec) {
     CAPI.setDynentFalling_raw(self, vec.x, vec.y, vec.z);
 };
 
-// Getters
-
-CAPI.getExtentO = function(self) {
-    var vec = [ CAPI.getExtentO_raw(self, 0),
-                CAPI.getExtentO_raw(self, 1),
-                CAPI.getExtentO_raw(self, 2) ];
-
-    log(INFO, format("CAPI.getExtentO: {0}", serializeJSON(vec)));
-
-    return vec;
-};
-
-CAPI.getDynentO = function(self, index) {
-    return [ CAPI.getDynentO_raw(self, 0),
-             CAPI.getDynentO_raw(self, 1),
-             CAPI.getDynentO_raw(self, 2) ];
-};
-
-CAPI.getDynentVel = function(self, index) {
-    return [ CAPI.getDynentVel_raw(self, 0),
-             CAPI.getDynentVel_raw(self, 1),
-             CAPI.getDynentVel_raw(self, 2) ];
-};
+// Getters: getExtentO, getDynentO, getDynentVel and getDynentFalling are native, and return
+// a whole vector in one call. For many entities at once, getDynentsO(entities) and
+// getDynentsVel(entities) return the vectors in a single flat array, [x0, y0, z0, x1, ...],
+// and setDynentsO(entities, values) and setDynentsVel(entities, values) take the same.
+// They pay off in code that handles many characters in one pass. The built-in loops do not:
+// manageActions calls each entity's act(), whose actions (e.g. in Steering.js) read and write
+// only their own actor, and Projectiles.js has no per-entity loop.
+
+//! Convenience wrapper for the flat arrays of the batched getters/setters
+function flatToVectors(values) {
+    var ret = [];
+    for (var i = 0; i < values.length; i += 3) {
+        ret.push(new Vector3(values[i], values[i+1], values[i+2]));
+    }
+    return ret;
+}
 
-CAPI.getDynentFalling = function(self, index) {
-    return [ CAPI.getDynentFalling_raw(self, 0),
-             CAPI.getDynentFalling_raw(self, 1),
-             CAPI.getDynentFalling_raw(self, 2) ];
-};
+function vectorsToFlat(vectors) {
+    var ret = [];
+    forEach(vectors, function(vec) {
+        vec = vectorize(vec);
+        ret.push(vec.x, vec.y, vec.z);
+    });
+    return ret;
+}
 
 
 CAPI.setAttachments = function(self, attachments) {
@@ -13,7 +13,7 @@
 
 eval(assert(" Global.CLIENT || Global.SERVER "));
 eval(assert(" !(Global.CLIENT && Global.SERVER) "));
-log(DEBUG, format("Generating LogicEntity system with CLIENT = {0}", Global.CLIENT));
+log(DEBUG, function() { return format("Generating LogicEntity system with CLIENT = {0}", Global.CLIENT); });
 
 
 //
@@ -132,10 +132,17 @@ RootLogicEntity = Class.extend({
     },
 
     hasTag: function(tag) {
-        log(INFO, "I can has " + tag + ", looking in: " + serializeJSON(this.tags));
+        if (shouldShow(INFO)) log(INFO, "I can has " + tag + ", looking in: " + serializeJSON(this.tags));
         return (findIdentical(this.tags.asArray(), tag) >= 0);
     },
 
+    //! Tells the native tag index (see getEntitiesByTag) that our tags changed
+    _tagsModified: function(tags) {
+        if (hasNativeEntityIndex()) {
+            CAPI.setEntityTags(this.uniqueId, tags.asArray !== undefined ? tags.asArray() : tags);
+        }
+    },
+
     //! Internal utility to set up C handlers, given their names
     _setupHandlers: function(handlerNames) {
         var prefix = onModifyPrefix();
@@ -173,7 +180,7 @@ RootLogicEntity = Class.extend({
     //! a dictionary with them (that can then be serialized using e.g. JSON)
     //! Variables with hasHistory set to false are not included here.
     createStateDataDict: function() {
-        log(DEBUG, "createStateDataDict():" + this._class + this.uniqueId);
+        if (shouldShow(DEBUG)) log(DEBUG, "createStateDataDict():" + this._class + this.uniqueId);
 
         var ret = {};
 
@@ -182,15 +189,15 @@ RootLogicEntity = Class.extend({
             if (isVariable(variable) && variable.hasHistory) {
                 var value = this[variable._name];
                 if (value != undefined) {
-                    log(INFO, "createStateDataDict() adding " + variable._name + ":" + serializeJSON(value));
+                    log(INFO, function() { return "createStateDataDict() adding " + variable._name + ":" + serializeJSON(value); });
                     ret[variable._name] = variable.toData( value );
                     log(INFO, "createStateDataDict() currently...");
-                    log(INFO, "createStateDataDict() currently: " + serializeJSON(ret));
+                    log(INFO, function() { return "createStateDataDict() currently: " + serializeJSON(ret); });
                 }
             }
         }, this);
 
-        log(DEBUG, "createStateDataDict() returns: " + serializeJSON(ret));
+        log(DEBUG, function() { return "createStateDataDict() returns: " + serializeJSON(ret); });
 
         return ret;
     },
@@ -199,7 +206,7 @@ RootLogicEntity = Class.extend({
     //! Should not be needed by casual developers. Calls setStateDatum for each state data element (datum).
     //! @param stateData The actual state data, in network-appropriate form (needs to be parsed).
     _updateCompleteStateData: function(stateData) {
-        log(DEBUG, format("updating complete state data for {0} with {1} ({2})", this.uniqueId, stateData, typeof stateData));
+        if (shouldShow(DEBUG)) log(DEBUG, format("updating complete state data for {0} with {1} ({2})", this.uniqueId, stateData, typeof stateData));
 
         var newStateData = evalJSON(stateData); // FIXME XXX: Use json.org version of this, which is safer
 
@@ -213,7 +220,7 @@ RootLogicEntity = Class.extend({
 
         // Set each datum separately, calling onModify's as necessary, etc.
         forEach(items(newStateData), function(item) {
-            log(DEBUG, format("update of complete state datum: {0} = {1}", item[0], item[1]));
+            log(DEBUG, function() { return format("update of complete state datum: {0} = {1}", item[0], item[1]); });
             this._setStateDatum(item[0], item[1], undefined, true); // true - this is an internal op, we are sending raw state data
             log(DEBUG, format("update of complete state datum ok"));
         }, this);
@@ -235,7 +242,7 @@ var ClientLogicEntity = RootLogicEntity.extend({
         this._generalSetup();
 
         if (!this._sauerType) {
-            log(DEBUG, "non-Sauer entity going to be set up:" + this._class, + "," + this._sauerType);
+            if (shouldShow(DEBUG)) log(DEBUG, "non-Sauer entity going to be set up:" + this._class, + "," + this._sauerType);
             CAPI.setupNonSauer(this); // Does C++ registration, etc. Sauer types need special registration, which is done by them
         }
 
@@ -280,7 +287,7 @@ var ClientLogicEntity = RootLogicEntity.extend({
     //!                      client itself in a script. Currently any value except for null is
     //!                      considered as a server update.
     _setStateDatum : function(key, value, actorUniqueId) {
-        log(INFO, format("Setting state datum: {0} = {1} for {2}", key, serializeJSON(value), this.uniqueId));
+        if (shouldShow(INFO)) log(INFO, format("Setting state datum: {0} = {1} for {2}", key, serializeJSON(value), this.uniqueId));
 
         var variable = this[_SV_PREFIX + key];
 
@@ -314,6 +321,9 @@ var ClientLogicEntity = RootLogicEntity.extend({
             eval(assert(" variable.validate(value) "));
             this.emit( 'client_onModify_' + key, value, actorUniqueId !== null);
             this.stateVariableValues[key] = value;
+            if (key === 'tags') {
+                this._tagsModified(value);
+            }
         }
     },
 
@@ -324,7 +334,7 @@ var ClientLogicEntity = RootLogicEntity.extend({
     //!                seconds will be equal to 0.0125 (or close to it, because each frame can be
     //!                a little more or less).
     clientAct: function(seconds) {
-        log(INFO, "ClientLogicEntity.clientAct, " + this.uniqueId);
+        if (shouldShow(INFO)) log(INFO, "ClientLogicEntity.clientAct, " + this.uniqueId);
         this.actionSystem.manageActions(seconds);
     },
 
@@ -346,7 +356,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
     //! Only called on creation, not on loading of an existent entity in the database.
     //! __activate__ is called for existing entities loaded from the database.
     init: function(uniqueId, kwargs) {
-        log(DEBUG, "ServerLogicEntity.init(" + uniqueId + ", " + kwargs + ")");
+        log(DEBUG, function() { return "ServerLogicEntity.init(" + uniqueId + ", " + kwargs + ")"; });
 
         eval(assert(' uniqueId !== undefined '));
         eval(assert(' typeof uniqueId === "number" '));
@@ -369,12 +379,12 @@ var ServerLogicEntity = RootLogicEntity.extend({
     //! client number (if any), etc., to be ready to send. If this is an issue, then it is best to override this and
     //! not call the parent at all.
     activate: function(kwargs) {
-        log(DEBUG, "ServerLogicEntity.activate(" + kwargs + ")");
+        log(DEBUG, function() { return "ServerLogicEntity.activate(" + kwargs + ")"; });
 
         this._logicEntitySetup();
 
         if (!this._sauerType) {
-            log(DEBUG, "non-Sauer entity going to be set up:" + this._class, + "," + this._sauerType);
+            if (shouldShow(DEBUG)) log(DEBUG, "non-Sauer entity going to be set up:" + this._class, + "," + this._sauerType);
             CAPI.setupNonSauer(this); // Does C++ registration, etc. Sauer types need special registration, which is done by them
         }
 
@@ -399,7 +409,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
     sendCompleteNotification: function(clientNumber) {
         clientNumber = defaultValue(clientNumber, MessageSystem.ALL_CLIENTS);
 
-        log(DEBUG, format("LE.sendCompleteNotification: {1}, {2}", this.clientNumber, this.uniqueId));
+        if (shouldShow(DEBUG)) log(DEBUG, format("LE.sendCompleteNotification: {1}, {2}", this.clientNumber, this.uniqueId));
 
         MessageSystem.send( clientNumber,
                             CAPI.LogicEntityCompleteNotification,
@@ -471,7 +481,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
     //!                   data format. An example of an internal operation is the server
     //!                   reading a state data from a dumpfile and applying it to an entity.
     _setStateDatum: function(key, value, actorUniqueId, internalOp) {
-        log(INFO, format("Setting state datum: {0} = {1} ({2}) : {3}, {4}", key, value, typeof value, serializeJSON(value)), value._class);
+        log(INFO, function() { return format("Setting state datum: {0} = {1} ({2}) : {3}, {4}", key, value, typeof value, serializeJSON(value), value._class); });
 
         var _class = this._class;
 
@@ -489,7 +499,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
             value = variable.fromData(value); // Translate to correct type
         }
 
-        log(DEBUG, format("Translated value: {0} = {1} ({2}) : {3}, {4}", key, value, typeof value, serializeJSON(value)), value._class);
+        log(DEBUG, function() { return format("Translated value: {0} = {1} ({2}) : {3}, {4}", key, value, typeof value, serializeJSON(value), value._class); });
 
 /*
         if ( !variable.validate(value) ) {
@@ -509,8 +519,11 @@ var ServerLogicEntity = RootLogicEntity.extend({
         }
 
         this.stateVariableValues[key] = value;
+        if (key === 'tags') {
+            this._tagsModified(value);
+        }
 
-        log(INFO, "New state data: " + this.stateVariableValues[key]);
+        if (shouldShow(INFO)) log(INFO, "New state data: " + this.stateVariableValues[key]);
 
         var customSynchFromHere = variable.customSynch && this._controlledHere;
 
@@ -538,8 +551,9 @@ var ServerLogicEntity = RootLogicEntity.extend({
                                    variable.reliable ? CAPI.StateDataUpdate : CAPI.UnreliableStateDataUpdate,
                                    this.uniqueId,
                                    MessageSystem.toProtocolId(_class, key),
-                                   variable.toWire(value),
-                                   (variable.clientSet && actorUniqueId) ? getEntity(actorUniqueId).clientNumber : -1);
+                                   variable.toWireTyped(value),
+                                   (variable.clientSet && actorUniqueId) ? getEntity(actorUniqueId).clientNumber : -1,
+                                   variable.wireType);
             }
         }
     },
@@ -548,7 +562,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
     //! copied to the C++ entity, as CAPI.setupXXXX has not yet been called - the C++ entity doesn't exist yet.
     //! We queue such things here, and flushes them out with _flush_queued_state_variable_changed.
     _queueStateVariableChange: function(key, value) {
-        log(DEBUG, format("Queueing SV change: {0} - {1} ({2})", key, value, typeof value));
+        log(DEBUG, function() { return format("Queueing SV change: {0} - {1} ({2})", key, value, typeof value); });
 
         this._queuedStateVariableChanges[key] = value;
     },
@@ -561,7 +575,7 @@ var ServerLogicEntity = RootLogicEntity.extend({
 
     //! This is called after the CAPI.setupXXXX call. See _queueStateVariableChange.
     _flushQueuedStateVariableChanges: function() {
-        log(DEBUG, "Flushing Queued SV changes for " + this.uniqueId);
+        if (shouldShow(DEBUG)) log(DEBUG, "Flushing Queued SV changes for " + this.uniqueId);
 
         if (this.canCallCFuncs()) {
             return; // We have already been called
@@ -576,9 +590,9 @@ var ServerLogicEntity = RootLogicEntity.extend({
 
             var variable = this[_SV_PREFIX + key];
 
-            log(DEBUG, format("(A) Flushing queued SV change: {0} - {1} (real: {2})", key, value, this.stateVariableValues[key]));
+            if (shouldShow(DEBUG)) log(DEBUG, format("(A) Flushing queued SV change: {0} - {1} (real: {2})", key, value, this.stateVariableValues[key]));
             this[key] = this.stateVariableValues[key];
-            log(DEBUG, format("(B) Flushing of {0} - ok", key));
+            log(DEBUG, function() { return format("(B) Flushing of {0} - ok", key); });
         }, this);
     }
 });
@@ -5,17 +5,26 @@
 
 __entitiesStore = {}; //! Local store of entities, in Python. Parallels the C++ LogicData store, has same interface as server's persistence
 
+//! The entities not based on Sauer types. These are not in the native spatial index (see getCloseEntities),
+//! as their positions, if any, exist only here
+__nonSauerEntitiesStore = {};
+
+//! Whether the native entity indexes are available. They are not, for example, in the testing environment
+function hasNativeEntityIndex() {
+    return CAPI.getEntitiesInRadius !== undefined;
+}
+
 //! Same interface as the server's persistence system, but accesses just the local client's store of active LogicEntities.
 //! @param uniqueId The unique id of the entity to be retrieved.
 //! @return The logic entity corresponding to that unique id.
 function getEntity(uniqueId) {
-    log(INFO, "getEntity" + uniqueId);
+    log(INFO, function() { return "getEntity" + uniqueId; });
     var ret = __entitiesStore[uniqueId];
     if (ret !== undefined) {
-        log(INFO, format("getEntity found entity {0} ({1})", uniqueId, ret.uniqueId));
+        log(INFO, function() { return format("getEntity found entity {0} ({1})", uniqueId, ret.uniqueId); });
         return ret;
     } else {
-        log(INFO, format("getEntity could not find entity {0}", uniqueId));
+        log(INFO, function() { return format("getEntity could not find entity {0}", uniqueId); });
         return null;
     }
 }
@@ -25,6 +34,17 @@ function getEntity(uniqueId) {
 //! @return All the currently active logic entities (i.e., registered LEs), currently in memory and running.
 function getEntitiesByTag(withTag) {
     var ret = [];
+    if (hasNativeEntityIndex()) {
+        var uniqueIds = CAPI.getEntitiesByTag(withTag);
+        for (var i = 0; i < uniqueIds.length; i++) {
+            var entity = __entitiesStore[uniqueIds[i]];
+            if (entity !== undefined) {
+                ret.push(entity);
+            }
+        }
+        return ret;
+    }
+
     forEach(values(__entitiesStore), function(entity) {
         if (entity.hasTag(withTag)) {
             ret.push(entity);
@@ -56,16 +76,31 @@ function getEntityByTag(withTag) {
 //! Useful for example to find all close-by doors, and not characters, etc.
 //! @param with_tag If provided, then only entities having this tag will be taken into consideration.
 //! @param unsorted By default we sort the output; this can disable that.
-//! @return A list, from close to far, of tuples of the form (entity, distance)
+//! @return A list of tuples of the form (entity, distance). Note that the order is from far to close, which
+//!         existing callers rely on.
 function getCloseEntities(origin, maxDistance, _class, withTag, unsorted) {
     var ret = [];
+    var candidates = __entitiesStore;
+
+    // Sauer entities are found by the native spatial index, so only the rest need to be checked here
+    if (hasNativeEntityIndex()) {
+        var found = CAPI.getEntitiesInRadius(origin.x, origin.y, origin.z, maxDistance, withTag ? withTag : "");
+        for (var i = found.length - 2; i >= 0; i -= 2) { // Far to close
+            var otherEntity = __entitiesStore[found[i]];
+            if ( otherEntity !== undefined && !(_class && !(otherEntity instanceof _class)) ) {
+                ret.push( [otherEntity, found[i+1]] );
+            }
+        }
+        candidates = __nonSauerEntitiesStore;
+    }
+    var numFound = ret.length;
 
-    forEach(values(__entitiesStore), function(otherEntity) {
+    forEach(values(candidates), function(otherEntity) {
         if ( _class && !(otherEntity instanceof _class) ) {
             return;
         }
 
-        if ( withTag && !entity.hasTag(withTag) ) {
+        if ( withTag && !otherEntity.hasTag(withTag) ) {
             return;
         }
 
@@ -78,20 +113,60 @@ function getCloseEntities(origin, maxDistance, _class, withTag, unsorted) {
         }
     });
 
-    // Sort results by distance
-    if (!unsorted) {
+    // Sort results by distance (those from the native index already are)
+    if (!unsorted && ret.length > numFound) {
         ret.sort(function(a, b) { return (b[1] - a[1]); });
     }
 
     return ret;
 }
 
+//! Returns the Sauer entities (dynamic and static - not non-Sauer ones) inside a box.
+//! @param lo The corner of the box with the lowest coordinates.
+//! @param hi The corner of the box with the highest coordinates.
+//! @param _class If given, then consider only LogicEntities that are instances of this class or its subclasses.
+//! @param withTag If provided, then only entities having this tag will be taken into consideration.
+//! @return A list, from close to far from the center of the box, of tuples of the form (entity, distance)
+function getEntitiesInBox(lo, hi, _class, withTag) {
+    var ret = [];
+
+    if (hasNativeEntityIndex()) {
+        var found = CAPI.getEntitiesInBox(lo.x, lo.y, lo.z, hi.x, hi.y, hi.z, withTag ? withTag : "");
+        for (var i = 0; i < found.length; i += 2) {
+            var entity = __entitiesStore[found[i]];
+            if ( entity !== undefined && !(_class && !(entity instanceof _class)) ) {
+                ret.push( [entity, found[i+1]] );
+            }
+        }
+        return ret;
+    }
+
+    var center = lo.addNew(hi).mul(0.5);
+    forEach(values(__entitiesStore), function(entity) {
+        if ( !entity._sauerType || (_class && !(entity instanceof _class)) || (withTag && !entity.hasTag(withTag)) ) {
+            return;
+        }
+
+        var position = entity.position;
+        if ( position.x < lo.x || position.y < lo.y || position.z < lo.z ||
+             position.x > hi.x || position.y > hi.y || position.z > hi.z ) {
+            return;
+        }
+
+        ret.push( [entity, center.subNew(position).magnitude()] );
+    });
+
+    ret.sort(function(a, b) { return (a[1] - b[1]); });
+
+    return ret;
+}
+
 
 function addEntity(_className, uniqueId, kwargs, _new) {
     uniqueId = defaultValue(uniqueId, 1331); // Useful for debugging
 
-    log(DEBUG, format("Adding new Scripting LogicEntity of type {0} with unique ID {1}", _className, uniqueId));
-    log(DEBUG, format("   with arguments: {0}, {1}", serializeJSON(kwargs), _new));
+    log(DEBUG, function() { return format("Adding new Scripting LogicEntity of type {0} with unique ID {1}", _className, uniqueId); });
+    log(DEBUG, function() { return format("   with arguments: {0}, {1}", serializeJSON(kwargs), _new); });
 
     eval(assert(' getEntity(uniqueId) === null ')); // Cannot re-create!
 
@@ -111,6 +186,9 @@ function addEntity(_className, uniqueId, kwargs, _new) {
     }
 
     __entitiesStore[ret.uniqueId] = ret;
+    if (!ret._sauerType) {
+        __nonSauerEntitiesStore[ret.uniqueId] = ret;
+    }
     eval(assert(' getEntity(uniqueId) ===  ret '));
 
     // Done after setting the unique ID and placing in the global store, because C++
@@ -131,7 +209,7 @@ function addEntity(_className, uniqueId, kwargs, _new) {
 //! Removes a logic entity from the local store. Called from LogicData::unregisterLogicEntity. Calls __nregister__
 //! @param uniqueId The unique id of the entity to unregister
 function removeEntity(uniqueId) {
-    log(DEBUG, format("Removing Scripting LogicEntity: {0}", uniqueId));
+    log(DEBUG, function() { return format("Removing Scripting LogicEntity: {0}", uniqueId); });
 
     if (__entitiesStore[uniqueId] === undefined) {
         log(WARNING, "Cannot remove entity " + uniqueId + " as it does not exist");
@@ -147,6 +225,7 @@ function removeEntity(uniqueId) {
     }
 
     delete __entitiesStore[uniqueId];
+    delete __nonSauerEntitiesStore[uniqueId];
 }
 
 
@@ -176,7 +255,7 @@ manageActions = function(seconds) {
     Global.time += seconds;
     Global.currTimeDelta = seconds;
 
-    log(INFO, "manageActions: " + seconds);
+    log(INFO, function() { return "manageActions: " + seconds; });
 
     forEach(values(__entitiesStore), function(entity) {
 //        log(INFO, "manageActions for: " + entity.uniqueId);
@@ -205,7 +284,7 @@ function renderDynamic(thirdperson) {
     log(INFO, "renderDynamic");
 
     forEach(values(__entitiesStore), function(entity) {
-        log(INFO, "renderDynamic for: " + entity.uniqueId);
+        log(INFO, function() { return "renderDynamic for: " + entity.uniqueId; });
 
         if (entity.deactivated || entity.renderDynamic === null) {
             return;
@@ -245,7 +324,7 @@ if (Global.CLIENT) {
     //! which can then be accessed by get_playerLogicEntity().
     //! @param uniqueId The unique id of the player's LogicEntity.
     function setPlayerUniqueId(uniqueId) {
-        log(DEBUG, format("Setting player unique ID to {0}", uniqueId));
+        log(DEBUG, function() { return format("Setting player unique ID to {0}", uniqueId); });
 
         if (uniqueId !== null) {
             playerLogicEntity = getEntity(uniqueId);
@@ -284,6 +363,14 @@ if (Global.CLIENT) {
         }
     }
 
+    //! Sets many state data at once, as a response to a batched server update (StateDataUpdates).
+    //! @param updates A flat array of uniqueId, keyProtocolId, value triplets, each as in setStateDatum.
+    function setStateData(updates) {
+        for (var i = 0; i < updates.length; i += 3) {
+            setStateDatum(updates[i], updates[i+1], updates[i+2]);
+        }
+    }
+
     //! Checks whether the client has all necessary info to actually run the scenario, i.e. the current
     //! application. In particular, tests if all LogicEntities are initialized, and if the player logic entity
     //! has been created in completion.
@@ -306,7 +393,7 @@ if (Global.CLIENT) {
 
         forEach(values(__entitiesStore), function(entity) {
             if (!entity.initialized) {
-                log(INFO, format("...no, {0} is not initialized", entity.uniqueId));
+                log(INFO, function() { return format("...no, {0} is not initialized", entity.uniqueId); });
                 return false;
             }
         });
@@ -329,12 +416,12 @@ if (Global.SERVER) {
             ret = Math.max(ret, uniqueId);
         });
         ret = ret + 1
-        log(DEBUG, "Generating new unique ID: " + ret);
+        log(DEBUG, function() { return "Generating new unique ID: " + ret; });
         return ret;
     }
 
     function newEntity(_className, kwargs, forceUniqueId, returnUniqueId) {
-        log(DEBUG, "New logic entity: " + forceUniqueId);
+        log(DEBUG, function() { return "New logic entity: " + forceUniqueId; });
 
         if (forceUniqueId === undefined) {
             forceUniqueId = getNewUniqueId();
@@ -359,7 +446,7 @@ if (Global.SERVER) {
     //! and non-map (NPCs, non-Sauers, etc.)
     //! @param clientNumber The identifier of the client to which to send all data, or ALL_CLIENTS (-1) for all of them.
     function sendEntities(clientNumber) {
-        log(DEBUG, "Sending active logic entities to " + clientNumber);
+        log(DEBUG, function() { return "Sending active logic entities to " + clientNumber; });
 
         var numEntities = 0; // TODO: Better JS-ey way to do this?
         for (var item in __entitiesStore) {
@@ -399,16 +486,16 @@ if (Global.SERVER) {
     //! in the database that correspond to that map. This in particular lets us handle static and
     //! dynamic entities in the same manner.
     function loadEntities(serializedEntities) {
-        log(DEBUG, "Loading entities...: " + serializedEntities + typeof(serializedEntities));
+        log(DEBUG, function() { return "Loading entities...: " + serializedEntities + typeof(serializedEntities); });
 
         var entities = evalJSON(serializedEntities);
 
         forEach(entities, function(entity) {
-            log(DEBUG, format("loadEntities: {0}", serializeJSON(entity)));
+            log(DEBUG, function() { return format("loadEntities: {0}", serializeJSON(entity)); });
             var uniqueId = entity[0];
             var _class = entity[1];
             var stateData = entity[2];
-            log(DEBUG, format("loadEntities: {0},{1},{2}", uniqueId, _class, stateData));
+            log(DEBUG, function() { return format("loadEntities: {0},{1},{2}", uniqueId, _class, stateData); });
 
             addEntity(_class, uniqueId, { 'stateData': serializeJSON(stateData) }); // TODO: See comment below on parsing speed
         });
@@ -425,7 +512,7 @@ if (Global.SERVER) {
 
         forEach(values(__entitiesStore), function(entity) {
             if (entity._persistent) {
-                log(DEBUG, "Saving entity " + entity.uniqueId);
+                log(DEBUG, function() { return "Saving entity " + entity.uniqueId; });
                 var uniqueId = entity.uniqueId;
                 var _class = entity._class;
                 var stateData = entity.createStateDataDict();
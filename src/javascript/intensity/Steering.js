@@ -213,6 +213,19 @@ function canWalkDistance(actor, target, radiiToCheck, stepFraction) { //, cache_
 }
 
 
+//! Finds a path for walking from one position to another, using the navigation graph of the map (see
+//! the 'navgen' command). Path queries are cached natively, so asking again, even every frame, is cheap.
+//! @return An array of positions to walk through, ending in 'to', or null if there is no path, or no graph.
+function findPath(from, to) {
+    if (!CAPI.findPath || !CAPI.hasNavigationGraph()) {
+        return null;
+    }
+
+    var path = CAPI.findPath(from.x, from.y, from.z, to.x, to.y, to.z);
+    return path ? flatToVectors(path) : null;
+}
+
+
 //! Makes the actor of the action turn towards a target, and stop when facing it.
 FaceTowardsAction = TargetedAction.extend({
     _name: 'FaceTowardsAction',
@@ -391,6 +404,66 @@ ArrivalAction = TargetedAction.extend({
 });
 
 
+//! Move towards a target entity along a path in the navigation graph, replanning as the target moves. If
+//! the map has no graph, or there is no path, this moves straight towards the target, like ArrivalAction.
+//! @param kwargs.repathInterval How often to ask again for a path, in seconds. Default: 0.5
+PathArrivalAction = TargetedAction.extend({
+    _name: 'PathArrivalAction',
+
+    create: function(target, kwargs) {
+        kwargs = defaultValue(kwargs, {});
+
+        this._super(target, kwargs);
+
+        this.repathTimer = new RepeatingTimer(defaultValue(kwargs.repathInterval, 0.5));
+        this.repathTimer.prime();
+
+        this.path = null;
+        this.pathGoal = null;
+
+        if (this.animation !== (ANIM_IDLE | ANIM_LOOP)) {
+            this.animation = ANIM_IDLE | ANIM_LOOP; // Set only if changed, to save bandwidth
+        }
+    },
+
+    doExecute: function(seconds) {
+        if (this.target.deactivated) {
+            return true;
+        }
+
+        var actor = this.actor;
+        var goal = this.target.position.copy();
+        var facingSpeed = seconds*actor.facingSpeed;
+
+        // Replan once in a while, or at once if the target moved away from where we planned to
+        if (this.repathTimer.tick(seconds) || (this.pathGoal && distance(this.pathGoal, goal) > actor.radius*2)) {
+            this.path = findPath(actor.position, goal);
+            this.pathGoal = goal;
+        }
+
+        if (!this.path) {
+            return moveTowards(actor, goal, facingSpeed);
+        }
+
+        // Skip waypoints we have reached, keeping the last, which is the target itself
+        while (this.path.length > 1 && distance(actor.position, this.path[0]) <= actor.radius*2) {
+            this.path.shift();
+        }
+
+        if (this.path.length > 1) {
+            moveTowards(actor, this.path[0], facingSpeed);
+            return false;
+        }
+
+        return moveTowards(actor, goal, facingSpeed);
+    },
+
+    doFinish: function() {
+        this.actor.move = 0;
+    }
+});
+
+
 /*
 //! A form of Arrival (or Pursuit) that attempts to go where the target *will* be. Instead of normal
 //! prediction of future target locations, we use the guideline hinted at in the CR's Steering paper,
@@ -453,6 +526,7 @@ FleeAction = FaceTowardsAction.extend({
 // Public interface for some 'internal' functions
 
 Steering = {
-    faceTowards: faceTowards
+    faceTowards: faceTowards,
+    findPath: findPath
 };
 
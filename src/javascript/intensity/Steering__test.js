@@ -57,3 +57,7 @@ moveTowards(actor, target, 150);
 eval(assert(' Math.abs(actor.yaw - 153.434) < 0.01 '));
 eval(assert(' actor.move = 1 '));
 
+// findPath - without a navigation graph, there is no path
+
+eval(assert(' findPath(actor.position, target) === null '));
+
@@ -29,6 +29,16 @@ isVariable = function(possible) {
 //! It is hidden with this prefix so we can still access it (and its info).
 _SV_PREFIX = "__SV_";
 
+//! How state variable values are sent from the server to clients. The engine encodes each type in binary
+//! and gives clients native values, so they need no parsing. Must match StateDataEncoding in message_system.h.
+WireTypes = {
+    STRING: 0,
+    INTEGER: 1,
+    FLOAT: 2,
+    FLOAT_ARRAY: 3,
+    STRING_ARRAY: 4
+};
+
 
 function __getVariable(uniqueId, variableName) {
     return getEntity(uniqueId)[_SV_PREFIX + variableName];
@@ -130,7 +140,7 @@ StateVariable = Variable.extend({
         // We partially apply the function, as the spec of these functions is
         //  getter(variable)        (and this is bound to the LogicEntity)
         //  setter(variable, value) (and this is bound to the LogicEntity)
-        log(INFO, "Setting up setter/getter for " + _name);// + ": " + this.getter + ",,," + this.setter);
+        log(INFO, function() { return "Setting up setter/getter for " + _name; });// + ": " + this.getter + ",,," + this.setter);
         eval(assert(" this.getter !== undefined "));
         eval(assert(" this.setter !== undefined "));
         parent.__defineGetter__(_name, partial(this.getter, this));
@@ -182,6 +192,15 @@ StateVariable = Variable.extend({
     //! Overridden in child classes with relevant functionality
     validate: function(value) {
         return true;
+    },
+
+    //! The WireTypes type in which the server sends values to clients. Clients get values of that
+    //! type in fromWire.
+    wireType: WireTypes.STRING,
+
+    //! Converts a value into the form sent for wireType. By default, the string from toWire.
+    toWireTyped: function(value) {
+        return this.toWire(value);
     }
 });
 
@@ -210,6 +229,8 @@ integer = function(x) {
 
 //! A StateVariable that holds an integer value.
 StateInteger = StateVariable.extend({
+    wireType: WireTypes.INTEGER,
+    toWireTyped: integer,
     toWire: string,
     fromWire: integer,
     toData: string,
@@ -229,6 +250,8 @@ decimal2 = function(x) {
 
 //! A StateVariable that holds a float value. Can enforce non-negativity
 StateFloat = StateVariable.extend({
+    wireType: WireTypes.FLOAT,
+    toWireTyped: Number,
     toWire: decimal2,
     fromWire: parseFloat,
     toData: decimal2,
@@ -284,18 +307,18 @@ var ArraySurrogate = Class.extend({
         for (var i = 0; i < MAX_STATE_ARRAY_SIZE; i++) {
             (function() {
                 var j = i; // Use function scoping to fix i as j.
-                log(INFO, "Setting up getters/setters for ArraySurrogate:" + j);
+                log(INFO, function() { return "Setting up getters/setters for ArraySurrogate:" + j; });
 
                 var success;
 
                 success = that.__defineGetter__("0", function() {
-                    log(INFO, "ArraySurrogate::getter(" + j + ")");
+                    log(INFO, function() { return "ArraySurrogate::getter(" + j + ")"; });
                     return that.variable.getItem(that.entity, j);
                 });
 //                eval(assert(' success' ));
 
                 success = that.__defineSetter__("0", function(value) {
-                    log(INFO, "ArraySurrogate::setter(" + j + ", " + value + ")");
+                    log(INFO, function() { return "ArraySurrogate::setter(" + j + ", " + value + ")"; });
                     that.variable.setItem(that.entity, j, value);
                 });
 //                eval(assert(' success' ));
@@ -321,11 +344,11 @@ var ArraySurrogate = Class.extend({
     },
 
     asArray: function() {
-        log(INFO, "asArray:" + this);
+        if (shouldShow(INFO)) log(INFO, "asArray:" + this);
 
         var ret = [];
         for (var i = 0; i < this.length; i++) {
-            log(INFO, "asArray(" + i + ")");
+            log(INFO, function() { return "asArray(" + i + ")"; });
             ret.push( this.get(i) );
         }
         return ret;
@@ -351,7 +374,7 @@ StateArray = StateVariable.extend({
             return undefined;
         }
 
-        log(INFO, "StateArray.getter (" + variable._name + "," + variable._class + "): Creating surrogate");
+        log(INFO, function() { return "StateArray.getter (" + variable._name + "," + variable._class + "): Creating surrogate"; });
 
         var cacheName = '__arraysurrogate_' + variable._name;
         if (this[cacheName] === undefined) {
@@ -361,12 +384,12 @@ StateArray = StateVariable.extend({
     },
 
     setter: function(variable, value) {
-        log(INFO, "StateArray.setter:" + serializeJSON(value));
+        log(INFO, function() { return "StateArray.setter:" + serializeJSON(value); });
         if (value.x) {
-            log(INFO, "StateArray.setter:" + value.x + "," + value.y + "," + value.z);
+            log(INFO, function() { return "StateArray.setter:" + value.x + "," + value.y + "," + value.z; });
         }
         if (value.get) {
-            log(INFO, "StateArray.setter:" + value.get(0) + "," + value.get(1) + "," + value.get(2));
+            log(INFO, function() { return "StateArray.setter:" + value.get(0) + "," + value.get(1) + "," + value.get(2); });
         }
 
         var data;
@@ -393,11 +416,11 @@ StateArray = StateVariable.extend({
 
 /*
         // Set to [], erasing previous content (necessary), then we build from scratch
-        log(DEBUG, "Setting empty value: " + serializeJSON(variable.emptyValue()));
+        log(DEBUG, function() { return "Setting empty value: " + serializeJSON(variable.emptyValue()); });
         this.stateVariableValues[variable._name] = variable.emptyValue();
 
         for (i = 0; i < data.length; i++) {
-            log(DEBUG, "StateArray.setter: " + i + " : " + val);
+            log(DEBUG, function() { return "StateArray.setter: " + i + " : " + val; });
             variable.setItem(this, i, data[i]);
         }
 
@@ -406,7 +429,7 @@ StateArray = StateVariable.extend({
 
 /*
         for (i = 0; i < data.length; i++) {
-            log(DEBUG, i + ": " + variable.getItem(this, i) + " vs. " + data[i]);
+            if (shouldShow(DEBUG)) log(DEBUG, i + ": " + variable.getItem(this, i) + " vs. " + data[i]);
             eval(assert(' variable.getItem(this, i) === data[i] '));
         }
 */
@@ -415,7 +438,7 @@ StateArray = StateVariable.extend({
     toWireItem: string,
 
     toWire: function(value) {
-        log(INFO, "toWire of StateArray:" + serializeJSON(value));
+        log(INFO, function() { return "toWire of StateArray:" + serializeJSON(value); });
         if (value.asArray !== undefined) {
             // This is an ArraySurrogate or other class that we can get a true array form from, using asArray()
             value = value.asArray();
@@ -424,11 +447,26 @@ StateArray = StateVariable.extend({
         return '[' + map(this.toWireItem, value).join("|") + ']';
     },
 
+    wireType: WireTypes.STRING_ARRAY,
+
+    //! Converts an *item* of the array into the form sent for wireType
+    toWireTypedItem: string,
+
+    toWireTyped: function(value) {
+        if (value.asArray !== undefined) {
+            value = value.asArray();
+        }
+
+        return map(this.toWireTypedItem, value);
+    },
+
     fromWireItem: string,
 
     fromWire: function(value) {
-        log(DEBUG, "fromWire of StateArray:" + serializeJSON(value));
-        if (value === "[]") {
+        log(DEBUG, function() { return "fromWire of StateArray:" + serializeJSON(value); });
+        if (typeof value !== 'string') {
+            return map(this.fromWireItem, value); // Already an array, sent typed
+        } else if (value === "[]") {
             return [];
         } else {
             return map(this.fromWireItem, value.slice(1,-1).split("|"));
@@ -438,7 +476,7 @@ StateArray = StateVariable.extend({
     toDataItem: string,
 
     toData: function(value) {
-        log(INFO, "(1) StateArray.toData:" + value + typeof value + serializeJSON(value));
+        log(INFO, function() { return "(1) StateArray.toData:" + value + typeof value + serializeJSON(value); });
 
         if (value.asArray !== undefined) {
             log(INFO, "(1.5) StateArray.toData: using asArray");
@@ -446,7 +484,7 @@ StateArray = StateVariable.extend({
             value = value.asArray();
         }
 
-        log(INFO, "(2) StateArray.toData:" + value + typeof value + serializeJSON(value));
+        log(INFO, function() { return "(2) StateArray.toData:" + value + typeof value + serializeJSON(value); });
 
         return '[' + map(this.toDataItem, value).join("|") + ']';
     },
@@ -455,7 +493,7 @@ StateArray = StateVariable.extend({
     fromDataItem: string,
 
     fromData: function(value) {
-        log(DEBUG, "StateArray.fromData " + this._name + "::" + value);
+        if (shouldShow(DEBUG)) log(DEBUG, "StateArray.fromData " + this._name + "::" + value);
         if (value === "[]") {
             return [];
         } else {
@@ -467,7 +505,7 @@ StateArray = StateVariable.extend({
     //! stateData, but it can be overridden in child classes.
     getRaw: function(entity) {
         log(INFO, "getRaw:");
-        log(INFO, serializeJSON(entity.stateVariableValues));
+        log(INFO, function() { return serializeJSON(entity.stateVariableValues); });
         var value = entity._getStateDatum(this._name);
         if (value === undefined) {
             value = [];
@@ -476,9 +514,9 @@ StateArray = StateVariable.extend({
     },
 
     setItem: function(entity, i, value) {
-        log(INFO, "setItem: " + i + " : " + serializeJSON(value));
+        log(INFO, function() { return "setItem: " + i + " : " + serializeJSON(value); });
         var array = this.getRaw(entity);
-        log(INFO, "gotraw: " + serializeJSON(array));
+        log(INFO, function() { return "gotraw: " + serializeJSON(array); });
         if (typeof value === 'string') {
             eval(assert(' value.indexOf("|") === -1 '));
         }
@@ -487,9 +525,9 @@ StateArray = StateVariable.extend({
     },
 
     getItem: function(entity, i) {
-        log(INFO, "StateArray.getItem for " + i);
+        log(INFO, function() { return "StateArray.getItem for " + i; });
         var array = this.getRaw(entity);
-        log(INFO, "StateArray.getItem " + serializeJSON(array) + " ==> " + array[i]);
+        log(INFO, function() { return "StateArray.getItem " + serializeJSON(array) + " ==> " + array[i]; });
         return array[i]; // TODO optimize all of this
     },
 
@@ -520,6 +558,9 @@ StateArrayFloat = StateArray.extend({
     toWireItem: decimal2,
     fromWireItem: parseFloat,
 
+    wireType: WireTypes.FLOAT_ARRAY,
+    toWireTypedItem: Number,
+
     toDataItem: decimal2,
     fromDataItem: parseFloat
 });
@@ -601,7 +642,7 @@ WrappedCVariable = {
             var variable = this;
             parent.connect(prefix + _name, function(value) {
                 if (Global.CLIENT || parent.canCallCFuncs()) {
-                    log(INFO, format("Calling cSetter for {0}, with: {1} ({2})", variable._name, value, typeof value));
+                    log(INFO, function() { return format("Calling cSetter for {0}, with: {1} ({2})", variable._name, value, typeof value); });
                     // We have been set up, so apply the change
                     variable.cSetter(parent, value);
 
@@ -616,7 +657,7 @@ WrappedCVariable = {
                 }
             });
         } else {
-            log(DEBUG, "No cSetter for " + _name + "; not connecting to signal");
+            log(DEBUG, function() { return "No cSetter for " + _name + "; not connecting to signal"; });
         }
 //        log(INFO, "_register WrappedCVariable done.");
     },
@@ -632,7 +673,7 @@ WrappedCVariable = {
 //        }
 //log(DEBUG, "Going to read from source for " + variable._name);
 
-        log(INFO, "WCV getter " + variable._name);
+        log(INFO, function() { return "WCV getter " + variable._name; });
         if (variable.cGetter !== undefined && (Global.CLIENT || this.canCallCFuncs())) {
             log(INFO, "WCV getter: call C");
             // We have a special getter, and can call it, so do so
@@ -645,7 +686,7 @@ WrappedCVariable = {
 
             return value;
         } else {
-            log(INFO, "WCV getter: fallback to stateData since " + variable.cGetter);
+            log(INFO, function() { return "WCV getter: fallback to stateData since " + variable.cGetter; });
             return this._super(variable);
         }
     }
@@ -675,14 +716,14 @@ WrappedCArray = StateArray.extend(
             getter: new StateArray().getter, // We need the getter from StateArray, not WrappedCVariable
 
             getRaw: function(entity) {
-                log(INFO, "WCA.getRaw " + this._name + this.cGetter);
+                if (shouldShow(INFO)) log(INFO, "WCA.getRaw " + this._name + this.cGetter);
                 if (this.cGetter !== undefined && (Global.CLIENT || entity.canCallCFuncs())) {
                     log(INFO, "WCA.getRaw: call C");
                     return this.cGetter(entity);
                 } else {
                     log(INFO, "WCA.getRaw: fallback to stateData");
                     var ret = entity._getStateDatum(this._name);
-                    log(INFO, "WCA.getRaw..." + ret);
+                    log(INFO, function() { return "WCA.getRaw..." + ret; });
                     return ret;
                 }
             }
@@ -773,9 +814,12 @@ WrappedCVector3 = WrappedCArray.extend({
     fromWireItem: parseFloat,
     toWireItem: decimal2,
 
+    wireType: WireTypes.FLOAT_ARRAY,
+    toWireTypedItem: Number,
+
 /*    getItem: function(entity, i) {
         var array = this.getRaw(entity);
-        log(INFO, "StateArray.getItem " + array + " ==> " + array[i]);
+        log(INFO, function() { return "StateArray.getItem " + array + " ==> " + array[i]; });
         return array[i]; // TODO optimize all of this
     }*/
 });
@@ -138,6 +138,13 @@ test.float1 = 183.2;
 eval(assert(' test.stateVariableValues["float1"] === 183.2 '));
 eval(assert(" test.float1 === 183.2 "));
 
+// Floats that do not fit the typed wire encoding (NaN, infinite or too large) arrive as strings
+eval(assert(' test[_SV_PREFIX + "float1"].fromWire(183.2) === 183.2 '));
+eval(assert(' test[_SV_PREFIX + "float1"].fromWire("3e+40") === 3e+40 '));
+eval(assert(' test[_SV_PREFIX + "float1"].fromWire(String(1e10)) === 1e10 '));
+eval(assert(' isNaN(test[_SV_PREFIX + "float1"].fromWire(String(NaN))) '));
+eval(assert(' test[_SV_PREFIX + "float1"].fromWire(String(-Infinity)) === -Infinity '));
+
 // Boolean
 
 test.bool1._register("bool1", test);
@@ -238,6 +245,11 @@ eval(assert(' typeof test.farr1.get(0) === "number" '));
 eval(assert(' test[_SV_PREFIX + "farr1"].toData(test.stateVariableValues["farr1"]) === "[1|7.56]" '));
 eval(assert(" arrayEqual(test.farr1.asArray(), [1, 7.56]) "));
 
+// Float arrays arrive typed, or as arrays of strings if an item does not fit the typed wire encoding
+eval(assert(' arrayEqual(test[_SV_PREFIX + "farr1"].fromWire([1, 7.56]), [1, 7.56]) '));
+eval(assert(' arrayEqual(test[_SV_PREFIX + "farr1"].fromWire(["1", String(5e20)]), [1, 5e20]) '));
+eval(assert(' isNaN(test[_SV_PREFIX + "farr1"].fromWire(["1", String(NaN)])[1]) '));
+
 
 // Subclasses, aliases, etc.
 
@@ -224,6 +224,12 @@ def set_config(section, option, value):
     configFile.set(section, option, value)
     # TODO: Save the config file at this point?
 
+    # Let C++ drop any values it cached (see Utility::Config::changed). Not yet possible while starting up
+    import intensity.c_module
+    CModule = intensity.c_module.CModule.holder
+    if hasattr(CModule, 'config_changed'):
+        CModule.config_changed(section, option)
+
 
 ### Components
 
@@ -270,6 +276,12 @@ def quit():
     global _should_quit
     _should_quit = True
 
+    # The server main loop is native, and does not poll should_quit
+    import intensity.c_module
+    CModule = intensity.c_module.CModule.holder
+    if hasattr(CModule, 'quit_main_loop'):
+        CModule.quit_main_loop()
+
 ## @return Whether quitting has been called, and we should shut down.
 def should_quit():
     global _should_quit
@@ -23,11 +23,14 @@ class SafeActionQueue:
         self.action_needed = threading.Event() # Either a new action, or to quit
         self.should_quit = False
         self.has_quit = False
+        self.on_action_added = None # Optional, called (in the adding thread) after each action is added
 
     def add_action(self, action):
         with self.lock:
             self.action_queue.append(action)
             self.action_needed.set()
+        if self.on_action_added is not None:
+            self.on_action_added()
 
     ## Runs all queued actions, in order, and returns
     def execute_all(self):
@@ -22,6 +22,8 @@ enum
     TRIGGER_DISAPPEARED
 };
 
+struct CLogicEntity; // INTENSITY
+
 struct entitylight
 {
     vec color, dir;
@@ -38,8 +40,9 @@ struct extentity : entity                       // part of the entity that doesn
     extentity *attached;
 
     int uniqueId; // Kripken: Added this
+    CLogicEntity *logicEntity; // INTENSITY: Set by LogicSystem while registered
 
-    extentity() : visible(false), triggerstate(TRIGGER_RESET), lasttrigger(0), attached(NULL), uniqueId(-1) {}
+    extentity() : visible(false), triggerstate(TRIGGER_RESET), lasttrigger(0), attached(NULL), uniqueId(-1), logicEntity(NULL) {}
 };
 
 #define MAXENTS 10000
@@ -78,12 +81,15 @@ struct physent                                  // base entity type, can be affe
     physent *onplayer;
     int lastmove, lastmoveattempt, collisions, stacks;
 
+    CLogicEntity *logicEntity;                  // INTENSITY: Set by LogicSystem while registered
+
     physent() : o(0, 0, 0), deltapos(0, 0, 0), newpos(0, 0, 0), yaw(270), pitch(0), roll(0), maxspeed(100), 
                radius(4.1f), eyeheight(14), aboveeye(1), xradius(4.1f), yradius(4.1f), zmargin(0),
                state(CS_ALIVE), editstate(CS_ALIVE), type(ENT_PLAYER),
                collidetype(COLLIDE_ELLIPSE),
                blocked(false), moving(true),
-               onplayer(NULL), lastmove(0), lastmoveattempt(0), collisions(0), stacks(0)
+               onplayer(NULL), lastmove(0), lastmoveattempt(0), collisions(0), stacks(0),
+               logicEntity(NULL) // INTENSITY
                { reset(); }
               
     void resetinterp()